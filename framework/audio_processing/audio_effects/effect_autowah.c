@@ -8,8 +8,12 @@
  * 800-1000Hz and as the note decays, the filter is swept towards
  * a lower frequnecy.
  *
- * This audio effect also serves as an example of how to utilize the
- * biquad filter audio element.
+ * The three band-pass filters are run as one biquad cascade, in a single
+ * pass over the block.  They share their coefficients, which are calculated
+ * once for all three when the frequency or Q changes and ramped to over
+ * AUTOWAH_RAMP_SAMPLES so the sweep has no zipper noise.  The envelope moves
+ * the frequency a little every block, so the coefficients are only
+ * recalculated once it has moved by more than AUTOWAH_FREQ_THRESHOLD.
  *
  */
 #include <stdlib.h>
@@ -25,6 +29,12 @@
 #define  AUTOWAH_Q_MIN          (0.0)
 #define  AUTOWAH_Q_MAX          (1.0)
 #define  AUTOWAH_MAX_BF_FREQ    (800.0)
+#define  AUTOWAH_BPF_SECTIONS   (3)     // band-pass filters in series, 6th order
+#define  AUTOWAH_RAMP_SAMPLES   (320)   // as BIQUAD_TRANS_MED in per-sample mode
+#define  AUTOWAH_FREQ_THRESHOLD (0.01)  // fraction of the frequency, ~1/6 semitone
+
+// Static function prototypes
+static void autowah_update_filter(AUTOWAH * c);
 
 /**
  * @brief Initializes instance of an autowah
@@ -52,14 +62,15 @@ RESULT_AUTOWAH autowah_setup(AUTOWAH * c, float depth, float decay,
 		return AUTOWAH_INVALID_DECAY;
 	}
 
-	filter_setup(&c->bpf1, BIQUAD_TYPE_BPF, BIQUAD_TRANS_MED,
-			(pm float *) c->bpf_coeffs1, 400.0, 2.0, 1.0, audio_sample_rate);
+	biquad_cascade_setup(&c->bpf, AUTOWAH_BPF_SECTIONS, audio_sample_rate);
 
-	filter_setup(&c->bpf2, BIQUAD_TYPE_BPF, BIQUAD_TRANS_MED,
-			(pm float *) c->bpf_coeffs2, 400.0, 2.0, 1.0, audio_sample_rate);
+	c->freq = 400.0;
+	c->q = 2.0;
+	c->q_last = c->q;
+	autowah_update_filter(c);
 
-	filter_setup(&c->bpf3, BIQUAD_TYPE_BPF, BIQUAD_TRANS_MED,
-			(pm float *) c->bpf_coeffs2, 400.0, 2.0, 1.0, audio_sample_rate);
+	// The filters are swept every block so ramp their coefficients per sample
+	biquad_cascade_set_ramp(&c->bpf, AUTOWAH_RAMP_SAMPLES);
 
 	c->depth = 1000.0 * depth;
 	c->decay = 0.999 + (0.001 * decay);
@@ -179,12 +190,10 @@ RESULT_AUTOWAH autowah_modify_q(AUTOWAH * c, float q_new) {
 	if (c->q == c->q_last) {
 		return res;
 	} else {
-		c->q_last = q;
+		c->q_last = c->q;
 	}
 
-	filter_modify_q(&c->bpf1, c->q);
-	filter_modify_q(&c->bpf2, c->q);
-	filter_modify_q(&c->bpf3, c->q);
+	autowah_update_filter(c);
 
 	return res;
 }
@@ -217,13 +226,33 @@ void autowah_read(AUTOWAH * c, float * audio_in, float * audio_out,
 	if (env_freq > AUTOWAH_MAX_BF_FREQ)
 		env_freq = AUTOWAH_MAX_BF_FREQ;
 
-	// Update filter center frequency based on amplitude
-	filter_modify_freq(&c->bpf1, 300.0 + env_freq);
-	filter_modify_freq(&c->bpf2, 300.0 + env_freq);
-	filter_modify_freq(&c->bpf3, 300.0 + env_freq);
+	// Update filter center frequency based on amplitude, once it has moved
+	// far enough to be heard
+	float freq = 300.0 + env_freq;
+	float freq_change = freq - c->freq;
+	if (freq_change < 0.0) {
+		freq_change = -freq_change;
+	}
+	if (freq_change > c->freq * AUTOWAH_FREQ_THRESHOLD) {
+		c->freq = freq;
+		autowah_update_filter(c);
+	}
 
 	// Apply band pass filters in series to create a 6th order filter
-	filter_read(&c->bpf1, audio_in, audio_out, audio_block_size);
-	filter_read(&c->bpf2, audio_out, audio_out, audio_block_size);
-	filter_read(&c->bpf3, audio_out, audio_out, audio_block_size);
+	biquad_cascade_read(&c->bpf, audio_in, audio_out, audio_block_size);
+}
+
+/**
+ * @brief Loads the current frequency and Q into all the band-pass filters
+ */
+static void autowah_update_filter(AUTOWAH * c) {
+
+	float coeffs_ab[6];
+
+	filter_generate_coeffs(BIQUAD_TYPE_BPF, c->freq, c->q, 1.0,
+			c->bpf.audio_sample_rate, coeffs_ab);
+
+	for (int i = 0; i < AUTOWAH_BPF_SECTIONS; i++) {
+		biquad_cascade_modify_section_coeffs(&c->bpf, i, coeffs_ab);
+	}
 }
@@ -9,7 +9,7 @@
 
 #include  <stdint.h>
 
-#include "../audio_elements/biquad_filter.h"
+#include "../audio_elements/biquad_cascade.h"
 #include "../audio_elements/audio_elements_common.h"
 
 // Result enumerations
@@ -25,8 +25,8 @@ typedef enum {
 typedef struct {
 
 	bool initialized;
-	BIQUAD_FILTER bpf1, bpf2, bpf3;
-	float bpf_coeffs1[6], bpf_coeffs2[6], bpf_coeffs3[6];
+	BIQUAD_CASCADE bpf;
+	float freq;
 	float measured_ampitude;
 	float freq_start;
 	float depth;
@@ -0,0 +1,542 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This effect is a feedback delay network (FDN) reverb.
+ *
+ * An FDN is a set of parallel delay lines whose outputs are mixed through an
+ * orthogonal (energy preserving) matrix and fed back into the inputs of all
+ * the lines.  Each trip around the network multiplies the echo density by the
+ * number of lines, so 8 or 16 lines build up a dense tail much faster than a
+ * bank of independent comb filters.  Decay is set by a gain per line that
+ * depends on the line length, so every line loses the same amount of energy
+ * per second and the reverb time can be set directly in seconds.
+ *
+ * Unlike the STEREO_REVERB effect, which runs a separate set of combs and
+ * allpasses for each output, both outputs are taken from the same network
+ * (even lines to the left, odd lines to the right).
+ *
+ * The network is processed in chunks of FDN_REVERB_CHUNK_SIZE samples.  As
+ * long as every line is at least one chunk long, the outputs of all lines for
+ * the whole chunk can be read before anything is written back, so each step
+ * (damping, mixing, feeding back) is a simple loop over the chunk.
+ *
+ * Mixing matrices:
+ *
+ *   Hadamard - every line feeds every other line equally.  Computed with a
+ *   fast Walsh-Hadamard transform (N log2 N adds per sample).
+ *
+ *   Householder - I - (2/N) * ones, computed as one sum and one subtraction
+ *   per line.  Cheaper, but lines mostly feed back into themselves so the
+ *   tail takes longer to become dense.
+ *
+ * For more information on FDN reverbs, see:
+ * https://ccrma.stanford.edu/~jos/pasp/FDN_Reverberation.html
+ */
+
+#include <math.h>
+
+#include "effect_fdn_reverb.h"
+#include "../audio_elements/circular_buffer.h"
+
+// Min/max limits and other constants
+#define     FDN_REVERB_DECAY_MIN        (0.1)
+#define     FDN_REVERB_DECAY_MAX        (20.0)
+#define     FDN_REVERB_DAMPING_MIN      (0.0)
+#define     FDN_REVERB_DAMPING_MAX      (1.0)
+#define     FDN_REVERB_SIZE_MIN         (0.1)
+#define     FDN_REVERB_SIZE_MAX         (2.0)
+#define     FDN_REVERB_WET_MIX_MIN      (0.0)
+#define     FDN_REVERB_WET_MIX_MAX      (1.0)
+#define     FDN_REVERB_DRY_MIX_MIN      (0.0)
+#define     FDN_REVERB_DRY_MIX_MAX      (1.0)
+
+#define     FDN_REVERB_CHUNK_SIZE       (32)
+#define     FDN_REVERB_MIN_LENGTH       (FDN_REVERB_CHUNK_SIZE)
+#define     FDN_REVERB_REFERENCE_FS     (48000.0)
+
+// Default line lengths at 48 kHz (primes, so the echoes don't line up)
+static const uint32_t fdn_reverb_lengths_8[8] = { 1031, 1213, 1361, 1493,
+		1657, 1801, 1949, 2089 };
+
+static const uint32_t fdn_reverb_lengths_16[16] = { 503, 577, 641, 709, 787,
+		853, 929, 997, 1069, 1151, 1223, 1301, 1373, 1453, 1531, 1601 };
+
+// Static function prototypes
+static void fdn_reverb_update_gains(FDN_REVERB * c);
+static void fdn_reverb_set_size(FDN_REVERB * c, float size);
+
+/**
+ * @brief Initializes instance of an FDN reverb
+ *
+ * The delay memory is split evenly between the lines.  Line lengths that
+ * don't fit are clipped to the memory available, so allocate
+ * FDN_REVERB_MEMORY_SIZE_8_LINES / FDN_REVERB_MEMORY_SIZE_16_LINES words for
+ * the default size at 48 kHz (more for larger sizes or sample rates).
+ *
+ * @param c Pointer to instance structure
+ * @param num_lines Number of delay lines (8 or 16)
+ * @param mixing Feedback matrix (see FDN_REVERB_MIXING)
+ * @param delay_memory Pointer to memory for the delay lines
+ * @param delay_memory_size Size of the delay memory in floating point words
+ * @param decay_s Reverb time in seconds (time for the tail to decay by 60 dB)
+ * @param damping High frequency damping (0.0->1.0)
+ * @param wet_mix Mix of processed (reverb) audio (0.0->1.0)
+ * @param dry_mix Mix of unprocessed audio (0.0->1.0)
+ * @param audio_sample_rate The system audio sample rate
+ * @return FDN reverb result (enumerated)
+ */
+RESULT_FDN_REVERB fdn_reverb_setup(FDN_REVERB * c, uint32_t num_lines,
+		FDN_REVERB_MIXING mixing, float * delay_memory,
+		uint32_t delay_memory_size, float decay_s, float damping,
+		float wet_mix, float dry_mix, float audio_sample_rate) {
+
+	if (c == NULL) {
+		return FDN_REVERB_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	// Fast Walsh-Hadamard transform needs a power of two
+	if (num_lines != 8 && num_lines != 16) {
+		return FDN_REVERB_INVALID_NUM_LINES;
+	}
+	c->num_lines = num_lines;
+	c->mixing = mixing;
+
+	if (delay_memory == NULL
+			|| delay_memory_size / num_lines < FDN_REVERB_MIN_LENGTH) {
+		return FDN_REVERB_INVALID_DELAY_MEMORY;
+	}
+	c->delay_memory = delay_memory;
+	c->line_capacity = delay_memory_size / num_lines;
+	c->write_index = 0;
+
+	if (decay_s < FDN_REVERB_DECAY_MIN || decay_s > FDN_REVERB_DECAY_MAX) {
+		return FDN_REVERB_INVALID_DECAY;
+	}
+	c->decay_s = decay_s;
+
+	if (damping < FDN_REVERB_DAMPING_MIN || damping > FDN_REVERB_DAMPING_MAX) {
+		return FDN_REVERB_INVALID_DAMPING;
+	}
+	c->damping = damping;
+	c->lpf_a = 1.0 - 0.9 * damping;
+
+	if (wet_mix < FDN_REVERB_WET_MIX_MIN || wet_mix > FDN_REVERB_WET_MIX_MAX) {
+		return FDN_REVERB_INVALID_WET_MIX;
+	}
+	c->wet_mix = wet_mix;
+
+	if (dry_mix < FDN_REVERB_DRY_MIX_MIN || dry_mix > FDN_REVERB_DRY_MIX_MAX) {
+		return FDN_REVERB_INVALID_DRY_MIX;
+	}
+	c->dry_mix = dry_mix;
+
+	c->audio_sample_rate = audio_sample_rate;
+
+	// Zero delay lines and filter state
+	for (int i = 0; i < c->line_capacity * num_lines; i++) {
+		delay_memory[i] = 0.0;
+	}
+	for (int i = 0; i < FDN_REVERB_MAX_LINES; i++) {
+		c->lpf_hist[i] = 0.0;
+	}
+
+	fdn_reverb_set_size(c, 1.0);
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return FDN_REVERB_OK;
+
+}
+
+/**
+ * @brief Modify reverb time
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param decay_s_new New reverb time in seconds (0.1->20.0)
+ * @return FDN reverb result (enumerated)
+ */
+RESULT_FDN_REVERB fdn_reverb_modify_decay(FDN_REVERB * c, float decay_s_new) {
+
+	if (c == NULL) {
+		return FDN_REVERB_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_FDN_REVERB res = FDN_REVERB_OK;
+
+	if (decay_s_new < FDN_REVERB_DECAY_MIN) {
+		decay_s_new = FDN_REVERB_DECAY_MIN;
+		res = FDN_REVERB_INVALID_DECAY;
+	} else if (decay_s_new > FDN_REVERB_DECAY_MAX) {
+		decay_s_new = FDN_REVERB_DECAY_MAX;
+		res = FDN_REVERB_INVALID_DECAY;
+	}
+
+	// Update instance parameters
+	c->decay_s = decay_s_new;
+	fdn_reverb_update_gains(c);
+
+	return res;
+}
+
+/**
+ * @brief Modify high frequency damping
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param damping_new New damping value (0.0->1.0); higher is more damping
+ * @return FDN reverb result (enumerated)
+ */
+RESULT_FDN_REVERB fdn_reverb_modify_damping(FDN_REVERB * c,
+		float damping_new) {
+
+	if (c == NULL) {
+		return FDN_REVERB_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_FDN_REVERB res = FDN_REVERB_OK;
+
+	if (damping_new < FDN_REVERB_DAMPING_MIN) {
+		damping_new = FDN_REVERB_DAMPING_MIN;
+		res = FDN_REVERB_INVALID_DAMPING;
+	} else if (damping_new > FDN_REVERB_DAMPING_MAX) {
+		damping_new = FDN_REVERB_DAMPING_MAX;
+		res = FDN_REVERB_INVALID_DAMPING;
+	}
+
+	// Update instance parameters
+	c->damping = damping_new;
+	c->lpf_a = 1.0 - 0.9 * damping_new;
+
+	return res;
+}
+
+/**
+ * @brief Modify room size by scaling all of the default line lengths
+ *
+ * Lengths that don't fit in the delay memory are clipped.  If the input
+ * parameter is out of bounds, it is clipped to the corresponding min/max
+ * value.  This function will return a value indicating an invalid input
+ * parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param size_new New size relative to the default lengths (0.1->2.0)
+ * @return FDN reverb result (enumerated)
+ */
+RESULT_FDN_REVERB fdn_reverb_modify_size(FDN_REVERB * c, float size_new) {
+
+	if (c == NULL) {
+		return FDN_REVERB_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_FDN_REVERB res = FDN_REVERB_OK;
+
+	if (size_new < FDN_REVERB_SIZE_MIN) {
+		size_new = FDN_REVERB_SIZE_MIN;
+		res = FDN_REVERB_INVALID_SIZE;
+	} else if (size_new > FDN_REVERB_SIZE_MAX) {
+		size_new = FDN_REVERB_SIZE_MAX;
+		res = FDN_REVERB_INVALID_SIZE;
+	}
+
+	fdn_reverb_set_size(c, size_new);
+
+	return res;
+}
+
+/**
+ * @brief Set the length of every delay line directly
+ *
+ * Lengths are clipped to FDN_REVERB_MIN_LENGTH and the memory available per
+ * line.  Use mutually prime lengths for the smoothest tail.
+ *
+ * @param c Pointer to instance structure
+ * @param lengths_new Array of num_lines lengths in samples
+ * @return FDN reverb result (enumerated)
+ */
+RESULT_FDN_REVERB fdn_reverb_modify_lengths(FDN_REVERB * c,
+		uint32_t * lengths_new) {
+
+	if (c == NULL) {
+		return FDN_REVERB_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_FDN_REVERB res = FDN_REVERB_OK;
+
+	for (int i = 0; i < c->num_lines; i++) {
+		uint32_t length = lengths_new[i];
+		if (length < FDN_REVERB_MIN_LENGTH) {
+			length = FDN_REVERB_MIN_LENGTH;
+			res = FDN_REVERB_INVALID_LENGTH;
+		} else if (length > c->line_capacity) {
+			length = c->line_capacity;
+			res = FDN_REVERB_INVALID_LENGTH;
+		}
+		c->lengths[i] = length;
+	}
+
+	fdn_reverb_update_gains(c);
+
+	return res;
+}
+
+/**
+ * @brief Modify reverb wet (processed) mix
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param wet_mix_new New wet mix value (0.0->1.0)
+ * @return FDN reverb result (enumerated)
+ */
+RESULT_FDN_REVERB fdn_reverb_modify_wet_mix(FDN_REVERB * c,
+		float wet_mix_new) {
+
+	if (c == NULL) {
+		return FDN_REVERB_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_FDN_REVERB res = FDN_REVERB_OK;
+
+	if (wet_mix_new < FDN_REVERB_WET_MIX_MIN) {
+		wet_mix_new = FDN_REVERB_WET_MIX_MIN;
+		res = FDN_REVERB_INVALID_WET_MIX;
+	} else if (wet_mix_new > FDN_REVERB_WET_MIX_MAX) {
+		wet_mix_new = FDN_REVERB_WET_MIX_MAX;
+		res = FDN_REVERB_INVALID_WET_MIX;
+	}
+
+	// Update instance parameters
+	c->wet_mix = wet_mix_new;
+
+	return res;
+}
+
+/**
+ * @brief Modify reverb dry (unprocessed) mix
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param dry_mix_new New dry mix value (0.0->1.0)
+ * @return FDN reverb result (enumerated)
+ */
+RESULT_FDN_REVERB fdn_reverb_modify_dry_mix(FDN_REVERB * c,
+		float dry_mix_new) {
+
+	if (c == NULL) {
+		return FDN_REVERB_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_FDN_REVERB res = FDN_REVERB_OK;
+
+	if (dry_mix_new < FDN_REVERB_DRY_MIX_MIN) {
+		dry_mix_new = FDN_REVERB_DRY_MIX_MIN;
+		res = FDN_REVERB_INVALID_DRY_MIX;
+	} else if (dry_mix_new > FDN_REVERB_DRY_MIX_MAX) {
+		dry_mix_new = FDN_REVERB_DRY_MIX_MAX;
+		res = FDN_REVERB_INVALID_DRY_MIX;
+	}
+
+	// Update instance parameters
+	c->dry_mix = dry_mix_new;
+
+	return res;
+}
+
+/**
+ * @brief Apply effect/process to a block of audio data
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out_left Pointer to floating point output buffer (mono left)
+ * @param audio_out_right Pointer to floating point output buffer (mono right)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void fdn_reverb_read(FDN_REVERB * c, float * audio_in, float * audio_out_left,
+		float * audio_out_right, uint32_t audio_block_size) {
+
+	// If this instance hasn't been properly initialized, pass audio through
+	if (c == NULL || !c->initialized) {
+		for (int i = 0; i < audio_block_size; i++) {
+			audio_out_left[i] = audio_in[i];
+			audio_out_right[i] = audio_in[i];
+		}
+		return;
+	}
+
+	uint32_t num_lines = c->num_lines;
+	uint32_t capacity = c->line_capacity;
+	float lpf_a = c->lpf_a;
+	float dry_mix = c->dry_mix;
+
+	// Each output sums half of the lines, scaled to roughly the same level
+	// as STEREO_REVERB for the same wet mix
+	float wet_gain = c->wet_mix / (float) num_lines;
+
+	float lines[FDN_REVERB_MAX_LINES][FDN_REVERB_CHUNK_SIZE];
+	float wet_left[FDN_REVERB_CHUNK_SIZE], wet_right[FDN_REVERB_CHUNK_SIZE];
+
+	for (int base = 0; base < audio_block_size; base += FDN_REVERB_CHUNK_SIZE) {
+
+		uint32_t n = audio_block_size - base;
+		if (n > FDN_REVERB_CHUNK_SIZE) {
+			n = FDN_REVERB_CHUNK_SIZE;
+		}
+		float * x = &audio_in[base];
+
+		// Read the output of every line for the whole chunk
+		for (int i = 0; i < num_lines; i++) {
+			uint32_t read_index = circular_buffer_wrap(
+					(int32_t) c->write_index - (int32_t) c->lengths[i],
+					capacity);
+			circular_buffer_read(&c->delay_memory[i * capacity], capacity,
+					read_index, lines[i], n);
+		}
+
+		// Even lines to the left, odd lines to the right
+		for (int k = 0; k < n; k++) {
+			wet_left[k] = 0.0;
+			wet_right[k] = 0.0;
+		}
+		for (int i = 0; i < num_lines; i += 2) {
+			float * l = lines[i];
+			float * r = lines[i + 1];
+			for (int k = 0; k < n; k++) {
+				wet_left[k] += l[k];
+				wet_right[k] += r[k];
+			}
+		}
+
+		// Damping and decay
+		for (int i = 0; i < num_lines; i++) {
+			float * d = lines[i];
+			float g = c->line_gain[i];
+			float h = c->lpf_hist[i];
+			for (int k = 0; k < n; k++) {
+				h += lpf_a * (d[k] - h);
+				d[k] = h * g;
+			}
+			c->lpf_hist[i] = h;
+		}
+
+		// Feedback matrix
+		if (c->mixing == FDN_REVERB_MIX_HADAMARD) {
+			for (int h = 1; h < num_lines; h *= 2) {
+				for (int j = 0; j < num_lines; j += 2 * h) {
+					for (int i = j; i < j + h; i++) {
+						float * a = lines[i];
+						float * b = lines[i + h];
+						for (int k = 0; k < n; k++) {
+							float t = a[k];
+							a[k] = t + b[k];
+							b[k] = t - b[k];
+						}
+					}
+				}
+			}
+		} else {
+			float sum[FDN_REVERB_CHUNK_SIZE];
+			for (int k = 0; k < n; k++) {
+				sum[k] = 0.0;
+			}
+			for (int i = 0; i < num_lines; i++) {
+				for (int k = 0; k < n; k++) {
+					sum[k] += lines[i][k];
+				}
+			}
+			float scale = 2.0 / (float) num_lines;
+			for (int i = 0; i < num_lines; i++) {
+				float * d = lines[i];
+				for (int k = 0; k < n; k++) {
+					d[k] -= scale * sum[k];
+				}
+			}
+		}
+
+		// Feed the input into every line (alternating polarity) and write back
+		for (int i = 0; i < num_lines; i++) {
+			float * d = lines[i];
+			if (i & 1) {
+				for (int k = 0; k < n; k++) {
+					d[k] -= x[k];
+				}
+			} else {
+				for (int k = 0; k < n; k++) {
+					d[k] += x[k];
+				}
+			}
+			circular_buffer_write(&c->delay_memory[i * capacity], capacity,
+					c->write_index, d, n);
+		}
+		c->write_index = circular_buffer_wrap(c->write_index + n, capacity);
+
+		// Mix (input may be the same buffer as one of the outputs)
+		for (int k = 0; k < n; k++) {
+			float dry = x[k] * dry_mix;
+			audio_out_left[base + k] = wet_left[k] * wet_gain + dry;
+			audio_out_right[base + k] = wet_right[k] * wet_gain + dry;
+		}
+	}
+}
+
+/**
+ * @brief Sets the line lengths from the default table scaled by size
+ *
+ * @param c Pointer to instance structure
+ * @param size Size relative to the default lengths
+ */
+static void fdn_reverb_set_size(FDN_REVERB * c, float size) {
+
+	const uint32_t * table = (c->num_lines == 8) ?
+			fdn_reverb_lengths_8 : fdn_reverb_lengths_16;
+	float scale = size * c->audio_sample_rate * (1.0 / FDN_REVERB_REFERENCE_FS);
+
+	for (int i = 0; i < c->num_lines; i++) {
+		uint32_t length = (uint32_t) ((float) table[i] * scale + 0.5);
+		if (length < FDN_REVERB_MIN_LENGTH) {
+			length = FDN_REVERB_MIN_LENGTH;
+		} else if (length > c->line_capacity) {
+			length = c->line_capacity;
+		}
+		c->lengths[i] = length;
+	}
+	c->size = size;
+
+	fdn_reverb_update_gains(c);
+}
+
+/**
+ * @brief Calculates the feedback gain of each line from the reverb time
+ *
+ * A line of length L is passed through fs * T60 / L times in T60 seconds, and
+ * the gain per pass is chosen so these add up to -60 dB.  The normalization
+ * of the Hadamard matrix (1 / sqrt(N)) is folded into the same gains.
+ *
+ * @param c Pointer to instance structure
+ */
+static void fdn_reverb_update_gains(FDN_REVERB * c) {
+
+	float norm = 1.0;
+	if (c->mixing == FDN_REVERB_MIX_HADAMARD) {
+		norm = 1.0 / sqrtf((float) c->num_lines);
+	}
+
+	for (int i = 0; i < c->num_lines; i++) {
+		float passes = c->decay_s * c->audio_sample_rate / (float) c->lengths[i];
+		c->line_gain[i] = norm * powf(10.0, -3.0 / passes);
+	}
+}
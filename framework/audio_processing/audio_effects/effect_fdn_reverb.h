@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _AUDIO_EFFECT_FDN_REVERB_H
+#define _AUDIO_EFFECT_FDN_REVERB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../audio_elements/audio_elements_common.h"
+
+#define FDN_REVERB_MAX_LINES    (16)
+
+// Delay memory needed for the default line lengths at size 1.0 (48 kHz)
+#define FDN_REVERB_MEMORY_SIZE_8_LINES      (8 * 2096)
+#define FDN_REVERB_MEMORY_SIZE_16_LINES     (16 * 1608)
+
+// Result enumerations
+typedef enum {
+	FDN_REVERB_OK,
+	FDN_REVERB_INVALID_INSTANCE_POINTER,
+	FDN_REVERB_INVALID_NUM_LINES,
+	FDN_REVERB_INVALID_DELAY_MEMORY,
+	FDN_REVERB_INVALID_DECAY,
+	FDN_REVERB_INVALID_DAMPING,
+	FDN_REVERB_INVALID_SIZE,
+	FDN_REVERB_INVALID_LENGTH,
+	FDN_REVERB_INVALID_WET_MIX,
+	FDN_REVERB_INVALID_DRY_MIX
+} RESULT_FDN_REVERB;
+
+// Feedback matrix used to mix the delay lines
+typedef enum {
+	FDN_REVERB_MIX_HADAMARD,	// dense, every line feeds every other line
+	FDN_REVERB_MIX_HOUSEHOLDER	// cheaper, lines mostly feed themselves
+} FDN_REVERB_MIXING;
+
+// C struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	uint32_t num_lines;
+	FDN_REVERB_MIXING mixing;
+
+	// Each line has line_capacity words of delay_memory, all lines share
+	// the same write index and read at their own length behind it
+	float * delay_memory;
+	uint32_t line_capacity;
+	uint32_t write_index;
+	uint32_t lengths[FDN_REVERB_MAX_LINES];
+
+	float line_gain[FDN_REVERB_MAX_LINES];
+	float lpf_hist[FDN_REVERB_MAX_LINES];
+	float lpf_a;
+
+	float decay_s;
+	float damping;
+	float size;
+	float wet_mix;
+	float dry_mix;
+
+	float audio_sample_rate;
+
+} FDN_REVERB;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_FDN_REVERB fdn_reverb_setup(FDN_REVERB * c, uint32_t num_lines,
+		FDN_REVERB_MIXING mixing, float * delay_memory,
+		uint32_t delay_memory_size, float decay_s, float damping,
+		float wet_mix, float dry_mix, float audio_sample_rate);
+
+RESULT_FDN_REVERB fdn_reverb_modify_decay(FDN_REVERB * c, float decay_s_new);
+
+RESULT_FDN_REVERB fdn_reverb_modify_damping(FDN_REVERB * c,
+		float damping_new);
+
+RESULT_FDN_REVERB fdn_reverb_modify_size(FDN_REVERB * c, float size_new);
+
+RESULT_FDN_REVERB fdn_reverb_modify_lengths(FDN_REVERB * c,
+		uint32_t * lengths_new);
+
+RESULT_FDN_REVERB fdn_reverb_modify_wet_mix(FDN_REVERB * c,
+		float wet_mix_new);
+
+RESULT_FDN_REVERB fdn_reverb_modify_dry_mix(FDN_REVERB * c,
+		float dry_mix_new);
+
+void fdn_reverb_read(FDN_REVERB * c, float * audio_in, float * audio_out_left,
+		float * audio_out_right, uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif // _AUDIO_EFFECT_FDN_REVERB_H
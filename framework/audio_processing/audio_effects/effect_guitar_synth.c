@@ -3,11 +3,11 @@
  *
  * A guitar synth creates additional synthesized voices / instruments at the
  * same frequency that is currently being played.  It does this by first
- * determining the frequency being played using a zero-crossing detector.
+ * determining the frequency being played using a pitch detector.
  * Based on the detected frequency, it synthesis additional waveforms.
  *
  * This audio effect also serves as an example of how to utilize the
- * zero_crossing_detector, simple synth and biquad filter audio elements.
+ * pitch_detector, simple synth and biquad filter audio elements.
  */
 
 #include "effect_guitar_synth.h"
@@ -19,6 +19,14 @@
 #define  GUITAR_SYNTH_SYNTH_MIX_MIN      (0.0)
 #define  GUITAR_SYNTH_SYNTH_MIX_MAX      (1.0)
 
+// Pitch range of a guitar in standard tuning (low E is 82 Hz)
+#define  GUITAR_SYNTH_PITCH_MIN_FREQ     (70.0)
+#define  GUITAR_SYNTH_PITCH_MAX_FREQ     (1200.0)
+
+// Set to true and call guitar_synth_process_background() from the background
+// loop to take the pitch analysis out of the audio callback
+#define  GUITAR_SYNTH_PITCH_IN_BACKGROUND   (false)
+
 /**
  * @brief Initializes instance of a guitar synth
  *
@@ -49,8 +57,11 @@ RESULT_GUITAR_SYNTH guitar_synth_setup(GUITAR_SYNTH * c, float clean_mix,
 	c->synth_volume = 0.5;
 	c->measured_ampitude = 0;
 
-	// Set up zero-crossing detector
-	zero_cross_setup(&c->zc_detect, ZC_DEFAULT_THRESHOLD, audio_sample_rate);
+	// Set up pitch detector
+	pitch_detector_setup(&c->pitch_detect, GUITAR_SYNTH_PITCH_MIN_FREQ,
+			GUITAR_SYNTH_PITCH_MAX_FREQ, PITCH_DETECTOR_DEFAULT_THRESHOLD,
+			PITCH_DETECTOR_DEFAULT_LEVEL, GUITAR_SYNTH_PITCH_IN_BACKGROUND,
+			audio_sample_rate);
 
 	// Set up synthesizers
 	synth_setup(&c->synth, c->synth_attack, c->synth_decay, c->synth_sustain,
@@ -67,8 +78,12 @@ RESULT_GUITAR_SYNTH guitar_synth_setup(GUITAR_SYNTH * c, float clean_mix,
 	filter_setup(&c->env_filter, BIQUAD_TYPE_BPF, BIQUAD_TRANS_VERY_SLOW,
 			(pm float *) c->env_filter_coeffs, 400.0, 3.0, 1.0,
 			audio_sample_rate);
+	filter_set_transition_mode(&c->env_filter, BIQUAD_TRANSITION_PER_SAMPLE);
 
 	c->lock_cntr = 0;
+	c->last_lock = false;
+	c->current_lock = false;
+	c->detected_frequency = 0.0;
 
 	// Instance was successfully initialized
 	c->initialized = true;
@@ -163,7 +178,7 @@ void guitar_synth_read(GUITAR_SYNTH * c, float * audio_in, float * audio_out,
 	float synth_out_1[MAX_AUDIO_BLOCK_SIZE], synth_out_2[MAX_AUDIO_BLOCK_SIZE],
 			synth_out_3[MAX_AUDIO_BLOCK_SIZE];
 
-	c->current_lock = zero_crossing_read(&c->zc_detect, audio_in,
+	c->current_lock = pitch_detector_read(&c->pitch_detect, audio_in,
 			audio_block_size, &c->detected_frequency);
 
 	if (c->current_lock) {
@@ -226,3 +241,20 @@ void guitar_synth_read(GUITAR_SYNTH * c, float * audio_in, float * audio_out,
 
 }
 
+/**
+ * @brief Runs the pitch analysis outside of the audio callback
+ *
+ * Only does anything when GUITAR_SYNTH_PITCH_IN_BACKGROUND is true, in which
+ * case this should be called from processaudio_background_loop().
+ *
+ * @param c Pointer to instance structure
+ * @return true if a frame was analyzed
+ */
+bool guitar_synth_process_background(GUITAR_SYNTH * c) {
+
+	if (c == NULL || !c->initialized) {
+		return false;
+	}
+
+	return pitch_detector_process_background(&c->pitch_detect);
+}
@@ -9,7 +9,8 @@
 
 #include "../audio_elements/audio_elements_common.h"
 
-#include "../audio_elements/zero_crossing_detector.h"
+#include "../audio_elements/biquad_filter.h"
+#include "../audio_elements/pitch_detector.h"
 #include "../audio_elements/simple_synth.h"
 #include "../audio_elements/audio_utilities.h"
 
@@ -27,7 +28,7 @@ typedef enum {
 typedef struct {
 
 	bool initialized;
-	ZERO_CROSSING_DETECTOR zc_detect;
+	PITCH_DETECTOR pitch_detect;
 
 	BIQUAD_FILTER env_filter;
 	float env_filter_coeffs[6];
@@ -74,6 +75,8 @@ RESULT_GUITAR_SYNTH guitar_synth_modify_synth_mix(GUITAR_SYNTH * c,
 void guitar_synth_read(GUITAR_SYNTH * c, float * audio_in, float * audio_out,
 		uint32_t audio_block_size);
 
+bool guitar_synth_process_background(GUITAR_SYNTH * c);
+
 #if __cplusplus
 }
 #endif
@@ -1,5 +1,9 @@
 /*
  * copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * A stereo flanger mixes the input with a copy of itself delayed by a few
+ * milliseconds, with the delay swept by a sine LFO.  The two sides sweep in
+ * opposite directions from one shared LFO, which widens the stereo image.
  */
 
 #include "effect_stereo_flanger.h"
@@ -12,6 +16,13 @@
 #define FLANGER_RATE_HZ_MIN    (0.01)
 #define FLANGER_RATE_HZ_MAX    (10.0)
 
+// Shortest delay, and the sweep (in samples) either side of the center at full depth
+#define FLANGER_PRE_DELAY      (100.0)
+#define FLANGER_SWEEP          (460.8)
+
+// Static function prototypes
+static void flanger_set_sweep(STEREO_FLANGER * c, float depth);
+
 /**
  * @brief Initializes instance of a stereo flanger
  *
@@ -43,15 +54,24 @@ RESULT_FLANGER flanger_setup(STEREO_FLANGER * c, float depth, float rate_hz,
 		return FLANGER_INVALID_FEEDBACK;
 	}
 
-	variable_delay_setup(&c->var_del_left, depth, feedback, rate_hz,
-			audio_sample_rate, VARIABLE_DELAY_EXT_LFO);
+	// Right side sweeps with the inverted LFO (180 degrees out of phase)
+	float sweep = depth * FLANGER_SWEEP;
+	fractional_delay_setup(&c->delay_left, c->delay_line_left,
+	FLANGER_DELAY_LINE_LEN, FLANGER_PRE_DELAY + sweep, sweep, 0.0,
+			FRACTIONAL_DELAY_LAGRANGE3);
+	fractional_delay_setup(&c->delay_right, c->delay_line_right,
+	FLANGER_DELAY_LINE_LEN, FLANGER_PRE_DELAY + sweep, -sweep, 0.0,
+			FRACTIONAL_DELAY_LAGRANGE3);
 
-	variable_delay_setup(&c->var_del_right, depth, feedback, rate_hz,
-			audio_sample_rate, VARIABLE_DELAY_EXT_LFO);
+	// Feedback is clipped to what the delay line supports
+	fractional_delay_modify_feedback(&c->delay_left, feedback);
+	fractional_delay_modify_feedback(&c->delay_right, feedback);
 
-	// Set up oscillators to be 180 degrees out of phase
-	c->lfo_t_left = 0.0;
-	c->lfo_t_right = 0.5;
+	c->depth = depth;
+	c->rate_hz = rate_hz;
+	c->feedback = feedback;
+
+	c->lfo_t = 0.0;
 	c->inc = rate_hz / audio_sample_rate;
 
 	c->audio_sample_rate = audio_sample_rate;
@@ -125,8 +145,7 @@ RESULT_FLANGER flanger_modify_depth(STEREO_FLANGER * c, float depth_new) {
 
 	// Update instance parameters
 	c->depth = depth;
-	variable_delay_modify_depth(&c->var_del_left, depth);
-	variable_delay_modify_depth(&c->var_del_right, depth);
+	flanger_set_sweep(c, depth);
 
 	return res;
 }
@@ -160,8 +179,8 @@ RESULT_FLANGER flanger_modify_feedback(STEREO_FLANGER * c, float feedback_new) {
 
 	// Update instance parameters
 	c->feedback = feedback;
-	variable_delay_modify_feedback(&c->var_del_left, feedback);
-	variable_delay_modify_feedback(&c->var_del_right, feedback);
+	fractional_delay_modify_feedback(&c->delay_left, feedback);
+	fractional_delay_modify_feedback(&c->delay_right, feedback);
 
 	return res;
 }
@@ -187,23 +206,41 @@ void flanger_read(STEREO_FLANGER * c, float * audio_in, float * audio_out_left,
 		return;
 	}
 
-	float lfo_left[MAX_AUDIO_BLOCK_SIZE], lfo_right[MAX_AUDIO_BLOCK_SIZE];
+	float lfo[MAX_AUDIO_BLOCK_SIZE];
 
-	// Generate LFO signal
-	float t_l = c->lfo_t_left;
-	float t_r = c->lfo_t_right;
-	float inc = c->inc;
-	for (int i = 0; i < audio_block_size; i++) {
-		lfo_left[i] = oscillator_sine(t_l += inc);
-		lfo_right[i] = oscillator_sine(t_r += inc);
-	}
-	c->lfo_t_left = t_l - floor(t_l);
-	c->lfo_t_right = t_r - floor(t_r);
+	// Generate LFO signal, shared by both sides
+	oscillator_lfo_block(OSC_SINE, &c->lfo_t, c->inc, lfo, audio_block_size);
 
-	variable_delay_read(&c->var_del_left, audio_in, audio_out_left, lfo_left,
+	fractional_delay_read(&c->delay_left, audio_in, audio_out_left, lfo,
 			audio_block_size);
-	variable_delay_read(&c->var_del_right, audio_in, audio_out_right, lfo_right,
+	fractional_delay_read(&c->delay_right, audio_in, audio_out_right, lfo,
 			audio_block_size);
 
+	// Mix the delayed signal with the input
+	for (int i = 0; i < audio_block_size; i++) {
+		audio_out_left[i] += audio_in[i];
+		audio_out_right[i] += audio_in[i];
+	}
+
 }
 
+/**
+ * @brief Sets the center delay and sweep of both sides for a depth
+ *
+ * @param c Pointer to instance structure
+ * @param depth Flanger depth (0.0->1.0)
+ */
+static void flanger_set_sweep(STEREO_FLANGER * c, float depth) {
+
+	float sweep = depth * FLANGER_SWEEP;
+
+	// Clear the sweep first so the new center delay is always in range
+	fractional_delay_modify_depth(&c->delay_left, 0.0);
+	fractional_delay_modify_depth(&c->delay_right, 0.0);
+
+	fractional_delay_modify_delay(&c->delay_left, FLANGER_PRE_DELAY + sweep);
+	fractional_delay_modify_delay(&c->delay_right, FLANGER_PRE_DELAY + sweep);
+
+	fractional_delay_modify_depth(&c->delay_left, sweep);
+	fractional_delay_modify_depth(&c->delay_right, -sweep);
+}
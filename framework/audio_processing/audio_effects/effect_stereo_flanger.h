@@ -7,12 +7,15 @@
 #ifndef _AUDIO_EFFECT_FLANGER_H
 #define _AUDIO_EFFECT_FLANGER_H
 
-#include "../audio_elements/variable_delay.h"
+#include "../audio_elements/fractional_delay.h"
 #include "../audio_elements/oscillators.h"
 
 #include <stdint.h>
 #include <stdbool.h>
 
+// Pre-delay plus the full sweep of the delay (samples)
+#define FLANGER_DELAY_LINE_LEN  (1124)
+
 // Result enumerations
 typedef enum {
 	FLANGER_OK,
@@ -27,14 +30,15 @@ typedef struct {
 
 	bool initialized;
 
-	VARIABLE_DELAY var_del_left;
-	VARIABLE_DELAY var_del_right;
+	FRACTIONAL_DELAY delay_left;
+	FRACTIONAL_DELAY delay_right;
+	float delay_line_left[FLANGER_DELAY_LINE_LEN];
+	float delay_line_right[FLANGER_DELAY_LINE_LEN];
 	float depth;
 	float rate_hz;
 	float feedback;
 
-	float lfo_t_left;
-	float lfo_t_right;
+	float lfo_t;
 	float inc;
 	float audio_sample_rate;
 
@@ -48,13 +48,14 @@ RESULT_STEREO_REVERB reverb_setup(STEREO_REVERB * c, float wet_mix,
 				allpass_right[i], 0.5);
 	}
 
+	// The right comb is kept as an offset from the left so one instance
+	// drives both
 	for (int i = 0; i < REVERB_DELAY_ELEMENTS; i++) {
-		delay_setup(&c->lpcf_left[i], &c->delay_buffers_left[i][0],
-				REVERB_MAX_DELAY_SIZE, delay_lens_left[i], feedback, 0.0,
-				lp_damp);
-		delay_setup(&c->lpcf_right[i], &c->delay_buffers_right[i][0],
-				REVERB_MAX_DELAY_SIZE, delay_lens_right[i], feedback, 0.0,
-				lp_damp);
+		int32_t offsets[2] = { 0, (int32_t) delay_lens_right[i]
+				- (int32_t) delay_lens_left[i] };
+		delay_setup_multichannel(&c->lpcf[i], 2, &c->delay_buffers[i][0],
+				REVERB_MAX_DELAY_SIZE, delay_lens_left[i], offsets, feedback,
+				0.0, lp_damp);
 	}
 
 	c->dry_mix = dry_mix;
@@ -164,8 +165,7 @@ RESULT_STEREO_REVERB reverb_change_feedback(STEREO_REVERB * c,
 
 	// Update instance parameters
 	for (int i = 0; i < REVERB_DELAY_ELEMENTS; i++) {
-		delay_modify_feedback(&c->lpcf_left[i], feedback);
-		delay_modify_feedback(&c->lpcf_right[i], feedback);
+		delay_modify_feedback(&c->lpcf[i], feedback);
 	}
 	c->feedback = feedback;
 
@@ -206,8 +206,7 @@ RESULT_STEREO_REVERB reverb_change_lp_damp_coeff(STEREO_REVERB * c,
 	lp_damp = (lp_damp * 0.4) + 0.1;
 
 	for (int i = 0; i < REVERB_DELAY_ELEMENTS; i++) {
-		delay_modify_dampening(&c->lpcf_left[i], lp_damp);
-		delay_modify_dampening(&c->lpcf_right[i], lp_damp);
+		delay_modify_dampening(&c->lpcf[i], lp_damp);
 	}
 	c->lp_damp = lp_damp;
 
@@ -236,35 +235,33 @@ void reverb_read(STEREO_REVERB * c, float * audio_in, float * audio_out_left,
 		return;
 	}
 
-	int i;
-	float temp_audio1[MAX_AUDIO_BLOCK_SIZE], temp_audio2[MAX_AUDIO_BLOCK_SIZE];
+	float wet_left[MAX_AUDIO_BLOCK_SIZE], wet_right[MAX_AUDIO_BLOCK_SIZE];
+	float comb_left[MAX_AUDIO_BLOCK_SIZE], comb_right[MAX_AUDIO_BLOCK_SIZE];
+	float * comb_in[2] = { audio_in, audio_in };
+	float * comb_out[2] = { comb_left, comb_right };
 
-	clear_buffer(temp_audio1, audio_block_size);
+	// Run both channels through the parallel comb filters
+	clear_buffer(wet_left, audio_block_size);
+	clear_buffer(wet_right, audio_block_size);
 	for (int i = 0; i < REVERB_DELAY_ELEMENTS; i++) {
-		delay_read(&c->lpcf_left[i], audio_in, temp_audio2, audio_block_size);
-		mix_2x1(temp_audio1, temp_audio2, temp_audio1, audio_block_size);
-	}
-
-	// run through all-pass filters
-	for (int i = 0; i < REVERB_ALLPASS_ELEMENTS; i++) {
-		allpass_read(&c->allpass_outputs_left[i], temp_audio1, temp_audio1,
+		delay_read_multichannel(&c->lpcf[i], comb_in, comb_out,
 				audio_block_size);
-	}
-	mix_2x1_gain(temp_audio1, c->wet_mix * (1.0 / (2 * REVERB_DELAY_ELEMENTS)),
-			audio_in, c->dry_mix, audio_out_left, audio_block_size);
-
-	clear_buffer(temp_audio1, audio_block_size);
-	for (int i = 0; i < REVERB_DELAY_ELEMENTS; i++) {
-		delay_read(&c->lpcf_right[i], audio_in, temp_audio2, audio_block_size);
-		mix_2x1(temp_audio1, temp_audio2, temp_audio1, audio_block_size);
+		mix_2x1(wet_left, comb_left, wet_left, audio_block_size);
+		mix_2x1(wet_right, comb_right, wet_right, audio_block_size);
 	}
 
 	// run through all-pass filters
 	for (int i = 0; i < REVERB_ALLPASS_ELEMENTS; i++) {
-		allpass_read(&c->allpass_outputs_right[i], temp_audio1, temp_audio1,
+		allpass_read(&c->allpass_outputs_left[i], wet_left, wet_left,
+				audio_block_size);
+		allpass_read(&c->allpass_outputs_right[i], wet_right, wet_right,
 				audio_block_size);
 	}
-	mix_2x1_gain(temp_audio1, c->wet_mix * (1.0 / (2 * REVERB_DELAY_ELEMENTS)),
-			audio_in, c->dry_mix, audio_out_right, audio_block_size);
+
+	float wet_gain = c->wet_mix * (1.0 / (2 * REVERB_DELAY_ELEMENTS));
+	mix_2x1_gain(wet_left, wet_gain, audio_in, c->dry_mix, audio_out_left,
+			audio_block_size);
+	mix_2x1_gain(wet_right, wet_gain, audio_in, c->dry_mix, audio_out_right,
+			audio_block_size);
 
 }
@@ -49,10 +49,9 @@ typedef struct {
 	float allpass_buffers_left[REVERB_ALLPASS_ELEMENTS][REVERB_MAX_ALLPASS_SIZE];
 	float allpass_buffers_right[REVERB_ALLPASS_ELEMENTS][REVERB_MAX_ALLPASS_SIZE];
 
-	DELAY_LPF lpcf_left[REVERB_DELAY_ELEMENTS];
-	DELAY_LPF lpcf_right[REVERB_DELAY_ELEMENTS];
-	float delay_buffers_left[REVERB_DELAY_ELEMENTS][REVERB_MAX_DELAY_SIZE];
-	float delay_buffers_right[REVERB_DELAY_ELEMENTS][REVERB_MAX_DELAY_SIZE];
+	// Each comb filter runs both channels (left delay line first)
+	DELAY_LPF lpcf[REVERB_DELAY_ELEMENTS];
+	float delay_buffers[REVERB_DELAY_ELEMENTS][2 * REVERB_MAX_DELAY_SIZE];
 
 } STEREO_REVERB;
 
@@ -72,6 +72,7 @@ RESULT_TUBE_DISTORTION tube_distortion_setup(TUBE_DISTORTION * c, float drive,
 			1.0, audio_sample_rate);
 
 	c->gain = gain;
+	c->drive = drive;
 
 	filter_modify_freq(&c->output_filter, 600.0 + 600.0 * contour);
 
@@ -235,19 +236,18 @@ void tube_distortion_read(TUBE_DISTORTION * c, float * audio_in,
 		return;
 	}
 
-	float temp_audio_1[MAX_AUDIO_BLOCK_SIZE],
-			temp_audio_2[MAX_AUDIO_BLOCK_SIZE];
+	float temp_audio_1[MAX_AUDIO_BLOCK_SIZE];
 
 	// Apply input filter
 	filter_read(&c->input_filter, audio_in, temp_audio_1, audio_block_size);
 
-	// Apply output gain
+	// Apply drive
 	for (int i = 0; i < audio_block_size; i++) {
-		audio_in[i] *= c->drive;
+		audio_out[i] = temp_audio_1[i] * c->drive;
 	}
 
-	// Apply clipping
-	clipper_read(&c->clipper, audio_in, audio_out, audio_block_size);
+	// Apply clipping (oversampled, see clipper.c)
+	clipper_read(&c->clipper, audio_out, audio_out, audio_block_size);
 
 	// Apply output gain
 	for (int i = 0; i < audio_block_size; i++) {
@@ -7,19 +7,155 @@
  * There is a setup function and an audio processing function which should be included
  * in the setup and audio processing functions of the audio callback (callback_audio_processing.cpp).
  *
+ * On core 1, each preset describes its chain of effects as an effect graph
+ * (see effect_graph.c) rather than calling the effects directly.  A preset has
+ * a setup routine, a build routine that adds its nodes and edges to a graph,
+ * and an optional control routine that updates parameters from the pots after
+ * each block.  The pots are latched once per block (see
+ * bm_parameter_snapshot.c) and each pot moves its parameter through a control
+ * parameter (see control_parameter.c), which maps, debounces and smooths it,
+ * so an effect is only updated while one of its parameters is moving.  The
+ * presets are run by a preset manager (see preset_manager.c): when the
+ * selected preset changes, the new preset is set up and its graph built in
+ * the background loop (audio_effects_background_core1), then the outputs of
+ * the old and new presets are crossfaded.
+ *
+ * The presets, the synth, the limiter and the reverb are the stages of a
+ * pipeline that is split between core 1 and core 2 (see "Effects pipeline"
+ * below).
+ *
  */
 
 #include "common/audio_system_config.h"
 #include "common/multicore_shared_memory.h"
+#include "drivers/bm_cycle_profiler_driver/bm_cycle_profiler.h"
+#include "drivers/bm_parameter_snapshot_driver/bm_parameter_snapshot.h"
 
 #include "audio_effects_selector.h"
 
+// Audio buffers used when the effects don't work on the framework's buffers
+float audio_effects_left_in_buffer[AUDIO_BLOCK_SIZE];
+float audio_effects_right_in_buffer[AUDIO_BLOCK_SIZE];
+
+float audio_effects_left_out_buffer[AUDIO_BLOCK_SIZE];
+float audio_effects_right_out_buffer[AUDIO_BLOCK_SIZE];
+
 // Audio buffers to pass audio to and from the effects
-float audio_effects_left_in[AUDIO_BLOCK_SIZE];
-float audio_effects_right_in[AUDIO_BLOCK_SIZE];
+float * audio_effects_left_in = audio_effects_left_in_buffer;
+float * audio_effects_right_in = audio_effects_right_in_buffer;
+
+float * audio_effects_left_out = audio_effects_left_out_buffer;
+float * audio_effects_right_out = audio_effects_right_out_buffer;
+
+// Preset manager running the selected preset on core 1 and its memory
+#define CORE1_GRAPH_SCRATCH_BUFFERS		(8)
+#define CORE1_PRESET_CROSSFADE_BLOCKS	(16)	// ~10ms at 48kHz / 32 samples
+
+// Cycles the presets may take per block, the rest of a block is left for the
+// audio framework and the other stages on core 1.  Presets that don't fit in
+// it together are faded through silence instead of crossfaded.
+#define CORE1_PRESET_CYCLE_BUDGET		((((CORE_CLOCK_FREQ_HZ / AUDIO_SAMPLE_RATE) * AUDIO_BLOCK_SIZE) * 3) / 4)
+PRESET_MANAGER core1_preset_manager;
+float core1_preset_memory[PRESET_MANAGER_MEMORY_SIZE(2,
+		CORE1_GRAPH_SCRATCH_BUFFERS, AUDIO_BLOCK_SIZE)];
 
-float audio_effects_left_out[AUDIO_BLOCK_SIZE];
-float audio_effects_right_out[AUDIO_BLOCK_SIZE];
+// Pots on the Audio Project Fin, latched at the start of each block on core 1
+BM_PARAMETER_SNAPSHOT core1_pots;
+
+/**
+ * @brief Returns the value of a pot (0 -> 1.0) latched for this block
+ *
+ * @param pot Pot number (HADC0 - HADC2)
+ */
+static float pot_value(uint32_t pot) {
+
+	return core1_pots.values[AUDIOPROJ_FIN_POT_HADC0 + pot];
+}
+
+/**
+ * @brief Checks if a pot has moved since a control routine last applied it
+ *
+ * @param pot Pot number (HADC0 - HADC2)
+ * @param applied Version of core1_pots the control routine applied last, or
+ *        0 to apply every pot
+ */
+static bool pot_changed(uint32_t pot, uint32_t applied) {
+
+	return parameter_snapshot_changed(&core1_pots,
+			AUDIOPROJ_FIN_POT_HADC0 + pot, applied);
+}
+
+// Control parameters moved by the pots (see control_parameter.c)
+#define POT_DEADBAND		(0.005)		// ignores HADC noise of up to 0.5%
+#define POT_SMOOTHING_TIME	(0.03)		// seconds
+#define POT_UPDATE_RATE		((float) AUDIO_SAMPLE_RATE / AUDIO_BLOCK_SIZE)
+
+/**
+ * @brief Sets up a control parameter moved by one of the pots
+ *
+ * @param param Pointer to the control parameter
+ * @param min Value with the pot turned all the way down
+ * @param max Value with the pot turned all the way up
+ * @param taper Mapping of the pot onto min -> max
+ * @param smooth Set to false for parameters the effect already ramps
+ */
+static void pot_parameter_setup(CONTROL_PARAMETER * param, float min,
+		float max, CONTROL_PARAMETER_TAPER taper, bool smooth) {
+
+	control_parameter_setup(param, min, max, taper, POT_DEADBAND,
+			smooth ? POT_SMOOTHING_TIME : 0.0, POT_UPDATE_RATE);
+}
+
+/**
+ * @brief Updates a control parameter from its pot
+ *
+ * Call once per block from a control routine.
+ *
+ * @param param Pointer to the control parameter
+ * @param pot Pot number (HADC0 - HADC2)
+ * @param applied Version of core1_pots the control routine applied last
+ * @param value Set to the new value of the parameter if it changed
+ * @return true if the parameter changed and the effect needs updating
+ */
+static bool pot_parameter_update(CONTROL_PARAMETER * param, uint32_t pot,
+		uint32_t applied, float * value) {
+
+	if (pot_changed(pot, applied)) {
+		control_parameter_set(param, pot_value(pot));
+	}
+	return control_parameter_update(param, value);
+}
+
+/**
+ * @brief Points the effects at the buffers they read from and write to
+ *
+ * By default the effects work on their own buffers, so the callback has to
+ * copy audio into audio_effects_left_in / audio_effects_right_in before
+ * processing and out of audio_effects_left_out / audio_effects_right_out
+ * afterwards.  Passing the framework's channel buffers here instead lets the
+ * effects read the audio straight from the buffers the DMA handler converted
+ * the incoming block into, and write the processed audio straight to the
+ * buffers that get converted back and sent out, with no copies in between.
+ *
+ * The input and output buffers must not overlap.  The presets on core 1
+ * bind to the input buffers when their graphs are built, so this must be
+ * called before audio_effects_setup_core1() / audio_effects_setup_core2()
+ * and the buffers must stay in place from then on.
+ *
+ * @param left_in Left channel input buffer (AUDIO_BLOCK_SIZE floats)
+ * @param right_in Right channel input buffer (AUDIO_BLOCK_SIZE floats)
+ * @param left_out Left channel output buffer (AUDIO_BLOCK_SIZE floats)
+ * @param right_out Right channel output buffer (AUDIO_BLOCK_SIZE floats)
+ */
+void audio_effects_set_buffers(float * left_in, float * right_in,
+		float * left_out, float * right_out) {
+
+	audio_effects_left_in = left_in;
+	audio_effects_right_in = right_in;
+
+	audio_effects_left_out = left_out;
+	audio_effects_right_out = right_out;
+}
 
 /**
  * @brief Audio bypass routine
@@ -27,13 +163,14 @@ float audio_effects_right_out[AUDIO_BLOCK_SIZE];
  * The effect bypass routine will simply pass audio from the input buffers to
  * the output buffers.
  */
-static void effect_bypass(void) {
+static void effect_bypass(float ** audio_in, float ** audio_out,
+		uint32_t audio_block_size) {
 
 	// Copy input buffers to output buffers, thereby bypassing effects
-	copy_buffer(audio_effects_left_in, audio_effects_left_out,
-	AUDIO_BLOCK_SIZE);
-	copy_buffer(audio_effects_right_in, audio_effects_right_out,
-	AUDIO_BLOCK_SIZE);
+	if (audio_in[0] != audio_out[0]) {
+		copy_buffer(audio_in[0], audio_out[0], audio_block_size);
+		copy_buffer(audio_in[1], audio_out[1], audio_block_size);
+	}
 
 }
 
@@ -41,6 +178,114 @@ static void effect_bypass(void) {
  * Effects running on SHARC core 1
  *****************************************************************************/
 
+/**
+ * Graph nodes
+ *
+ * Each node function adapts the _read function of an effect or element to
+ * the effect graph's node interface.  The instance pointer is the effect
+ * instance, audio_in and audio_out hold the buffers of the node's edges in
+ * the order they were added.
+ */
+static void node_delay(void * instance, float ** audio_in, float ** audio_out,
+		uint32_t audio_block_size) {
+	delay_read_multichannel((DELAY_LPF *) instance, audio_in, audio_out,
+			audio_block_size);
+}
+
+static void node_multitap_delay(void * instance, float ** audio_in,
+		float ** audio_out, uint32_t audio_block_size) {
+	multitap_delay_read_multichannel((MULTITAP_DELAY *) instance, audio_in,
+			audio_out, audio_block_size);
+}
+
+static void node_tube_distortion(void * instance, float ** audio_in,
+		float ** audio_out, uint32_t audio_block_size) {
+	tube_distortion_read((TUBE_DISTORTION *) instance, audio_in[0],
+			audio_out[0], audio_block_size);
+}
+
+static void node_multiband_compressor(void * instance, float ** audio_in,
+		float ** audio_out, uint32_t audio_block_size) {
+	multiband_comp_read((MULTIBAND_COMPRESSOR *) instance, audio_in[0],
+			audio_out[0], audio_block_size);
+}
+
+static void node_flanger(void * instance, float ** audio_in, float ** audio_out,
+		uint32_t audio_block_size) {
+	flanger_read((STEREO_FLANGER *) instance, audio_in[0], audio_out[0],
+			audio_out[1], audio_block_size);
+}
+
+static void node_guitar_synth(void * instance, float ** audio_in,
+		float ** audio_out, uint32_t audio_block_size) {
+	guitar_synth_read((GUITAR_SYNTH *) instance, audio_in[0], audio_out[0],
+			audio_block_size);
+}
+
+static void node_autowah(void * instance, float ** audio_in,
+		float ** audio_out, uint32_t audio_block_size) {
+	autowah_read((AUTOWAH *) instance, audio_in[0], audio_out[0],
+			audio_block_size);
+}
+
+static void node_ring_modulator(void * instance, float ** audio_in,
+		float ** audio_out, uint32_t audio_block_size) {
+	ring_modulator_read((RING_MODULATOR *) instance, audio_in[0], audio_out[0],
+			audio_block_size);
+}
+
+static void node_convolver(void * instance, float ** audio_in,
+		float ** audio_out, uint32_t audio_block_size) {
+	convolver_read((CONVOLVER *) instance, audio_in[0], audio_out[0],
+			audio_block_size);
+}
+
+/**
+ * @brief Adds the nodes that pass audio from the inputs to the outputs
+ *
+ * @param graph Graph to add the nodes to
+ * @param audio_out Left and right output buffers
+ */
+static void effect_bypass_build(EFFECT_GRAPH * graph, float ** audio_out) {
+
+	EFFECT_GRAPH_EDGE left_in = effect_graph_add_input(graph,
+			audio_effects_left_in);
+	EFFECT_GRAPH_EDGE right_in = effect_graph_add_input(graph,
+			audio_effects_right_in);
+	EFFECT_GRAPH_EDGE left_out = effect_graph_add_output(graph,
+			audio_out[0]);
+	EFFECT_GRAPH_EDGE right_out = effect_graph_add_output(graph,
+			audio_out[1]);
+
+	effect_graph_add_node(graph, effect_graph_copy, NULL, 1, &left_in, 1,
+			&left_out);
+	effect_graph_add_node(graph, effect_graph_copy, NULL, 1, &right_in, 1,
+			&right_out);
+}
+
+/**
+ * @brief Adds the output edges and a node copying the left output to the right
+ *
+ * Mono effects write the left output, this sends it to both sides.
+ *
+ * @param graph Graph to add the nodes to
+ * @param audio_out Left and right output buffers
+ * @return Left output edge for the mono effect to write
+ */
+static EFFECT_GRAPH_EDGE effect_mono_to_stereo_build(EFFECT_GRAPH * graph,
+		float ** audio_out) {
+
+	EFFECT_GRAPH_EDGE left_out = effect_graph_add_output(graph,
+			audio_out[0]);
+	EFFECT_GRAPH_EDGE right_out = effect_graph_add_output(graph,
+			audio_out[1]);
+
+	effect_graph_add_node(graph, effect_graph_copy, NULL, 1, &left_out, 1,
+			&right_out);
+
+	return left_out;
+}
+
 /**
  * 1 - ECHO EFFECT
  *
@@ -57,64 +302,83 @@ static void effect_bypass(void) {
  * Some fun things to try:
  *  - Add a second delay line and feed the output of the first delay line into the second
  *  - Feed the output of the second delay back into the first
- *  - Try very different delay values for left and right side
+ *  - Try very different delay values for left and right side (see the channel
+ *    offsets of delay_setup_multichannel)
  *
  */
 
-// Declare instances and buffers
-DELAY_LPF integer_delay_l, integer_delay_r;
+// Declare instance and buffers (one instance processes both channels)
+DELAY_LPF integer_delay;
 
 // declare delay buffers in SDRAM with a max length of 32000 (2/3 of a second each
 #define INT_DELAY_LEN	(32000)
-float section("seg_sdram") integer_delay_line_l[INT_DELAY_LEN];
-float section("seg_sdram") integer_delay_line_r[INT_DELAY_LEN];
+float section("seg_sdram") integer_delay_line[2 * INT_DELAY_LEN];
+
+// Version of the pots applied by effect_echo_control()
+static uint32_t echo_pots_applied = 0;
+
+// Parameters moved by the pots
+static CONTROL_PARAMETER echo_dampening, echo_length, echo_feedback;
 
 /**
  * @brief Setup routine to initialize instances of the delay line
  */
 static void effect_echo_setup() {
 
-	// Initialize effect instances
-	delay_setup(&integer_delay_l, integer_delay_line_l,
-	INT_DELAY_LEN,
-	INT_DELAY_LEN - 1000, 0.5, 0.8, 0.2);
-	delay_setup(&integer_delay_r, integer_delay_line_r,
+	// Apply all the pots on the first control
+	echo_pots_applied = 0;
+	pot_parameter_setup(&echo_dampening, 0.1, 0.4, CONTROL_TAPER_LINEAR, true);
+	pot_parameter_setup(&echo_length, INT_DELAY_LEN / 2, INT_DELAY_LEN, CONTROL_TAPER_LINEAR, false);
+	pot_parameter_setup(&echo_feedback, 0.0, 1.0, CONTROL_TAPER_LINEAR, true);
+
+	// Initialize effect instance
+	delay_setup_multichannel(&integer_delay, 2, integer_delay_line,
 	INT_DELAY_LEN,
-	INT_DELAY_LEN - 3000, 0.5, 0.8, 0.2);
+	INT_DELAY_LEN - 1000, NULL, 0.5, 0.8, 0.2);
+}
+
+/**
+ * @brief Adds the echo to the effect graph
+ *
+ * @param graph Graph to add the nodes to
+ * @param audio_out Left and right output buffers
+ */
+static void effect_echo_build(EFFECT_GRAPH * graph, float ** audio_out) {
+
+	EFFECT_GRAPH_EDGE left_in = effect_graph_add_input(graph,
+			audio_effects_left_in);
+	EFFECT_GRAPH_EDGE delay_in[2] = { left_in, left_in };
+	EFFECT_GRAPH_EDGE delay_out[2] = { effect_graph_add_output(graph,
+			audio_out[0]), effect_graph_add_output(graph,
+			audio_out[1]) };
+
+	effect_graph_add_node(graph, node_delay, &integer_delay, 2, delay_in, 2,
+			delay_out);
 }
 
 /**
- * @brief  Process audio and update some modifiable parameters via the pots
+ * @brief  Update some modifiable parameters via the pots
  */
-static void effect_echo_process() {
+static void effect_echo_control() {
 
-	// Apply effect
-	delay_read(&integer_delay_l, audio_effects_left_in, audio_effects_left_out,
-	AUDIO_BLOCK_SIZE);
-	delay_read(&integer_delay_r, audio_effects_left_in, audio_effects_right_out,
-	AUDIO_BLOCK_SIZE);
+	float value;
 
 	// Use pot (HADC0) to modify the dampening factor in feeedback path of delay
-	delay_modify_dampening(&integer_delay_l,
-			multicore_data->audioproj_fin_pot_hadc0 * 0.3 + 0.1);
-	delay_modify_dampening(&integer_delay_r,
-			multicore_data->audioproj_fin_pot_hadc0 * 0.3 + 0.1);
+	if (pot_parameter_update(&echo_dampening, 0, echo_pots_applied, &value)) {
+		delay_modify_dampening(&integer_delay, value);
+	}
 
 	// Use pot (HADC1) to modify the lenght of the delay
-	delay_modify_length(&integer_delay_l,
-			INT_DELAY_LEN / 2
-					+ multicore_data->audioproj_fin_pot_hadc1 * INT_DELAY_LEN
-							/ 2);
-	delay_modify_length(&integer_delay_r,
-			INT_DELAY_LEN / 2
-					+ multicore_data->audioproj_fin_pot_hadc1 * INT_DELAY_LEN
-							/ 2);
+	if (pot_parameter_update(&echo_length, 1, echo_pots_applied, &value)) {
+		delay_modify_length(&integer_delay, value);
+	}
 
 	// Use pot (HADC2) to modify the feedback value
-	delay_modify_feedback(&integer_delay_l,
-			multicore_data->audioproj_fin_pot_hadc2);
-	delay_modify_feedback(&integer_delay_r,
-			multicore_data->audioproj_fin_pot_hadc2);
+	if (pot_parameter_update(&echo_feedback, 2, echo_pots_applied, &value)) {
+		delay_modify_feedback(&integer_delay, value);
+	}
+
+	echo_pots_applied = core1_pots.version;
 
 }
 
@@ -138,16 +402,14 @@ static void effect_echo_process() {
  *
  */
 
-// Declare instances and buffers
-MULTITAP_DELAY integer_mt_delay_l, integer_mt_delay_r;
+// Declare instance and buffers (one instance processes both channels)
+MULTITAP_DELAY integer_mt_delay;
 #define INT_DELAY_LEN	(32000)
-float section("seg_sdram") integer_mt_delay_line_l[INT_DELAY_LEN]; // Delay line in SDRAM
-float section("seg_sdram") integer_mt_delay_line_r[INT_DELAY_LEN]; // Delay line in SDRAM
+float section("seg_sdram") integer_mt_delay_line[2 * INT_DELAY_LEN]; // Delay line in SDRAM
 
-uint32_t tap_offsets_l[3] = { 10000, 20000, 28000 };
-uint32_t tap_offsets_r[3] = { 8000, 22000, 29000 };
-float tap_gains_l[3] = { 0.3, 0.4, 0.2 };
-float tap_gains_r[3] = { 0.4, 0.3, 0.2 };
+// Taps for the left channel followed by the taps for the right channel
+uint32_t tap_offsets[2 * 3] = { 10000, 20000, 28000, 8000, 22000, 29000 };
+float tap_gains[2 * 3] = { 0.3, 0.4, 0.2, 0.4, 0.3, 0.2 };
 
 /**
  * @brief Setup routine to initialize instances of the multi-tap delay line
@@ -155,26 +417,28 @@ float tap_gains_r[3] = { 0.4, 0.3, 0.2 };
 static void effect_multitap_delay_setup() {
 
 	// Initialize effect instance
-	multitap_delay_setup(&integer_mt_delay_l, integer_mt_delay_line_l,
-	INT_DELAY_LEN, 3, tap_offsets_l, tap_gains_l, 0.8);
-
-	multitap_delay_setup(&integer_mt_delay_r, integer_mt_delay_line_r,
-	INT_DELAY_LEN, 3, tap_offsets_r, tap_gains_r, 0.8);
+	multitap_delay_setup_multichannel(&integer_mt_delay, 2,
+			integer_mt_delay_line, INT_DELAY_LEN, 3, tap_offsets, tap_gains,
+			0.8);
 }
 
 /**
- * @brief  Process audio and update some modifiable parameters via the pots
+ * @brief Adds the multi-tap delay to the effect graph
+ *
+ * @param graph Graph to add the nodes to
+ * @param audio_out Left and right output buffers
  */
-static void effect_multitap_delay_process() {
+static void effect_multitap_delay_build(EFFECT_GRAPH * graph, float ** audio_out) {
 
-	// Apply effect
-	multitap_delay_read(&integer_mt_delay_l, audio_effects_left_in,
-			audio_effects_left_out,
-			AUDIO_BLOCK_SIZE);
+	EFFECT_GRAPH_EDGE left_in = effect_graph_add_input(graph,
+			audio_effects_left_in);
+	EFFECT_GRAPH_EDGE delay_in[2] = { left_in, left_in };
+	EFFECT_GRAPH_EDGE delay_out[2] = { effect_graph_add_output(graph,
+			audio_out[0]), effect_graph_add_output(graph,
+			audio_out[1]) };
 
-	multitap_delay_read(&integer_mt_delay_r, audio_effects_left_in,
-			audio_effects_right_out,
-			AUDIO_BLOCK_SIZE);
+	effect_graph_add_node(graph, node_multitap_delay, &integer_mt_delay, 2,
+			delay_in, 2, delay_out);
 }
 
 /**
@@ -201,43 +465,70 @@ static void effect_multitap_delay_process() {
  */
 TUBE_DISTORTION tube_dist;
 
+// Version of the pots applied by effect_tube_distortion_control()
+static uint32_t tube_dist_pots_applied = 0;
+
+// Parameters moved by the pots
+static CONTROL_PARAMETER tube_dist_gain, tube_dist_drive, tube_dist_contour;
+
 /**
  * @brief Setup routine to initialize instance of the tube distortion simulator
  */
 static void effect_tube_distortion_setup(void) {
 
+	// Apply all the pots on the first control
+	tube_dist_pots_applied = 0;
+	pot_parameter_setup(&tube_dist_gain, 0.0, 0.5, CONTROL_TAPER_LINEAR, true);
+	pot_parameter_setup(&tube_dist_drive, 0.0, 64.0, CONTROL_TAPER_LINEAR, true);
+	pot_parameter_setup(&tube_dist_contour, 0.0, 1.0, CONTROL_TAPER_LINEAR, true);
+
 	// Initialize effect instance
 	tube_distortion_setup(&tube_dist,
-			multicore_data->audioproj_fin_pot_hadc1 * 64.0,
-			multicore_data->audioproj_fin_pot_hadc0 * 1.0,
-			multicore_data->audioproj_fin_pot_hadc2,
+			pot_value(1) * 64.0,
+			pot_value(0) * 1.0,
+			pot_value(2),
 			AUDIO_SAMPLE_RATE);
 }
 
 /**
- * @briend Process audio and update some modifiable parameters via the pots
+ * @brief Adds the tube distortion to the effect graph
+ *
+ * @param graph Graph to add the nodes to
+ * @param audio_out Left and right output buffers
  */
-static void effect_tube_distortion_process(void) {
-	tube_distortion_read(&tube_dist, audio_effects_left_in,
-			audio_effects_left_out,
-			AUDIO_BLOCK_SIZE);
+static void effect_tube_distortion_build(EFFECT_GRAPH * graph, float ** audio_out) {
 
-	// Make stereo
-	for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
-		audio_effects_right_out[i] = audio_effects_left_out[i];
-	}
+	EFFECT_GRAPH_EDGE left_in = effect_graph_add_input(graph,
+			audio_effects_left_in);
+	EFFECT_GRAPH_EDGE left_out = effect_mono_to_stereo_build(graph, audio_out);
+
+	effect_graph_add_node(graph, node_tube_distortion, &tube_dist, 1, &left_in,
+			1, &left_out);
+}
+
+/**
+ * @brief Update some modifiable parameters via the pots
+ */
+static void effect_tube_distortion_control(void) {
+
+	float value;
 
 	// Use pot (HADC0) to modify the output gain of the distortion
-	tube_distortion_modify_gain(&tube_dist,
-			multicore_data->audioproj_fin_pot_hadc2 * 0.5);
+	if (pot_parameter_update(&tube_dist_gain, 2, tube_dist_pots_applied, &value)) {
+		tube_distortion_modify_gain(&tube_dist, value);
+	}
 
 	// Use pot (HADC1) to modify the input drive into the clipping function of the distortion
-	tube_distortion_modify_drive(&tube_dist,
-			multicore_data->audioproj_fin_pot_hadc1 * 64.0);
+	if (pot_parameter_update(&tube_dist_drive, 1, tube_dist_pots_applied, &value)) {
+		tube_distortion_modify_drive(&tube_dist, value);
+	}
 
 	// Use pot (HADC2) to modify the bandpass filter after the clipper to change the tone
-	tube_distortion_modify_contour(&tube_dist,
-			multicore_data->audioproj_fin_pot_hadc0);
+	if (pot_parameter_update(&tube_dist_contour, 0, tube_dist_pots_applied, &value)) {
+		tube_distortion_modify_contour(&tube_dist, value);
+	}
+
+	tube_dist_pots_applied = core1_pots.version;
 
 }
 
@@ -266,11 +557,24 @@ static void effect_tube_distortion_process(void) {
  */
 MULTIBAND_COMPRESSOR multiband_comp_l, multiband_comp_r;
 
+// Version of the pots applied by effect_multiband_compressor_control()
+static uint32_t multiband_comp_pots_applied = 0;
+
+// Parameters moved by the pots
+static CONTROL_PARAMETER multiband_comp_xover, multiband_comp_thresh,
+		multiband_comp_gain;
+
 /**
  * @brief Setup routine to initialize instances of the multiband compressor
  */
 static void effect_multiband_compressor_setup(void) {
 
+	// Apply all the pots on the first control
+	multiband_comp_pots_applied = 0;
+	pot_parameter_setup(&multiband_comp_xover, 100.0, 700.0, CONTROL_TAPER_LOG, true);
+	pot_parameter_setup(&multiband_comp_thresh, 0.0, -50.0, CONTROL_TAPER_LINEAR, true);
+	pot_parameter_setup(&multiband_comp_gain, 0.0, 4.0, CONTROL_TAPER_LINEAR, true);
+
 	// Initialize effect instances for left and right channels
 	multiband_comp_setup(&multiband_comp_l, 200.0, -40.0,
 	AUDIO_SAMPLE_RATE);
@@ -281,35 +585,54 @@ static void effect_multiband_compressor_setup(void) {
 }
 
 /**
- * @brief Process audio and update some modifiable parameters via the pots
+ * @brief Adds the multiband compressors to the effect graph
+ *
+ * @param graph Graph to add the nodes to
+ * @param audio_out Left and right output buffers
  */
-static void effect_multiband_compressor_process(void) {
+static void effect_multiband_compressor_build(EFFECT_GRAPH * graph, float ** audio_out) {
+
+	EFFECT_GRAPH_EDGE left_in = effect_graph_add_input(graph,
+			audio_effects_left_in);
+	EFFECT_GRAPH_EDGE right_in = effect_graph_add_input(graph,
+			audio_effects_right_in);
+	EFFECT_GRAPH_EDGE left_out = effect_graph_add_output(graph,
+			audio_out[0]);
+	EFFECT_GRAPH_EDGE right_out = effect_graph_add_output(graph,
+			audio_out[1]);
+
+	effect_graph_add_node(graph, node_multiband_compressor, &multiband_comp_l,
+			1, &left_in, 1, &left_out);
+	effect_graph_add_node(graph, node_multiband_compressor, &multiband_comp_r,
+			1, &right_in, 1, &right_out);
+}
 
-	multiband_comp_read(&multiband_comp_l, audio_effects_left_in,
-			audio_effects_left_out,
-			AUDIO_BLOCK_SIZE);
+/**
+ * @brief Update some modifiable parameters via the pots
+ */
+static void effect_multiband_compressor_control(void) {
 
-	multiband_comp_read(&multiband_comp_r, audio_effects_right_in,
-			audio_effects_right_out,
-			AUDIO_BLOCK_SIZE);
+	float value;
 
 	// Use pot (HADC0) set the cross-over frequency in Hz
-	multiband_comp_change_xover(&multiband_comp_l,
-			100.0 + 600.0 * multicore_data->audioproj_fin_pot_hadc0);
-	multiband_comp_change_xover(&multiband_comp_r,
-			100.0 + 600.0 * multicore_data->audioproj_fin_pot_hadc0);
+	if (pot_parameter_update(&multiband_comp_xover, 0, multiband_comp_pots_applied, &value)) {
+		multiband_comp_change_xover(&multiband_comp_l, value);
+		multiband_comp_change_xover(&multiband_comp_r, value);
+	}
 
 	// Use pot (HADC1) to set compressor threshold (dB)
-	multiband_comp_change_thresh(&multiband_comp_l,
-			-50.0 * multicore_data->audioproj_fin_pot_hadc1);
-	multiband_comp_change_thresh(&multiband_comp_r,
-			-50.0 * multicore_data->audioproj_fin_pot_hadc1);
+	if (pot_parameter_update(&multiband_comp_thresh, 1, multiband_comp_pots_applied, &value)) {
+		multiband_comp_change_thresh(&multiband_comp_l, value);
+		multiband_comp_change_thresh(&multiband_comp_r, value);
+	}
 
 	// Use pot (HADC2) to modify the output gain of the compressors
-	multiband_comp_change_gain(&multiband_comp_l,
-			4.0 * multicore_data->audioproj_fin_pot_hadc2);
-	multiband_comp_change_gain(&multiband_comp_r,
-			4.0 * multicore_data->audioproj_fin_pot_hadc2);
+	if (pot_parameter_update(&multiband_comp_gain, 2, multiband_comp_pots_applied, &value)) {
+		multiband_comp_change_gain(&multiband_comp_l, value);
+		multiband_comp_change_gain(&multiband_comp_r, value);
+	}
+
+	multiband_comp_pots_applied = core1_pots.version;
 
 }
 
@@ -333,36 +656,69 @@ static void effect_multiband_compressor_process(void) {
 
 STEREO_FLANGER flanger;
 
+// Version of the pots applied by effect_flanger_control()
+static uint32_t flanger_pots_applied = 0;
+
+// Parameters moved by the pots
+static CONTROL_PARAMETER flanger_rate, flanger_depth, flanger_feedback;
+
 /**
  * @brief Setup routine to initialize instance of the stereo flanger
  */
 static void effect_flanger_setup(void) {
 
+	// Apply all the pots on the first control
+	flanger_pots_applied = 0;
+	pot_parameter_setup(&flanger_rate, 0.0, 2.0, CONTROL_TAPER_LINEAR, true);
+	pot_parameter_setup(&flanger_depth, 0.0, 1.0, CONTROL_TAPER_LINEAR, true);
+	pot_parameter_setup(&flanger_feedback, -1.0, 1.0, CONTROL_TAPER_LINEAR, true);
+
 	// Initialize effect instance
 	flanger_setup(&flanger, 0.5, 0.5, 0.5, AUDIO_SAMPLE_RATE);
 
 }
 
 /**
- * Process audio and update some modifiable parameters via the pots
+ * @brief Adds the stereo flanger to the effect graph
+ *
+ * @param graph Graph to add the nodes to
+ * @param audio_out Left and right output buffers
  */
-static void effect_flanger_process(void) {
+static void effect_flanger_build(EFFECT_GRAPH * graph, float ** audio_out) {
 
-	// Apply effect
-	flanger_read(&flanger, audio_effects_left_in, audio_effects_left_out,
-			audio_effects_right_out,
-			AUDIO_BLOCK_SIZE);
+	EFFECT_GRAPH_EDGE left_in = effect_graph_add_input(graph,
+			audio_effects_left_in);
+	EFFECT_GRAPH_EDGE flanger_out[2] = { effect_graph_add_output(graph,
+			audio_out[0]), effect_graph_add_output(graph,
+			audio_out[1]) };
+
+	effect_graph_add_node(graph, node_flanger, &flanger, 1, &left_in, 2,
+			flanger_out);
+}
+
+/**
+ * Update some modifiable parameters via the pots
+ */
+static void effect_flanger_control(void) {
+
+	float value;
 
 	// Use pot (HADC0) to set the flanger rate in Hz
-	flanger_modify_rate(&flanger,
-			2.0 * multicore_data->audioproj_fin_pot_hadc0);
+	if (pot_parameter_update(&flanger_rate, 0, flanger_pots_applied, &value)) {
+		flanger_modify_rate(&flanger, value);
+	}
 
 	// Use pot (HADC1) to set the flanger depth (0 -> 1.0)
-	flanger_modify_depth(&flanger, multicore_data->audioproj_fin_pot_hadc1);
+	if (pot_parameter_update(&flanger_depth, 1, flanger_pots_applied, &value)) {
+		flanger_modify_depth(&flanger, value);
+	}
 
 	// Use pot (HADC2) to set the flanger feedback (-1.0 -> 0 -> 1.0)
-	flanger_modify_feedback(&flanger,
-			2.0 * multicore_data->audioproj_fin_pot_hadc2 - 1.0);
+	if (pot_parameter_update(&flanger_feedback, 2, flanger_pots_applied, &value)) {
+		flanger_modify_feedback(&flanger, value);
+	}
+
+	flanger_pots_applied = core1_pots.version;
 
 }
 
@@ -387,11 +743,22 @@ static void effect_flanger_process(void) {
  */
 GUITAR_SYNTH guitar_synth;
 
+// Version of the pots applied by effect_guitar_synth_control()
+static uint32_t guitar_synth_pots_applied = 0;
+
+// Parameters moved by the pots
+static CONTROL_PARAMETER guitar_synth_clean_mix, guitar_synth_synth_mix;
+
 /**
  * @brief Setup routine to initialize instance of the guitar synth
  */
 static void effect_guitar_synth_setup(void) {
 
+	// Apply all the pots on the first control
+	guitar_synth_pots_applied = 0;
+	pot_parameter_setup(&guitar_synth_clean_mix, 0.0, 1.0, CONTROL_TAPER_LINEAR, true);
+	pot_parameter_setup(&guitar_synth_synth_mix, 0.0, 1.0, CONTROL_TAPER_LINEAR, true);
+
 	// Initialize effect instance
 	guitar_synth_setup(&guitar_synth, 0.5, 0.5,
 	AUDIO_SAMPLE_RATE);
@@ -399,25 +766,39 @@ static void effect_guitar_synth_setup(void) {
 }
 
 /**
- * Process audio and update some modifiable parameters via the pots
+ * @brief Adds the guitar synth to the effect graph
+ *
+ * @param graph Graph to add the nodes to
+ * @param audio_out Left and right output buffers
  */
-static void effect_guitar_synth_process(void) {
+static void effect_guitar_synth_build(EFFECT_GRAPH * graph, float ** audio_out) {
 
-	// Apply effect
-	guitar_synth_read(&guitar_synth, audio_effects_left_in,
-			audio_effects_left_out,
-			AUDIO_BLOCK_SIZE);
+	EFFECT_GRAPH_EDGE left_in = effect_graph_add_input(graph,
+			audio_effects_left_in);
+	EFFECT_GRAPH_EDGE left_out = effect_mono_to_stereo_build(graph, audio_out);
+
+	effect_graph_add_node(graph, node_guitar_synth, &guitar_synth, 1, &left_in,
+			1, &left_out);
+}
+
+/**
+ * Update some modifiable parameters via the pots
+ */
+static void effect_guitar_synth_control(void) {
 
-	copy_buffer(audio_effects_left_out, audio_effects_right_out,
-	AUDIO_BLOCK_SIZE);
+	float value;
 
 	// Use pot (HADC0) to set the clean mix
-	guitar_synth_modify_clean_mix(&guitar_synth,
-			multicore_data->audioproj_fin_pot_hadc0);
+	if (pot_parameter_update(&guitar_synth_clean_mix, 0, guitar_synth_pots_applied, &value)) {
+		guitar_synth_modify_clean_mix(&guitar_synth, value);
+	}
 
 	// Use pot (HADC1) to set the synth mix
-	guitar_synth_modify_synth_mix(&guitar_synth,
-			multicore_data->audioproj_fin_pot_hadc1);
+	if (pot_parameter_update(&guitar_synth_synth_mix, 1, guitar_synth_pots_applied, &value)) {
+		guitar_synth_modify_synth_mix(&guitar_synth, value);
+	}
+
+	guitar_synth_pots_applied = core1_pots.version;
 
 }
 
@@ -440,38 +821,69 @@ static void effect_guitar_synth_process(void) {
  */
 AUTOWAH autowah;
 
+// Version of the pots applied by effect_autowah_control()
+static uint32_t autowah_pots_applied = 0;
+
+// Parameters moved by the pots
+static CONTROL_PARAMETER autowah_depth, autowah_decay, autowah_q;
+
 /**
  * @brief Setup routine to initialize instance of the autowah
  */
 static void effect_autowah_setup(void) {
 
+	// Apply all the pots on the first control
+	autowah_pots_applied = 0;
+	pot_parameter_setup(&autowah_depth, 0.0, 1.0, CONTROL_TAPER_LINEAR, true);
+	pot_parameter_setup(&autowah_decay, 0.0, 1.0, CONTROL_TAPER_LINEAR, true);
+	pot_parameter_setup(&autowah_q, 0.0, 1.0, CONTROL_TAPER_LINEAR, true);
+
 	// Initialize effect instance
-	autowah_setup(&autowah, multicore_data->audioproj_fin_pot_hadc0,
-			multicore_data->audioproj_fin_pot_hadc1,
+	autowah_setup(&autowah, pot_value(0),
+			pot_value(1),
 			AUDIO_SAMPLE_RATE);
 
 }
 
 /**
- * Process audio and update some modifiable parameters via the pots
+ * @brief Adds the autowah to the effect graph
+ *
+ * @param graph Graph to add the nodes to
+ * @param audio_out Left and right output buffers
  */
-static void effect_autowah_process(void) {
+static void effect_autowah_build(EFFECT_GRAPH * graph, float ** audio_out) {
+
+	EFFECT_GRAPH_EDGE left_in = effect_graph_add_input(graph,
+			audio_effects_left_in);
+	EFFECT_GRAPH_EDGE left_out = effect_mono_to_stereo_build(graph, audio_out);
 
-	// Apply effect
-	autowah_read(&autowah, audio_effects_left_in, audio_effects_left_out,
-	AUDIO_BLOCK_SIZE);
+	effect_graph_add_node(graph, node_autowah, &autowah, 1, &left_in, 1,
+			&left_out);
+}
+
+/**
+ * Update some modifiable parameters via the pots
+ */
+static void effect_autowah_control(void) {
 
-	copy_buffer(audio_effects_left_out, audio_effects_right_out,
-	AUDIO_BLOCK_SIZE);
+	float value;
 
 	// Use pot (HADC0) to set the depth (i.e. frequency range of sweep)
-	autowah_modify_depth(&autowah, multicore_data->audioproj_fin_pot_hadc0);
+	if (pot_parameter_update(&autowah_depth, 0, autowah_pots_applied, &value)) {
+		autowah_modify_depth(&autowah, value);
+	}
 
 	// Use pot (HADC0) to set the decay time
-	autowah_modify_decay(&autowah, multicore_data->audioproj_fin_pot_hadc1);
+	if (pot_parameter_update(&autowah_decay, 1, autowah_pots_applied, &value)) {
+		autowah_modify_decay(&autowah, value);
+	}
 
 	// Use pot (HADC2) to set the width of the filter
-	autowah_modify_q(&autowah, multicore_data->audioproj_fin_pot_hadc2);
+	if (pot_parameter_update(&autowah_q, 2, autowah_pots_applied, &value)) {
+		autowah_modify_q(&autowah, value);
+	}
+
+	autowah_pots_applied = core1_pots.version;
 
 }
 
@@ -492,73 +904,100 @@ static void effect_autowah_process(void) {
  */
 STEREO_FLANGER flanger_fx1;
 TUBE_DISTORTION tube_dist_fx1;
-DELAY_LPF delay_l_fx1, delay_r_fx1;
+DELAY_LPF delay_fx1;
 #define FX_DELAY_LEN	(32000)
-float section("seg_sdram") delay_line_l_fx1[INT_DELAY_LEN];	// Delay line in SDRAM
-float section("seg_sdram") delay_line_r_fx1[INT_DELAY_LEN];	// Delay line in SDRAM
+float section("seg_sdram") delay_line_fx1[2 * FX_DELAY_LEN];	// Delay line in SDRAM
+
+// The right echo is 1000 samples shorter than the left
+int32_t delay_offsets_fx1[2] = { 0, -1000 };
+
+// Version of the pots applied by multifx_1_test_control()
+static uint32_t multifx_1_pots_applied = 0;
+
+// Parameters moved by the pots
+static CONTROL_PARAMETER multifx_1_depth, multifx_1_drive, multifx_1_length;
 
 /**
  * @brief Setup routine to initialize instances for the multli-effects example
  */
 static void multifx_1_test_setup(void) {
 
+	// Apply all the pots on the first control
+	multifx_1_pots_applied = 0;
+	pot_parameter_setup(&multifx_1_depth, 0.0, 1.0, CONTROL_TAPER_LINEAR, true);
+	pot_parameter_setup(&multifx_1_drive, 0.0, 64.0, CONTROL_TAPER_LINEAR, true);
+	pot_parameter_setup(&multifx_1_length, FX_DELAY_LEN / 2, FX_DELAY_LEN, CONTROL_TAPER_LINEAR, false);
+
 	// Initialize effect instances
 	// Initialize effect instance
 	flanger_setup(&flanger_fx1, 0.3, 0.2, -0.35, AUDIO_SAMPLE_RATE);
 
 	tube_distortion_setup(&tube_dist_fx1,
-			multicore_data->audioproj_fin_pot_hadc1 * 128.0, 0.20, 0.9,
+			pot_value(1) * 128.0, 0.20, 0.9,
 			AUDIO_SAMPLE_RATE);
 
-	delay_setup(&delay_l_fx1, delay_line_l_fx1,
+	delay_setup_multichannel(&delay_fx1, 2, delay_line_fx1,
 	FX_DELAY_LEN,
-	FX_DELAY_LEN - 1000, 0.3, 0.6, 0.2);
-	delay_setup(&delay_r_fx1, delay_line_r_fx1,
-	FX_DELAY_LEN,
-	FX_DELAY_LEN, 0.3, 0.6, 0.2);
+	FX_DELAY_LEN, delay_offsets_fx1, 0.3, 0.6, 0.2);
 
 }
 
 /**
- * @brief: Process audio and update some modifiable parameters via the pots
+ * @brief Adds the chain of effects to the effect graph
+ *
+ * The blocks between the effects are intermediate edges, the graph places
+ * them in its scratch memory.
+ *
+ * @param graph Graph to add the nodes to
+ * @param audio_out Left and right output buffers
  */
-static void multifx_1_test_process(void) {
+static void multifx_1_test_build(EFFECT_GRAPH * graph, float ** audio_out) {
 
-	// Apply effects
-	float temp_1[AUDIO_BLOCK_SIZE], temp_2[AUDIO_BLOCK_SIZE];
+	EFFECT_GRAPH_EDGE left_in = effect_graph_add_input(graph,
+			audio_effects_left_in);
+	EFFECT_GRAPH_EDGE distorted = effect_graph_add_edge(graph);
+	EFFECT_GRAPH_EDGE flanged[2] = { effect_graph_add_edge(graph),
+			effect_graph_add_edge(graph) };
+	EFFECT_GRAPH_EDGE delay_out[2] = { effect_graph_add_output(graph,
+			audio_out[0]), effect_graph_add_output(graph,
+			audio_out[1]) };
 
 	// Apply distortion
-	tube_distortion_read(&tube_dist_fx1, audio_effects_left_in, temp_1,
-	AUDIO_BLOCK_SIZE);
+	effect_graph_add_node(graph, node_tube_distortion, &tube_dist_fx1, 1,
+			&left_in, 1, &distorted);
 
-	// Apply tremelo
-	flanger_read(&flanger_fx1, temp_1, audio_effects_left_out,
-			audio_effects_right_out,
-			AUDIO_BLOCK_SIZE);
+	// Apply flanger
+	effect_graph_add_node(graph, node_flanger, &flanger_fx1, 1, &distorted, 2,
+			flanged);
 
 	// Apply delay / echo
-	delay_read(&delay_l_fx1, audio_effects_left_out, audio_effects_left_out,
-	AUDIO_BLOCK_SIZE);
+	effect_graph_add_node(graph, node_delay, &delay_fx1, 2, flanged, 2,
+			delay_out);
+}
+
+/**
+ * @brief: Update some modifiable parameters via the pots
+ */
+static void multifx_1_test_control(void) {
 
-	delay_read(&delay_r_fx1, audio_effects_right_out, audio_effects_right_out,
-	AUDIO_BLOCK_SIZE);
+	float value;
 
 	// Use pot (HADC0) to modify the flanger depth
-	flanger_modify_depth(&flanger_fx1, multicore_data->audioproj_fin_pot_hadc0);
+	if (pot_parameter_update(&multifx_1_depth, 0, multifx_1_pots_applied, &value)) {
+		flanger_modify_depth(&flanger_fx1, value);
+	}
 
 	// Use pot (HADC1) to modify the distortion drive
-	tube_distortion_modify_drive(&tube_dist_fx1,
-			multicore_data->audioproj_fin_pot_hadc1 * 64.0);
+	if (pot_parameter_update(&multifx_1_drive, 1, multifx_1_pots_applied, &value)) {
+		tube_distortion_modify_drive(&tube_dist_fx1, value);
+	}
 
 	// Use pot (HADC2) to modify the length of the delay
-	delay_modify_length(&delay_l_fx1,
-			FX_DELAY_LEN / 2
-					+ multicore_data->audioproj_fin_pot_hadc2 * FX_DELAY_LEN
-							/ 2);
-	delay_modify_length(&delay_r_fx1,
-			FX_DELAY_LEN / 2
-					+ multicore_data->audioproj_fin_pot_hadc2 * FX_DELAY_LEN / 2
-					- 1000);
+	if (pot_parameter_update(&multifx_1_length, 2, multifx_1_pots_applied, &value)) {
+		delay_modify_length(&delay_fx1, value);
+	}
+
+	multifx_1_pots_applied = core1_pots.version;
 
 }
 
@@ -583,11 +1022,22 @@ static void multifx_1_test_process(void) {
  */
 RING_MODULATOR ring_mod;
 
+// Version of the pots applied by effect_ringmod_control()
+static uint32_t ringmod_pots_applied = 0;
+
+// Parameters moved by the pots
+static CONTROL_PARAMETER ringmod_freq, ringmod_depth;
+
 /**
  * @brief Setup routine to initialize instance of the ring modulator
  */
 static void effect_ringmod_setup(void) {
 
+	// Apply all the pots on the first control
+	ringmod_pots_applied = 0;
+	pot_parameter_setup(&ringmod_freq, 50.0, 350.0, CONTROL_TAPER_LOG, true);
+	pot_parameter_setup(&ringmod_depth, 0.0, 1.0, CONTROL_TAPER_LINEAR, true);
+
 	// Initialize effect instance
 	ring_modulator_setup(&ring_mod, 200.0, 0.5,
 	AUDIO_SAMPLE_RATE);
@@ -595,92 +1045,280 @@ static void effect_ringmod_setup(void) {
 }
 
 /**
- * @brief Process audio and update some modifiable parameters via the pots
+ * @brief Adds the ring modulator to the effect graph
+ *
+ * @param graph Graph to add the nodes to
+ * @param audio_out Left and right output buffers
  */
-static void effect_ringmod_process(void) {
+static void effect_ringmod_build(EFFECT_GRAPH * graph, float ** audio_out) {
 
-	// Apply effect
-	ring_modulator_read(&ring_mod, audio_effects_left_in,
-			audio_effects_left_out,
-			AUDIO_BLOCK_SIZE);
+	EFFECT_GRAPH_EDGE left_in = effect_graph_add_input(graph,
+			audio_effects_left_in);
+	EFFECT_GRAPH_EDGE left_out = effect_mono_to_stereo_build(graph, audio_out);
+
+	effect_graph_add_node(graph, node_ring_modulator, &ring_mod, 1, &left_in, 1,
+			&left_out);
+}
 
-	copy_buffer(audio_effects_left_out, audio_effects_right_out,
-	AUDIO_BLOCK_SIZE);
+/**
+ * @brief Update some modifiable parameters via the pots
+ */
+static void effect_ringmod_control(void) {
+
+	float value;
 
 	// Use pot (HADC0) to set the modulation frequency
-	ring_modulator_modify_freq(&ring_mod,
-			50.0 + 300.0 * multicore_data->audioproj_fin_pot_hadc0);
+	if (pot_parameter_update(&ringmod_freq, 0, ringmod_pots_applied, &value)) {
+		ring_modulator_modify_freq(&ring_mod, value);
+	}
 
 	// Use pot (HADC1) to set the depth / mix of the effect
-	ring_modulator_modify_depth(&ring_mod,
-			multicore_data->audioproj_fin_pot_hadc1);
+	if (pot_parameter_update(&ringmod_depth, 1, ringmod_pots_applied, &value)) {
+		ring_modulator_modify_depth(&ring_mod, value);
+	}
+
+	ringmod_pots_applied = core1_pots.version;
 
 }
 
 /**
- * @brief Set up routines for all effects running on core 1
+ * 10 - AMP AND CABINET SIMULATOR
+ *
+ * A guitar amp's tone owes as much to its speaker cabinet as to its tubes.
+ * This effect runs the tube distortion into a convolver (see
+ * audio_elements/convolver.c), which filters it with the impulse response
+ * (IR) of a cabinet.  The IR here is modelled with a few filters (a box
+ * resonance, a presence peak and the roll-off of the speakers), a measured
+ * cabinet IR can be loaded in its place.
+ *
+ * The first 2 * CABINET_TAIL_SIZE samples of the IR are convolved in the
+ * audio callback, the rest in the background loop (see
+ * audio_effects_background_core1()).
+ *
+ * POT/HADC0 : distortion output gain
+ * POT/HADC1 : distortion drive (prior to clipping)
+ * POT/HADC2 : tone of the distortion
+ *
+ * Some fun things to try:
+ *  - Load a measured cabinet IR into cabinet_ir
+ *  - Use the IR of a room instead for a convolution reverb (longer IRs need
+ *    a larger CABINET_TAIL_SIZE and more bulk memory)
+ *
  */
-void audio_effects_setup_core1(void) {
+TUBE_DISTORTION tube_dist_cab;
+CONVOLVER cabinet;
 
-	effect_echo_setup();
-	effect_multitap_delay_setup();
-	effect_multiband_compressor_setup();
-	effect_tube_distortion_setup();
-	effect_flanger_setup();
-	effect_guitar_synth_setup();
-	effect_autowah_setup();
-	multifx_1_test_setup();
-	effect_ringmod_setup();
+#define CABINET_IR_LENGTH	(2048)		// ~43ms at 48kHz
+#define CABINET_TAIL_SIZE	(256)
 
+// Memory for the convolver, as returned by convolver_memory_required()
+#define CABINET_FAST_MEMORY_SIZE	(4 * CABINET_TAIL_SIZE + 2 * AUDIO_BLOCK_SIZE \
+		* (2 * (2 * CABINET_TAIL_SIZE / AUDIO_BLOCK_SIZE) + 3))
+#define CABINET_BULK_MEMORY_SIZE	(2 * CABINET_TAIL_SIZE \
+		* (2 * ((CABINET_IR_LENGTH - CABINET_TAIL_SIZE - 1) / CABINET_TAIL_SIZE) + 3))
+float cabinet_fast_memory[CABINET_FAST_MEMORY_SIZE];
+float section("seg_sdram") cabinet_bulk_memory[CABINET_BULK_MEMORY_SIZE];
+float section("seg_sdram") cabinet_ir[CABINET_IR_LENGTH];
+
+// Version of the pots applied by effect_cabinet_control()
+static uint32_t cabinet_pots_applied = 0;
+
+// Parameters moved by the pots
+static CONTROL_PARAMETER cabinet_gain, cabinet_drive, cabinet_contour;
+
+/**
+ * @brief Models the impulse response of a guitar cabinet in cabinet_ir
+ *
+ * An impulse is run through a cascade of filters and the end of the response
+ * is faded out.
+ */
+static void effect_cabinet_model_ir(void) {
+
+	BIQUAD_CASCADE model;
+
+	biquad_cascade_setup(&model, 5, AUDIO_SAMPLE_RATE);
+	biquad_cascade_modify_section(&model, 0, BIQUAD_TYPE_HPF, 70.0, 0.7, 0.0);
+	biquad_cascade_modify_section(&model, 1, BIQUAD_TYPE_PEAKING, 110.0, 1.4,
+			6.0);
+	biquad_cascade_modify_section(&model, 2, BIQUAD_TYPE_PEAKING, 2500.0, 1.0,
+			4.0);
+	biquad_cascade_modify_section(&model, 3, BIQUAD_TYPE_LPF, 5000.0, 0.7,
+			0.0);
+	biquad_cascade_modify_section(&model, 4, BIQUAD_TYPE_LPF, 5000.0, 0.7,
+			0.0);
+
+	for (int i = 0; i < CABINET_IR_LENGTH; i++) {
+		cabinet_ir[i] = (i == 0) ? 1.0 : 0.0;
+	}
+	biquad_cascade_read(&model, cabinet_ir, cabinet_ir, CABINET_IR_LENGTH);
+
+	// Fade out the last CABINET_TAIL_SIZE samples so the IR doesn't end abruptly
+	for (int i = 0; i < CABINET_TAIL_SIZE; i++) {
+		cabinet_ir[CABINET_IR_LENGTH - 1 - i] *= (float) i
+				/ CABINET_TAIL_SIZE;
+	}
 }
 
 /**
- * This routine should be called every time a new block of audio arrives (in the callback
- * function) in SHARC core 1.
+ * @brief Setup routine to initialize instances of the amp and the cabinet
  */
-void audio_effects_process_audio_core1(void) {
+static void effect_cabinet_setup(void) {
 
-	/**
-	 * On core 1, we'll apply various audio effects and on core 2, we'll do just reverb
-	 */
-
-	static int32_t core_1_effect_preset = 0;
-	uint32_t core_1_total_presets = 10;
-
-	switch (multicore_data->effects_preset) {
-	case 1:
-		effect_echo_process();
-		break;
-	case 2:
-		effect_multitap_delay_process();
-		break;
-	case 3:
-		effect_tube_distortion_process();
-		break;
-	case 4:
-		effect_multiband_compressor_process();
-		break;
-	case 5:
-		effect_flanger_process();
-		break;
-	case 6:
-		effect_guitar_synth_process();
-		break;
-	case 7:
-		effect_autowah_process();
-		break;
-	case 8:
-		multifx_1_test_process();
-		break;
-	case 9:
-		effect_ringmod_process();
-		break;
-
-	default:
-		effect_bypass();
-		break;
+	// Apply all the pots on the first control
+	cabinet_pots_applied = 0;
+	pot_parameter_setup(&cabinet_gain, 0.0, 0.5, CONTROL_TAPER_LINEAR, true);
+	pot_parameter_setup(&cabinet_drive, 0.0, 64.0, CONTROL_TAPER_LINEAR, true);
+	pot_parameter_setup(&cabinet_contour, 0.0, 1.0, CONTROL_TAPER_LINEAR, true);
+
+	// Initialize effect instances
+	tube_distortion_setup(&tube_dist_cab,
+			pot_value(1) * 64.0,
+			pot_value(0) * 0.5,
+			pot_value(2),
+			AUDIO_SAMPLE_RATE);
+
+	effect_cabinet_model_ir();
+	convolver_setup(&cabinet, cabinet_ir, CABINET_IR_LENGTH, AUDIO_BLOCK_SIZE,
+			CABINET_TAIL_SIZE, cabinet_fast_memory, CABINET_FAST_MEMORY_SIZE,
+			cabinet_bulk_memory, CABINET_BULK_MEMORY_SIZE);
+}
+
+/**
+ * @brief Adds the amp and the cabinet to the effect graph
+ *
+ * @param graph Graph to add the nodes to
+ * @param audio_out Left and right output buffers
+ */
+static void effect_cabinet_build(EFFECT_GRAPH * graph, float ** audio_out) {
+
+	EFFECT_GRAPH_EDGE left_in = effect_graph_add_input(graph,
+			audio_effects_left_in);
+	EFFECT_GRAPH_EDGE distorted = effect_graph_add_edge(graph);
+	EFFECT_GRAPH_EDGE left_out = effect_mono_to_stereo_build(graph, audio_out);
+
+	effect_graph_add_node(graph, node_tube_distortion, &tube_dist_cab, 1,
+			&left_in, 1, &distorted);
+	effect_graph_add_node(graph, node_convolver, &cabinet, 1, &distorted, 1,
+			&left_out);
+}
+
+/**
+ * @brief Update some modifiable parameters via the pots
+ */
+static void effect_cabinet_control(void) {
+
+	float value;
+
+	// Use pot (HADC0) to modify the output gain of the distortion
+	if (pot_parameter_update(&cabinet_gain, 0, cabinet_pots_applied, &value)) {
+		tube_distortion_modify_gain(&tube_dist_cab, value);
 	}
 
+	// Use pot (HADC1) to modify the input drive into the clipping function
+	if (pot_parameter_update(&cabinet_drive, 1, cabinet_pots_applied, &value)) {
+		tube_distortion_modify_drive(&tube_dist_cab, value);
+	}
+
+	// Use pot (HADC2) to modify the tone of the distortion
+	if (pot_parameter_update(&cabinet_contour, 2, cabinet_pots_applied, &value)) {
+		tube_distortion_modify_contour(&tube_dist_cab, value);
+	}
+
+	cabinet_pots_applied = core1_pots.version;
+
+}
+
+#if defined(MIDI_UART_MANAGED_BY_SHARC1_CORE) && (MIDI_UART_MANAGED_BY_SHARC1_CORE)
+
+/**
+ * MIDI POLYPHONIC SYNTH
+ *
+ * This isn't a preset - the synth is mixed into the output of whichever effect
+ * is selected, so a MIDI keyboard connected to the Audio Project Fin can play
+ * along with the effects.  MIDI bytes received by the UART callback on this
+ * core (callback_midi_message.cpp) are parsed into messages and passed to
+ * audio_effects_midi_message_core1().
+ *
+ * Some fun things to try:
+ *  - Map a MIDI CC to the envelope with poly_synth_modify_envelope()
+ *  - Run the synth output through one of the effects above
+ *
+ */
+POLY_SYNTH poly_synth;
+
+/**
+ * @brief Setup routine to initialize instance of the poly synth
+ */
+static void effect_poly_synth_setup(void) {
+
+	poly_synth_setup(&poly_synth, POLY_SYNTH_MAX_VOICES, OSC_RAMP, 0.005, 0.8,
+			0.6, 0.4, 0.1,
+			AUDIO_SAMPLE_RATE);
+}
+
+/**
+ * @brief Renders the notes being played and adds them to the audio
+ */
+static void effect_poly_synth_process(float ** audio_in, float ** audio_out,
+		uint32_t audio_block_size) {
+
+	float synth_out[AUDIO_BLOCK_SIZE];
+
+	poly_synth_read(&poly_synth, synth_out, audio_block_size);
+
+	for (int i = 0; i < audio_block_size; i++) {
+		audio_out[0][i] = audio_in[0][i] + synth_out[i];
+		audio_out[1][i] = audio_in[1][i] + synth_out[i];
+	}
+}
+
+/**
+ * @brief Passes a MIDI message to the poly synth
+ *
+ * This is called from the MIDI UART interrupt, the message is queued and
+ * applied at the start of the next audio block.
+ *
+ * @param message Pointer to a complete MIDI message
+ */
+void audio_effects_midi_message_core1(MIDI_MESSAGE * message) {
+
+	poly_synth_midi_message(&poly_synth, message);
+}
+
+#endif
+
+/**
+ * Core 1 presets, indexed by multicore_data->effects_preset
+ */
+static const PRESET_MANAGER_PRESET core1_presets[] = {
+	{ NULL, effect_bypass_build, NULL },
+	{ effect_echo_setup, effect_echo_build, effect_echo_control },
+	{ effect_multitap_delay_setup, effect_multitap_delay_build, NULL },
+	{ effect_tube_distortion_setup, effect_tube_distortion_build,
+			effect_tube_distortion_control },
+	{ effect_multiband_compressor_setup, effect_multiband_compressor_build,
+			effect_multiband_compressor_control },
+	{ effect_flanger_setup, effect_flanger_build, effect_flanger_control },
+	{ effect_guitar_synth_setup, effect_guitar_synth_build,
+			effect_guitar_synth_control },
+	{ effect_autowah_setup, effect_autowah_build, effect_autowah_control },
+	{ multifx_1_test_setup, multifx_1_test_build, multifx_1_test_control },
+	{ effect_ringmod_setup, effect_ringmod_build, effect_ringmod_control },
+	{ effect_cabinet_setup, effect_cabinet_build, effect_cabinet_control }
+};
+
+#define CORE1_TOTAL_PRESETS	(sizeof(core1_presets) / sizeof(core1_presets[0]))
+
+/**
+ * @brief Returns the selected core 1 preset (bypass if out of range)
+ */
+static uint32_t audio_effects_selected_preset_core1(void) {
+
+	uint32_t preset = multicore_data->effects_preset;
+	if (preset >= CORE1_TOTAL_PRESETS) {
+		preset = 0;
+	}
+	return preset;
 }
 
 /******************************************************************************
@@ -690,23 +1328,305 @@ void audio_effects_process_audio_core1(void) {
  * conventions so the input and output buffers use the same names.  This makes
  * it easy to move effects from core 1 to core 2 and visa versa.
  *
+ * The limiter and the reverb are stages of the effects pipeline (below), so
+ * they can also run on core 1 when that balances the load of the two cores.
+ *
  *****************************************************************************/
 
 // Instances
-STEREO_REVERB reverb_stereo;
-COMPRESSOR limiter_l, limiter_r;
+FDN_REVERB reverb_fdn;
+float reverb_fdn_memory[FDN_REVERB_MEMORY_SIZE_8_LINES];
+LINKED_COMPRESSOR limiter_stereo;
+
+// Lookahead delay lines for the limiter (2 channels)
+#define LIMITER_CONTROL_INTERVAL    (8)
+#define LIMITER_LOOKAHEAD           (2 * LIMITER_CONTROL_INTERVAL)
+float limiter_lookahead[2 * LIMITER_LOOKAHEAD];
+
+// Reverb presets selected by multicore_data->reverb_preset
+#define REVERB_TOTAL_PRESETS		(10)
+
+// Reverb preset that was last applied
+static uint32_t reverb_preset_last = 0;
+
+/**
+ * @brief Setup routine for the limiter
+ */
+static void effect_limiter_setup(void) {
+
+	// Fast stereo-linked peak limiter on the audio arriving from core 1
+	linked_compressor_setup(&limiter_stereo, 2, -6.0, 1000.0, 0, 5, 1.0,
+			LINKED_COMPRESSOR_DETECT_PEAK, LIMITER_CONTROL_INTERVAL,
+			limiter_lookahead, LIMITER_LOOKAHEAD, AUDIO_SAMPLE_RATE);
+}
+
+/**
+ * @brief Applies the limiter (bypassed along with the reverb by reverb preset 0)
+ */
+static void effect_limiter_process(float ** audio_in, float ** audio_out,
+		uint32_t audio_block_size) {
+
+	if (multicore_data->reverb_preset == 0) {
+		effect_bypass(audio_in, audio_out, audio_block_size);
+		return;
+	}
+
+	// Apply limiter at -6dB to avoid clipping from earlier stage effects
+	linked_compressor_read(&limiter_stereo, audio_in, audio_out,
+			audio_block_size);
+}
+
+/**
+ * @brief Setup routine for the reverb
+ */
+static void effect_reverb_setup(void) {
+
+	// Stereo reverb (8-line feedback delay network)
+	fdn_reverb_setup(&reverb_fdn, 8, FDN_REVERB_MIX_HADAMARD,
+			reverb_fdn_memory, FDN_REVERB_MEMORY_SIZE_8_LINES, 1.5, 0.2, 0.3,
+			1.0, AUDIO_SAMPLE_RATE);
+
+	// Apply the selected reverb preset on the next block
+	reverb_preset_last = 0;
+}
+
+/**
+ * @brief Applies the reverb selected by multicore_data->reverb_preset
+ */
+static void effect_reverb_process(float ** audio_in, float ** audio_out,
+		uint32_t audio_block_size) {
+
+	float reverb_decay[REVERB_TOTAL_PRESETS] = { 0.0, 1.5, 0.8, 3.0, 0.8, 1.5,
+			3.0, 0.5, 1.5, 5.0 };
+	float reverb_dampening[REVERB_TOTAL_PRESETS] = { 0.0, 0.1, 0.2, 0.2, 0.3,
+			0.3, 0.3, 0.4, 0.4, 0.4 };
+
+	// The ARM wraps the reverb presets at the number of effects presets,
+	// which can be more (bypass if out of range)
+	uint32_t reverb_preset = multicore_data->reverb_preset;
+	if (reverb_preset >= REVERB_TOTAL_PRESETS) {
+		reverb_preset = 0;
+	}
+
+	// Only recalculate the reverb gains when the preset changes
+	if (reverb_preset != reverb_preset_last && reverb_preset != 0) {
+		fdn_reverb_modify_decay(&reverb_fdn, reverb_decay[reverb_preset]);
+		fdn_reverb_modify_damping(&reverb_fdn,
+				reverb_dampening[reverb_preset]);
+	}
+	reverb_preset_last = reverb_preset;
+
+	if (reverb_preset == 0) {
+		effect_bypass(audio_in, audio_out, audio_block_size);
+		return;
+	}
+
+	// Apply stereo reverb effect
+	fdn_reverb_read(&reverb_fdn, audio_in[0], audio_out[0], audio_out[1],
+			audio_block_size);
+}
+
+/******************************************************************************
+ * Effects pipeline
+ *
+ * The effects run as a pipeline that is split between the two cores (see
+ * pipeline_scheduler.c): the selected preset (and the synth) on core 1, then
+ * the limiter and the reverb, on core 2 at start-up.  When
+ * REBALANCE_EFFECTS_BETWEEN_CORES is set, the background loop on core 1
+ * compares the profiles both cores publish once per second and moves the
+ * limiter and the reverb between the cores to balance their load.
+ *
+ * Core 1 records the split it processed each block with in
+ * multicore_data->pipeline_split and the audio framework passes it on in
+ * pipeline_split_to_core2 when it sends the block to core 2.  A move is
+ * handed over in the background loops: core 1 sets up the stages it takes
+ * over and requests the new split, core 2 sets up the stages it takes over
+ * and acknowledges, then core 1 starts using the new split.
+ *
+ *****************************************************************************/
+
+/**
+ * @brief Runs the selected preset(s) and updates their parameters
+ *
+ * This is always the first stage, on core 1.  The preset graphs are bound to
+ * audio_effects_left_in / audio_effects_right_in (which is audio_in here)
+ * when they are built, and the preset manager was set up with the block
+ * size, so neither is passed on.
+ */
+static void effect_presets_process(float ** audio_in, float ** audio_out,
+		uint32_t audio_block_size) {
+
+	(void) audio_in;
+	(void) audio_block_size;
+
+	preset_manager_read(&core1_preset_manager, audio_out);
+}
+
+// Stages of the pipeline, in processing order
+static const PIPELINE_STAGE effects_pipeline_stages[] = {
+	{ "effects", PIPELINE_STAGE_CORE1, NULL, effect_presets_process },
+#if defined(MIDI_UART_MANAGED_BY_SHARC1_CORE) && (MIDI_UART_MANAGED_BY_SHARC1_CORE)
+	{ "synth", PIPELINE_STAGE_CORE1, effect_poly_synth_setup,
+			effect_poly_synth_process },
+#endif
+	{ "limiter", PIPELINE_STAGE_ANY_CORE, effect_limiter_setup,
+			effect_limiter_process },
+	{ "reverb", PIPELINE_STAGE_ANY_CORE, effect_reverb_setup,
+			effect_reverb_process }
+};
+
+#define EFFECTS_PIPELINE_STAGES	(sizeof(effects_pipeline_stages) / sizeof(effects_pipeline_stages[0]))
+
+// The limiter and the reverb start on core 2
+#define EFFECTS_PIPELINE_INITIAL_SPLIT	(EFFECTS_PIPELINE_STAGES - 2)
+
+// A new split has to save 5% of a block on the busier core
+#define EFFECTS_PIPELINE_HYSTERESIS		(((CORE_CLOCK_FREQ_HZ / AUDIO_SAMPLE_RATE) * AUDIO_BLOCK_SIZE) / 20)
+
+PIPELINE_SCHEDULER effects_pipeline;
+
+// Split core 1 processes with (changed by the background loop on core 1)
+static volatile uint32_t effects_pipeline_split =
+		EFFECTS_PIPELINE_INITIAL_SPLIT;
+
+// Profile windows each core must have published before balancing again
+static uint32_t effects_pipeline_next_window[2] = { 0, 0 };
+
+/**
+ * @brief Moves stages between the cores if that balances their load better
+ *
+ * Called from the background loop on core 1.
+ */
+static void effects_pipeline_balance_core1(void) {
+
+	uint32_t split = effects_pipeline_split;
+	uint32_t split_requested = multicore_data->pipeline_split_requested;
+
+	// Once core 2 has set up the stages it takes over, switch to the new split
+	if (split_requested != split) {
+		if (multicore_data->pipeline_split_prepared == split_requested) {
+			effects_pipeline_split = split_requested;
+			multicore_data->pipeline_rebalances++;
+
+			// Skip the windows measured partly with the old split
+			effects_pipeline_next_window[0] =
+					multicore_data->sharc_core1_cycle_profile.windows_published
+							+ 2;
+			effects_pipeline_next_window[1] =
+					multicore_data->sharc_core2_cycle_profile.windows_published
+							+ 2;
+		}
+		return;
+	}
+
+	// Wait for a new window from both cores
+	if (multicore_data->sharc_core1_cycle_profile.windows_published
+			< effects_pipeline_next_window[0]
+			|| multicore_data->sharc_core2_cycle_profile.windows_published
+					< effects_pipeline_next_window[1]) {
+		return;
+	}
+
+	BM_CYCLE_PROFILE_TABLE profile[2];
+	if (!cycle_profiler_copy_table(&multicore_data->sharc_core1_cycle_profile,
+			&profile[0])
+			|| !cycle_profiler_copy_table(
+					&multicore_data->sharc_core2_cycle_profile, &profile[1])) {
+		return;
+	}
+	effects_pipeline_next_window[0] = profile[0].windows_published + 1;
+	effects_pipeline_next_window[1] = profile[1].windows_published + 1;
+
+	uint32_t split_best = pipeline_scheduler_balance(&effects_pipeline,
+			&profile[0], &profile[1], split, EFFECTS_PIPELINE_HYSTERESIS);
+
+	// Set up the stages moving to this core, then ask core 2 to do the same
+	if (split_best != split) {
+		pipeline_scheduler_prepare(&effects_pipeline, split, split_best);
+		multicore_data->pipeline_split_requested = split_best;
+	}
+}
+
+/**
+ * @brief Set up routines for the effects running on core 1
+ *
+ * Only the preset selected at start-up is set up here, the others are set
+ * up in the background loop when they are selected.
+ */
+void audio_effects_setup_core1(void) {
+
+	parameter_snapshot_setup(&core1_pots);
+
+	preset_manager_setup(&core1_preset_manager, core1_presets,
+	CORE1_TOTAL_PRESETS, audio_effects_selected_preset_core1(), 2,
+			core1_preset_memory, CORE1_GRAPH_SCRATCH_BUFFERS,
+			CORE1_PRESET_CROSSFADE_BLOCKS,
+			AUDIO_BLOCK_SIZE);
+	preset_manager_modify_cycle_budget(&core1_preset_manager,
+			CORE1_PRESET_CYCLE_BUDGET);
+
+	pipeline_scheduler_setup(&effects_pipeline, effects_pipeline_stages,
+			EFFECTS_PIPELINE_STAGES, 1, EFFECTS_PIPELINE_INITIAL_SPLIT, 2,
+			AUDIO_BLOCK_SIZE);
+	effects_pipeline_split = EFFECTS_PIPELINE_INITIAL_SPLIT;
+
+	// Core 2 prepares the split requested last, so publish that last
+	multicore_data->pipeline_split = EFFECTS_PIPELINE_INITIAL_SPLIT;
+	multicore_data->pipeline_split_to_core2 = EFFECTS_PIPELINE_INITIAL_SPLIT;
+	multicore_data->pipeline_split_prepared = EFFECTS_PIPELINE_INITIAL_SPLIT;
+	multicore_data->pipeline_split_requested = EFFECTS_PIPELINE_INITIAL_SPLIT;
+
+}
+
+/**
+ * This routine should be called every time a new block of audio arrives (in the callback
+ * function) in SHARC core 1.
+ */
+void audio_effects_process_audio_core1(void) {
+
+	// Latch the pots once so the whole block is processed with the same values
+	parameter_snapshot_latch(&multicore_data->audioproj_fin_hadc, &core1_pots);
+
+	// Request the selected preset, the switch itself happens in the background
+	preset_manager_select(&core1_preset_manager,
+			audio_effects_selected_preset_core1());
+
+	// Run the stages of the pipeline on this core
+	float * audio_in[2] = { audio_effects_left_in, audio_effects_right_in };
+	float * audio_out[2] = { audio_effects_left_out, audio_effects_right_out };
+	uint32_t split = effects_pipeline_split;
+	pipeline_scheduler_run(&effects_pipeline, split, audio_in, audio_out);
+
+	// Passed on to core 2 along with this block
+	multicore_data->pipeline_split = split;
+
+}
+
+/**
+ * This routine should be called from the background loop on SHARC core 1.  It
+ * sets up presets that have been selected so the audio callback doesn't have to
+ * and moves effects between the cores.
+ */
+void audio_effects_background_core1(void) {
+
+	// Convolve the tail of the cabinet IR (if that preset is playing)
+	convolver_process_tail(&cabinet);
+
+	preset_manager_process_background(&core1_preset_manager);
+
+#if (USE_BOTH_CORES_TO_PROCESS_AUDIO) && (REBALANCE_EFFECTS_BETWEEN_CORES)
+	effects_pipeline_balance_core1();
+#endif
+}
 
 /**
  * @brief  Set up routines for any effects running on core 2
  */
 void audio_effects_setup_core2(void) {
 
-	// Fast limiter on output
-	compressor_setup(&limiter_l, -6.0, 1000.0, 5, 5, 1.0, AUDIO_SAMPLE_RATE);
-	compressor_setup(&limiter_r, -6.0, 1000.0, 5, 5, 1.0, AUDIO_SAMPLE_RATE);
-
-	// Stereo reverb
-	reverb_setup(&reverb_stereo, 0.3, 1.0, 0.92, 0.2);
+	pipeline_scheduler_setup(&effects_pipeline, effects_pipeline_stages,
+			EFFECTS_PIPELINE_STAGES, 2, EFFECTS_PIPELINE_INITIAL_SPLIT, 2,
+			AUDIO_BLOCK_SIZE);
 
 }
 
@@ -716,31 +1636,24 @@ void audio_effects_setup_core2(void) {
  */
 void audio_effects_process_audio_core2(void) {
 
-	float reverb_feedback[10] = { 0.0, 0.9, 0.8, 0.95, 0.8, 0.9, 0.95, 0.7, 0.9,
-			0.97 };
-	float reverb_dampening[10] = { 0.0, 0.1, 0.2, 0.2, 0.3, 0.3, 0.3, 0.4, 0.4,
-			0.4 };
-
-	reverb_change_feedback(&reverb_stereo,
-			reverb_feedback[multicore_data->reverb_preset]);
-	reverb_change_lp_damp_coeff(&reverb_stereo,
-			reverb_dampening[multicore_data->reverb_preset]);
+	// Run the rest of the pipeline, split the way core 1 split this block
+	float * audio_in[2] = { audio_effects_left_in, audio_effects_right_in };
+	float * audio_out[2] = { audio_effects_left_out, audio_effects_right_out };
+	pipeline_scheduler_run(&effects_pipeline,
+			multicore_data->pipeline_split_to_core2, audio_in, audio_out);
 
-	if (multicore_data->reverb_preset == 0) {
-		effect_bypass();
-	} else {
-
-		// Apply limiter at -6dB to avoid clipping from earlier stage effects
-		compressor_read(&limiter_l, audio_effects_left_out,
-				audio_effects_left_out, AUDIO_BLOCK_SIZE);
-		compressor_read(&limiter_r, audio_effects_left_out,
-				audio_effects_left_out, AUDIO_BLOCK_SIZE);
+}
 
-		// Apply stereo reverb effect
-		reverb_read(&reverb_stereo, audio_effects_left_in,
-				audio_effects_left_out, audio_effects_right_out,
-				AUDIO_BLOCK_SIZE);
+/**
+ * @brief  Called from the background loop on SHARC core 2.  Sets up the
+ * effects core 1 is about to move to this core.
+ */
+void audio_effects_background_core2(void) {
 
+	uint32_t split_requested = multicore_data->pipeline_split_requested;
+	if (split_requested != multicore_data->pipeline_split_prepared) {
+		pipeline_scheduler_prepare(&effects_pipeline,
+				multicore_data->pipeline_split, split_requested);
+		multicore_data->pipeline_split_prepared = split_requested;
 	}
-
 }
@@ -17,18 +17,32 @@
 #include "audio_processing/audio_elements/allpass_filter.h"
 #include "audio_processing/audio_elements/amplitude_modulation.h"
 #include "audio_processing/audio_elements/biquad_filter.h"
+#include "audio_processing/audio_elements/biquad_cascade.h"
 #include "audio_processing/audio_elements/clickless_volume_ctrl.h"
 #include "audio_processing/audio_elements/compressor.h"
+#include "audio_processing/audio_elements/compressor_linked.h"
+#include "audio_processing/audio_elements/control_parameter.h"
+#include "audio_processing/audio_elements/convolver.h"
 #include "audio_processing/audio_elements/integer_delay_lpf.h"
 #include "audio_processing/audio_elements/integer_delay_multitap.h"
+#include "audio_processing/audio_elements/midi_parser.h"
 #include "audio_processing/audio_elements/oscillators.h"
+#include "audio_processing/audio_elements/poly_synth.h"
 #include "audio_processing/audio_elements/simple_synth.h"
 #include "audio_processing/audio_elements/variable_delay.h"
 #include "audio_processing/audio_elements/zero_crossing_detector.h"
 
+// Effect graph and preset manager used to chain the effects on core 1
+#include "audio_processing/effect_graph.h"
+#include "audio_processing/preset_manager.h"
+
+// Pipeline scheduler used to split the effects between the two cores
+#include "audio_processing/pipeline_scheduler.h"
+
 // Audio effects
 #include "audio_processing/audio_effects/effect_autowah.h"
 #include "audio_processing/audio_effects/effect_stereo_reverb.h"
+#include "audio_processing/audio_effects/effect_fdn_reverb.h"
 #include "audio_processing/audio_effects/effect_stereo_flanger.h"
 #include "audio_processing/audio_effects/effect_tube_distortion.h"
 #include "audio_processing/audio_effects/effect_guitar_synth.h"
@@ -37,22 +51,30 @@
 #include "audio_processing/audio_effects/effect_ring_modulator.h"
 
 // Audio buffers to pass audio to and from the effects
-extern float audio_effects_left_in[];
-extern float audio_effects_right_in[];
+extern float * audio_effects_left_in;
+extern float * audio_effects_right_in;
 
-extern float audio_effects_left_out[];
-extern float audio_effects_right_out[];
+extern float * audio_effects_left_out;
+extern float * audio_effects_right_out;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+void audio_effects_set_buffers(float * left_in, float * right_in,
+		float * left_out, float * right_out);
+
 void audio_effects_setup_core1();
 void audio_effects_setup_core2();
 
 void audio_effects_process_audio_core1();
 void audio_effects_process_audio_core2();
 
+void audio_effects_background_core1();
+void audio_effects_background_core2();
+
+void audio_effects_midi_message_core1(MIDI_MESSAGE * message);
+
 #ifdef __cplusplus
 }
 #endif
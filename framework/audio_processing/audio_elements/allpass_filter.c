@@ -13,6 +13,7 @@
 
 #include <stdlib.h>
 #include "allpass_filter.h"
+#include "circular_buffer.h"
 
 /**
  * @brief Initializes instance of an all-pass filter
@@ -35,13 +36,14 @@ RESULT_ALLPASS_FILTER allpass_setup(ALLPASS_FILTER * c, float * delay_buffer,
 	c->initialized = false;
 
 	// If a buffer has been provided, use that
-	if (delay_buffer == NULL) {
+	if (delay_buffer == NULL || delay_buffer_size == 0) {
 		return ALLPASS_INVALID_DELAY_POINTER;
 	}
 
 	// Set delay line
 	c->delay_line = delay_buffer;
 	c->delay_line_size = delay_buffer_size;
+	c->length = delay_buffer_size;
 	c->index = 0;
 
 	// Set gain parameter
@@ -78,18 +80,32 @@ void allpass_read(ALLPASS_FILTER * c, float * audio_in, float * audio_out,
 	}
 
 	float * buffer = c->delay_line;
-	int indx = c->index;
-	int len = c->length;
+	uint32_t indx = c->index;
+	uint32_t len = c->length;
 	float gain = c->gain;
-	float out, in;
-
-	for (int i = 0; i < audio_block_size; i++) {
-		out = -audio_in[i] * gain + buffer[indx];
-		buffer[indx] = audio_in[i] + (buffer[indx] * gain);
-		audio_out[i] = out;
-		indx++;
-		if (indx >= len)
+
+	// Every sample of the delay line is read and then overwritten in place,
+	// so the block is processed in (at most) two contiguous spans
+	int i = 0;
+	while (i < audio_block_size) {
+
+		uint32_t span = circular_buffer_span(indx, audio_block_size - i, len);
+		float * d = &buffer[indx];
+		float * x = &audio_in[i];
+		float * y = &audio_out[i];
+
+		for (int k = 0; k < span; k++) {
+			float delayed = d[k];
+			float in = x[k];
+			d[k] = in + (delayed * gain);
+			y[k] = -in * gain + delayed;
+		}
+
+		i += span;
+		indx += span;
+		if (indx >= len) {
 			indx = 0;
+		}
 	}
 
 	c->index = indx;
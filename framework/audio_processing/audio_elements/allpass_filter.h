@@ -26,7 +26,7 @@ typedef struct {
 	float * delay_line;
 	uint32_t delay_line_size;
 	uint32_t index;
-	int length;
+	uint32_t length;
 	float gain;
 } ALLPASS_FILTER;
 
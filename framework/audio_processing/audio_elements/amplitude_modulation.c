@@ -18,6 +18,7 @@
 #include <stdlib.h>
 
 #include "amplitude_modulation.h"
+#include "fast_math.h"
 #include "oscillators.h"
 
 // Min/max limits and other constants
@@ -158,54 +159,35 @@ void amplitude_modulation_read(AMPLITUDE_MODULATION * c, float * audio_in,
 		return;
 	}
 
-	float t = c->t;
-	float inc = c->inc;
 	float depth = c->mod_depth;
-	float trem_factor;
+	float lfo[MAX_AUDIO_BLOCK_SIZE];
+	float * mod = lfo;
 
 	switch (c->type) {
 	case AMP_MOD_SIN:
-		for (int i = 0; i < audio_block_size; i++) {
-			trem_factor = 1.0
-					- (depth * (0.5 * oscillator_sine(t += inc) + 0.5));
-			audio_out[i] = audio_in[i] * trem_factor;
-		}
+		oscillator_lfo_block(OSC_SINE, &c->t, c->inc, lfo, audio_block_size);
 		break;
-
 	case AMP_MOD_TRI:
-		for (int i = 0; i < audio_block_size; i++) {
-			trem_factor = 1.0
-					- (depth * (0.5 * oscillator_triangle(t += inc) + 0.5));
-			audio_out[i] = audio_in[i] * trem_factor;
-		}
+		oscillator_lfo_block(OSC_TRIANGLE, &c->t, c->inc, lfo,
+				audio_block_size);
 		break;
-
 	case AMP_MOD_SQR:
-		for (int i = 0; i < audio_block_size; i++) {
-			trem_factor = 1.0
-					- (depth * (0.5 * oscillator_square(t += inc) + 0.5));
-			audio_out[i] = audio_in[i] * trem_factor;
-		}
+		oscillator_lfo_block(OSC_SQUARE, &c->t, c->inc, lfo, audio_block_size);
 		break;
-
 	case AMP_MOD_RAMP:
-		for (int i = 0; i < audio_block_size; i++) {
-			trem_factor = 1.0
-					- (depth * (0.5 * oscillator_ramp(t += inc) + 0.5));
-			audio_out[i] = audio_in[i] * trem_factor;
-		}
+		oscillator_lfo_block(OSC_RAMP, &c->t, c->inc, lfo, audio_block_size);
 		break;
-
 	case AMP_MOD_EXT_LFO:
-		for (int i = 0; i < audio_block_size; i++) {
-			trem_factor = 1.0 - (depth * (0.5 * ext_mod[i] + 0.5));
-			audio_out[i] = audio_in[i] * trem_factor;
-		}
+	default:
+		mod = ext_mod;
 		break;
-
 	}
 
-	// Store updated and wrapped t value
-	c->t = t - floor(t);
+	// 1.0 - depth * (0.5 * mod + 0.5)
+	float scale = -0.5 * depth;
+	float offset = 1.0 - 0.5 * depth;
+	for (int i = 0; i < audio_block_size; i++) {
+		audio_out[i] = audio_in[i] * (offset + scale * mod[i]);
+	}
 
 }
@@ -7,6 +7,7 @@
 #ifndef _AMPLITUDE_MODULATION_H
 #define _AMPLITUDE_MODULATION_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "audio_elements_common.h"
 
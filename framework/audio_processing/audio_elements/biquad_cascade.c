@@ -0,0 +1,359 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This audio element implements a cascade of biquad filters (a "second-order
+ * section bank").  Up to BIQUAD_CASCADE_MAX_SECTIONS sections are kept in a
+ * single coefficient array and a single interleaved state array and the whole
+ * cascade is run in one pass over the audio block: every sample is pushed
+ * through all sections before moving on to the next sample, so the state of
+ * each section stays in registers and the block is only read and written once.
+ *
+ * Unlike the BIQUAD_FILTER element, which uses the CCES iir() routine and then
+ * needs a second pass to apply the b0 scaling factor, each section here holds
+ * b0 directly (transposed direct form II).  A 10-band parametric EQ therefore
+ * costs a single pass over memory rather than twenty.
+ *
+ * By default coefficient changes take effect on the next block.  For
+ * cascades that are swept continuously (e.g. an auto-wah), a ramp can be set
+ * with biquad_cascade_set_ramp(): the coefficients then move linearly to new
+ * values over that many samples, stepped every sample inside the filter loop,
+ * like the per-sample transition mode of BIQUAD_FILTER.
+ */
+#include "biquad_cascade.h"
+
+#include <stdlib.h>
+
+// Min/max limits and other constants
+#define BIQUAD_CASCADE_MIN_Q        (0.01)
+#define BIQUAD_CASCADE_MAX_Q        (100.0)
+#define BIQUAD_CASCADE_MIN_FREQ     (10.0)
+#define BIQUAD_CASCADE_MAX_FREQ     (20000.0)
+#define BIQUAD_CASCADE_GAIN_MIN     (-100.0)
+#define BIQUAD_CASCADE_GAIN_MAX     (100.0)
+
+// Index of each coefficient within a section
+#define SECTION_B0      (0)
+#define SECTION_B1      (1)
+#define SECTION_B2      (2)
+#define SECTION_A1      (3)
+#define SECTION_A2      (4)
+
+// Static function prototypes
+static void biquad_cascade_start_ramp(BIQUAD_CASCADE * c);
+
+/**
+ * @brief Initializes instance of a biquad cascade
+ *
+ * All sections are initialized as pass-through (b0 = 1) and should then be
+ * configured with biquad_cascade_modify_section().
+ *
+ * @param c Pointer to instance structure
+ * @param num_sections Number of second-order sections (1 - BIQUAD_CASCADE_MAX_SECTIONS)
+ * @param audio_sample_rate Sampling frequency of system
+ * @return Biquad cascade result (enumeration)
+ */
+RESULT_BIQUAD_CASCADE biquad_cascade_setup(BIQUAD_CASCADE * c,
+		uint32_t num_sections, float audio_sample_rate) {
+
+	if (c == NULL) {
+		return BIQUAD_CASCADE_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	if (num_sections < 1 || num_sections > BIQUAD_CASCADE_MAX_SECTIONS) {
+		return BIQUAD_CASCADE_INVALID_NUM_SECTIONS;
+	}
+
+	c->num_sections = num_sections;
+	c->audio_sample_rate = audio_sample_rate;
+
+	// Set every section to pass audio through unchanged
+	for (int i = 0; i < BIQUAD_CASCADE_MAX_SECTIONS; i++) {
+		float * k = &c->coeffs[i * BIQUAD_CASCADE_COEFFS_PER_SECTION];
+		k[SECTION_B0] = 1.0;
+		k[SECTION_B1] = 0.0;
+		k[SECTION_B2] = 0.0;
+		k[SECTION_A1] = 0.0;
+		k[SECTION_A2] = 0.0;
+	}
+
+	// No ramp, coefficient changes apply straight away
+	c->ramp_samples = 0;
+	c->ramp_steps = 0;
+	for (int i = 0;
+			i < BIQUAD_CASCADE_MAX_SECTIONS * BIQUAD_CASCADE_COEFFS_PER_SECTION;
+			i++) {
+		c->coeffs_dest[i] = c->coeffs[i];
+		c->coeffs_inc[i] = 0.0;
+	}
+
+	biquad_cascade_reset_state(c);
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return BIQUAD_CASCADE_OK;
+
+}
+
+/**
+ * @brief Configure one section of the cascade
+ *
+ * If an input parameter is out of bounds, it is clipped to the corresponding
+ * min/max and applied.  A flag indicating an invalid input parameter is
+ * returned but the cascade stays enabled.
+ *
+ * @param c Pointer to instance structure
+ * @param section Section index (0 - num_sections-1)
+ * @param type Type of filter (see enum in biquad_filter.h)
+ * @param freq Cutoff/center frequency of filter
+ * @param q Q factor of filter
+ * @param gain_db Gain of the filter (peaking / shelving types)
+ * @return Biquad cascade result (enumeration)
+ */
+RESULT_BIQUAD_CASCADE biquad_cascade_modify_section(BIQUAD_CASCADE * c,
+		uint32_t section, BIQUAD_FILTER_TYPE type, float freq, float q,
+		float gain_db) {
+
+	if (c == NULL) {
+		return BIQUAD_CASCADE_INVALID_INSTANCE_POINTER;
+	}
+
+	if (section >= c->num_sections) {
+		return BIQUAD_CASCADE_INVALID_SECTION;
+	}
+
+	RESULT_BIQUAD_CASCADE res = BIQUAD_CASCADE_OK;
+
+	if (freq < BIQUAD_CASCADE_MIN_FREQ) {
+		freq = BIQUAD_CASCADE_MIN_FREQ;
+		res = BIQUAD_CASCADE_INVALID_FREQ;
+	} else if (freq > BIQUAD_CASCADE_MAX_FREQ) {
+		freq = BIQUAD_CASCADE_MAX_FREQ;
+		res = BIQUAD_CASCADE_INVALID_FREQ;
+	}
+
+	if (q < BIQUAD_CASCADE_MIN_Q) {
+		q = BIQUAD_CASCADE_MIN_Q;
+		res = BIQUAD_CASCADE_INVALID_Q;
+	} else if (q > BIQUAD_CASCADE_MAX_Q) {
+		q = BIQUAD_CASCADE_MAX_Q;
+		res = BIQUAD_CASCADE_INVALID_Q;
+	}
+
+	if (gain_db < BIQUAD_CASCADE_GAIN_MIN) {
+		gain_db = BIQUAD_CASCADE_GAIN_MIN;
+		res = BIQUAD_CASCADE_INVALID_GAIN;
+	} else if (gain_db > BIQUAD_CASCADE_GAIN_MAX) {
+		gain_db = BIQUAD_CASCADE_GAIN_MAX;
+		res = BIQUAD_CASCADE_INVALID_GAIN;
+	}
+
+	float coeffs_ab[6];
+	filter_generate_coeffs(type, freq, q, gain_db, c->audio_sample_rate,
+			coeffs_ab);
+
+	biquad_cascade_modify_section_coeffs(c, section, coeffs_ab);
+
+	return res;
+}
+
+/**
+ * @brief Load one section of the cascade with raw A/B coefficients
+ *
+ * If a ramp is set, the cascade ramps to the new coefficients (along with
+ * any other sections still ramping).
+ *
+ * @param c Pointer to instance structure
+ * @param section Section index (0 - num_sections-1)
+ * @param coeffs_ab 6 coefficients b0, b1, b2, a0, a1, a2 (see BIQUAD_COEFF_*)
+ * @return Biquad cascade result (enumeration)
+ */
+RESULT_BIQUAD_CASCADE biquad_cascade_modify_section_coeffs(BIQUAD_CASCADE * c,
+		uint32_t section, float * coeffs_ab) {
+
+	if (c == NULL) {
+		return BIQUAD_CASCADE_INVALID_INSTANCE_POINTER;
+	}
+
+	if (section >= c->num_sections) {
+		return BIQUAD_CASCADE_INVALID_SECTION;
+	}
+
+	// Normalize to a0, keep b0 and negate the feedback terms so the
+	// processing loop is multiply-accumulate only
+	float a0_recip = 1.0 / coeffs_ab[BIQUAD_COEFF_A0];
+	uint32_t offset = section * BIQUAD_CASCADE_COEFFS_PER_SECTION;
+	float * k = &c->coeffs_dest[offset];
+
+	k[SECTION_B0] = coeffs_ab[BIQUAD_COEFF_B0] * a0_recip;
+	k[SECTION_B1] = coeffs_ab[BIQUAD_COEFF_B1] * a0_recip;
+	k[SECTION_B2] = coeffs_ab[BIQUAD_COEFF_B2] * a0_recip;
+	k[SECTION_A1] = -coeffs_ab[BIQUAD_COEFF_A1] * a0_recip;
+	k[SECTION_A2] = -coeffs_ab[BIQUAD_COEFF_A2] * a0_recip;
+
+	if (c->ramp_samples) {
+		biquad_cascade_start_ramp(c);
+		return BIQUAD_CASCADE_OK;
+	}
+
+	// No ramp, apply this section straight away
+	for (int i = 0; i < BIQUAD_CASCADE_COEFFS_PER_SECTION; i++) {
+		c->coeffs[offset + i] = k[i];
+		c->coeffs_inc[offset + i] = 0.0;
+	}
+
+	return BIQUAD_CASCADE_OK;
+}
+
+/**
+ * @brief Sets how many samples coefficient changes are ramped over
+ *
+ * Any ramp in progress is finished at its destination.
+ *
+ * @param c Pointer to instance structure
+ * @param ramp_samples Length of the ramp in samples (0 to apply changes on
+ *        the next block)
+ * @return Biquad cascade result (enumeration)
+ */
+RESULT_BIQUAD_CASCADE biquad_cascade_set_ramp(BIQUAD_CASCADE * c,
+		uint32_t ramp_samples) {
+
+	if (c == NULL) {
+		return BIQUAD_CASCADE_INVALID_INSTANCE_POINTER;
+	}
+
+	for (int i = 0;
+			i < BIQUAD_CASCADE_MAX_SECTIONS * BIQUAD_CASCADE_COEFFS_PER_SECTION;
+			i++) {
+		c->coeffs[i] = c->coeffs_dest[i];
+		c->coeffs_inc[i] = 0.0;
+	}
+	c->ramp_steps = 0;
+	c->ramp_samples = ramp_samples;
+
+	return BIQUAD_CASCADE_OK;
+}
+
+/**
+ * @brief Clears the state of every section
+ *
+ * @param c Pointer to instance structure
+ */
+void biquad_cascade_reset_state(BIQUAD_CASCADE * c) {
+
+	if (c == NULL) {
+		return;
+	}
+
+	for (int i = 0; i < BIQUAD_CASCADE_MAX_SECTIONS * 2; i++) {
+		c->state[i] = 0.0;
+	}
+}
+
+/**
+ * @brief Apply effect/process to a block of audio data
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point audio output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void biquad_cascade_read(BIQUAD_CASCADE * c, float * audio_in,
+		float * audio_out, uint32_t audio_block_size) {
+
+	// If this instance hasn't been properly initialized, pass audio through
+	if (c == NULL || !c->initialized) {
+		for (int i = 0; i < audio_block_size; i++) {
+			audio_out[i] = audio_in[i];
+		}
+		return;
+	}
+
+	uint32_t num_sections = c->num_sections;
+	float * state = c->state;
+
+	uint32_t ramp_len = c->ramp_steps;
+	if (ramp_len > audio_block_size) {
+		ramp_len = audio_block_size;
+	}
+
+	int i = 0;
+
+	// While a ramp is in progress, step the coefficients after every sample
+	if (ramp_len) {
+		for (; i < ramp_len; i++) {
+
+			float x = audio_in[i];
+			float * k = c->coeffs;
+			float * k_inc = c->coeffs_inc;
+			float * s = state;
+
+#pragma loop_count(1, 16, 1)
+			for (int j = 0; j < num_sections; j++) {
+				float y = k[SECTION_B0] * x + s[0];
+				s[0] = k[SECTION_B1] * x + k[SECTION_A1] * y + s[1];
+				s[1] = k[SECTION_B2] * x + k[SECTION_A2] * y;
+				x = y;
+				k[SECTION_B0] += k_inc[SECTION_B0];
+				k[SECTION_B1] += k_inc[SECTION_B1];
+				k[SECTION_B2] += k_inc[SECTION_B2];
+				k[SECTION_A1] += k_inc[SECTION_A1];
+				k[SECTION_A2] += k_inc[SECTION_A2];
+				k += BIQUAD_CASCADE_COEFFS_PER_SECTION;
+				k_inc += BIQUAD_CASCADE_COEFFS_PER_SECTION;
+				s += 2;
+			}
+
+			audio_out[i] = x;
+		}
+
+		c->ramp_steps -= ramp_len;
+
+		// Land exactly on the destination to avoid accumulated rounding
+		if (c->ramp_steps == 0) {
+			for (int j = 0;
+					j < num_sections * BIQUAD_CASCADE_COEFFS_PER_SECTION;
+					j++) {
+				c->coeffs[j] = c->coeffs_dest[j];
+			}
+		}
+	}
+
+	for (; i < audio_block_size; i++) {
+
+		float x = audio_in[i];
+		float * k = c->coeffs;
+		float * s = state;
+
+		// Transposed direct form II, one section after another
+#pragma loop_count(1, 16, 1)
+		for (int j = 0; j < num_sections; j++) {
+			float y = k[SECTION_B0] * x + s[0];
+			s[0] = k[SECTION_B1] * x + k[SECTION_A1] * y + s[1];
+			s[1] = k[SECTION_B2] * x + k[SECTION_A2] * y;
+			x = y;
+			k += BIQUAD_CASCADE_COEFFS_PER_SECTION;
+			s += 2;
+		}
+
+		audio_out[i] = x;
+	}
+}
+
+/**
+ * @brief Starts ramping every section from its current coefficients to its
+ * destination over ramp_samples
+ */
+static void biquad_cascade_start_ramp(BIQUAD_CASCADE * c) {
+
+	float factor = 1.0 / (float) c->ramp_samples;
+
+	for (int i = 0; i < c->num_sections * BIQUAD_CASCADE_COEFFS_PER_SECTION;
+			i++) {
+		c->coeffs_inc[i] = (c->coeffs_dest[i] - c->coeffs[i]) * factor;
+	}
+
+	c->ramp_steps = c->ramp_samples;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _BIQUAD_CASCADE_H
+#define _BIQUAD_CASCADE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+#include "biquad_filter.h"
+
+// Maximum number of second-order sections in a cascade
+#define BIQUAD_CASCADE_MAX_SECTIONS     (16)
+
+// Coefficients per section: b0, b1, b2, -a1, -a2 (normalized to a0)
+#define BIQUAD_CASCADE_COEFFS_PER_SECTION   (5)
+
+// Result enumerations
+typedef enum {
+	BIQUAD_CASCADE_OK,
+	BIQUAD_CASCADE_INVALID_INSTANCE_POINTER,
+	BIQUAD_CASCADE_INVALID_NUM_SECTIONS,
+	BIQUAD_CASCADE_INVALID_SECTION,
+	BIQUAD_CASCADE_INVALID_Q,
+	BIQUAD_CASCADE_INVALID_FREQ,
+	BIQUAD_CASCADE_INVALID_GAIN
+} RESULT_BIQUAD_CASCADE;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	float audio_sample_rate;
+	uint32_t num_sections;
+
+	// b0 is folded into each section so no separate scaling pass is needed
+	float coeffs[BIQUAD_CASCADE_MAX_SECTIONS
+			* BIQUAD_CASCADE_COEFFS_PER_SECTION];
+
+	// Two state variables per section, interleaved (s1, s2, s1, s2, ...)
+	float state[BIQUAD_CASCADE_MAX_SECTIONS * 2];
+
+	// Per-sample coefficient ramp (see biquad_cascade_set_ramp())
+	uint32_t ramp_samples;
+	uint32_t ramp_steps;
+	float coeffs_dest[BIQUAD_CASCADE_MAX_SECTIONS
+			* BIQUAD_CASCADE_COEFFS_PER_SECTION];
+	float coeffs_inc[BIQUAD_CASCADE_MAX_SECTIONS
+			* BIQUAD_CASCADE_COEFFS_PER_SECTION];
+
+} BIQUAD_CASCADE;
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+RESULT_BIQUAD_CASCADE biquad_cascade_setup(BIQUAD_CASCADE * c,
+		uint32_t num_sections, float audio_sample_rate);
+
+RESULT_BIQUAD_CASCADE biquad_cascade_modify_section(BIQUAD_CASCADE * c,
+		uint32_t section, BIQUAD_FILTER_TYPE type, float freq, float q,
+		float gain_db);
+
+RESULT_BIQUAD_CASCADE biquad_cascade_modify_section_coeffs(BIQUAD_CASCADE * c,
+		uint32_t section, float * coeffs_ab);
+
+RESULT_BIQUAD_CASCADE biquad_cascade_set_ramp(BIQUAD_CASCADE * c,
+		uint32_t ramp_samples);
+
+void biquad_cascade_reset_state(BIQUAD_CASCADE * c);
+
+void biquad_cascade_read(BIQUAD_CASCADE * c, float * audio_in,
+		float * audio_out, uint32_t audio_block_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _BIQUAD_CASCADE_H
@@ -23,13 +23,16 @@
 #define BIQUAD_GAIN_MIN     (-100.0)
 #define BIQUAD_GAIN_MAX     (100.0)
 
+// In per-sample transition mode, each transition step lasts this many samples
+#define BIQUAD_SAMPLES_PER_TRANSITION_STEP  (32)
+
 // Static function prototypes
-static RESULT_BIQUAD filter_generate_coeffs(BIQUAD_FILTER_TYPE filter_type,
-		float freq, float q, float gain_db, float audio_sample_rate,
-		float * result);
 static RESULT_BIQUAD convert_coeffs(float * coeffs_ab, float * sos_coeffs,
 		float * scaling_factor);
 static void filter_transition_coeffs(BIQUAD_FILTER * c);
+static void filter_start_coeff_ramp(BIQUAD_FILTER * c);
+static void filter_read_ramp(BIQUAD_FILTER * c, float * audio_in,
+		float * audio_out, uint32_t audio_block_size);
 
 /**
  * @brief Initializes instance of a biquad filter
@@ -67,8 +70,13 @@ RESULT_BIQUAD filter_setup(BIQUAD_FILTER * c, BIQUAD_FILTER_TYPE type,
 	}
 
 	// Save filter and system parameters
+	c->filter_type = type;
 	c->q = q;
+	c->q_last = q;
+	c->q_dest = q;
 	c->freq = freq;
+	c->freq_last = freq;
+	c->freq_dest = freq;
 	c->gain_db = gain_db;
 	c->audio_sample_rate = audio_sample_rate;
 
@@ -77,8 +85,9 @@ RESULT_BIQUAD filter_setup(BIQUAD_FILTER * c, BIQUAD_FILTER_TYPE type,
 
 	// Set how quickly we can transition coefficients
 	c->transition_speed = transition_speed;
+	c->transition_mode = BIQUAD_TRANSITION_PER_BLOCK;
 
-	float coeffs[6], sos[4];
+	float coeffs[6];
 
 	// Geneate A/B filter coefficients
 	filter_generate_coeffs(type, freq, q, gain_db, audio_sample_rate, coeffs);
@@ -91,7 +100,9 @@ RESULT_BIQUAD filter_setup(BIQUAD_FILTER * c, BIQUAD_FILTER_TYPE type,
 		c->sos_state[i] = 0;
 	}
 
-	// Clear filter transition counter
+	// Clear filter transition counters
+	c->freq_steps = 0;
+	c->q_steps = 0;
 	c->sos_coeffs_steps = 0;
 
 	// Instance was successfully initialized
@@ -100,6 +111,56 @@ RESULT_BIQUAD filter_setup(BIQUAD_FILTER * c, BIQUAD_FILTER_TYPE type,
 
 }
 
+/**
+ * @brief Selects how coefficients are transitioned when frequency / Q change
+ *
+ * In BIQUAD_TRANSITION_PER_BLOCK mode (the default) the coefficients are
+ * recalculated once per audio block until the new frequency / Q is reached.
+ * In BIQUAD_TRANSITION_PER_SAMPLE mode the target coefficients are calculated
+ * once when a parameter is modified and then linearly ramped every sample
+ * inside the filter loop.  This avoids trig / pow calls on the audio path and
+ * the zipper noise of block-rate steps, which suits filters that are swept
+ * continuously (e.g. auto-wah).
+ *
+ * @param c Pointer to instance structure
+ * @param mode Transition mode (see enum in .h file)
+ * @return Biquad result (enumeration)
+ */
+RESULT_BIQUAD filter_set_transition_mode(BIQUAD_FILTER * c,
+		BIQUAD_FILTER_TRANSITION_MODE mode) {
+
+	if (c == NULL) {
+		return BIQUAD_INVALID_INSTANCE_POINTER;
+	}
+
+	// Finish any transition in progress at its destination
+	if (c->freq_steps || c->q_steps) {
+		c->freq = c->freq_dest;
+		c->q = c->q_dest;
+		c->freq_steps = 0;
+		c->q_steps = 0;
+		filter_start_coeff_ramp(c);
+	}
+	if (c->sos_coeffs_steps) {
+		for (int i = 0; i < 4; i++) {
+			c->sos_coeffs[i] = c->sos_coeffs_dest[i];
+		}
+		c->scaling_factor = c->scaling_factor_dest;
+		c->sos_coeffs_steps = 0;
+	}
+
+	// The per-sample loop keeps its own state layout so start from silence
+	if (mode != c->transition_mode) {
+		for (int i = 0; i < 3; i++) {
+			c->sos_state[i] = 0;
+		}
+	}
+
+	c->transition_mode = mode;
+
+	return BIQUAD_OK;
+}
+
 /**
  * @brief Modify Q of current frequency
  *
@@ -135,10 +196,18 @@ RESULT_BIQUAD filter_modify_q(BIQUAD_FILTER * c, float new_q) {
 		c->q_last = q;
 	}
 
+	c->q_dest = q;
+
+	// In per-sample mode, calculate the target coefficients once and ramp to them
+	if (c->transition_mode == BIQUAD_TRANSITION_PER_SAMPLE) {
+		c->q = q;
+		filter_start_coeff_ramp(c);
+		return res;
+	}
+
 	// Calculate parameters
 	c->q_steps = c->transition_speed;
 	float factor = 1.0 / (float) c->transition_speed;
-	c->q_dest = q;
 	c->q_inc = (c->q_dest - c->q) * factor;
 
 	return res;
@@ -163,11 +232,11 @@ RESULT_BIQUAD filter_modify_freq(BIQUAD_FILTER * c, float freq_new) {
 	 * invalid input parameter was supplied but it won't disable the effect.
 	 */
 	if (freq_new > BIQUAD_MAX_FREQ) {
-		freq_new = BIQUAD_MAX_FREQ;
-		res = BIQUAD_INVALID_Q;
+		freq = BIQUAD_MAX_FREQ;
+		res = BIQUAD_INVALID_FREQ;
 	} else if (freq_new < BIQUAD_MIN_FREQ) {
 		freq = BIQUAD_MIN_FREQ;
-		res = BIQUAD_INVALID_Q;
+		res = BIQUAD_INVALID_FREQ;
 	} else {
 		freq = freq_new;
 		res = BIQUAD_OK;
@@ -180,10 +249,18 @@ RESULT_BIQUAD filter_modify_freq(BIQUAD_FILTER * c, float freq_new) {
 		c->freq_last = freq;
 	}
 
+	c->freq_dest = freq;
+
+	// In per-sample mode, calculate the target coefficients once and ramp to them
+	if (c->transition_mode == BIQUAD_TRANSITION_PER_SAMPLE) {
+		c->freq = freq;
+		filter_start_coeff_ramp(c);
+		return res;
+	}
+
 	// Calculate parameters
 	c->freq_steps = c->transition_speed;
 	float factor = 1.0 / (float) c->transition_speed;
-	c->freq_dest = freq;
 	c->freq_inc = (c->freq_dest - c->freq) * factor;
 
 	return res;
@@ -210,8 +287,14 @@ void filter_read(BIQUAD_FILTER * c, float * audio_in, float * audio_out,
 		return;
 	}
 
+	// Per-sample transitions use their own loop with the ramp built in
+	if (c->transition_mode == BIQUAD_TRANSITION_PER_SAMPLE) {
+		filter_read_ramp(c, audio_in, audio_out, audio_block_size);
+		return;
+	}
+
 	// If we need to transition the coefficients do so now
-	if (c->freq_steps) {
+	if (c->freq_steps || c->q_steps) {
 		filter_transition_coeffs(c);
 	}
 
@@ -224,13 +307,6 @@ void filter_read(BIQUAD_FILTER * c, float * audio_in, float * audio_out,
 	}
 }
 
-#define COEFF_B0    (0)
-#define COEFF_B1    (1)
-#define COEFF_B2    (2)
-#define COEFF_A0    (3)
-#define COEFF_A1    (4)
-#define COEFF_A2    (5)
-
 /**
  * @brief Calculates coefficients for biquad filters
  *
@@ -240,9 +316,10 @@ void filter_read(BIQUAD_FILTER * c, float * audio_in, float * audio_out,
  * @param gain_db Filter gain in dB
  * @param audio_sample_rate Sampling frequency of system
  * @param result Pointer to floating-point buffer where coefficients will be stored
+ *               (6 floats, see BIQUAD_COEFF_* indices in .h file)
  * @return Result enum - see .h file for details
  */
-static RESULT_BIQUAD filter_generate_coeffs(BIQUAD_FILTER_TYPE filter_type,
+RESULT_BIQUAD filter_generate_coeffs(BIQUAD_FILTER_TYPE filter_type,
 		float freq, float q, float gain_db, float audio_sample_rate,
 		float * result) {
 
@@ -257,39 +334,39 @@ static RESULT_BIQUAD filter_generate_coeffs(BIQUAD_FILTER_TYPE filter_type,
 		switch (filter_type) {
 
 		case BIQUAD_TYPE_LPF:
-			result[COEFF_B0] = (1.0 - c_omega) * 0.5;
-			result[COEFF_B1] = (1.0 - c_omega);
-			result[COEFF_B2] = result[COEFF_B0];
-			result[COEFF_A0] = (1.0 + alpha);
-			result[COEFF_A1] = ncos2;
-			result[COEFF_A2] = (1.0 - alpha);
+			result[BIQUAD_COEFF_B0] = (1.0 - c_omega) * 0.5;
+			result[BIQUAD_COEFF_B1] = (1.0 - c_omega);
+			result[BIQUAD_COEFF_B2] = result[BIQUAD_COEFF_B0];
+			result[BIQUAD_COEFF_A0] = (1.0 + alpha);
+			result[BIQUAD_COEFF_A1] = ncos2;
+			result[BIQUAD_COEFF_A2] = (1.0 - alpha);
 			break;
 
 		case BIQUAD_TYPE_HPF:
-			result[COEFF_B0] = (1.0 + c_omega) * 0.5;
-			result[COEFF_B1] = -(1.0 + c_omega);
-			result[COEFF_B2] = result[COEFF_B0];
-			result[COEFF_A0] = (1.0 + alpha);
-			result[COEFF_A1] = ncos2;
-			result[COEFF_A2] = (1.0 - alpha);
+			result[BIQUAD_COEFF_B0] = (1.0 + c_omega) * 0.5;
+			result[BIQUAD_COEFF_B1] = -(1.0 + c_omega);
+			result[BIQUAD_COEFF_B2] = result[BIQUAD_COEFF_B0];
+			result[BIQUAD_COEFF_A0] = (1.0 + alpha);
+			result[BIQUAD_COEFF_A1] = ncos2;
+			result[BIQUAD_COEFF_A2] = (1.0 - alpha);
 			break;
 
 		case BIQUAD_TYPE_BPF:
-			result[COEFF_B0] = (alpha);
-			result[COEFF_B1] = 0;
-			result[COEFF_B2] = (-result[COEFF_B0]);
-			result[COEFF_A0] = (1.0 + alpha);
-			result[COEFF_A1] = ncos2;
-			result[COEFF_A2] = (1.0 - alpha);
+			result[BIQUAD_COEFF_B0] = (alpha);
+			result[BIQUAD_COEFF_B1] = 0;
+			result[BIQUAD_COEFF_B2] = (-result[BIQUAD_COEFF_B0]);
+			result[BIQUAD_COEFF_A0] = (1.0 + alpha);
+			result[BIQUAD_COEFF_A1] = ncos2;
+			result[BIQUAD_COEFF_A2] = (1.0 - alpha);
 			break;
 
 		case BIQUAD_TYPE_NOTCH:
-			result[COEFF_B0] = (1.0);
-			result[COEFF_B1] = -2.0 * c_omega;
-			result[COEFF_B2] = (1.0);
-			result[COEFF_A0] = (1.0 + alpha);
-			result[COEFF_A1] = ncos2;
-			result[COEFF_A2] = (1.0 - alpha);
+			result[BIQUAD_COEFF_B0] = (1.0);
+			result[BIQUAD_COEFF_B1] = -2.0 * c_omega;
+			result[BIQUAD_COEFF_B2] = (1.0);
+			result[BIQUAD_COEFF_A0] = (1.0 + alpha);
+			result[BIQUAD_COEFF_A1] = ncos2;
+			result[BIQUAD_COEFF_A2] = (1.0 - alpha);
 			break;
 		}
 	} else {
@@ -299,34 +376,34 @@ static RESULT_BIQUAD filter_generate_coeffs(BIQUAD_FILTER_TYPE filter_type,
 
 		switch (filter_type) {
 		case BIQUAD_TYPE_PEAKING:
-			result[COEFF_B0] = 1.0 + alpha * A;
-			result[COEFF_B1] = ncos2;
-			result[COEFF_B2] = 1.0 - alpha * A;
-			result[COEFF_A0] = 1.0 + alpha / A;
-			result[COEFF_A1] = ncos2;
-			result[COEFF_A2] = 1.0 - alpha / A;
+			result[BIQUAD_COEFF_B0] = 1.0 + alpha * A;
+			result[BIQUAD_COEFF_B1] = ncos2;
+			result[BIQUAD_COEFF_B2] = 1.0 - alpha * A;
+			result[BIQUAD_COEFF_A0] = 1.0 + alpha / A;
+			result[BIQUAD_COEFF_A1] = ncos2;
+			result[BIQUAD_COEFF_A2] = 1.0 - alpha / A;
 			break;
 
 		case BIQUAD_TYPE_L_SHELF:
-			result[COEFF_B0] = A
+			result[BIQUAD_COEFF_B0] = A
 					* ((A + 1) - (A - 1) * c_omega + sqrt_a_2 * alpha);
-			result[COEFF_B1] = 2.0 * A * ((A - 1) - (A + 1) * c_omega);
-			result[COEFF_B2] = A
+			result[BIQUAD_COEFF_B1] = 2.0 * A * ((A - 1) - (A + 1) * c_omega);
+			result[BIQUAD_COEFF_B2] = A
 					* ((A + 1) - (A - 1) * c_omega - sqrt_a_2 * alpha);
-			result[COEFF_A0] = ((A + 1) + (A - 1) * c_omega + sqrt_a_2 * alpha);
-			result[COEFF_A1] = -2.0 * ((A - 1) + (A + 1) * c_omega);
-			result[COEFF_A2] = ((A + 1) + (A - 1) * c_omega - sqrt_a_2 * alpha);
+			result[BIQUAD_COEFF_A0] = ((A + 1) + (A - 1) * c_omega + sqrt_a_2 * alpha);
+			result[BIQUAD_COEFF_A1] = -2.0 * ((A - 1) + (A + 1) * c_omega);
+			result[BIQUAD_COEFF_A2] = ((A + 1) + (A - 1) * c_omega - sqrt_a_2 * alpha);
 			break;
 
 		case BIQUAD_TYPE_H_SHELF:
-			result[COEFF_B0] = A
+			result[BIQUAD_COEFF_B0] = A
 					* ((A + 1) + (A - 1) * c_omega + sqrt_a_2 * alpha);
-			result[COEFF_B1] = 2.0 * A * ((A - 1) + (A + 1) * c_omega);
-			result[COEFF_B2] = A
+			result[BIQUAD_COEFF_B1] = 2.0 * A * ((A - 1) + (A + 1) * c_omega);
+			result[BIQUAD_COEFF_B2] = A
 					* ((A + 1) + (A - 1) * c_omega - sqrt_a_2 * alpha);
-			result[COEFF_A0] = ((A + 1) - (A - 1) * c_omega + sqrt_a_2 * alpha);
-			result[COEFF_A1] = -2.0 * ((A - 1) - (A + 1) * c_omega);
-			result[COEFF_A2] = ((A + 1) - (A - 1) * c_omega - sqrt_a_2 * alpha);
+			result[BIQUAD_COEFF_A0] = ((A + 1) - (A - 1) * c_omega + sqrt_a_2 * alpha);
+			result[BIQUAD_COEFF_A1] = -2.0 * ((A - 1) - (A + 1) * c_omega);
+			result[BIQUAD_COEFF_A2] = ((A + 1) - (A - 1) * c_omega - sqrt_a_2 * alpha);
 			break;
 
 		}
@@ -348,18 +425,18 @@ static RESULT_BIQUAD filter_generate_coeffs(BIQUAD_FILTER_TYPE filter_type,
 static RESULT_BIQUAD convert_coeffs(float * coeffs_ab, float * sos_coeffs,
 		float * scaling_factor) {
 
-	coeffs_ab[COEFF_B1] = coeffs_ab[COEFF_B1] / coeffs_ab[COEFF_B0];
-	coeffs_ab[COEFF_B2] = coeffs_ab[COEFF_B2] / coeffs_ab[COEFF_B0];
+	coeffs_ab[BIQUAD_COEFF_B1] = coeffs_ab[BIQUAD_COEFF_B1] / coeffs_ab[BIQUAD_COEFF_B0];
+	coeffs_ab[BIQUAD_COEFF_B2] = coeffs_ab[BIQUAD_COEFF_B2] / coeffs_ab[BIQUAD_COEFF_B0];
 
-	coeffs_ab[COEFF_A1] = -coeffs_ab[COEFF_A1] / coeffs_ab[COEFF_A0];
-	coeffs_ab[COEFF_A2] = -coeffs_ab[COEFF_A2] / coeffs_ab[COEFF_A0];
+	coeffs_ab[BIQUAD_COEFF_A1] = -coeffs_ab[BIQUAD_COEFF_A1] / coeffs_ab[BIQUAD_COEFF_A0];
+	coeffs_ab[BIQUAD_COEFF_A2] = -coeffs_ab[BIQUAD_COEFF_A2] / coeffs_ab[BIQUAD_COEFF_A0];
 
-	sos_coeffs[0] = coeffs_ab[COEFF_A2];
-	sos_coeffs[1] = coeffs_ab[COEFF_A1];
-	sos_coeffs[2] = coeffs_ab[COEFF_B2];
-	sos_coeffs[3] = coeffs_ab[COEFF_B1];
+	sos_coeffs[0] = coeffs_ab[BIQUAD_COEFF_A2];
+	sos_coeffs[1] = coeffs_ab[BIQUAD_COEFF_A1];
+	sos_coeffs[2] = coeffs_ab[BIQUAD_COEFF_B2];
+	sos_coeffs[3] = coeffs_ab[BIQUAD_COEFF_B1];
 
-	(*scaling_factor) = coeffs_ab[COEFF_B0];
+	(*scaling_factor) = coeffs_ab[BIQUAD_COEFF_B0];
 
 	return BIQUAD_OK;
 
@@ -411,3 +488,120 @@ void filter_transition_coeffs(BIQUAD_FILTER * c) {
 	}
 }
 
+
+/**
+ * @brief Calculates target coefficients and per-sample increments
+ *
+ * Used in per-sample transition mode.  The coefficients for the current
+ * frequency / Q are generated once and the ramp from the coefficients in use
+ * is spread over transition_speed * BIQUAD_SAMPLES_PER_TRANSITION_STEP
+ * samples.  Linear interpolation of a1 / a2 keeps the poles inside the
+ * (convex) stability triangle of a second-order section.
+ *
+ * @param c Pointer to instance structure
+ */
+static void filter_start_coeff_ramp(BIQUAD_FILTER * c) {
+
+	float coeffs_ab[6];
+
+	// Generate A/B filter coefficients for the new parameters
+	filter_generate_coeffs(c->filter_type, c->freq, c->q, c->gain_db,
+			c->audio_sample_rate, coeffs_ab);
+
+	// Convert them into SOS notation as the destination of the ramp
+	convert_coeffs(coeffs_ab, c->sos_coeffs_dest, &c->scaling_factor_dest);
+
+	uint32_t steps = (uint32_t) c->transition_speed
+			* BIQUAD_SAMPLES_PER_TRANSITION_STEP;
+	float factor = 1.0 / (float) steps;
+
+	for (int i = 0; i < 4; i++) {
+		c->sos_coeffs_inc[i] = (c->sos_coeffs_dest[i] - c->sos_coeffs[i])
+				* factor;
+	}
+	c->scaling_factor_inc = (c->scaling_factor_dest - c->scaling_factor)
+			* factor;
+
+	c->sos_coeffs_steps = steps;
+}
+
+/**
+ * @brief Filter loop for per-sample transition mode
+ *
+ * Direct form II with the same coefficient layout as the CCES iir() routine
+ * (a2, a1, b2, b1) and the b0 scaling applied in the same pass.  While a
+ * transition is in progress, the coefficients are stepped every sample.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point audio output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+static void filter_read_ramp(BIQUAD_FILTER * c, float * audio_in,
+		float * audio_out, uint32_t audio_block_size) {
+
+	// Bring coefficients and state into local variables
+	float a2 = c->sos_coeffs[0];
+	float a1 = c->sos_coeffs[1];
+	float b2 = c->sos_coeffs[2];
+	float b1 = c->sos_coeffs[3];
+	float b0 = c->scaling_factor;
+	float w1 = c->sos_state[0];
+	float w2 = c->sos_state[1];
+
+	uint32_t ramp_len = c->sos_coeffs_steps;
+	if (ramp_len > audio_block_size) {
+		ramp_len = audio_block_size;
+	}
+
+	int i = 0;
+
+	if (ramp_len) {
+		float a2_inc = c->sos_coeffs_inc[0];
+		float a1_inc = c->sos_coeffs_inc[1];
+		float b2_inc = c->sos_coeffs_inc[2];
+		float b1_inc = c->sos_coeffs_inc[3];
+		float b0_inc = c->scaling_factor_inc;
+
+		for (; i < ramp_len; i++) {
+			float w0 = audio_in[i] + a1 * w1 + a2 * w2;
+			audio_out[i] = b0 * (w0 + b1 * w1 + b2 * w2);
+			w2 = w1;
+			w1 = w0;
+
+			a2 += a2_inc;
+			a1 += a1_inc;
+			b2 += b2_inc;
+			b1 += b1_inc;
+			b0 += b0_inc;
+		}
+
+		c->sos_coeffs_steps -= ramp_len;
+
+		// Land exactly on the destination to avoid accumulated rounding
+		if (c->sos_coeffs_steps == 0) {
+			a2 = c->sos_coeffs_dest[0];
+			a1 = c->sos_coeffs_dest[1];
+			b2 = c->sos_coeffs_dest[2];
+			b1 = c->sos_coeffs_dest[3];
+			b0 = c->scaling_factor_dest;
+		}
+	}
+
+	for (; i < audio_block_size; i++) {
+		float w0 = audio_in[i] + a1 * w1 + a2 * w2;
+		audio_out[i] = b0 * (w0 + b1 * w1 + b2 * w2);
+		w2 = w1;
+		w1 = w0;
+	}
+
+	// Store coefficients and state back into struct
+	c->sos_coeffs[0] = a2;
+	c->sos_coeffs[1] = a1;
+	c->sos_coeffs[2] = b2;
+	c->sos_coeffs[3] = b1;
+	c->scaling_factor = b0;
+	c->sos_state[0] = w1;
+	c->sos_state[1] = w2;
+}
@@ -33,6 +33,20 @@ typedef enum {
 	BIQUAD_TRANS_VERY_SLOW = (30)
 } BIQUAD_FILTER_TRANSITION_SPEED;
 
+// How coefficient transitions are applied when frequency / Q are modified
+typedef enum {
+	BIQUAD_TRANSITION_PER_BLOCK,	// recompute coefficients once per block
+	BIQUAD_TRANSITION_PER_SAMPLE	// compute target once, ramp every sample
+} BIQUAD_FILTER_TRANSITION_MODE;
+
+// Index of each coefficient in the array built by filter_generate_coeffs()
+#define BIQUAD_COEFF_B0    (0)
+#define BIQUAD_COEFF_B1    (1)
+#define BIQUAD_COEFF_B2    (2)
+#define BIQUAD_COEFF_A0    (3)
+#define BIQUAD_COEFF_A1    (4)
+#define BIQUAD_COEFF_A2    (5)
+
 // Result enumerations
 typedef enum {
 	BIQUAD_OK,
@@ -49,6 +63,7 @@ typedef struct {
 
 	BIQUAD_FILTER_TYPE filter_type;
 	BIQUAD_FILTER_TRANSITION_SPEED transition_speed;
+	BIQUAD_FILTER_TRANSITION_MODE transition_mode;
 
 	float audio_sample_rate;
 
@@ -74,7 +89,7 @@ typedef struct {
 	float sos_state[3];
 	float sos_coeffs_dest[4];
 	float sos_coeffs_inc[4];
-	uint32_t sos_coeffs_steps;
+	uint32_t sos_coeffs_steps;	// remaining samples in per-sample transition
 
 } BIQUAD_FILTER;
 
@@ -86,10 +101,17 @@ RESULT_BIQUAD filter_setup(BIQUAD_FILTER * c, BIQUAD_FILTER_TYPE type,
 		BIQUAD_FILTER_TRANSITION_SPEED transition_speed, float pm * sos_coeffs,
 		float freq, float q, float gain_db, float audio_sample_rate);
 
+RESULT_BIQUAD filter_set_transition_mode(BIQUAD_FILTER * c,
+		BIQUAD_FILTER_TRANSITION_MODE mode);
+
 RESULT_BIQUAD filter_modify_q(BIQUAD_FILTER * c, float new_q);
 
 RESULT_BIQUAD filter_modify_freq(BIQUAD_FILTER * c, float new_freq);
 
+RESULT_BIQUAD filter_generate_coeffs(BIQUAD_FILTER_TYPE filter_type,
+		float freq, float q, float gain_db, float audio_sample_rate,
+		float * result);
+
 void filter_read(BIQUAD_FILTER * c, float * audio_in, float * audio_out,
 		uint32_t audio_block_size);
 
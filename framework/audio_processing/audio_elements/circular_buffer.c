@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Block access to circular buffers (delay lines).
+ *
+ * Processing a delay line one sample at a time means wrapping the read and
+ * write indices with a compare and branch on every sample, which stops the
+ * compiler from pipelining or vectorizing the loop.  As long as a block is
+ * no longer than the buffer, a block of samples starting at any index
+ * occupies at most two contiguous spans: one up to the end of the buffer and
+ * one from the start.  The functions below split each access into those
+ * spans so the inner loops are simple array loops.
+ *
+ * Delay elements use these to copy the delayed samples into a scratch buffer
+ * on the stack, do their math on the whole block and copy the result back.
+ * This only works when the delay is at least one block long (otherwise
+ * samples written in this block would be read back in the same block), so
+ * the elements keep a per-sample path for very short delays.
+ *
+ * The count passed to these functions must not exceed the buffer length.
+ */
+#include "circular_buffer.h"
+
+/**
+ * @brief Copies count samples out of a circular buffer
+ *
+ * @param buffer Pointer to the circular buffer
+ * @param length Length of the circular buffer
+ * @param index Index of the first sample to read (0 - length-1)
+ * @param dest Pointer to destination buffer
+ * @param count Number of samples to copy (<= length)
+ */
+#pragma optimize_for_speed
+void circular_buffer_read(float * buffer, uint32_t length, uint32_t index,
+		float * dest, uint32_t count) {
+
+	uint32_t span = circular_buffer_span(index, count, length);
+	float * src = &buffer[index];
+
+	for (int i = 0; i < span; i++) {
+		dest[i] = src[i];
+	}
+	for (int i = span; i < count; i++) {
+		dest[i] = buffer[i - span];
+	}
+}
+
+/**
+ * @brief Copies count samples into a circular buffer
+ *
+ * @param buffer Pointer to the circular buffer
+ * @param length Length of the circular buffer
+ * @param index Index of the first sample to write (0 - length-1)
+ * @param src Pointer to source buffer
+ * @param count Number of samples to copy (<= length)
+ */
+#pragma optimize_for_speed
+void circular_buffer_write(float * buffer, uint32_t length, uint32_t index,
+		float * src, uint32_t count) {
+
+	uint32_t span = circular_buffer_span(index, count, length);
+	float * dest = &buffer[index];
+
+	for (int i = 0; i < span; i++) {
+		dest[i] = src[i];
+	}
+	for (int i = span; i < count; i++) {
+		buffer[i - span] = src[i];
+	}
+}
+
+/**
+ * @brief Scales count samples from a circular buffer and adds them to dest
+ *
+ * This is the inner loop of a multitap delay (one call per tap).
+ *
+ * @param buffer Pointer to the circular buffer
+ * @param length Length of the circular buffer
+ * @param index Index of the first sample to read (0 - length-1)
+ * @param gain Gain applied to the samples read
+ * @param dest Pointer to accumulation buffer
+ * @param count Number of samples to process (<= length)
+ */
+#pragma optimize_for_speed
+void circular_buffer_read_mac(float * buffer, uint32_t length, uint32_t index,
+		float gain, float * dest, uint32_t count) {
+
+	uint32_t span = circular_buffer_span(index, count, length);
+	float * src = &buffer[index];
+
+	for (int i = 0; i < span; i++) {
+		dest[i] += src[i] * gain;
+	}
+	for (int i = span; i < count; i++) {
+		dest[i] += buffer[i - span] * gain;
+	}
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _CIRCULAR_BUFFER_H
+#define _CIRCULAR_BUFFER_H
+
+#include <stdint.h>
+
+#include "audio_elements_common.h"
+
+/**
+ * @brief Wraps an index that is at most one buffer length out of range
+ *
+ * @param index Index (-length < index < 2 * length)
+ * @param length Length of the circular buffer
+ * @return Index in the range 0 - length-1
+ */
+static inline uint32_t circular_buffer_wrap(int32_t index, uint32_t length) {
+	if (index < 0) {
+		index += length;
+	} else if (index >= (int32_t) length) {
+		index -= length;
+	}
+	return (uint32_t) index;
+}
+
+/**
+ * @brief Number of samples that can be accessed from index before the end of
+ * the buffer, limited to count
+ *
+ * @param index Starting index (0 - length-1)
+ * @param count Number of samples wanted
+ * @param length Length of the circular buffer
+ * @return Length of the first contiguous span
+ */
+static inline uint32_t circular_buffer_span(uint32_t index, uint32_t count,
+		uint32_t length) {
+	uint32_t span = length - index;
+	return (span < count) ? span : count;
+}
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void circular_buffer_read(float * buffer, uint32_t length, uint32_t index,
+		float * dest, uint32_t count);
+
+void circular_buffer_write(float * buffer, uint32_t length, uint32_t index,
+		float * src, uint32_t count);
+
+void circular_buffer_read_mac(float * buffer, uint32_t length, uint32_t index,
+		float gain, float * dest, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _CIRCULAR_BUFFER_H
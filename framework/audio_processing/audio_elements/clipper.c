@@ -6,27 +6,27 @@
  *
  * This implementation includes an optional upsampling / downsampling component that
  * can be used to eliminate the audio artifacts that can occur with clipping using
- * polynomial expansion.
+ * polynomial expansion.  The clipping polynomial is run inside an oversampler
+ * (see oversampler.c) at CLIPPER_OVERSAMPLE_FACTOR times the sample rate.
  *
  */
 
 #include <math.h>
-#include <filter.h>
 #include <stdlib.h>
 
 #include "audio_utilities.h"
 #include "clipper.h"
 
 // Min/max limits and other constants
-#define CLIPPER_INTERP_FACTOR       (8)
+#define CLIPPER_OVERSAMPLE_FACTOR   (8)
 #define CLIPPER_MAX_THRESHOLD       (1.0)
 #define CLIPPER_MIN_THRESHOLD       (0.001)
 
 // Static function prototypes
-static void upsample_signal(CLIPPER * c, float * audio_in, float * audio_out,
+static void clipper_apply(CLIPPER * c, float * input, float * output,
 		uint32_t audio_block_size);
 
-static void downsample_signal(CLIPPER * c, float * audio_in, float * audio_out,
+static void clipper_apply_oversampled(void * context, float * audio,
 		uint32_t audio_block_size);
 
 static void polynomial_smoothstep(float clip_value, float * input,
@@ -57,13 +57,13 @@ RESULT_CLIPPER clipper_setup(CLIPPER *c, float threshold,
 		return CLIPPER_INVALID_THRESHOLD;
 	}
 
-	for (int i = 0; i < CLIPPER_INTERP_TAPS + 1; i++) {
-		c->fir_upsample_state[i] = 0.0;
-		c->fir_downsample_state[i] = 0.0;
+	if (upsample) {
+		oversampler_setup(&c->oversampler, CLIPPER_OVERSAMPLE_FACTOR);
 	}
 
 	// Set parameters
 	c->clip_threshold = threshold;
+	c->poly_clip = poly_clip;
 	c->upsample = upsample;
 
 	// Instance was successfully initialized
@@ -110,10 +110,6 @@ RESULT_CLIPPER modify_clipper_threshold(CLIPPER *c, float threshold_new) {
 /**
  * @brief Apply effect/process to a block of audio data
  *
- * If the input parameter is out of bounds, clip it to the corresponding min/max
- * and apply that value.  This function will return a flag indicating an
- * invalid input parameter was supplied but it won't disable the effect.
- *
  * @param c Pointer to instance structure
  * @param audio_in Pointer to floating point audio input buffer (mono)
  * @param audio_out Pointer to floating point audio output buffer (mono)
@@ -130,102 +126,53 @@ void clipper_read(CLIPPER *c, float * audio_in, float * audio_out,
 		return;
 	}
 
-	float clipper_read_temp[MAX_AUDIO_BLOCK_SIZE * CLIPPER_INTERP_FACTOR];
-	int buffer_size_multipler = 1;
-
 	if (c->upsample) {
-		upsample_signal(c, audio_in, clipper_read_temp, audio_block_size);
-		buffer_size_multipler = CLIPPER_INTERP_FACTOR;
+		oversampler_read(&c->oversampler, audio_in, audio_out,
+				audio_block_size, clipper_apply_oversampled, c);
 	} else {
-		copy_buffer(audio_in, clipper_read_temp, audio_block_size);
-	}
-
-	// Apply polynomial
-	switch (c->poly_clip) {
-	case POLY_SMOOTHSTEP:
-		polynomial_smoothstep(c->clip_threshold, clipper_read_temp,
-				clipper_read_temp, audio_block_size * buffer_size_multipler);
-		break;
-
-	case POLY_SMOOTHERSTEP:
-		polynomial_smootherstep(c->clip_threshold, clipper_read_temp,
-				clipper_read_temp, audio_block_size * buffer_size_multipler);
-		break;
-	default:
-		break;
-	}
-
-	if (c->upsample) {
-		downsample_signal(c, clipper_read_temp, audio_out, audio_block_size);
-	} else {
-		copy_buffer(clipper_read_temp, audio_out, audio_block_size);
+		clipper_apply(c, audio_in, audio_out, audio_block_size);
 	}
 
 }
 
-// Coefficients used for upsampling/downsampling
-float pm fir_resample_x_8[CLIPPER_INTERP_TAPS] = { -3.88257917522e-19,
-		-0.000718555656558, -0.00184171525988, -0.0035491808885,
-		-0.00567312990492, -0.00757389494893, -0.00815933632458,
-		-0.00606971771843, 2.62074094328e-18, 0.0109147410627, 0.026753283728,
-		0.0466046240811, 0.0685805055399, 0.0900655377644, 0.108164525988,
-		0.120252312056, 0.124500000963, 0.120252312056, 0.108164525988,
-		0.0900655377644, 0.0685805055399, 0.0466046240811, 0.026753283728,
-		0.0109147410627, 2.62074094328e-18, -0.00606971771843,
-		-0.00815933632458, -0.00757389494893, -0.00567312990492,
-		-0.0035491808885, -0.00184171525988, -0.000718555656558,
-		-3.88257917522e-19 };
-
 /**
- * @brief Simple upsampling function
+ * @brief Applies the selected clipping polynomial
  *
  * @param c Pointer to instance structure
- * @param audio_in Pointer to floating point audio input buffer (mono)
- * @param audio_out Pointer to floating point audio output buffer (mono)
+ * @param input Input signal
+ * @param output Clipped output signal (may be input)
  * @param audio_block_size The number of floating-point words to process
  */
-#pragma optimize_for_speed
-static void upsample_signal(CLIPPER * c, float * audio_in, float * audio_out,
+static void clipper_apply(CLIPPER * c, float * input, float * output,
 		uint32_t audio_block_size) {
 
-	int i;
-	int indx = 0;
+	// Apply polynomial
+	switch (c->poly_clip) {
+	case POLY_SMOOTHSTEP:
+		polynomial_smoothstep(c->clip_threshold, input, output,
+				audio_block_size);
+		break;
 
-	// Upsample
-	for (i = 0; i < audio_block_size; i++) {
-		for (int j = 0; j < CLIPPER_INTERP_FACTOR; j++) {
-			audio_out[indx++] = audio_in[i];
-		}
+	case POLY_SMOOTHERSTEP:
+		polynomial_smootherstep(c->clip_threshold, input, output,
+				audio_block_size);
+		break;
+	default:
+		copy_buffer(input, output, audio_block_size);
+		break;
 	}
-
-	// Filter
-	fir(audio_out, audio_out, fir_resample_x_8, c->fir_upsample_state,
-			audio_block_size * CLIPPER_INTERP_FACTOR,
-			CLIPPER_INTERP_TAPS);
 }
 
 /**
- * @brief Simple downsampling function
+ * @brief Oversampler callback, clips the upsampled signal in place
  *
- * @param c Pointer to instance structure
- * @param audio_in Pointer to floating point audio input buffer (mono)
- * @param audio_out Pointer to floating point audio output buffer (mono)
+ * @param context Pointer to clipper instance structure
+ * @param audio Oversampled signal
  * @param audio_block_size The number of floating-point words to process
  */
-#pragma optimize_for_speed
-static void downsample_signal(CLIPPER * c, float * audio_in, float * audio_out,
+static void clipper_apply_oversampled(void * context, float * audio,
 		uint32_t audio_block_size) {
-
-	// Filter
-	fir(audio_in, audio_in, fir_resample_x_8, c->fir_downsample_state,
-			audio_block_size * CLIPPER_INTERP_FACTOR,
-			CLIPPER_INTERP_TAPS);
-
-	int indx = 0;
-	for (int i = 0; i < audio_block_size * CLIPPER_INTERP_FACTOR; i +=
-			CLIPPER_INTERP_FACTOR) {
-		audio_out[indx++] = audio_in[i];
-	}
+	clipper_apply((CLIPPER *) context, audio, audio, audio_block_size);
 }
 
 /**
@@ -242,10 +189,12 @@ static void downsample_signal(CLIPPER * c, float * audio_in, float * audio_out,
 static void polynomial_smoothstep(float clip_value, float * input,
 		float * output, uint32_t audio_block_size) {
 
+	float clip_scale = 1.0 / clip_value;
+
 	for (int i = 0; i < audio_block_size; i++) {
 
 		// Scale input so 1.0 = our clip value
-		float x = input[i] / clip_value;
+		float x = input[i] * clip_scale;
 
 		// Shift input from 0.0 -> 1.0
 		x = x * 0.5 + 0.5;
@@ -283,18 +232,20 @@ static void polynomial_smoothstep(float clip_value, float * input,
 static void polynomial_smootherstep(float clip_value, float * input,
 		float * output, uint32_t audio_block_size) {
 
+	float clip_scale = 1.0 / clip_value;
+
 	for (int i = 0; i < audio_block_size; i++) {
 
 		// Scale input so 1.0 = our clip value
-		float x = input[i] / clip_value;
+		float x = input[i] * clip_scale;
 
 		// Shift input from 0.0 -> 1.0
 		x = x * 0.5 + 0.5;
 
 		if (x > 1.0)
 			x = 1.0;
-		else if (x < -1.0)
-			x = -1.0;
+		else if (x < 0)
+			x = 0.0;
 		else {
 			// Apply smoothstep polynomial
 			x = x * x * x * (x * (x * 6.0 - 15.0) + 10.0);
@@ -11,8 +11,7 @@
 #include <stdbool.h>
 
 #include "audio_elements_common.h"
-
-#define CLIPPER_INTERP_TAPS         (33)
+#include "oversampler.h"
 
 // Result enumerations
 typedef enum {
@@ -29,8 +28,7 @@ typedef struct {
 
 	bool initialized;
 
-	float fir_upsample_state[CLIPPER_INTERP_TAPS + 1];
-	float fir_downsample_state[CLIPPER_INTERP_TAPS + 1];
+	OVERSAMPLER oversampler;
 	POLY_CLIP_FUNC poly_clip;
 	float clip_threshold;
 	bool upsample;
@@ -12,6 +12,7 @@
  */
 #include "compressor.h"
 #include "audio_elements_common.h"
+#include "fast_math.h"
 
 #include <math.h>
 #include <stdlib.h>
@@ -29,7 +30,6 @@
 #define     COMPRESSOR_MAX_GAIN         (10.0)
 
 // Static function prototypes
-static float log2f(float x);
 static float calculate_threshold_coeff(float threshold_db);
 static float calculate_ratio_coeff(float ratio);
 static LP_COEFF calculate_rms_coeffs(float rms_fc, float fs);
@@ -333,6 +333,7 @@ RESULT_COMPRESSOR compressor_modify_gain(COMPRESSOR * c, float gain_new) {
  * @param audio_out Pointer to floating point audio output buffer (mono)
  * @param audio_block_size The number of floating-point words to process
  */
+#pragma optimize_for_speed
 void compressor_read(COMPRESSOR * c, float * audio_in, float * audio_out,
 		uint32_t audio_block_size) {
 
@@ -350,16 +351,25 @@ void compressor_read(COMPRESSOR * c, float * audio_in, float * audio_out,
 	float rms_ff = c->rms_coeff.ff;
 	float rms_fb = c->rms_coeff.fb;
 
-	for (int i = 0; i < audio_block_size; i++) {
-		float x = audio_in[i];
+	// Gain computer works in the log2 domain, one value per sample
+	float level[MAX_AUDIO_BLOCK_SIZE];
 
-		// Calculate current signal RMS
-		float x2 = x * x;
-		float x2_lpf = rms_ff * x2 + rms_fb * x2_last;
+	// Calculate signal power
+	for (int i = 0; i < audio_block_size; i++) {
+		float x2 = audio_in[i] * audio_in[i];
+		level[i] = rms_ff * x2 + rms_fb * x2_last;
 		x2_last = x2;
-		float x_rms = 0.5 * log2f(x2_lpf);
+	}
+
+	// Convert to log2 in one vectorizable pass
+	fast_log2_block(level, level, audio_block_size);
+
+	for (int i = 0; i < audio_block_size; i++) {
+
+		// log2 of the RMS value is half the log2 of the power
+		float x_rms = 0.5 * level[i];
 
-		// Calculate and apply vca
+		// Calculate vca gain
 		float x_thresh = c->threshold_coeff - x_rms;
 		if (x_thresh > 0.0) {
 			x_thresh = 0.0;
@@ -377,10 +387,16 @@ void compressor_read(COMPRESSOR * c, float * audio_in, float * audio_out,
 		float x_ar = ff * x_ratio + fb * x_ar_last;
 		x_ar_last = x_ar;
 
-		float vca_coeff = powf(2.0, x_ar);
+		level[i] = x_ar;
+	}
 
-		audio_out[i] = x * vca_coeff * c->output_gain;
+	// Convert gains back to linear in one vectorizable pass
+	fast_exp2_block(level, level, audio_block_size);
 
+	// Apply vca
+	float output_gain = c->output_gain;
+	for (int i = 0; i < audio_block_size; i++) {
+		audio_out[i] = audio_in[i] * level[i] * output_gain;
 	}
 
 	// Save state variables for next time through
@@ -389,17 +405,6 @@ void compressor_read(COMPRESSOR * c, float * audio_in, float * audio_out,
 
 }
 
-/**
- * @brief Calculates log2(x)
- *
- * @param x input value
- * @return log2(input)
- */
-static float log2f(float x) {
-	float log10_2_recip = 1.0 / 0.301029995663981;
-	return log10f(x) * log10_2_recip;
-}
-
 /**
  * @brief Calculates LP coefficent for threshold
  *
@@ -407,7 +412,8 @@ static float log2f(float x) {
  * @return Coefficent
  */
 static float calculate_threshold_coeff(float threshold_db) {
-	return log2f(powf(10.0, threshold_db / 20.0));
+	// log2(10^(dB/20)) simplifies to a single multiply
+	return threshold_db * FAST_DB_TO_LOG2;
 }
 
 /**
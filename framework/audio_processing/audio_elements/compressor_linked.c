@@ -0,0 +1,589 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * A linked compressor / limiter for stereo and multichannel audio.
+ *
+ * All channels share a single gain computer which is driven by the loudest
+ * channel, so the stereo (or surround) image doesn't shift when only one
+ * channel crosses the threshold.  This also means the gain computer only has
+ * to run once, regardless of the number of channels.
+ *
+ * The gain computer runs at a decimated control rate: the level is detected
+ * over a segment of control_interval samples and a new target gain is
+ * calculated at the end of each segment.  The gain is then linearly
+ * interpolated back to audio rate and applied to each channel with a simple
+ * multiply loop that the compiler can vectorize.  With a control interval of
+ * 16, the log2 / exp2 and attack / release filtering cost 1/16th of what they
+ * do in the COMPRESSOR element.
+ *
+ * An optional lookahead delay lets the gain come down before a peak arrives
+ * at the output.  For true peak limiting, use the peak detector, an attack
+ * time of 0 and a lookahead of at least 2 * control_interval samples.  The
+ * peak detector holds each segment's peak until it has left the lookahead
+ * (over ceil(lookahead / control_interval) segments, at least 2), so the
+ * lookahead can be at most LINKED_COMPRESSOR_MAX_HOLD_SEGMENTS control
+ * intervals.  The lookahead adds that many samples of latency to every
+ * channel.
+ */
+#include "compressor_linked.h"
+#include "fast_math.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+// Min/max limits and other constants
+#define     LINKED_COMPRESSOR_MIN_THRESHOLD         (-100.0)
+#define     LINKED_COMPRESSOR_MAX_THRESHOLD         (30.0)
+#define     LINKED_COMPRESSOR_MIN_RATIO             (1.0)
+#define     LINKED_COMPRESSOR_MAX_RATIO             (100000.0)
+#define     LINKED_COMPRESSOR_MIN_ATTACK_MS         (0)
+#define     LINKED_COMPRESSOR_MAX_ATTACK_MS         (1000.0)
+#define     LINKED_COMPRESSOR_MIN_RELEASE_MS        (0)
+#define     LINKED_COMPRESSOR_MAX_RELEASE_MS        (1000.0)
+#define     LINKED_COMPRESSOR_MIN_GAIN              (0)
+#define     LINKED_COMPRESSOR_MAX_GAIN              (10.0)
+#define     LINKED_COMPRESSOR_RMS_MS                (10.0)
+
+// Static function prototypes
+static void update_gain_target(LINKED_COMPRESSOR * c);
+static LP_COEFF calculate_lp_coeffs(float timeconstant_ms, float fs);
+
+/**
+ * @brief Initializes instance of a linked compressor
+ *
+ * The lookahead buffer must hold num_channels * lookahead_samples floats.
+ * Pass NULL / 0 to disable the lookahead.  With the peak detector, the
+ * lookahead can be at most LINKED_COMPRESSOR_MAX_HOLD_SEGMENTS *
+ * control_interval samples.
+ *
+ * @param c Pointer to instance structure
+ * @param num_channels Number of channels (1 - LINKED_COMPRESSOR_MAX_CHANNELS)
+ * @param threshold_db The threshold at which the audio compression is applied
+ * @param ratio The ratio of compression to loudness (>=1.0)
+ * @param attack_ms The amount of time after the signal crosses the threshold to when compression is applied
+ * @param release_ms The amount of time the compression is held after the signal returns below threshold
+ * @param output_gain The output gain of the compressor
+ * @param detector Level detector (RMS for compression, peak for limiting)
+ * @param control_interval Number of samples between gain updates (1 - MAX_AUDIO_BLOCK_SIZE)
+ * @param lookahead_buffer Pointer to lookahead delay line memory
+ * @param lookahead_samples Lookahead delay in samples (0 - LINKED_COMPRESSOR_MAX_LOOKAHEAD)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Linked compressor result (enumeration)
+ */
+RESULT_LINKED_COMPRESSOR linked_compressor_setup(LINKED_COMPRESSOR * c,
+		uint32_t num_channels, float threshold_db, float ratio,
+		float attack_ms, float release_ms, float output_gain,
+		LINKED_COMPRESSOR_DETECTOR detector, uint32_t control_interval,
+		float * lookahead_buffer, uint32_t lookahead_samples,
+		float audio_sample_rate) {
+
+	if (c == NULL) {
+		return LINKED_COMPRESSOR_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+	c->num_channels = 0;
+
+	if (num_channels < 1 || num_channels > LINKED_COMPRESSOR_MAX_CHANNELS) {
+		return LINKED_COMPRESSOR_INVALID_NUM_CHANNELS;
+	}
+	c->num_channels = num_channels;
+	c->detector = detector;
+
+	// Set control rate, coefficients below depend on it
+	if (control_interval < 1 || control_interval > MAX_AUDIO_BLOCK_SIZE) {
+		return LINKED_COMPRESSOR_INVALID_CONTROL_INTERVAL;
+	}
+	c->control_interval = control_interval;
+	c->control_interval_recip = 1.0 / (float) control_interval;
+	c->audio_sample_rate = audio_sample_rate;
+
+	float control_rate = audio_sample_rate * c->control_interval_recip;
+
+	// Set compressor threshold
+	if (threshold_db > LINKED_COMPRESSOR_MAX_THRESHOLD
+			|| threshold_db < LINKED_COMPRESSOR_MIN_THRESHOLD) {
+		return LINKED_COMPRESSOR_INVALID_THRESHOLD;
+	}
+	c->threshold_db = threshold_db;
+	c->threshold_coeff = threshold_db * FAST_DB_TO_LOG2;
+
+	// Set compressor ratio
+	if (ratio > LINKED_COMPRESSOR_MAX_RATIO
+			|| ratio < LINKED_COMPRESSOR_MIN_RATIO) {
+		return LINKED_COMPRESSOR_INVALID_RATIO;
+	}
+	c->ratio = ratio;
+	c->ratio_coeff = 1.0 - 1.0 / ratio;
+
+	// Set compressor attack time
+	if (attack_ms > LINKED_COMPRESSOR_MAX_ATTACK_MS
+			|| attack_ms < LINKED_COMPRESSOR_MIN_ATTACK_MS) {
+		return LINKED_COMPRESSOR_INVALID_ATTACK;
+	}
+	c->attack_ms = attack_ms;
+	c->attack_coeff = calculate_lp_coeffs(attack_ms, control_rate);
+
+	// Set compressor release time
+	if (release_ms > LINKED_COMPRESSOR_MAX_RELEASE_MS
+			|| release_ms < LINKED_COMPRESSOR_MIN_RELEASE_MS) {
+		return LINKED_COMPRESSOR_INVALID_RELEASE;
+	}
+	c->release_ms = release_ms;
+	c->release_coeff = calculate_lp_coeffs(release_ms, control_rate);
+
+	// Set RMS averaging time
+	c->rms_coeff = calculate_lp_coeffs(LINKED_COMPRESSOR_RMS_MS, control_rate);
+
+	// Set output gain
+	if (output_gain > LINKED_COMPRESSOR_MAX_GAIN
+			|| output_gain < LINKED_COMPRESSOR_MIN_GAIN) {
+		return LINKED_COMPRESSOR_INVALID_GAIN;
+	}
+	c->output_gain = output_gain;
+
+	// Set lookahead delay
+	if (lookahead_samples > LINKED_COMPRESSOR_MAX_LOOKAHEAD
+			|| (lookahead_samples > 0 && lookahead_buffer == NULL)) {
+		return LINKED_COMPRESSOR_INVALID_LOOKAHEAD;
+	}
+
+	// Hold each peak until it has left the lookahead delay
+	uint32_t hold_segments = (lookahead_samples + control_interval - 1)
+			/ control_interval;
+	if (hold_segments < 2) {
+		hold_segments = 2;
+	}
+	if (hold_segments > LINKED_COMPRESSOR_MAX_HOLD_SEGMENTS) {
+		if (detector == LINKED_COMPRESSOR_DETECT_PEAK) {
+			return LINKED_COMPRESSOR_INVALID_LOOKAHEAD;
+		}
+		hold_segments = LINKED_COMPRESSOR_MAX_HOLD_SEGMENTS;
+	}
+	c->hold_segments = hold_segments;
+
+	c->lookahead_buffer = lookahead_buffer;
+	c->lookahead_samples = lookahead_samples;
+	c->lookahead_index = 0;
+	for (int i = 0; i < num_channels * lookahead_samples; i++) {
+		lookahead_buffer[i] = 0.0;
+	}
+
+	// Initialize state variables
+	c->segment_pos = 0;
+	for (int ch = 0; ch < LINKED_COMPRESSOR_MAX_CHANNELS; ch++) {
+		c->segment_level[ch] = 0.0;
+	}
+	for (int s = 0; s < LINKED_COMPRESSOR_MAX_HOLD_SEGMENTS; s++) {
+		c->segment_peak[s] = 0.0;
+	}
+	c->peak_index = 0;
+	c->level_lpf = 0.0;
+	c->x_ar_last = 0.0;
+	c->gain_current = 1.0;
+	c->gain_inc = 0.0;
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return LINKED_COMPRESSOR_OK;
+
+}
+
+/**
+ * @brief Modify the compression threshold
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param threshold_db_new Updated threshold value
+ *
+ * @return Linked compressor result (enumeration)
+ */
+RESULT_LINKED_COMPRESSOR linked_compressor_modify_threshold(
+		LINKED_COMPRESSOR * c, float threshold_db_new) {
+
+	if (c == NULL) {
+		return LINKED_COMPRESSOR_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_LINKED_COMPRESSOR res = LINKED_COMPRESSOR_OK;
+
+	if (threshold_db_new > LINKED_COMPRESSOR_MAX_THRESHOLD) {
+		threshold_db_new = LINKED_COMPRESSOR_MAX_THRESHOLD;
+		res = LINKED_COMPRESSOR_INVALID_THRESHOLD;
+	} else if (threshold_db_new < LINKED_COMPRESSOR_MIN_THRESHOLD) {
+		threshold_db_new = LINKED_COMPRESSOR_MIN_THRESHOLD;
+		res = LINKED_COMPRESSOR_INVALID_THRESHOLD;
+	}
+
+	c->threshold_db = threshold_db_new;
+	c->threshold_coeff = threshold_db_new * FAST_DB_TO_LOG2;
+
+	return res;
+
+}
+
+/**
+ * @brief Modify compression ratio
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param ratio_new Updated compression ratio
+ *
+ * @return Linked compressor result (enumeration)
+ */
+RESULT_LINKED_COMPRESSOR linked_compressor_modify_ratio(LINKED_COMPRESSOR * c,
+		float ratio_new) {
+
+	if (c == NULL) {
+		return LINKED_COMPRESSOR_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_LINKED_COMPRESSOR res = LINKED_COMPRESSOR_OK;
+
+	if (ratio_new > LINKED_COMPRESSOR_MAX_RATIO) {
+		ratio_new = LINKED_COMPRESSOR_MAX_RATIO;
+		res = LINKED_COMPRESSOR_INVALID_RATIO;
+	} else if (ratio_new < LINKED_COMPRESSOR_MIN_RATIO) {
+		ratio_new = LINKED_COMPRESSOR_MIN_RATIO;
+		res = LINKED_COMPRESSOR_INVALID_RATIO;
+	}
+
+	c->ratio = ratio_new;
+	c->ratio_coeff = 1.0 - 1.0 / ratio_new;
+
+	return res;
+
+}
+
+/**
+ * @brief Modify the attack time in ms
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param attack_ms_new Updated attack time in milliseconds
+ *
+ * @return Linked compressor result (enumeration)
+ */
+RESULT_LINKED_COMPRESSOR linked_compressor_modify_attack(LINKED_COMPRESSOR * c,
+		float attack_ms_new) {
+
+	if (c == NULL) {
+		return LINKED_COMPRESSOR_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_LINKED_COMPRESSOR res = LINKED_COMPRESSOR_OK;
+
+	if (attack_ms_new > LINKED_COMPRESSOR_MAX_ATTACK_MS) {
+		attack_ms_new = LINKED_COMPRESSOR_MAX_ATTACK_MS;
+		res = LINKED_COMPRESSOR_INVALID_ATTACK;
+	} else if (attack_ms_new < LINKED_COMPRESSOR_MIN_ATTACK_MS) {
+		attack_ms_new = LINKED_COMPRESSOR_MIN_ATTACK_MS;
+		res = LINKED_COMPRESSOR_INVALID_ATTACK;
+	}
+
+	c->attack_ms = attack_ms_new;
+	c->attack_coeff = calculate_lp_coeffs(attack_ms_new,
+			c->audio_sample_rate * c->control_interval_recip);
+
+	return res;
+
+}
+
+/**
+ * @brief Modify the release time in ms
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param release_ms_new Updated release time in milliseconds
+ *
+ * @return Linked compressor result (enumeration)
+ */
+RESULT_LINKED_COMPRESSOR linked_compressor_modify_release(
+		LINKED_COMPRESSOR * c, float release_ms_new) {
+
+	if (c == NULL) {
+		return LINKED_COMPRESSOR_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_LINKED_COMPRESSOR res = LINKED_COMPRESSOR_OK;
+
+	if (release_ms_new > LINKED_COMPRESSOR_MAX_RELEASE_MS) {
+		release_ms_new = LINKED_COMPRESSOR_MAX_RELEASE_MS;
+		res = LINKED_COMPRESSOR_INVALID_RELEASE;
+	} else if (release_ms_new < LINKED_COMPRESSOR_MIN_RELEASE_MS) {
+		release_ms_new = LINKED_COMPRESSOR_MIN_RELEASE_MS;
+		res = LINKED_COMPRESSOR_INVALID_RELEASE;
+	}
+
+	c->release_ms = release_ms_new;
+	c->release_coeff = calculate_lp_coeffs(release_ms_new,
+			c->audio_sample_rate * c->control_interval_recip);
+
+	return res;
+
+}
+
+/**
+ * @brief Modify compressor output gain
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the effect.
+ *
+ * @param c Pointer to instance structure
+ * @param gain_new Updated output gain value
+ *
+ * @return Linked compressor result (enumeration)
+ */
+RESULT_LINKED_COMPRESSOR linked_compressor_modify_gain(LINKED_COMPRESSOR * c,
+		float gain_new) {
+
+	if (c == NULL) {
+		return LINKED_COMPRESSOR_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_LINKED_COMPRESSOR res = LINKED_COMPRESSOR_OK;
+
+	if (gain_new > LINKED_COMPRESSOR_MAX_GAIN) {
+		gain_new = LINKED_COMPRESSOR_MAX_GAIN;
+		res = LINKED_COMPRESSOR_INVALID_GAIN;
+	} else if (gain_new < LINKED_COMPRESSOR_MIN_GAIN) {
+		gain_new = LINKED_COMPRESSOR_MIN_GAIN;
+		res = LINKED_COMPRESSOR_INVALID_GAIN;
+	}
+
+	c->output_gain = gain_new;
+
+	return res;
+
+}
+
+/**
+ * @brief Apply effect/process to a block of audio data
+ *
+ * Input and output buffers may be the same (in-place processing).
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Array of num_channels pointers to audio input buffers
+ * @param audio_out Array of num_channels pointers to audio output buffers
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void linked_compressor_read(LINKED_COMPRESSOR * c, float ** audio_in,
+		float ** audio_out, uint32_t audio_block_size) {
+
+	// If this instance hasn't been properly initialized, pass audio through
+	if (c == NULL || !c->initialized) {
+		if (c != NULL) {
+			for (int ch = 0; ch < c->num_channels; ch++) {
+				for (int i = 0; i < audio_block_size; i++) {
+					audio_out[ch][i] = audio_in[ch][i];
+				}
+			}
+		}
+		return;
+	}
+
+	uint32_t num_channels = c->num_channels;
+	uint32_t control_interval = c->control_interval;
+	bool peak = (c->detector == LINKED_COMPRESSOR_DETECT_PEAK);
+
+	// Audio rate gain, shared by all channels
+	float gain[MAX_AUDIO_BLOCK_SIZE];
+
+	float gain_current = c->gain_current;
+	float gain_inc = c->gain_inc;
+
+	int i = 0;
+	while (i < audio_block_size) {
+
+		// Run up to the end of the current control segment or the block
+		uint32_t len = control_interval - c->segment_pos;
+		if (len > audio_block_size - i) {
+			len = audio_block_size - i;
+		}
+
+		// Accumulate the power (or peak power) of each channel
+		for (int ch = 0; ch < num_channels; ch++) {
+			float * x = &audio_in[ch][i];
+			float level = c->segment_level[ch];
+			if (peak) {
+				for (int k = 0; k < len; k++) {
+					float x2 = x[k] * x[k];
+					level = (x2 > level) ? x2 : level;
+				}
+			} else {
+				for (int k = 0; k < len; k++) {
+					level += x[k] * x[k];
+				}
+			}
+			c->segment_level[ch] = level;
+		}
+
+		// Interpolate towards the last target gain
+		for (int k = 0; k < len; k++) {
+			gain_current += gain_inc;
+			gain[i + k] = gain_current;
+		}
+
+		i += len;
+		c->segment_pos += len;
+
+		// End of segment, calculate the next target gain
+		if (c->segment_pos == control_interval) {
+			c->gain_current = gain_current;
+			update_gain_target(c);
+			gain_inc = c->gain_inc;
+		}
+	}
+
+	c->gain_current = gain_current;
+
+	float output_gain = c->output_gain;
+#pragma SIMD_for
+	for (int k = 0; k < audio_block_size; k++) {
+		gain[k] *= output_gain;
+	}
+
+	uint32_t lookahead_samples = c->lookahead_samples;
+
+	// No lookahead, apply gain directly
+	if (lookahead_samples == 0) {
+		for (int ch = 0; ch < num_channels; ch++) {
+			float * x = audio_in[ch];
+			float * y = audio_out[ch];
+#pragma SIMD_for
+			for (int k = 0; k < audio_block_size; k++) {
+				y[k] = x[k] * gain[k];
+			}
+		}
+		return;
+	}
+
+	// Apply gain to the delayed audio.  The delay line is processed in
+	// contiguous spans between the wrap points so the inner loop has no
+	// index arithmetic.
+	uint32_t index = c->lookahead_index;
+	for (int ch = 0; ch < num_channels; ch++) {
+
+		float * line = &c->lookahead_buffer[ch * lookahead_samples];
+		float * x = audio_in[ch];
+		float * y = audio_out[ch];
+
+		index = c->lookahead_index;
+		int n = 0;
+		while (n < audio_block_size) {
+			uint32_t span = lookahead_samples - index;
+			if (span > audio_block_size - n) {
+				span = audio_block_size - n;
+			}
+			float * d = &line[index];
+			for (int k = 0; k < span; k++) {
+				float delayed = d[k];
+				d[k] = x[n + k];
+				y[n + k] = delayed * gain[n + k];
+			}
+			n += span;
+			index += span;
+			if (index >= lookahead_samples) {
+				index = 0;
+			}
+		}
+	}
+	c->lookahead_index = index;
+
+}
+
+/**
+ * @brief Runs the gain computer once per control segment
+ *
+ * @param c Pointer to instance structure
+ */
+static void update_gain_target(LINKED_COMPRESSOR * c) {
+
+	// Link the channels by following the loudest one
+	float level = 0.0;
+	for (int ch = 0; ch < c->num_channels; ch++) {
+		if (c->segment_level[ch] > level) {
+			level = c->segment_level[ch];
+		}
+		c->segment_level[ch] = 0.0;
+	}
+	c->segment_pos = 0;
+
+	if (c->detector == LINKED_COMPRESSOR_DETECT_PEAK) {
+
+		// Hold each peak over hold_segments segments so the interpolated
+		// gain never rises above what the peak needs before it leaves the
+		// lookahead
+		c->segment_peak[c->peak_index] = level;
+		if (++c->peak_index == c->hold_segments) {
+			c->peak_index = 0;
+		}
+		for (int s = 0; s < c->hold_segments; s++) {
+			if (c->segment_peak[s] > level) {
+				level = c->segment_peak[s];
+			}
+		}
+
+	} else {
+
+		// Smooth the mean power at the control rate
+		float mean = level * c->control_interval_recip;
+		c->level_lpf = c->rms_coeff.ff * mean + c->rms_coeff.fb * c->level_lpf;
+		level = c->level_lpf;
+	}
+
+	// log2 of the RMS / peak value is half the log2 of the power
+	float x_level = 0.5 * fast_log2f(level);
+
+	// Calculate vca gain
+	float x_thresh = c->threshold_coeff - x_level;
+	if (x_thresh > 0.0) {
+		x_thresh = 0.0;
+	}
+	float x_ratio = c->ratio_coeff * x_thresh;
+
+	float ff, fb;
+	if (c->x_ar_last < x_ratio) {
+		ff = c->release_coeff.ff;
+		fb = c->release_coeff.fb;
+	} else {
+		ff = c->attack_coeff.ff;
+		fb = c->attack_coeff.fb;
+	}
+	float x_ar = ff * x_ratio + fb * c->x_ar_last;
+	c->x_ar_last = x_ar;
+
+	// Ramp to the new gain over the next segment
+	float gain_target = fast_exp2f(x_ar);
+	c->gain_inc = (gain_target - c->gain_current) * c->control_interval_recip;
+
+}
+
+/**
+ * @brief Calculates feedforward and feedback coefficients for a one-pole
+ * smoothing filter with the given time constant
+ *
+ * @param timeconstant_ms Time constant in milliseconds
+ * @param fs Rate at which the filter is run
+ * @return Filter coefficients
+ */
+static LP_COEFF calculate_lp_coeffs(float timeconstant_ms, float fs) {
+	LP_COEFF coeffs;
+	coeffs.fb = expf(-3.0 / (1.0e-3 * timeconstant_ms * fs));
+	coeffs.ff = 1.0 - coeffs.fb;
+	return coeffs;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _COMPRESSOR_LINKED_H
+#define _COMPRESSOR_LINKED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+#include "compressor.h"
+
+// Maximum number of channels sharing one gain computer
+#define LINKED_COMPRESSOR_MAX_CHANNELS      (16)
+
+// Maximum lookahead delay in samples
+#define LINKED_COMPRESSOR_MAX_LOOKAHEAD     (1024)
+
+// Maximum number of control segments a peak is held over (peak detector),
+// i.e. the longest lookahead is 16 control intervals
+#define LINKED_COMPRESSOR_MAX_HOLD_SEGMENTS (16)
+
+// Result enumerations
+typedef enum {
+	LINKED_COMPRESSOR_OK,
+	LINKED_COMPRESSOR_INVALID_INSTANCE_POINTER,
+	LINKED_COMPRESSOR_INVALID_NUM_CHANNELS,
+	LINKED_COMPRESSOR_INVALID_THRESHOLD,
+	LINKED_COMPRESSOR_INVALID_RATIO,
+	LINKED_COMPRESSOR_INVALID_ATTACK,
+	LINKED_COMPRESSOR_INVALID_RELEASE,
+	LINKED_COMPRESSOR_INVALID_GAIN,
+	LINKED_COMPRESSOR_INVALID_CONTROL_INTERVAL,
+	LINKED_COMPRESSOR_INVALID_LOOKAHEAD
+} RESULT_LINKED_COMPRESSOR;
+
+// Level detector used by the gain computer
+typedef enum {
+	LINKED_COMPRESSOR_DETECT_RMS,	// smoothed power, for compression
+	LINKED_COMPRESSOR_DETECT_PEAK	// segment peak, for limiting
+} LINKED_COMPRESSOR_DETECTOR;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	uint32_t num_channels;
+	LINKED_COMPRESSOR_DETECTOR detector;
+
+	float threshold_db;
+	float threshold_coeff;
+
+	float ratio;
+	float ratio_coeff;
+
+	float attack_ms;
+	float release_ms;
+
+	float output_gain;
+
+	// Coefficients are calculated for the control rate (fs / control_interval)
+	LP_COEFF rms_coeff;
+	LP_COEFF attack_coeff;
+	LP_COEFF release_coeff;
+
+	float audio_sample_rate;
+	uint32_t control_interval;
+	float control_interval_recip;
+
+	// Gain computer state
+	uint32_t segment_pos;
+	float segment_level[LINKED_COMPRESSOR_MAX_CHANNELS];
+	float segment_peak[LINKED_COMPRESSOR_MAX_HOLD_SEGMENTS];
+	uint32_t hold_segments;
+	uint32_t peak_index;
+	float level_lpf;
+	float x_ar_last;
+
+	// Linear gain interpolation between control points
+	float gain_current;
+	float gain_inc;
+
+	// Lookahead delay lines, one per channel, stored back to back
+	float * lookahead_buffer;
+	uint32_t lookahead_samples;
+	uint32_t lookahead_index;
+
+} LINKED_COMPRESSOR;
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+RESULT_LINKED_COMPRESSOR linked_compressor_setup(LINKED_COMPRESSOR * c,
+		uint32_t num_channels, float threshold_db, float ratio,
+		float attack_ms, float release_ms, float output_gain,
+		LINKED_COMPRESSOR_DETECTOR detector, uint32_t control_interval,
+		float * lookahead_buffer, uint32_t lookahead_samples,
+		float audio_sample_rate);
+
+RESULT_LINKED_COMPRESSOR linked_compressor_modify_threshold(
+		LINKED_COMPRESSOR * c, float threshold_db_new);
+
+RESULT_LINKED_COMPRESSOR linked_compressor_modify_ratio(LINKED_COMPRESSOR * c,
+		float ratio_new);
+
+RESULT_LINKED_COMPRESSOR linked_compressor_modify_attack(LINKED_COMPRESSOR * c,
+		float attack_ms_new);
+
+RESULT_LINKED_COMPRESSOR linked_compressor_modify_release(
+		LINKED_COMPRESSOR * c, float release_ms_new);
+
+RESULT_LINKED_COMPRESSOR linked_compressor_modify_gain(LINKED_COMPRESSOR * c,
+		float gain_new);
+
+void linked_compressor_read(LINKED_COMPRESSOR * c, float ** audio_in,
+		float ** audio_out, uint32_t audio_block_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _COMPRESSOR_LINKED_H
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This element turns the position of a control (e.g. a pot, 0->1.0) into the
+ * value of an effect parameter and decides when the effect needs to be told
+ * about it.  Calling an effect's _modify_ function every block with the raw
+ * position is wasteful: many of them recompute filter coefficients, and the
+ * noise on the HADC inputs makes the position move a little every block
+ * even when nobody is touching the pot.
+ *
+ * A control parameter:
+ *  - maps the position onto the parameter's range with a linear, log or
+ *    exponential taper
+ *  - ignores moves smaller than a deadband, so noise around a position
+ *    doesn't change the parameter
+ *  - smooths the value towards its target with a one-pole filter run once
+ *    per update (e.g. once per block), snapping to the target once it is
+ *    close enough
+ *  - reports when the value has changed, so the _modify_ function is only
+ *    called while the parameter is actually moving
+ *
+ * Typical use, once per block:
+ *
+ *     control_parameter_set(&param, pot_position);
+ *     if (control_parameter_update(&param, &value)) {
+ *         effect_modify_something(&effect, value);
+ *     }
+ *
+ * The first position set after setup is applied immediately (no smoothing)
+ * and always reported, so an effect set up with a default value picks up the
+ * position of the control straight away.  Parameters that an effect already
+ * ramps internally (e.g. the length of a delay) should be set up without
+ * smoothing.
+ */
+#include <math.h>
+#include <stdlib.h>
+
+#include "control_parameter.h"
+
+// Curve of CONTROL_TAPER_EXP, the value rises 40dB over the range
+#define CONTROL_PARAMETER_EXP_CURVE         (4.605170186)   // ln(100)
+#define CONTROL_PARAMETER_EXP_SCALE         (1.0 / 99.0)    // 1 / (100 - 1)
+
+// The value snaps to its target within this fraction of the range
+#define CONTROL_PARAMETER_SETTLE_FRACTION   (0.001)
+
+/**
+ * @brief Initializes instance of a control parameter
+ *
+ * @param c Pointer to instance structure
+ * @param min Value at position 0.0
+ * @param max Value at position 1.0 (may be less than min)
+ * @param taper Mapping of the position onto min -> max
+ * @param deadband Smallest change of position that is accepted (0.0 for any)
+ * @param smoothing_time Time constant of the smoothing in seconds (0.0 for none)
+ * @param update_rate Number of times control_parameter_update is called per second
+ * @return Control parameter result (enumeration)
+ */
+RESULT_CONTROL_PARAMETER control_parameter_setup(CONTROL_PARAMETER * c,
+		float min, float max, CONTROL_PARAMETER_TAPER taper, float deadband,
+		float smoothing_time, float update_rate) {
+
+	// Ensure we don't have a null pointer
+	if (c == NULL) {
+		return CONTROL_PARAMETER_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	// A log taper needs a range of positive values
+	if (taper == CONTROL_TAPER_LOG && (min <= 0.0 || max <= 0.0)) {
+		return CONTROL_PARAMETER_INVALID_RANGE;
+	}
+
+	c->taper = taper;
+	c->min = min;
+	c->max = max;
+	c->log_ratio = (taper == CONTROL_TAPER_LOG) ? logf(max / min) : 0.0;
+	c->deadband = (deadband > 0.0) ? deadband : 0.0;
+	c->settle_threshold = fabsf(max - min) * CONTROL_PARAMETER_SETTLE_FRACTION;
+
+	// One-pole smoothing coefficient for the given time constant
+	if (smoothing_time > 0.0 && update_rate > 0.0) {
+		c->smoothing_coeff = 1.0 - expf(-1.0 / (smoothing_time * update_rate));
+	} else {
+		c->smoothing_coeff = 1.0;
+	}
+
+	// Nothing is reported until the first position is set
+	c->position_valid = false;
+	c->position = 0.0;
+	c->target = min;
+	c->value = min;
+	c->changed = false;
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return CONTROL_PARAMETER_OK;
+}
+
+/**
+ * @brief Sets the position of the control
+ *
+ * Moves smaller than the deadband are ignored, except onto either end of the
+ * range so the minimum and maximum can always be reached.  If the input
+ * parameter is out of bounds, it is clipped to 0.0 / 1.0 and applied.  This
+ * function will return a flag indicating an invalid input parameter was
+ * supplied but it won't disable the parameter.
+ *
+ * @param c Pointer to instance structure
+ * @param position New position of the control (0->1.0)
+ * @return Control parameter result (enumeration)
+ */
+RESULT_CONTROL_PARAMETER control_parameter_set(CONTROL_PARAMETER * c,
+		float position) {
+
+	RESULT_CONTROL_PARAMETER res = CONTROL_PARAMETER_OK;
+
+	if (c == NULL || !c->initialized) {
+		return CONTROL_PARAMETER_INVALID_INSTANCE_POINTER;
+	}
+
+	if (position < 0.0) {
+		position = 0.0;
+		res = CONTROL_PARAMETER_INVALID_POSITION;
+	} else if (position > 1.0) {
+		position = 1.0;
+		res = CONTROL_PARAMETER_INVALID_POSITION;
+	}
+
+	// Ignore small moves (noise) around the last accepted position
+	if (c->position_valid) {
+		if (position == c->position) {
+			return res;
+		}
+		bool at_end = (position == 0.0 || position == 1.0);
+		if (!at_end && fabsf(position - c->position) <= c->deadband) {
+			return res;
+		}
+	}
+	c->position = position;
+
+	// Map the position onto the range
+	switch (c->taper) {
+	case CONTROL_TAPER_LOG:
+		c->target = c->min * expf(c->log_ratio * position);
+		break;
+	case CONTROL_TAPER_EXP:
+		c->target = c->min
+				+ (c->max - c->min)
+						* (expf(CONTROL_PARAMETER_EXP_CURVE * position) - 1.0)
+						* CONTROL_PARAMETER_EXP_SCALE;
+		break;
+	default:
+		c->target = c->min + (c->max - c->min) * position;
+		break;
+	}
+
+	// The first position is applied straight away
+	if (!c->position_valid) {
+		c->position_valid = true;
+		c->value = c->target;
+		c->changed = true;
+	}
+
+	return res;
+}
+
+/**
+ * @brief Moves the value towards its target and reports if it changed
+ *
+ * Call once per update period (e.g. once per block, at the rate given to
+ * control_parameter_setup).  Once the value has reached its target this
+ * does nothing until the next accepted change of position.
+ *
+ * @param c Pointer to instance structure
+ * @param value Set to the new value if it changed
+ * @return true if the value changed since the last call
+ */
+bool control_parameter_update(CONTROL_PARAMETER * c, float * value) {
+
+	if (c == NULL || !c->initialized) {
+		return false;
+	}
+
+	// One step of the smoothing filter
+	if (c->value != c->target) {
+		float difference = c->target - c->value;
+		if (c->smoothing_coeff >= 1.0
+				|| fabsf(difference) <= c->settle_threshold) {
+			c->value = c->target;
+		} else {
+			c->value += c->smoothing_coeff * difference;
+		}
+		c->changed = true;
+	}
+
+	if (!c->changed) {
+		return false;
+	}
+
+	c->changed = false;
+	*value = c->value;
+	return true;
+}
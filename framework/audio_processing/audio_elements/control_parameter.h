@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _CONTROL_PARAMETER_H
+#define _CONTROL_PARAMETER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Result enumerations
+typedef enum {
+	CONTROL_PARAMETER_OK,
+	CONTROL_PARAMETER_INVALID_INSTANCE_POINTER,
+	CONTROL_PARAMETER_INVALID_RANGE,
+	CONTROL_PARAMETER_INVALID_POSITION
+} RESULT_CONTROL_PARAMETER;
+
+// How the position of a control (0->1.0) maps to the parameter's range
+typedef enum {
+	CONTROL_TAPER_LINEAR,	// equal moves change the value by the same amount
+	CONTROL_TAPER_LOG,		// equal moves change the value by the same ratio (min, max > 0)
+	CONTROL_TAPER_EXP		// slow at first, then fast (like an audio taper pot)
+} CONTROL_PARAMETER_TAPER;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	CONTROL_PARAMETER_TAPER taper;
+	float min;
+	float max;
+	float log_ratio;			// log(max / min) for CONTROL_TAPER_LOG
+	float deadband;				// smallest move of the control that is accepted
+	float smoothing_coeff;		// one-pole coefficient per update, 1.0 for none
+	float settle_threshold;		// distance at which the value snaps to the target
+
+	bool position_valid;		// a position has been set since setup
+	float position;				// last accepted position of the control
+	float target;
+	float value;
+	bool changed;				// value changed since the last notification
+} CONTROL_PARAMETER;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+RESULT_CONTROL_PARAMETER control_parameter_setup(CONTROL_PARAMETER * c,
+		float min, float max, CONTROL_PARAMETER_TAPER taper, float deadband,
+		float smoothing_time, float update_rate);
+
+RESULT_CONTROL_PARAMETER control_parameter_set(CONTROL_PARAMETER * c,
+		float position);
+
+bool control_parameter_update(CONTROL_PARAMETER * c, float * value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _CONTROL_PARAMETER_H
@@ -0,0 +1,429 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This audio element convolves audio with a long impulse response (IR), e.g.
+ * a guitar cabinet or the IR of a room, using partitioned FFT convolution.
+ *
+ * Direct (FIR) convolution costs one multiply-accumulate per IR sample per
+ * audio sample, so a 2 second IR at 48 kHz would need ~100,000 MACs per
+ * sample.  FFT convolution reduces this to a few operations per IR sample per
+ * block.  To avoid the latency of one huge FFT, the IR is cut into
+ * partitions which are transformed once at setup and combined with a
+ * frequency-domain delay line (FDL) of past input spectra ("uniformly
+ * partitioned overlap-save").
+ *
+ * Two partition sizes are used (non-uniform partitioning):
+ *
+ *   Head - partitions of one audio block, FFT size 2 * block_size.  These
+ *   cover the first 2 * tail_size samples of the IR and are processed in
+ *   convolver_read() in the audio callback, so the convolver adds no latency
+ *   beyond the framework's own block.
+ *
+ *   Tail - partitions of tail_size samples, FFT size 2 * tail_size.  These
+ *   cover the rest of the IR and are processed in convolver_process_tail(),
+ *   which should be called from the background loop
+ *   (processaudio_background_loop()).  The callback hands over a frame of
+ *   tail_size input samples and picks up the result tail_size samples later,
+ *   so each tail frame has tail_size samples' worth of time to complete.
+ *   Larger tail sizes are cheaper per sample but need more head partitions.
+ *
+ * The tail can be processed on the other SHARC core instead, as long as the
+ * instance and its memory are placed in memory both cores can see (and
+ * uncached or flushed).
+ *
+ * Memory is provided by the caller in two pools.  The fast pool is used by
+ * the audio callback and should be in L1/L2.  The bulk pool holds the tail
+ * IR spectra and FDL, which for an IR of several seconds is megabytes, and
+ * is intended for SDRAM.  Use convolver_memory_required() to size them.
+ *
+ * If tail_size is 0, the whole IR is processed in the callback (uniform
+ * partitioning), which is fine for short IRs such as cabinets.
+ */
+#include "convolver.h"
+
+#include <stdlib.h>
+
+// Static function prototypes
+static void convolver_partition_counts(uint32_t ir_length,
+		uint32_t block_size, uint32_t tail_size, uint32_t * head_partitions,
+		uint32_t * tail_partitions);
+static void convolver_transform_ir(FFT_REAL * fft, float * impulse_response,
+		uint32_t ir_length, uint32_t partition_size,
+		uint32_t num_partitions, float * spectra, float * scratch);
+static float * convolver_alloc(float ** pool, uint32_t size);
+
+/**
+ * @brief Calculates the memory needed for a convolver
+ *
+ * @param ir_length Length of the impulse response in samples
+ * @param block_size Audio block size (head partition size)
+ * @param tail_size Tail partition size (0 for head only)
+ * @param fast_memory_size Returns the number of floats needed in fast memory
+ * @param bulk_memory_size Returns the number of floats needed in bulk memory
+ */
+void convolver_memory_required(uint32_t ir_length, uint32_t block_size,
+		uint32_t tail_size, uint32_t * fast_memory_size,
+		uint32_t * bulk_memory_size) {
+
+	uint32_t head_partitions, tail_partitions;
+	convolver_partition_counts(ir_length, block_size, tail_size,
+			&head_partitions, &tail_partitions);
+
+	uint32_t head_fft = 2 * block_size;
+	*fast_memory_size = head_fft * (2 * head_partitions + 3);
+	*bulk_memory_size = 0;
+
+	if (tail_partitions > 0) {
+		uint32_t tail_fft = 2 * tail_size;
+		*fast_memory_size += 4 * tail_size;
+		*bulk_memory_size = tail_fft * (2 * tail_partitions + 3);
+	}
+}
+
+/**
+ * @brief Initializes instance of a convolver
+ *
+ * The impulse response is transformed here, which takes a while for long
+ * IRs, so call this before audio is started.
+ *
+ * @param c Pointer to instance structure
+ * @param impulse_response Pointer to the impulse response
+ * @param ir_length Length of the impulse response in samples
+ * @param block_size Audio block size (power of 2, 4 - MAX_AUDIO_BLOCK_SIZE)
+ * @param tail_size Tail partition size (power of 2 multiple of block_size, or 0)
+ * @param fast_memory Pointer to memory used in the audio callback
+ * @param fast_memory_size Size of fast_memory in floating point words
+ * @param bulk_memory Pointer to memory for the tail (e.g. SDRAM)
+ * @param bulk_memory_size Size of bulk_memory in floating point words
+ * @return Convolver result (enumeration)
+ */
+RESULT_CONVOLVER convolver_setup(CONVOLVER * c, float * impulse_response,
+		uint32_t ir_length, uint32_t block_size, uint32_t tail_size,
+		float * fast_memory, uint32_t fast_memory_size, float * bulk_memory,
+		uint32_t bulk_memory_size) {
+
+	if (c == NULL) {
+		return CONVOLVER_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	if (impulse_response == NULL || ir_length == 0) {
+		return CONVOLVER_INVALID_IMPULSE_RESPONSE;
+	}
+
+	if (block_size < FFT_MIN_SIZE / 2 || block_size > MAX_AUDIO_BLOCK_SIZE
+			|| (block_size & (block_size - 1))) {
+		return CONVOLVER_INVALID_BLOCK_SIZE;
+	}
+
+	if (tail_size != 0
+			&& (tail_size <= block_size || 2 * tail_size > FFT_MAX_SIZE
+					|| (tail_size & (tail_size - 1)))) {
+		return CONVOLVER_INVALID_TAIL_SIZE;
+	}
+
+	uint32_t fast_needed, bulk_needed;
+	convolver_memory_required(ir_length, block_size, tail_size, &fast_needed,
+			&bulk_needed);
+	if (fast_memory == NULL || fast_memory_size < fast_needed
+			|| (bulk_needed > 0
+					&& (bulk_memory == NULL || bulk_memory_size < bulk_needed))) {
+		return CONVOLVER_INSUFFICIENT_MEMORY;
+	}
+
+	convolver_partition_counts(ir_length, block_size, tail_size,
+			&c->head_partitions, &c->tail_partitions);
+	c->block_size = block_size;
+	c->tail_size = (c->tail_partitions > 0) ? tail_size : 0;
+
+	// Head, all in fast memory
+	uint32_t head_fft = 2 * block_size;
+	float * pool = fast_memory;
+
+	fft_real_setup(&c->fft_head, head_fft,
+			convolver_alloc(&pool, head_fft));
+	c->head_ir = convolver_alloc(&pool,
+			head_fft * c->head_partitions);
+	c->head_fdl = convolver_alloc(&pool,
+			head_fft * c->head_partitions);
+	c->head_input = convolver_alloc(&pool, head_fft);
+	c->head_acc = convolver_alloc(&pool, head_fft);
+	c->head_fdl_pos = 0;
+
+	uint32_t head_length = c->head_partitions * block_size;
+	if (head_length > ir_length) {
+		head_length = ir_length;
+	}
+	convolver_transform_ir(&c->fft_head, impulse_response, head_length,
+			block_size, c->head_partitions, c->head_ir, c->head_acc);
+
+	for (int i = 0; i < head_fft * c->head_partitions; i++) {
+		c->head_fdl[i] = 0.0;
+	}
+	for (int i = 0; i < head_fft; i++) {
+		c->head_input[i] = 0.0;
+	}
+
+	// Tail, exchange buffers in fast memory and everything else in bulk
+	c->tail_fill = 0;
+	c->tail_frame = 0;
+	c->tail_pending = false;
+	c->tail_pending_frame = 0;
+	c->tail_overruns = 0;
+
+	if (c->tail_partitions > 0) {
+
+		uint32_t tail_fft = 2 * tail_size;
+
+		for (int i = 0; i < 2; i++) {
+			c->tail_in[i] = convolver_alloc(&pool, tail_size);
+			c->tail_out[i] = convolver_alloc(&pool, tail_size);
+			for (int j = 0; j < tail_size; j++) {
+				c->tail_in[i][j] = 0.0;
+				c->tail_out[i][j] = 0.0;
+			}
+		}
+
+		pool = bulk_memory;
+
+		fft_real_setup(&c->fft_tail, tail_fft,
+				convolver_alloc(&pool, tail_fft));
+		c->tail_ir = convolver_alloc(&pool,
+				tail_fft * c->tail_partitions);
+		c->tail_fdl = convolver_alloc(&pool,
+				tail_fft * c->tail_partitions);
+		c->tail_input = convolver_alloc(&pool, tail_fft);
+		c->tail_acc = convolver_alloc(&pool, tail_fft);
+		c->tail_fdl_pos = 0;
+
+		// The tail starts where the head ends
+		convolver_transform_ir(&c->fft_tail, &impulse_response[head_length],
+				ir_length - head_length, tail_size, c->tail_partitions,
+				c->tail_ir, c->tail_acc);
+
+		for (int i = 0; i < tail_fft * c->tail_partitions; i++) {
+			c->tail_fdl[i] = 0.0;
+		}
+		for (int i = 0; i < tail_fft; i++) {
+			c->tail_input[i] = 0.0;
+		}
+	}
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return CONVOLVER_OK;
+}
+
+/**
+ * @brief Apply effect/process to a block of audio data
+ *
+ * audio_block_size must match the block size the convolver was set up with,
+ * otherwise audio is passed through.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point audio output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void convolver_read(CONVOLVER * c, float * audio_in, float * audio_out,
+		uint32_t audio_block_size) {
+
+	// If this instance hasn't been properly initialized, pass audio through
+	if (c == NULL || !c->initialized || audio_block_size != c->block_size) {
+		for (int i = 0; i < audio_block_size; i++) {
+			audio_out[i] = audio_in[i];
+		}
+		return;
+	}
+
+	uint32_t b = c->block_size;
+	uint32_t head_fft = 2 * b;
+	float * input = c->head_input;
+	float * acc = c->head_acc;
+
+	// Slide the input window by one block
+	for (int i = 0; i < b; i++) {
+		input[i] = input[b + i];
+		input[b + i] = audio_in[i];
+	}
+
+	// Hand the input to the tail before audio_out (which may be audio_in)
+	// is written
+	float * tail_out = NULL;
+	if (c->tail_partitions > 0) {
+		uint32_t frame = c->tail_frame & 1;
+		float * tail_in = &c->tail_in[frame][c->tail_fill];
+		for (int i = 0; i < b; i++) {
+			tail_in[i] = audio_in[i];
+		}
+		tail_out = &c->tail_out[frame][c->tail_fill];
+	}
+
+	// Add the newest spectrum to the FDL and convolve with the head
+	fft_real_forward(&c->fft_head, input, &c->head_fdl[c->head_fdl_pos
+			* head_fft]);
+
+	for (int i = 0; i < head_fft; i++) {
+		acc[i] = 0.0;
+	}
+
+	uint32_t slot = c->head_fdl_pos;
+	for (int p = 0; p < c->head_partitions; p++) {
+		fft_packed_cmac(acc, &c->head_fdl[slot * head_fft],
+				&c->head_ir[p * head_fft], head_fft);
+		slot = (slot == 0) ? c->head_partitions - 1 : slot - 1;
+	}
+
+	c->head_fdl_pos++;
+	if (c->head_fdl_pos >= c->head_partitions) {
+		c->head_fdl_pos = 0;
+	}
+
+	// Overlap-save, the second half is the valid part of the result
+	fft_real_inverse(&c->fft_head, acc, acc);
+
+	if (tail_out == NULL) {
+		for (int i = 0; i < b; i++) {
+			audio_out[i] = acc[b + i];
+		}
+		return;
+	}
+
+	for (int i = 0; i < b; i++) {
+		audio_out[i] = acc[b + i] + tail_out[i];
+	}
+
+	// Once a full tail frame is collected, hand it to the background
+	c->tail_fill += b;
+	if (c->tail_fill >= c->tail_size) {
+		if (c->tail_pending) {
+			// The previous frame hasn't finished, so this one is dropped
+			c->tail_overruns++;
+		} else {
+			c->tail_pending_frame = c->tail_frame;
+			c->tail_pending = true;
+		}
+		c->tail_frame++;
+		c->tail_fill = 0;
+	}
+}
+
+/**
+ * @brief Processes the tail partitions of one frame, if one is waiting
+ *
+ * Call this from the background loop, often enough to finish each frame
+ * within tail_size samples (c->tail_overruns counts frames that were
+ * dropped because it didn't).
+ *
+ * @param c Pointer to instance structure
+ * @return true if a frame was processed
+ */
+#pragma optimize_for_speed
+bool convolver_process_tail(CONVOLVER * c) {
+
+	if (c == NULL || !c->initialized || !c->tail_pending) {
+		return false;
+	}
+
+	uint32_t l = c->tail_size;
+	uint32_t tail_fft = 2 * l;
+	uint32_t frame = c->tail_pending_frame & 1;
+	float * input = c->tail_input;
+	float * acc = c->tail_acc;
+
+	// Slide the input window by one frame
+	for (int i = 0; i < l; i++) {
+		input[i] = input[l + i];
+		input[l + i] = c->tail_in[frame][i];
+	}
+
+	fft_real_forward(&c->fft_tail, input, &c->tail_fdl[c->tail_fdl_pos
+			* tail_fft]);
+
+	for (int i = 0; i < tail_fft; i++) {
+		acc[i] = 0.0;
+	}
+
+	uint32_t slot = c->tail_fdl_pos;
+	for (int p = 0; p < c->tail_partitions; p++) {
+		fft_packed_cmac(acc, &c->tail_fdl[slot * tail_fft],
+				&c->tail_ir[p * tail_fft], tail_fft);
+		slot = (slot == 0) ? c->tail_partitions - 1 : slot - 1;
+	}
+
+	c->tail_fdl_pos++;
+	if (c->tail_fdl_pos >= c->tail_partitions) {
+		c->tail_fdl_pos = 0;
+	}
+
+	fft_real_inverse(&c->fft_tail, acc, acc);
+
+	// Picked up by the callback two frames after this frame's input
+	float * out = c->tail_out[frame];
+	for (int i = 0; i < l; i++) {
+		out[i] = acc[l + i];
+	}
+
+	c->tail_pending = false;
+	return true;
+}
+
+/**
+ * @brief Splits an IR into head and tail partitions
+ *
+ * The tail can only start 2 * tail_size samples into the IR (one frame to
+ * collect the input and one frame to process it), so the head covers at
+ * least that much.
+ */
+static void convolver_partition_counts(uint32_t ir_length,
+		uint32_t block_size, uint32_t tail_size, uint32_t * head_partitions,
+		uint32_t * tail_partitions) {
+
+	uint32_t head_length = ir_length;
+	*tail_partitions = 0;
+
+	if (tail_size > 0 && ir_length > 2 * tail_size) {
+		head_length = 2 * tail_size;
+		*tail_partitions = (ir_length - head_length + tail_size - 1)
+				/ tail_size;
+	}
+
+	*head_partitions = (head_length + block_size - 1) / block_size;
+}
+
+/**
+ * @brief Transforms each partition of an IR to a packed spectrum
+ *
+ * Partitions are zero padded to the FFT size (2 * partition_size) and the
+ * 1 / size scaling of the inverse FFT is folded in here.
+ */
+static void convolver_transform_ir(FFT_REAL * fft, float * impulse_response,
+		uint32_t ir_length, uint32_t partition_size,
+		uint32_t num_partitions, float * spectra, float * scratch) {
+
+	uint32_t fft_size = 2 * partition_size;
+	float scale = 1.0 / (float) fft_size;
+
+	for (int p = 0; p < num_partitions; p++) {
+		for (int i = 0; i < fft_size; i++) {
+			uint32_t n = p * partition_size + i;
+			if (i < partition_size && n < ir_length) {
+				scratch[i] = impulse_response[n] * scale;
+			} else {
+				scratch[i] = 0.0;
+			}
+		}
+		fft_real_forward(fft, scratch, &spectra[p * fft_size]);
+	}
+}
+
+/**
+ * @brief Takes size floats from the front of a memory pool
+ */
+static float * convolver_alloc(float ** pool, uint32_t size) {
+	float * ptr = *pool;
+	*pool += size;
+	return ptr;
+}
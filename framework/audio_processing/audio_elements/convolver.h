@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _CONVOLVER_H
+#define _CONVOLVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+#include "fft.h"
+
+// Result enumerations
+typedef enum {
+	CONVOLVER_OK,
+	CONVOLVER_INVALID_INSTANCE_POINTER,
+	CONVOLVER_INVALID_IMPULSE_RESPONSE,
+	CONVOLVER_INVALID_BLOCK_SIZE,
+	CONVOLVER_INVALID_TAIL_SIZE,
+	CONVOLVER_INSUFFICIENT_MEMORY
+} RESULT_CONVOLVER;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	uint32_t block_size;
+	uint32_t tail_size;
+
+	// Head: partitions of block_size, processed in convolver_read()
+	FFT_REAL fft_head;
+	uint32_t head_partitions;
+	float * head_ir;
+	float * head_fdl;
+	uint32_t head_fdl_pos;
+	float * head_input;
+	float * head_acc;
+
+	// Tail: partitions of tail_size, processed in convolver_process_tail()
+	FFT_REAL fft_tail;
+	uint32_t tail_partitions;
+	float * tail_ir;
+	float * tail_fdl;
+	uint32_t tail_fdl_pos;
+	float * tail_input;
+	float * tail_acc;
+
+	// Ping-pong buffers between the callback and the background loop
+	float * tail_in[2];
+	float * tail_out[2];
+	uint32_t tail_fill;
+	uint32_t tail_frame;
+	volatile bool tail_pending;
+	volatile uint32_t tail_pending_frame;
+	uint32_t tail_overruns;
+
+} CONVOLVER;
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void convolver_memory_required(uint32_t ir_length, uint32_t block_size,
+		uint32_t tail_size, uint32_t * fast_memory_size,
+		uint32_t * bulk_memory_size);
+
+RESULT_CONVOLVER convolver_setup(CONVOLVER * c, float * impulse_response,
+		uint32_t ir_length, uint32_t block_size, uint32_t tail_size,
+		float * fast_memory, uint32_t fast_memory_size, float * bulk_memory,
+		uint32_t bulk_memory_size);
+
+void convolver_read(CONVOLVER * c, float * audio_in, float * audio_out,
+		uint32_t audio_block_size);
+
+bool convolver_process_tail(CONVOLVER * c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _CONVOLVER_H
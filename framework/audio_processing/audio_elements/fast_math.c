@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Fast approximations of the transcendental functions used on the audio
+ * path (log2, exp2, dB <-> linear, sine and tanh).
+ *
+ * The standard library versions (log10f, powf, sinf, ...) are accurate to the
+ * last bit but cost hundreds of cycles per call, which adds up quickly when
+ * they are called for every sample.  The approximations here split the input
+ * into an integer and fractional part (exploiting the IEEE float exponent for
+ * log2 / exp2) and evaluate a short polynomial over the reduced range.  They
+ * contain no library calls or loops, so the block versions below can be
+ * vectorized by the compiler.
+ *
+ * Error bounds over the supported input range:
+ *
+ *   fast_exp2f      relative error < 1e-6   (|x| < 24)
+ *   fast_log2f      absolute error < 1e-5   (~6e-5 dB)
+ *   fast_sin_2pi    absolute error < 1e-6   (|t| < 2)
+ *   fast_tanhf      absolute error < 1e-6
+ *
+ * Outside the ranges in brackets the error grows with the magnitude of the
+ * input because a float cannot resolve its fractional part as finely; keep
+ * oscillator phases wrapped to [0, 1).
+ *
+ * These are more than adequate for gain computers, envelopes and LFOs.  Filter
+ * coefficient design for very low cutoff frequencies needs more precision
+ * than this and should keep using the library functions.
+ *
+ * The scalar functions are defined inline in fast_math.h.
+ */
+#include "fast_math.h"
+
+/**
+ * @brief Calculates 2^x for a block of values
+ *
+ * @param input Pointer to input buffer
+ * @param output Pointer to output buffer (may be the same as input)
+ * @param block_size Number of values to process
+ */
+#pragma optimize_for_speed
+void fast_exp2_block(float * input, float * output, uint32_t block_size) {
+#pragma SIMD_for
+	for (int i = 0; i < block_size; i++) {
+		output[i] = fast_exp2f(input[i]);
+	}
+}
+
+/**
+ * @brief Calculates log2(x) for a block of values
+ *
+ * @param input Pointer to input buffer
+ * @param output Pointer to output buffer (may be the same as input)
+ * @param block_size Number of values to process
+ */
+#pragma optimize_for_speed
+void fast_log2_block(float * input, float * output, uint32_t block_size) {
+#pragma SIMD_for
+	for (int i = 0; i < block_size; i++) {
+		output[i] = fast_log2f(input[i]);
+	}
+}
+
+/**
+ * @brief Converts a block of decibel values to linear gains
+ *
+ * @param input Pointer to input buffer
+ * @param output Pointer to output buffer (may be the same as input)
+ * @param block_size Number of values to process
+ */
+#pragma optimize_for_speed
+void fast_db_to_lin_block(float * input, float * output, uint32_t block_size) {
+#pragma SIMD_for
+	for (int i = 0; i < block_size; i++) {
+		output[i] = fast_db_to_lin(input[i]);
+	}
+}
+
+/**
+ * @brief Converts a block of linear gains to decibels
+ *
+ * @param input Pointer to input buffer
+ * @param output Pointer to output buffer (may be the same as input)
+ * @param block_size Number of values to process
+ */
+#pragma optimize_for_speed
+void fast_lin_to_db_block(float * input, float * output, uint32_t block_size) {
+#pragma SIMD_for
+	for (int i = 0; i < block_size; i++) {
+		output[i] = fast_lin_to_db(input[i]);
+	}
+}
+
+/**
+ * @brief Calculates sin(2 * PI * t) for a block of phases
+ *
+ * @param phase Pointer to buffer of phases (in cycles)
+ * @param output Pointer to output buffer (may be the same as phase)
+ * @param block_size Number of values to process
+ */
+#pragma optimize_for_speed
+void fast_sin_2pi_block(float * phase, float * output, uint32_t block_size) {
+#pragma SIMD_for
+	for (int i = 0; i < block_size; i++) {
+		output[i] = fast_sin_2pi(phase[i]);
+	}
+}
+
+/**
+ * @brief Calculates tanh(x) for a block of values
+ *
+ * @param input Pointer to input buffer
+ * @param output Pointer to output buffer (may be the same as input)
+ * @param block_size Number of values to process
+ */
+#pragma optimize_for_speed
+void fast_tanh_block(float * input, float * output, uint32_t block_size) {
+#pragma SIMD_for
+	for (int i = 0; i < block_size; i++) {
+		output[i] = fast_tanhf(input[i]);
+	}
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _FAST_MATH_H
+#define _FAST_MATH_H
+
+#include <stdint.h>
+
+#include "audio_elements_common.h"
+
+// Polynomial coefficients (least-squares fits on Chebyshev nodes)
+#define FAST_EXP2_C0    (0.99999992693f)
+#define FAST_EXP2_C1    (0.69315296805f)
+#define FAST_EXP2_C2    (0.24015453098f)
+#define FAST_EXP2_C3    (0.05582360129f)
+#define FAST_EXP2_C4    (0.00899258775f)
+#define FAST_EXP2_C5    (0.00187623143f)
+
+#define FAST_LOG2_C1    (1.44253477962f)
+#define FAST_LOG2_C2    (-0.71803359097f)
+#define FAST_LOG2_C3    (0.45715812339f)
+#define FAST_LOG2_C4    (-0.27734165013f)
+#define FAST_LOG2_C5    (0.12147295188f)
+#define FAST_LOG2_C6    (-0.02579234614f)
+
+#define FAST_SIN_C1     (6.28316395095f)
+#define FAST_SIN_C3     (-41.33713041501f)
+#define FAST_SIN_C5     (81.34038615347f)
+#define FAST_SIN_C7     (-70.98993313952f)
+
+#define FAST_LOG2_E         (1.44269504089f)
+#define FAST_DB_TO_LOG2     (0.16609640474f)    // log2(10) / 20
+#define FAST_LOG2_TO_DB     (6.02059991328f)    // 20 / log2(10)
+
+// Lets us reinterpret the bits of a 32-bit IEEE float
+typedef union {
+	float f;
+	uint32_t i;
+} FAST_MATH_FLOAT_BITS;
+
+/*
+ * The scalar versions are inline so they can be used inside per-sample loops
+ * of other audio elements without a function call.
+ */
+
+/**
+ * @brief floor() for |x| < 2^31 without a library call
+ */
+static inline float fast_floorf(float x) {
+	float i = (float) (int32_t) x;
+	return (x < i) ? i - 1.0f : i;
+}
+
+/**
+ * @brief Fractional part of x, i.e. x - floor(x), in [0, 1)
+ */
+static inline float fast_fractf(float x) {
+	return x - fast_floorf(x);
+}
+
+/**
+ * @brief 2^x, relative error < 1e-6 for |x| < 24 (x clipped to [-126, 127])
+ */
+static inline float fast_exp2f(float x) {
+
+	if (x < -126.0f) {
+		x = -126.0f;
+	} else if (x > 127.0f) {
+		x = 127.0f;
+	}
+
+	float xi = fast_floorf(x);
+	float f = x - xi;
+
+	// 2^f for f in [0, 1) lands in [1, 2); add the integer part to the exponent
+	FAST_MATH_FLOAT_BITS v;
+	v.f = FAST_EXP2_C0
+			+ f * (FAST_EXP2_C1
+			+ f * (FAST_EXP2_C2
+			+ f * (FAST_EXP2_C3
+			+ f * (FAST_EXP2_C4
+			+ f * FAST_EXP2_C5))));
+	v.i += ((uint32_t) (int32_t) xi) << 23;
+
+	return v.f;
+}
+
+/**
+ * @brief log2(x) for x > 0, absolute error < 1e-5 (returns -127 for x = 0)
+ */
+static inline float fast_log2f(float x) {
+
+	FAST_MATH_FLOAT_BITS v;
+	v.f = x;
+
+	// Split into exponent and mantissa in [1, 2)
+	float e = (float) ((int32_t) ((v.i >> 23) & 0xFF) - 127);
+	v.i = (v.i & 0x007FFFFF) | 0x3F800000;
+	float m = v.f - 1.0f;
+
+	return e
+			+ m * (FAST_LOG2_C1
+			+ m * (FAST_LOG2_C2
+			+ m * (FAST_LOG2_C3
+			+ m * (FAST_LOG2_C4
+			+ m * (FAST_LOG2_C5
+			+ m * FAST_LOG2_C6)))));
+}
+
+/**
+ * @brief sin(2 * PI * t), absolute error < 1e-6 for |t| < 2
+ *
+ * Takes a phase in cycles (like the oscillators) rather than radians so the
+ * range reduction is a floor rather than a division.
+ */
+static inline float fast_sin_2pi(float t) {
+
+	// Reduce to [-0.5, 0.5) and then fold into [-0.25, 0.25]
+	t = t - fast_floorf(t + 0.5f);
+	if (t > 0.25f) {
+		t = 0.5f - t;
+	} else if (t < -0.25f) {
+		t = -0.5f - t;
+	}
+
+	float t2 = t * t;
+	return t * (FAST_SIN_C1 + t2 * (FAST_SIN_C3 + t2 * (FAST_SIN_C5
+			+ t2 * FAST_SIN_C7)));
+}
+
+/**
+ * @brief tanh(x), absolute error < 1e-6
+ */
+static inline float fast_tanhf(float x) {
+
+	// tanh saturates to +/-1 in single precision well before |x| = 9
+	if (x > 9.0f) {
+		return 1.0f;
+	} else if (x < -9.0f) {
+		return -1.0f;
+	}
+
+	float e = fast_exp2f(2.0f * FAST_LOG2_E * x);
+	return (e - 1.0f) / (e + 1.0f);
+}
+
+/**
+ * @brief Converts decibels to a linear gain
+ */
+static inline float fast_db_to_lin(float db) {
+	return fast_exp2f(FAST_DB_TO_LOG2 * db);
+}
+
+/**
+ * @brief Converts a linear gain (> 0) to decibels
+ */
+static inline float fast_lin_to_db(float lin) {
+	return FAST_LOG2_TO_DB * fast_log2f(lin);
+}
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void fast_exp2_block(float * input, float * output, uint32_t block_size);
+
+void fast_log2_block(float * input, float * output, uint32_t block_size);
+
+void fast_db_to_lin_block(float * input, float * output, uint32_t block_size);
+
+void fast_lin_to_db_block(float * input, float * output, uint32_t block_size);
+
+void fast_sin_2pi_block(float * phase, float * output, uint32_t block_size);
+
+void fast_tanh_block(float * input, float * output, uint32_t block_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FAST_MATH_H
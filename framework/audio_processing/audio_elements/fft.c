@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Real-input FFT (radix-2, sizes FFT_MIN_SIZE - FFT_MAX_SIZE).
+ *
+ * A real FFT of size N is computed as a complex FFT of size N/2 on the
+ * even/odd samples packed into the real/imaginary parts, followed by a
+ * post-processing pass that separates the two spectra.  This halves the work
+ * of a complex FFT with a zero imaginary part.
+ *
+ * Spectra use the common "packed" format of N floats:
+ *
+ *   [0] = DC (real), [1] = Nyquist (real), [2k, 2k+1] = (re, im) of bin k
+ *
+ * so the spectrum of a real signal takes no more memory than the signal.
+ *
+ * fft_real_inverse() is unscaled: inverse(forward(x)) = size * x.  Callers
+ * that multiply spectra (e.g. convolution) can fold 1 / size into one of the
+ * spectra ahead of time.
+ *
+ * This is a portable implementation.  On the ADSP-SC589, the FFTA hardware
+ * accelerator or the optimized CCES library FFTs can take over these calls
+ * when more performance is needed.
+ */
+#include "fft.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define FFT_PI  (3.14159265358979)
+
+// Static function prototypes
+static void fft_complex(float * data, uint32_t n, float * twiddle,
+		uint32_t twiddle_stride, bool inverse);
+
+/**
+ * @brief Initializes instance of a real FFT
+ *
+ * @param c Pointer to instance structure
+ * @param size FFT size (power of 2, FFT_MIN_SIZE - FFT_MAX_SIZE)
+ * @param twiddle_memory Pointer to size floats for the twiddle table
+ * @return FFT result (enumeration)
+ */
+RESULT_FFT fft_real_setup(FFT_REAL * c, uint32_t size, float * twiddle_memory) {
+
+	if (c == NULL) {
+		return FFT_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	if (size < FFT_MIN_SIZE || size > FFT_MAX_SIZE || (size & (size - 1))) {
+		return FFT_INVALID_SIZE;
+	}
+
+	if (twiddle_memory == NULL) {
+		return FFT_INVALID_TWIDDLE_POINTER;
+	}
+
+	c->size = size;
+	c->twiddle = twiddle_memory;
+
+	for (int k = 0; k < size / 2; k++) {
+		double w = -2.0 * FFT_PI * (double) k / (double) size;
+		c->twiddle[2 * k] = (float) cos(w);
+		c->twiddle[2 * k + 1] = (float) sin(w);
+	}
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return FFT_OK;
+}
+
+/**
+ * @brief Forward FFT of a real signal
+ *
+ * @param c Pointer to instance structure
+ * @param input Pointer to size real samples
+ * @param output Pointer to size floats for the packed spectrum (may be input)
+ */
+#pragma optimize_for_speed
+void fft_real_forward(FFT_REAL * c, float * input, float * output) {
+
+	uint32_t n = c->size;
+	uint32_t m = n / 2;
+	float * w = c->twiddle;
+
+	// Even / odd samples are already interleaved like complex data
+	if (output != input) {
+		for (int i = 0; i < n; i++) {
+			output[i] = input[i];
+		}
+	}
+
+	fft_complex(output, m, w, 2, false);
+
+	// Separate the spectra of the even and odd samples
+	float z0r = output[0];
+	float z0i = output[1];
+	output[0] = z0r + z0i;
+	output[1] = z0r - z0i;
+
+	for (int k = 1; k <= m / 2; k++) {
+
+		float * a = &output[2 * k];
+		float * b = &output[2 * (m - k)];
+
+		float ar = a[0], ai = a[1];
+		float br = b[0], bi = b[1];
+
+		// Fe = (Z[k] + conj(Z[m-k])) / 2, Fo = (Z[k] - conj(Z[m-k])) / 2i
+		float er = 0.5 * (ar + br);
+		float ei = 0.5 * (ai - bi);
+		float or_ = 0.5 * (ai + bi);
+		float oi = -0.5 * (ar - br);
+
+		float wr = w[2 * k], wi = w[2 * k + 1];
+		float tr = wr * or_ - wi * oi;
+		float ti = wr * oi + wi * or_;
+
+		// X[k] = Fe + w^k Fo, X[m-k] = conj(Fe - w^k Fo)
+		a[0] = er + tr;
+		a[1] = ei + ti;
+		b[0] = er - tr;
+		b[1] = -(ei - ti);
+	}
+}
+
+/**
+ * @brief Inverse FFT to a real signal (unscaled, see top of file)
+ *
+ * @param c Pointer to instance structure
+ * @param input Pointer to size floats of packed spectrum
+ * @param output Pointer to size real samples (may be input)
+ */
+#pragma optimize_for_speed
+void fft_real_inverse(FFT_REAL * c, float * input, float * output) {
+
+	uint32_t n = c->size;
+	uint32_t m = n / 2;
+	float * w = c->twiddle;
+
+	if (output != input) {
+		for (int i = 0; i < n; i++) {
+			output[i] = input[i];
+		}
+	}
+
+	// Recombine into the spectrum of the interleaved even / odd samples
+	float x0 = output[0];
+	float xm = output[1];
+	output[0] = x0 + xm;
+	output[1] = x0 - xm;
+
+	for (int k = 1; k <= m / 2; k++) {
+
+		float * a = &output[2 * k];
+		float * b = &output[2 * (m - k)];
+
+		float ar = a[0], ai = a[1];
+		float br = b[0], bi = -b[1];
+
+		// Fe = X[k] + conj(X[m-k]), Fo = (X[k] - conj(X[m-k])) * conj(w^k)
+		float er = ar + br;
+		float ei = ai + bi;
+		float dr = ar - br;
+		float di = ai - bi;
+
+		float wr = w[2 * k], wi = -w[2 * k + 1];
+		float or_ = dr * wr - di * wi;
+		float oi = dr * wi + di * wr;
+
+		// Z[k] = Fe + i Fo, Z[m-k] = conj(Fe - i Fo)
+		a[0] = er - oi;
+		a[1] = ei + or_;
+		b[0] = er + oi;
+		b[1] = -(ei - or_);
+	}
+
+	fft_complex(output, m, w, 2, true);
+}
+
+/**
+ * @brief Multiplies two packed spectra and adds the result to a third
+ *
+ * This is the inner loop of FFT convolution: acc += x * h
+ *
+ * @param acc Pointer to packed spectrum to accumulate into
+ * @param x Pointer to first packed spectrum
+ * @param h Pointer to second packed spectrum
+ * @param size FFT size
+ */
+#pragma optimize_for_speed
+void fft_packed_cmac(float * acc, float * x, float * h, uint32_t size) {
+
+	// DC and Nyquist are real
+	acc[0] += x[0] * h[0];
+	acc[1] += x[1] * h[1];
+
+	for (int k = 2; k < size; k += 2) {
+		float xr = x[k], xi = x[k + 1];
+		float hr = h[k], hi = h[k + 1];
+		acc[k] += xr * hr - xi * hi;
+		acc[k + 1] += xr * hi + xi * hr;
+	}
+}
+
+/**
+ * @brief In-place iterative radix-2 complex FFT (unscaled)
+ *
+ * @param data Pointer to n complex values as (re, im) pairs
+ * @param n Number of complex values (power of 2)
+ * @param twiddle Twiddle table of the parent real FFT
+ * @param twiddle_stride Table stride for a full turn over n points
+ * @param inverse true for the inverse transform
+ */
+#pragma optimize_for_speed
+static void fft_complex(float * data, uint32_t n, float * twiddle,
+		uint32_t twiddle_stride, bool inverse) {
+
+	// Bit reversal permutation
+	uint32_t j = 0;
+	for (int i = 0; i < n - 1; i++) {
+		if (i < j) {
+			float tr = data[2 * i], ti = data[2 * i + 1];
+			data[2 * i] = data[2 * j];
+			data[2 * i + 1] = data[2 * j + 1];
+			data[2 * j] = tr;
+			data[2 * j + 1] = ti;
+		}
+		uint32_t bit = n >> 1;
+		while (j & bit) {
+			j ^= bit;
+			bit >>= 1;
+		}
+		j |= bit;
+	}
+
+	float sign = inverse ? -1.0 : 1.0;
+
+	// Butterflies
+	for (uint32_t len = 2; len <= n; len <<= 1) {
+
+		uint32_t half = len >> 1;
+		uint32_t step = twiddle_stride * (n / len);
+
+		for (int k = 0; k < half; k++) {
+
+			float wr = twiddle[2 * k * step];
+			float wi = sign * twiddle[2 * k * step + 1];
+
+			for (int i = k; i < n; i += len) {
+				float * a = &data[2 * i];
+				float * b = &data[2 * (i + half)];
+				float tr = b[0] * wr - b[1] * wi;
+				float ti = b[0] * wi + b[1] * wr;
+				b[0] = a[0] - tr;
+				b[1] = a[1] - ti;
+				a[0] += tr;
+				a[1] += ti;
+			}
+		}
+	}
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _FFT_H
+#define _FFT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+#define FFT_MIN_SIZE    (8)
+#define FFT_MAX_SIZE    (8192)
+
+// Result enumerations
+typedef enum {
+	FFT_OK,
+	FFT_INVALID_INSTANCE_POINTER,
+	FFT_INVALID_SIZE,
+	FFT_INVALID_TWIDDLE_POINTER
+} RESULT_FFT;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	uint32_t size;
+
+	// size floats: e^(-2*pi*i*k/size) for k = 0 - size/2-1 as (re, im) pairs
+	float * twiddle;
+
+} FFT_REAL;
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+RESULT_FFT fft_real_setup(FFT_REAL * c, uint32_t size, float * twiddle_memory);
+
+void fft_real_forward(FFT_REAL * c, float * input, float * output);
+
+void fft_real_inverse(FFT_REAL * c, float * input, float * output);
+
+void fft_packed_cmac(float * acc, float * x, float * h, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FFT_H
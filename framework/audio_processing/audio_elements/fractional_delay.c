@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * A fractional delay is a delay line which can be read between samples, for
+ * modulated delay effects such as chorus, vibrato and flanging.
+ *
+ * The delay line is provided by the caller and can be any length, so long
+ * delays (e.g. a chorus with 20 - 30 ms of delay plus modulation) can be
+ * placed in SDRAM rather than taking up L1 memory in the instance.
+ *
+ * The delay in samples is delay + mod_depth * mod[n], where mod is a block of
+ * modulation (-1.0 -> 1.0) supplied to fractional_delay_read(), typically
+ * from oscillator_lfo_block().  Several delays can share one block of LFO.
+ * If mod is NULL, the delay is fixed.  A negative depth inverts the
+ * modulation, so e.g. the two sides of a stereo flanger can sweep in opposite
+ * directions from the same LFO.
+ *
+ * Three interpolators are available, chosen at setup:
+ *
+ *   Linear - cheapest, but acts as a low-pass filter which changes as the
+ *   delay is modulated (-6 dB at Nyquist half way between samples).
+ *
+ *   Lagrange-3 - third-order polynomial through four samples.  Much flatter
+ *   response than linear for about twice the cost.  Good default for chorus
+ *   and vibrato.
+ *
+ *   Allpass - first-order allpass (Thiran) interpolator.  The magnitude
+ *   response is flat, but the interpolator has state, so it's best suited to
+ *   fixed or slowly changing delays (e.g. tuning a delay in a feedback loop).
+ *
+ * The output is the delayed signal only.  The input to the delay line is
+ * audio_in + feedback * output.
+ */
+#include <math.h>
+#include <stdlib.h>
+
+#include "fractional_delay.h"
+
+// Min/max limits and other constants
+#define FRACTIONAL_DELAY_FEEDBACK_MIN   (-0.99)
+#define FRACTIONAL_DELAY_FEEDBACK_MAX   (0.99)
+
+// The interpolators read up to two samples either side of the delay
+#define FRACTIONAL_DELAY_MIN_DELAY      (3.0)
+#define FRACTIONAL_DELAY_GUARD          (3)
+
+// Below this fraction the allpass reads one sample later to stay away from its pole at -1
+#define FRACTIONAL_DELAY_ALLPASS_MIN    (0.1)
+
+// Static function prototypes
+static inline int32_t fractional_delay_position(FRACTIONAL_DELAY * c,
+		uint32_t write_index, float delay, float * frac);
+
+/**
+ * @brief Initializes instance of a fractional delay
+ *
+ * @param c Pointer to instance structure
+ * @param delay_line Pointer to the delay line memory
+ * @param delay_line_length Length of the delay line in samples
+ * @param delay_samples Center delay in samples
+ * @param mod_depth_samples Modulation depth in samples (negative inverts the modulation)
+ * @param feedback Feedback from output to input (-0.99 -> 0.99)
+ * @param interpolation Interpolator (see enumeration)
+ * @return Fractional delay result (enumeration)
+ */
+RESULT_FRACTIONAL_DELAY fractional_delay_setup(FRACTIONAL_DELAY * c,
+		float * delay_line, uint32_t delay_line_length, float delay_samples,
+		float mod_depth_samples, float feedback,
+		FRACTIONAL_DELAY_INTERPOLATION interpolation) {
+
+	if (c == NULL) {
+		return FRACTIONAL_DELAY_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	if (delay_line == NULL
+			|| delay_line_length
+					< FRACTIONAL_DELAY_MIN_DELAY + FRACTIONAL_DELAY_GUARD) {
+		return FRACTIONAL_DELAY_INVALID_DELAY_LINE;
+	}
+
+	float max_delay = (float) (delay_line_length - FRACTIONAL_DELAY_GUARD);
+	float depth = fabsf(mod_depth_samples);
+
+	if (delay_samples - depth < FRACTIONAL_DELAY_MIN_DELAY
+			|| delay_samples + depth > max_delay) {
+		return FRACTIONAL_DELAY_INVALID_DELAY;
+	}
+
+	if (feedback < FRACTIONAL_DELAY_FEEDBACK_MIN
+			|| feedback > FRACTIONAL_DELAY_FEEDBACK_MAX) {
+		return FRACTIONAL_DELAY_INVALID_FEEDBACK;
+	}
+
+	if (interpolation != FRACTIONAL_DELAY_LINEAR
+			&& interpolation != FRACTIONAL_DELAY_LAGRANGE3
+			&& interpolation != FRACTIONAL_DELAY_ALLPASS) {
+		return FRACTIONAL_DELAY_INVALID_INTERPOLATION;
+	}
+
+	c->delay_line = delay_line;
+	c->delay_line_length = delay_line_length;
+	c->write_index = 0;
+	c->interpolation = interpolation;
+	c->delay = delay_samples;
+	c->mod_depth = mod_depth_samples;
+	c->feedback = feedback;
+	c->allpass_last = 0.0;
+
+	for (int i = 0; i < delay_line_length; i++) {
+		delay_line[i] = 0.0;
+	}
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return FRACTIONAL_DELAY_OK;
+}
+
+/**
+ * @brief Modify the center delay
+ *
+ * If the delay doesn't leave room for the modulation depth within the delay
+ * line, it is clipped to the nearest delay that does.  This function will
+ * return a value indicating an invalid input parameter was supplied but the
+ * effect will continue to operate.
+ *
+ * @param c Pointer to instance structure
+ * @param delay_samples New center delay in samples
+ * @return Fractional delay result (enumeration)
+ */
+RESULT_FRACTIONAL_DELAY fractional_delay_modify_delay(FRACTIONAL_DELAY * c,
+		float delay_samples) {
+
+	if (c == NULL || !c->initialized) {
+		return FRACTIONAL_DELAY_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_FRACTIONAL_DELAY res = FRACTIONAL_DELAY_OK;
+
+	float depth = fabsf(c->mod_depth);
+	float min_delay = FRACTIONAL_DELAY_MIN_DELAY + depth;
+	float max_delay = (float) (c->delay_line_length - FRACTIONAL_DELAY_GUARD)
+			- depth;
+
+	if (delay_samples < min_delay) {
+		delay_samples = min_delay;
+		res = FRACTIONAL_DELAY_INVALID_DELAY;
+	} else if (delay_samples > max_delay) {
+		delay_samples = max_delay;
+		res = FRACTIONAL_DELAY_INVALID_DELAY;
+	}
+
+	c->delay = delay_samples;
+
+	return res;
+}
+
+/**
+ * @brief Modify the modulation depth
+ *
+ * If the depth would take the delay outside of the delay line, it is clipped
+ * to the largest depth that fits around the current center delay.
+ *
+ * @param c Pointer to instance structure
+ * @param mod_depth_samples New modulation depth in samples (negative inverts the modulation)
+ * @return Fractional delay result (enumeration)
+ */
+RESULT_FRACTIONAL_DELAY fractional_delay_modify_depth(FRACTIONAL_DELAY * c,
+		float mod_depth_samples) {
+
+	if (c == NULL || !c->initialized) {
+		return FRACTIONAL_DELAY_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_FRACTIONAL_DELAY res = FRACTIONAL_DELAY_OK;
+
+	float max_depth = c->delay - FRACTIONAL_DELAY_MIN_DELAY;
+	float max_depth_long = (float) (c->delay_line_length
+			- FRACTIONAL_DELAY_GUARD) - c->delay;
+	if (max_depth_long < max_depth) {
+		max_depth = max_depth_long;
+	}
+
+	if (mod_depth_samples < -max_depth) {
+		mod_depth_samples = -max_depth;
+		res = FRACTIONAL_DELAY_INVALID_DEPTH;
+	} else if (mod_depth_samples > max_depth) {
+		mod_depth_samples = max_depth;
+		res = FRACTIONAL_DELAY_INVALID_DEPTH;
+	}
+
+	c->mod_depth = mod_depth_samples;
+
+	return res;
+}
+
+/**
+ * @brief Modify the feedback
+ *
+ * @param c Pointer to instance structure
+ * @param feedback New feedback (-0.99 -> 0.99)
+ * @return Fractional delay result (enumeration)
+ */
+RESULT_FRACTIONAL_DELAY fractional_delay_modify_feedback(FRACTIONAL_DELAY * c,
+		float feedback) {
+
+	if (c == NULL || !c->initialized) {
+		return FRACTIONAL_DELAY_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_FRACTIONAL_DELAY res = FRACTIONAL_DELAY_OK;
+
+	if (feedback < FRACTIONAL_DELAY_FEEDBACK_MIN) {
+		feedback = FRACTIONAL_DELAY_FEEDBACK_MIN;
+		res = FRACTIONAL_DELAY_INVALID_FEEDBACK;
+	} else if (feedback > FRACTIONAL_DELAY_FEEDBACK_MAX) {
+		feedback = FRACTIONAL_DELAY_FEEDBACK_MAX;
+		res = FRACTIONAL_DELAY_INVALID_FEEDBACK;
+	}
+
+	c->feedback = feedback;
+
+	return res;
+}
+
+/**
+ * @brief Apply the delay to a block of audio data
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point output buffer (mono), delayed only
+ * @param mod Pointer to a block of modulation (-1.0 -> 1.0), or NULL for none
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void fractional_delay_read(FRACTIONAL_DELAY * c, float * audio_in,
+		float * audio_out, float * mod, uint32_t audio_block_size) {
+
+	// If this instance hasn't been properly initialized, pass audio through
+	if (c == NULL || !c->initialized) {
+		for (int i = 0; i < audio_block_size; i++) {
+			audio_out[i] = audio_in[i];
+		}
+		return;
+	}
+
+	float * buf = c->delay_line;
+	uint32_t len = c->delay_line_length;
+	uint32_t w = c->write_index;
+	float delay = c->delay;
+	float depth = (mod == NULL) ? 0.0 : c->mod_depth;
+	float feedback = c->feedback;
+
+	switch (c->interpolation) {
+
+	case FRACTIONAL_DELAY_LINEAR:
+		for (int i = 0; i < audio_block_size; i++) {
+
+			float d = (mod == NULL) ? delay : delay + depth * mod[i];
+			float t;
+			int32_t i0 = fractional_delay_position(c, w, d, &t);
+			int32_t i1 = (i0 + 1 == len) ? 0 : i0 + 1;
+
+			float x0 = buf[i0];
+			float y = x0 + t * (buf[i1] - x0);
+
+			buf[w] = audio_in[i] + feedback * y;
+			audio_out[i] = y;
+			if (++w >= len) {
+				w = 0;
+			}
+		}
+		break;
+
+	case FRACTIONAL_DELAY_LAGRANGE3:
+		for (int i = 0; i < audio_block_size; i++) {
+
+			float d = (mod == NULL) ? delay : delay + depth * mod[i];
+			float t;
+			int32_t i0 = fractional_delay_position(c, w, d, &t);
+			int32_t im = (i0 == 0) ? len - 1 : i0 - 1;
+			int32_t i1 = (i0 + 1 == len) ? 0 : i0 + 1;
+			int32_t i2 = (i1 + 1 == len) ? 0 : i1 + 1;
+
+			// Lagrange basis through the samples at -1, 0, 1 and 2
+			float tp1 = t + 1.0;
+			float tm1 = t - 1.0;
+			float tm2 = t - 2.0;
+			float h_m = -t * tm1 * tm2 * (1.0 / 6.0);
+			float h_0 = tp1 * tm1 * tm2 * 0.5;
+			float h_1 = -tp1 * t * tm2 * 0.5;
+			float h_2 = tp1 * t * tm1 * (1.0 / 6.0);
+
+			float y = h_m * buf[im] + h_0 * buf[i0] + h_1 * buf[i1]
+					+ h_2 * buf[i2];
+
+			buf[w] = audio_in[i] + feedback * y;
+			audio_out[i] = y;
+			if (++w >= len) {
+				w = 0;
+			}
+		}
+		break;
+
+	case FRACTIONAL_DELAY_ALLPASS: {
+		float y_last = c->allpass_last;
+		for (int i = 0; i < audio_block_size; i++) {
+
+			float d = (mod == NULL) ? delay : delay + depth * mod[i];
+			float t;
+			int32_t i0 = fractional_delay_position(c, w, d, &t);
+			int32_t i1 = (i0 + 1 == len) ? 0 : i0 + 1;
+
+			// t is the distance past buf[i0], the allpass delays buf[i1] by 1 - t
+			float lo = buf[i0];
+			float hi = buf[i1];
+			if (t > 1.0 - FRACTIONAL_DELAY_ALLPASS_MIN) {
+				int32_t i2 = (i1 + 1 == len) ? 0 : i1 + 1;
+				lo = hi;
+				hi = buf[i2];
+				t -= 1.0;
+			}
+			float eta = t / (2.0 - t);
+
+			float y = eta * (hi - y_last) + lo;
+			y_last = y;
+
+			buf[w] = audio_in[i] + feedback * y;
+			audio_out[i] = y;
+			if (++w >= len) {
+				w = 0;
+			}
+		}
+		c->allpass_last = y_last;
+		break;
+	}
+	}
+
+	c->write_index = w;
+}
+
+/**
+ * @brief Finds the samples either side of a fractional delay
+ *
+ * @param c Pointer to instance structure
+ * @param write_index Index the current input sample will be written to
+ * @param delay Delay in samples
+ * @param frac Returns the position past the returned sample (0.0 -> 1.0)
+ * @return Index of the sample before the delayed position (the older one)
+ */
+static inline int32_t fractional_delay_position(FRACTIONAL_DELAY * c,
+		uint32_t write_index, float delay, float * frac) {
+
+	float max_delay = (float) (c->delay_line_length - FRACTIONAL_DELAY_GUARD);
+	if (delay < FRACTIONAL_DELAY_MIN_DELAY) {
+		delay = FRACTIONAL_DELAY_MIN_DELAY;
+	} else if (delay > max_delay) {
+		delay = max_delay;
+	}
+
+	// Split into integer and fraction before indexing, so long delay lines
+	// don't lose precision in the fraction
+	int32_t whole = (int32_t) delay;
+	*frac = 1.0 - (delay - (float) whole);
+
+	int32_t index = (int32_t) write_index - whole - 1;
+	if (index < 0) {
+		index += c->delay_line_length;
+	}
+	return index;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _FRACTIONAL_DELAY_H
+#define _FRACTIONAL_DELAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Interpolation used to read between samples
+typedef enum {
+	FRACTIONAL_DELAY_LINEAR,
+	FRACTIONAL_DELAY_LAGRANGE3,
+	FRACTIONAL_DELAY_ALLPASS
+} FRACTIONAL_DELAY_INTERPOLATION;
+
+// Result enumerations
+typedef enum {
+	FRACTIONAL_DELAY_OK,
+	FRACTIONAL_DELAY_INVALID_INSTANCE_POINTER,
+	FRACTIONAL_DELAY_INVALID_DELAY_LINE,
+	FRACTIONAL_DELAY_INVALID_DELAY,
+	FRACTIONAL_DELAY_INVALID_DEPTH,
+	FRACTIONAL_DELAY_INVALID_FEEDBACK,
+	FRACTIONAL_DELAY_INVALID_INTERPOLATION
+} RESULT_FRACTIONAL_DELAY;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	// Delay line provided by the caller (can be in SDRAM)
+	float * delay_line;
+	uint32_t delay_line_length;
+	uint32_t write_index;
+
+	FRACTIONAL_DELAY_INTERPOLATION interpolation;
+
+	// Center delay and modulation depth in samples
+	float delay;
+	float mod_depth;
+	float feedback;
+
+	// Previous output of the allpass interpolator
+	float allpass_last;
+
+} FRACTIONAL_DELAY;
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+RESULT_FRACTIONAL_DELAY fractional_delay_setup(FRACTIONAL_DELAY * c,
+		float * delay_line, uint32_t delay_line_length, float delay_samples,
+		float mod_depth_samples, float feedback,
+		FRACTIONAL_DELAY_INTERPOLATION interpolation);
+
+RESULT_FRACTIONAL_DELAY fractional_delay_modify_delay(FRACTIONAL_DELAY * c,
+		float delay_samples);
+
+RESULT_FRACTIONAL_DELAY fractional_delay_modify_depth(FRACTIONAL_DELAY * c,
+		float mod_depth_samples);
+
+RESULT_FRACTIONAL_DELAY fractional_delay_modify_feedback(FRACTIONAL_DELAY * c,
+		float feedback);
+
+void fractional_delay_read(FRACTIONAL_DELAY * c, float * audio_in,
+		float * audio_out, float * mod, uint32_t audio_block_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FRACTIONAL_DELAY_H
@@ -6,6 +6,7 @@
 #include <stddef.h>
 
 #include "integer_delay_lpf.h"
+#include "circular_buffer.h"
 
 // Min/max limits and other constants
 #define DELAY_MIN_FEEDBACK      (-1.0)
@@ -33,13 +34,70 @@ RESULT_DELAY delay_setup(DELAY_LPF * c, float * delay_buffer,
 		uint32_t delay_buffer_size, uint32_t delay_initial_length,
 		float feedback, float feedthrough, float a_coeff) {
 
+	return delay_setup_multichannel(c, 1, delay_buffer, delay_buffer_size,
+			delay_initial_length, NULL, feedback, feedthrough, a_coeff);
+}
+
+/**
+ * @brief Initializes instance of a multichannel digital delay effect
+ *
+ * All channels share one write pointer, one delay length (and its length
+ * ramp), the feedback, feedthrough and dampening coefficients.  Each channel
+ * has its own delay line and dampening filter state.  A channel can be given
+ * a fixed offset from the shared delay length (e.g. to decorrelate the left
+ * and right sides of a reverb), which is kept as the length is modified.
+ *
+ * The delay buffer must hold num_channels * delay_buffer_size floats.
+ *
+ * @param c Pointer to instance structure
+ * @param num_channels Number of channels (1 - DELAY_LPF_MAX_CHANNELS)
+ * @param delay_buffer Pointer to delay line buffer
+ * @param delay_buffer_size Size of each channel's delay line in floating point words
+ * @param delay_initial_length Initial length of delay (location of read pointer)
+ * @param channel_offsets Array of num_channels delay offsets in samples, or NULL
+ * @param feedback Amount of feedback (-1.0->1.0)
+ * @param feedthrough Amount of feedthrough (-1.0->1.0)
+ * @param a_coeff Dampening coefficent - set to 0.0 for no dampening
+ * @return Delay result (enumeration)
+ */
+RESULT_DELAY delay_setup_multichannel(DELAY_LPF * c, uint32_t num_channels,
+		float * delay_buffer, uint32_t delay_buffer_size,
+		uint32_t delay_initial_length, int32_t * channel_offsets,
+		float feedback, float feedthrough, float a_coeff) {
+
 	if (c == NULL) {
 		return DELAY_INVALID_INSTANCE_POINTER;
 	}
 
 	c->initialized = false;
+	c->num_channels = 0;
 
-	if (delay_initial_length > delay_buffer_size) {
+	if (num_channels < 1 || num_channels > DELAY_LPF_MAX_CHANNELS) {
+		return DELAY_INVALID_NUM_CHANNELS;
+	}
+	c->num_channels = num_channels;
+
+	// Range of shared lengths that keeps every channel within its delay line
+	int32_t min_offset = 0;
+	int32_t max_offset = 0;
+	for (int ch = 0; ch < num_channels; ch++) {
+		int32_t offset = (channel_offsets == NULL) ? 0 : channel_offsets[ch];
+		if (offset < min_offset) {
+			min_offset = offset;
+		}
+		if (offset > max_offset) {
+			max_offset = offset;
+		}
+		c->tap_offset[ch] = offset;
+	}
+	if (max_offset - min_offset > (int32_t) delay_buffer_size) {
+		return DELAY_LENGTH_EXCEEDS_BUF_SIZE;
+	}
+	c->min_length = -min_offset;
+	c->max_length = delay_buffer_size - max_offset;
+
+	if (delay_initial_length < c->min_length
+			|| delay_initial_length > c->max_length) {
 		return DELAY_LENGTH_EXCEEDS_BUF_SIZE;
 	}
 
@@ -63,14 +121,15 @@ RESULT_DELAY delay_setup(DELAY_LPF * c, float * delay_buffer,
 	}
 	c->feedthrough = feedthrough;
 
-	// Zero delay line
-	for (int i = 0; i < delay_buffer_size; i++) {
+	// Zero delay lines
+	for (int i = 0; i < num_channels * delay_buffer_size; i++) {
 		delay_buffer[i] = 0.0;
 	}
 
 	c->read_tap = delay_initial_length;
 	c->read_tap_f = (float) c->read_tap;
 	c->target_read_tap = delay_initial_length;
+	c->read_tap_steps = 0;
 
 	c->write_ptr = 0;
 
@@ -80,7 +139,9 @@ RESULT_DELAY delay_setup(DELAY_LPF * c, float * delay_buffer,
 	}
 
 	c->lpf_a = a_coeff;
-	c->lpf_hist = 0.0;
+	for (int ch = 0; ch < num_channels; ch++) {
+		c->lpf_hist[ch] = 0.0;
+	}
 
 	// Instance was successfully initialized
 	c->initialized = true;
@@ -139,6 +200,9 @@ RESULT_DELAY delay_modify_dampening(DELAY_LPF * c, float coeff_new) {
  * and apply that value.  This function will return a flag indicating an
  * invalid input parameter was supplied but it won't disable the effect.
  *
+ * For multichannel instances, the length applies to the shared read tap; the
+ * per-channel offsets are added to it.
+ *
  * @param c Pointer to instance structure
  * @param delay_length_new New delay line length
  *
@@ -154,8 +218,11 @@ RESULT_DELAY delay_modify_length(DELAY_LPF * c, uint32_t delay_length_new) {
 	 * invalid input parameter was supplied but it won't disable the effect.
 	 */
 	uint32_t delay_length;
-	if (delay_length_new > c->delay_line_size) {
-		delay_length = c->delay_line_size;
+	if (delay_length_new > c->max_length) {
+		delay_length = c->max_length;
+		res = DELAY_LENGTH_EXCEEDS_BUF_SIZE;
+	} else if (delay_length_new < c->min_length) {
+		delay_length = c->min_length;
 		res = DELAY_LENGTH_EXCEEDS_BUF_SIZE;
 	} else {
 		delay_length = delay_length_new;
@@ -251,76 +318,134 @@ RESULT_DELAY delay_modify_feedthrough(DELAY_LPF * c, float feedthrough_new) {
  * @param audio_out Pointer to floating point audio output buffer (mono)
  * @param audio_block_size The number of floating-point words to process
  */
-#pragma optimize_for_speed
 void delay_read(DELAY_LPF * c, float * audio_in, float * audio_out,
 		uint32_t audio_block_size) {
 
+	delay_read_multichannel(c, &audio_in, &audio_out, audio_block_size);
+}
+
+/**
+ * @brief Apply effect/process to a block of multichannel audio data
+ *
+ * While the delay length is steady and at least one block long on every
+ * channel, each channel is processed in one pass over a scratch copy of the
+ * delayed samples (see circular_buffer.c).  While the delay length is being
+ * ramped, or for delays shorter than a block, the delay lines are processed
+ * sample by sample with all channels stepping the same read tap.
+ *
+ * Input and output buffers may be the same (in-place processing).
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Array of num_channels pointers to audio input buffers
+ * @param audio_out Array of num_channels pointers to audio output buffers
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void delay_read_multichannel(DELAY_LPF * c, float ** audio_in,
+		float ** audio_out, uint32_t audio_block_size) {
+
 	// If this instance hasn't been properly initialized, pass audio through
 	if (c == NULL || !c->initialized) {
-		for (int i = 0; i < audio_block_size; i++) {
-			audio_out[i] = audio_in[i];
+		if (c != NULL) {
+			for (int ch = 0; ch < c->num_channels; ch++) {
+				for (int i = 0; i < audio_block_size; i++) {
+					audio_out[ch][i] = audio_in[ch][i];
+				}
+			}
 		}
+		return;
 	}
 
-	int i;
-
-	float * buffer = c->delay_line;
-	int len = c->delay_line_size;
+	uint32_t num_channels = c->num_channels;
+	uint32_t len = c->delay_line_size;
 	float feedback_amt = c->feedback;
 	float feedthrough_amt = c->feedthrough;
-
-	// Intermediate values
-	float out, in, fb;
-	float lpf_hist = c->lpf_hist;
 	float lpf_a = c->lpf_a;
-
-	// Set initial taps
-	int write_ptr = c->write_ptr;
-	int read_tap = write_ptr - c->read_tap;
-	if (read_tap < 0) {
-		read_tap += len;
+	uint32_t write_ptr = c->write_ptr;
+
+	// Shortest delay of any channel; a read tap of 0 reads the oldest sample,
+	// i.e. a full buffer of delay
+	uint32_t delay_length = len;
+	for (int ch = 0; ch < num_channels; ch++) {
+		uint32_t tap = c->read_tap + c->tap_offset[ch];
+		if (tap != 0 && tap < delay_length) {
+			delay_length = tap;
+		}
 	}
 
-	if (c->lpf_a != 0.0) {
-		// Perform delay with LPF (LBCF)
-		for (i = 0; i < audio_block_size; i++) {
+	if (c->read_tap_steps == 0 && delay_length >= audio_block_size
+			&& audio_block_size <= MAX_AUDIO_BLOCK_SIZE) {
 
-			audio_out[i] = (audio_in[i] * c->feedthrough) + buffer[read_tap];
-			out = audio_in[i] + buffer[read_tap];
-			buffer[write_ptr] = lpf_hist;
-			lpf_hist += lpf_a * (out * c->feedback - lpf_hist);
+		float delayed[MAX_AUDIO_BLOCK_SIZE];
+		float feedback[MAX_AUDIO_BLOCK_SIZE];
 
-			write_ptr++;
-			if (write_ptr >= len) {
-				write_ptr = 0;
-			}
+		for (int ch = 0; ch < num_channels; ch++) {
 
-			// If we are adjusting the delay length, do it here
-			if (c->read_tap_steps) {
-				c->read_tap_steps--;
-				if (c->read_tap_steps == 0) {
-					c->read_tap = c->target_read_tap;
-					c->read_tap_f = (float) c->read_tap;
-				} else {
-					c->read_tap_f += c->read_tap_inc;
-					c->read_tap = (uint32_t) c->read_tap_f;
+			float * buffer = c->delay_line + ch * len;
+			float * in = audio_in[ch];
+			float * out = audio_out[ch];
+
+			uint32_t read_tap = circular_buffer_wrap(
+					(int32_t) write_ptr - (c->read_tap + c->tap_offset[ch]),
+					len);
+			circular_buffer_read(buffer, len, read_tap, delayed,
+					audio_block_size);
+
+			if (lpf_a != 0.0) {
+				// Delay with LPF (LBCF), the filter is recursive so stays scalar
+				float lpf_hist = c->lpf_hist[ch];
+				for (int i = 0; i < audio_block_size; i++) {
+					feedback[i] = lpf_hist;
+					float sum = in[i] + delayed[i];
+					lpf_hist += lpf_a * (sum * feedback_amt - lpf_hist);
+				}
+				c->lpf_hist[ch] = lpf_hist;
+			} else {
+				// Standard delay
+				for (int i = 0; i < audio_block_size; i++) {
+					feedback[i] = (in[i] + delayed[i]) * feedback_amt;
 				}
 			}
-			read_tap = write_ptr - c->read_tap;
-			if (read_tap < 0) {
-				read_tap += len;
+
+			for (int i = 0; i < audio_block_size; i++) {
+				out[i] = (in[i] * feedthrough_amt) + delayed[i];
 			}
+
+			circular_buffer_write(buffer, len, write_ptr, feedback,
+					audio_block_size);
 		}
-		c->lpf_hist = lpf_hist;
+
+		write_ptr = circular_buffer_wrap(write_ptr + audio_block_size, len);
+
 	} else {
-		// Perform standard delay
-		for (i = 0; i < audio_block_size; i++) {
 
-			audio_out[i] = (audio_in[i] * c->feedthrough) + buffer[read_tap];
-			out = audio_in[i] + buffer[read_tap];
+		for (int i = 0; i < audio_block_size; i++) {
 
-			fb = out * c->feedback;
-			buffer[write_ptr] = fb;
+			for (int ch = 0; ch < num_channels; ch++) {
+
+				float * buffer = c->delay_line + ch * len;
+
+				int32_t read_tap = (int32_t) write_ptr
+						- (c->read_tap + c->tap_offset[ch]);
+				if (read_tap < 0) {
+					read_tap += len;
+				}
+
+				float in = audio_in[ch][i];
+				float delayed = buffer[read_tap];
+				float sum = in + delayed;
+				audio_out[ch][i] = (in * feedthrough_amt) + delayed;
+
+				if (lpf_a != 0.0) {
+					// Perform delay with LPF (LBCF)
+					buffer[write_ptr] = c->lpf_hist[ch];
+					c->lpf_hist[ch] += lpf_a
+							* (sum * feedback_amt - c->lpf_hist[ch]);
+				} else {
+					// Perform standard delay
+					buffer[write_ptr] = sum * feedback_amt;
+				}
+			}
 
 			write_ptr++;
 			if (write_ptr >= len) {
@@ -338,16 +463,10 @@ void delay_read(DELAY_LPF * c, float * audio_in, float * audio_out,
 					c->read_tap = (uint32_t) c->read_tap_f;
 				}
 			}
-			read_tap = write_ptr - c->read_tap;
-			if (read_tap < 0) {
-				read_tap += len;
-			}
-
 		}
 	}
 
-	// Store index back into instance struct
+	// Store state back into instance struct
 	c->write_ptr = write_ptr;
 
 }
-
@@ -12,6 +12,9 @@
 
 #include "audio_elements_common.h"
 
+// Maximum number of channels sharing one delay instance
+#define DELAY_LPF_MAX_CHANNELS      (16)
+
 // Result enumerations
 typedef enum {
 	DELAY_OK,
@@ -20,7 +23,8 @@ typedef enum {
 	DELAY_LENGTH_EXCEEDS_BUF_SIZE,
 	DELAY_INVALID_FEEDBACK,
 	DELAY_INVALID_FEEDTHROUGH,
-	DELAY_INVALID_DAMPENING_COEFF
+	DELAY_INVALID_DAMPENING_COEFF,
+	DELAY_INVALID_NUM_CHANNELS
 } RESULT_DELAY;
 
 // C struct with parameters and state information
@@ -28,6 +32,9 @@ typedef struct {
 
 	bool initialized;
 
+	uint32_t num_channels;
+
+	// One delay line of delay_line_size floats per channel, back to back
 	float * delay_line;
 	uint32_t delay_line_size;
 	uint32_t write_ptr;
@@ -37,10 +44,15 @@ typedef struct {
 	float read_tap_inc;
 	uint32_t read_tap_steps;
 
+	// Per-channel offsets from the shared delay length
+	int32_t tap_offset[DELAY_LPF_MAX_CHANNELS];
+	uint32_t min_length;
+	uint32_t max_length;
+
 	float feedback;
 	float feedthrough;
 	float lpf_a;
-	float lpf_hist;
+	float lpf_hist[DELAY_LPF_MAX_CHANNELS];
 } DELAY_LPF;
 
 #if __cplusplus
@@ -51,6 +63,11 @@ RESULT_DELAY delay_setup(DELAY_LPF * c, float * delay_buffer,
 		uint32_t delay_buffer_size, uint32_t delay_initial_length,
 		float feedback, float feedthrough, float a_coeff);
 
+RESULT_DELAY delay_setup_multichannel(DELAY_LPF * c, uint32_t num_channels,
+		float * delay_buffer, uint32_t delay_buffer_size,
+		uint32_t delay_initial_length, int32_t * channel_offsets,
+		float feedback, float feedthrough, float a_coeff);
+
 RESULT_DELAY delay_modify_dampening(DELAY_LPF * c, float coeff);
 RESULT_DELAY delay_modify_length(DELAY_LPF * c, uint32_t new_delay_length);
 RESULT_DELAY delay_modify_feedback(DELAY_LPF * c, float new_feedback);
@@ -59,6 +76,9 @@ RESULT_DELAY delay_modify_feedthrough(DELAY_LPF * c, float new_feedthrough);
 void delay_read(DELAY_LPF * c, float * input, float * output,
 		uint32_t audio_block_size);
 
+void delay_read_multichannel(DELAY_LPF * c, float ** audio_in,
+		float ** audio_out, uint32_t audio_block_size);
+
 #if __cplusplus
 }
 #endif
@@ -12,6 +12,11 @@
 #include <stddef.h>
 
 #include "integer_delay_multitap.h"
+#include "circular_buffer.h"
+
+// Static function prototypes
+static bool multitap_delay_block_safe(MULTITAP_DELAY * c,
+		uint32_t audio_block_size);
 
 /**
  * @brief Initializes instance of a multi-tap delay
@@ -29,17 +34,52 @@ RESULT_MT_DELAY multitap_delay_setup(MULTITAP_DELAY * c, float * delay_line,
 		uint32_t delay_line_size, uint32_t num_taps, uint32_t * tap_offsets,
 		float * tap_gains, float feedthrough) {
 
+	return multitap_delay_setup_multichannel(c, 1, delay_line, delay_line_size,
+			num_taps, tap_offsets, tap_gains, feedthrough);
+}
+
+/**
+ * @brief Initializes instance of a multichannel multi-tap delay
+ *
+ * All channels share the write index, the number of taps and the feedthrough.
+ * Each channel has its own delay line and its own row of tap offsets and
+ * gains, so the taps can differ between channels (e.g. a stereo echo).
+ *
+ * The delay line must hold num_channels * delay_line_size floats, and the
+ * tap arrays num_channels * num_taps entries (channel 0's taps first).
+ *
+ * @param c Pointer to instance structure
+ * @param num_channels Number of channels (1 - MULTITAP_DELAY_MAX_CHANNELS)
+ * @param delay_line Pointer to delay line
+ * @param delay_line_size Length of each channel's delay line in samples
+ * @param num_taps Number of delay line taps per channel
+ * @param tap_offsets A pointer to an array of offsets for each channel and tap
+ * @param tap_gains A pointer to an array of gains for each channel and tap
+ * @param feedthrough The clean mix of audio passed through
+ * @return Multitap delay result (enumeration)
+ */
+RESULT_MT_DELAY multitap_delay_setup_multichannel(MULTITAP_DELAY * c,
+		uint32_t num_channels, float * delay_line, uint32_t delay_line_size,
+		uint32_t num_taps, uint32_t * tap_offsets, float * tap_gains,
+		float feedthrough) {
+
 	if (c == NULL) {
 		return MT_DELAY_INVALID_INSTANCE_POINTER;
 	}
 	c->initialized = false;
+	c->num_channels = 0;
+
+	if (num_channels < 1 || num_channels > MULTITAP_DELAY_MAX_CHANNELS) {
+		return MT_DELAY_INVALID_NUM_CHANNELS;
+	}
+	c->num_channels = num_channels;
 
 	// Allocate our buffer
 	if (delay_line == NULL) {
 		return MT_DELAY_INVALID_DELAY_LINE_POINTER;
 	}
 
-	if (num_taps > MULTITAP_DELAY_MAX_TAPS) {
+	if (num_channels * num_taps > MULTITAP_DELAY_MAX_TAPS) {
 		return MT_DELAY_TOO_MANY_TAPS;
 	}
 
@@ -53,7 +93,7 @@ RESULT_MT_DELAY multitap_delay_setup(MULTITAP_DELAY * c, float * delay_line,
 	c->feedthrough = feedthrough;
 
 	c->num_taps = num_taps;
-	for (int tap = 0; tap < c->num_taps; tap++) {
+	for (int tap = 0; tap < num_channels * num_taps; tap++) {
 		if (tap_offsets[tap] > delay_line_size) {
 			return MT_DELAY_TAP_EXCEEDS_DELAY_LINE_LEN;
 		}
@@ -61,12 +101,10 @@ RESULT_MT_DELAY multitap_delay_setup(MULTITAP_DELAY * c, float * delay_line,
 		c->tap_gains[tap] = tap_gains[tap];
 	}
 
-	// Zero delay line
-	int i;
-	float * ptr;
-	ptr = c->delay_line;
-	for (i = 0; i < delay_line_size; i++)
+	// Zero delay lines
+	for (int i = 0; i < num_channels * delay_line_size; i++) {
 		delay_line[i] = 0.0;
+	}
 	c->index = 0;
 
 	c->initialized = true;
@@ -77,7 +115,7 @@ RESULT_MT_DELAY multitap_delay_setup(MULTITAP_DELAY * c, float * delay_line,
  * @brief Modify the tap sizes
  *
  * @param c Pointer to instance structure
- * @param new_tap_offsets Pointer to array with new offsets
+ * @param new_tap_offsets Pointer to array with new offsets (num_channels * num_taps)
  *
  * @return Multitap delay result (enumeration)
  */
@@ -86,7 +124,7 @@ RESULT_MT_DELAY multitap_delay_modify_taps(MULTITAP_DELAY * c,
 		uint32_t * new_tap_offsets) {
 
 	// Copy new taps into instance struct
-	for (int tap = 0; tap < c->num_taps; tap++) {
+	for (int tap = 0; tap < c->num_channels * c->num_taps; tap++) {
 		if (new_tap_offsets[tap] > c->delay_line_size) {
 			return MT_DELAY_TAP_EXCEEDS_DELAY_LINE_LEN;
 		}
@@ -105,36 +143,175 @@ RESULT_MT_DELAY multitap_delay_modify_taps(MULTITAP_DELAY * c,
  * @param audio_out Pointer to floating point audio output buffer (mono)
  * @param audio_block_size The number of floating-point words to process
  */
-#pragma optimize_for_speed
 void multitap_delay_read(MULTITAP_DELAY * c, float * audio_in,
 		float * audio_out, uint32_t audio_block_size) {
 
+	multitap_delay_read_multichannel(c, &audio_in, &audio_out,
+			audio_block_size);
+}
+
+/**
+ * @brief Apply effect/process to a block of multichannel audio data
+ *
+ * The input block is written to the delay line first and then each tap is
+ * accumulated into the output over the whole block (see circular_buffer.c).
+ * Taps longer than delay_line_size - audio_block_size would read samples
+ * that were just overwritten, so in that case the delay lines are processed
+ * sample by sample instead.
+ *
+ * Input and output buffers may be the same (in-place processing).
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Array of num_channels pointers to audio input buffers
+ * @param audio_out Array of num_channels pointers to audio output buffers
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void multitap_delay_read_multichannel(MULTITAP_DELAY * c, float ** audio_in,
+		float ** audio_out, uint32_t audio_block_size) {
+
 	// If this instance hasn't been properly initialized, pass audio through
 	if (c == NULL || !c->initialized) {
+		if (c != NULL) {
+			for (int ch = 0; ch < c->num_channels; ch++) {
+				for (int i = 0; i < audio_block_size; i++) {
+					audio_out[ch][i] = audio_in[ch][i];
+				}
+			}
+		}
+		return;
+	}
+
+	uint32_t num_channels = c->num_channels;
+	uint32_t len = c->delay_line_size;
+	uint32_t indx = c->index;
+	uint32_t num_taps = c->num_taps;
+	float feedthrough = c->feedthrough;
+
+	if (multitap_delay_block_safe(c, audio_block_size)) {
+
+		for (int ch = 0; ch < num_channels; ch++) {
+
+			float * delay_buffer = c->delay_line + ch * len;
+			uint32_t * tap_offsets = &c->tap_offsets[ch * num_taps];
+			float * tap_gains = &c->tap_gains[ch * num_taps];
+			float * in = audio_in[ch];
+			float * out = audio_out[ch];
+
+			circular_buffer_write(delay_buffer, len, indx, in,
+					audio_block_size);
+
+			for (int i = 0; i < audio_block_size; i++) {
+				out[i] = in[i] * feedthrough;
+			}
+
+			for (int tap = 0; tap < num_taps; tap++) {
+				uint32_t tap_pos = circular_buffer_wrap(
+						(int32_t) indx - (int32_t) tap_offsets[tap], len);
+				circular_buffer_read_mac(delay_buffer, len, tap_pos,
+						tap_gains[tap], out, audio_block_size);
+			}
+		}
+
+		indx = circular_buffer_wrap(indx + audio_block_size, len);
+
+	} else {
+
 		for (int i = 0; i < audio_block_size; i++) {
-			audio_out[i] = audio_in[i];
+
+			for (int ch = 0; ch < num_channels; ch++) {
+
+				float * delay_buffer = c->delay_line + ch * len;
+				uint32_t * tap_offsets = &c->tap_offsets[ch * num_taps];
+				float * tap_gains = &c->tap_gains[ch * num_taps];
+
+				float in = audio_in[ch][i];
+				delay_buffer[indx] = in;
+				float out = in * feedthrough;
+
+				for (int tap = 0; tap < num_taps; tap++) {
+					int32_t tap_pos = (int32_t) indx - tap_offsets[tap];
+					if (tap_pos < 0) {
+						tap_pos += len;
+					}
+					out += delay_buffer[tap_pos] * tap_gains[tap];
+				}
+				audio_out[ch][i] = out;
+			}
+
+			indx++;
+			if (indx >= len) {
+				indx = 0;
+			}
 		}
+	}
+
+	// Store index back into instance struct
+	c->index = indx;
+}
+
+/**
+ * @brief Apply effect/process to a block of audio data, with each tap written
+ * to its own output buffer
+ *
+ * Each output is the delayed signal scaled by the gain of its tap (the
+ * feedthrough is not included).  This is useful when the taps are panned or
+ * processed separately, for example as the early reflections of a reverb.
+ * Only the first channel of a multichannel instance is processed.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_outs Array of num_taps pointers to floating point output buffers
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void multitap_delay_read_isolated(MULTITAP_DELAY * c, float * audio_in,
+		float ** audio_outs, uint32_t audio_block_size) {
+
+	if (c == NULL || !c->initialized) {
 		return;
 	}
 
 	float * delay_buffer = c->delay_line;
+	uint32_t len = c->delay_line_size;
 	uint32_t indx = c->index;
+	uint32_t num_taps = c->num_taps;
+
+	if (multitap_delay_block_safe(c, audio_block_size)) {
 
-	for (int i = 0; i < audio_block_size; i++) {
-		delay_buffer[indx] = audio_in[i];
-		audio_out[i] = audio_in[i] * c->feedthrough;
+		circular_buffer_write(delay_buffer, len, indx, audio_in,
+				audio_block_size);
 
-		for (int tap = 0; tap < c->num_taps; tap++) {
-			int32_t tap_pos = c->tap_offsets[tap];
-			tap_pos = indx - tap_pos;
-			if (tap_pos < 0) {
-				tap_pos += c->delay_line_size;
+		for (int tap = 0; tap < num_taps; tap++) {
+			uint32_t tap_pos = circular_buffer_wrap(
+					(int32_t) indx - (int32_t) c->tap_offsets[tap], len);
+			float * out = audio_outs[tap];
+			for (int i = 0; i < audio_block_size; i++) {
+				out[i] = 0.0;
 			}
-			audio_out[i] += delay_buffer[tap_pos] * c->tap_gains[tap];
+			circular_buffer_read_mac(delay_buffer, len, tap_pos,
+					c->tap_gains[tap], out, audio_block_size);
 		}
-		indx++;
-		if (indx >= c->delay_line_size) {
-			indx = 0;
+
+		indx = circular_buffer_wrap(indx + audio_block_size, len);
+
+	} else {
+
+		for (int i = 0; i < audio_block_size; i++) {
+			delay_buffer[indx] = audio_in[i];
+
+			for (int tap = 0; tap < num_taps; tap++) {
+				int32_t tap_pos = (int32_t) indx - c->tap_offsets[tap];
+				if (tap_pos < 0) {
+					tap_pos += len;
+				}
+				audio_outs[tap][i] = delay_buffer[tap_pos] * c->tap_gains[tap];
+			}
+
+			indx++;
+			if (indx >= len) {
+				indx = 0;
+			}
 		}
 	}
 
@@ -142,3 +319,27 @@ void multitap_delay_read(MULTITAP_DELAY * c, float * audio_in,
 	c->index = indx;
 }
 
+/**
+ * @brief Checks whether a block can be written to the delay line before the
+ * taps are read
+ *
+ * @param c Pointer to instance structure
+ * @param audio_block_size The number of floating-point words to process
+ * @return true if no tap reaches into the part of the line about to be written
+ */
+static bool multitap_delay_block_safe(MULTITAP_DELAY * c,
+		uint32_t audio_block_size) {
+
+	if (audio_block_size > c->delay_line_size) {
+		return false;
+	}
+
+	uint32_t max_offset = c->delay_line_size - audio_block_size;
+	for (int tap = 0; tap < c->num_channels * c->num_taps; tap++) {
+		if (c->tap_offsets[tap] > max_offset) {
+			return false;
+		}
+	}
+
+	return true;
+}
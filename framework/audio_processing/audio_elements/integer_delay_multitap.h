@@ -13,6 +13,9 @@
 
 #define     MULTITAP_DELAY_MAX_TAPS (32)
 
+// Maximum number of channels sharing one delay instance
+#define     MULTITAP_DELAY_MAX_CHANNELS (16)
+
 // Result enumerations
 typedef enum {
 	MT_DELAY_OK,
@@ -20,13 +23,18 @@ typedef enum {
 	MT_DELAY_INVALID_DELAY_LINE_POINTER,
 	MT_DELAY_INVALID_TAPS_POINTER,
 	MT_DELAY_TOO_MANY_TAPS,
-	MT_DELAY_TAP_EXCEEDS_DELAY_LINE_LEN
+	MT_DELAY_TAP_EXCEEDS_DELAY_LINE_LEN,
+	MT_DELAY_INVALID_NUM_CHANNELS
 } RESULT_MT_DELAY;
 
 // C struct with parameters and state information
 typedef struct {
 	bool initialized;
 
+	uint32_t num_channels;
+
+	// One delay line per channel, back to back; taps are stored per channel
+	// (num_channels * num_taps <= MULTITAP_DELAY_MAX_TAPS)
 	float * delay_line;
 	uint32_t tap_offsets[MULTITAP_DELAY_MAX_TAPS];
 	float tap_gains[MULTITAP_DELAY_MAX_TAPS];
@@ -44,12 +52,20 @@ RESULT_MT_DELAY multitap_delay_setup(MULTITAP_DELAY * c, float * delay_line,
 		uint32_t delay_line_size, uint32_t num_taps, uint32_t * tap_offsets,
 		float * tap_gains, float feedthrough);
 
+RESULT_MT_DELAY multitap_delay_setup_multichannel(MULTITAP_DELAY * c,
+		uint32_t num_channels, float * delay_line, uint32_t delay_line_size,
+		uint32_t num_taps, uint32_t * tap_offsets, float * tap_gains,
+		float feedthrough);
+
 RESULT_MT_DELAY multitap_delay_modify_taps(MULTITAP_DELAY * c,
 		uint32_t * new_tap_offsets);
 
 void multitap_delay_read(MULTITAP_DELAY * c, float * audio_in,
 		float * audio_out, uint32_t audio_block_size);
 
+void multitap_delay_read_multichannel(MULTITAP_DELAY * c, float ** audio_in,
+		float ** audio_out, uint32_t audio_block_size);
+
 void multitap_delay_read_isolated(MULTITAP_DELAY * c, float * audio_in,
 		float ** audio_outs, uint32_t audio_block_size);
 
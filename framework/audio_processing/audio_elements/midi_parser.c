@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This element turns a stream of MIDI bytes (e.g. from the Audio Project Fin
+ * MIDI input via the UART driver) into complete channel voice messages.
+ *
+ * Running status is supported, so a keyboard can send a run of note on/off
+ * messages without repeating the status byte.  System real-time bytes (clock,
+ * start / stop, active sensing) can arrive in the middle of a message and are
+ * skipped without disturbing it.  System exclusive and other system common
+ * messages are ignored.
+ */
+
+#include <stdlib.h>
+
+#include "midi_parser.h"
+
+/**
+ * @brief Initializes instance of a MIDI parser
+ *
+ * @param c Pointer to instance structure
+ * @return MIDI parser result (enumeration)
+ */
+RESULT_MIDI_PARSER midi_parser_setup(MIDI_PARSER * c) {
+
+	if (c == NULL) {
+		return MIDI_PARSER_INVALID_INSTANCE_POINTER;
+	}
+
+	c->running_status = 0;
+	c->data_count = 0;
+	c->data_needed = 0;
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return MIDI_PARSER_OK;
+}
+
+/**
+ * @brief Feeds one received byte to the parser
+ *
+ * @param c Pointer to instance structure
+ * @param byte Received MIDI byte
+ * @param message Filled in when a message is complete
+ * @return true if byte completed a message
+ */
+bool midi_parser_read_byte(MIDI_PARSER * c, uint8_t byte,
+		MIDI_MESSAGE * message) {
+
+	if (c == NULL || !c->initialized) {
+		return false;
+	}
+
+	// System real-time, doesn't affect the message in progress
+	if (byte >= 0xF8) {
+		return false;
+	}
+
+	if (byte & 0x80) {
+
+		// Channel voice status byte
+		if (byte < 0xF0) {
+			c->running_status = byte;
+			c->data_count = 0;
+			uint8_t type = byte & 0xF0;
+			c->data_needed = (type == MIDI_PROGRAM_CHANGE
+					|| type == MIDI_CHANNEL_PRESSURE) ? 1 : 2;
+		}
+		// System common / exclusive, ignore data bytes until the next status
+		else {
+			c->running_status = 0;
+			c->data_count = 0;
+		}
+		return false;
+	}
+
+	// Data byte without a status (e.g. inside system exclusive)
+	if (c->running_status == 0) {
+		return false;
+	}
+
+	c->data[c->data_count++] = byte;
+	if (c->data_count < c->data_needed) {
+		return false;
+	}
+
+	message->status = c->running_status;
+	message->data1 = c->data[0];
+	message->data2 = (c->data_needed == 2) ? c->data[1] : 0;
+
+	// Keep the status for running status
+	c->data_count = 0;
+
+	return true;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _MIDI_PARSER_H
+#define _MIDI_PARSER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Channel voice message types (upper nibble of the status byte)
+#define MIDI_NOTE_OFF               (0x80)
+#define MIDI_NOTE_ON                (0x90)
+#define MIDI_POLY_PRESSURE          (0xA0)
+#define MIDI_CONTROL_CHANGE         (0xB0)
+#define MIDI_PROGRAM_CHANGE         (0xC0)
+#define MIDI_CHANNEL_PRESSURE       (0xD0)
+#define MIDI_PITCH_BEND             (0xE0)
+
+// Controller numbers used by the synth elements
+#define MIDI_CC_SUSTAIN_PEDAL       (64)
+#define MIDI_CC_ALL_SOUND_OFF       (120)
+#define MIDI_CC_ALL_NOTES_OFF       (123)
+
+// Result enumerations
+typedef enum {
+	MIDI_PARSER_OK, MIDI_PARSER_INVALID_INSTANCE_POINTER
+} RESULT_MIDI_PARSER;
+
+// A complete channel voice message
+typedef struct {
+	uint8_t status;
+	uint8_t data1;
+	uint8_t data2;
+} MIDI_MESSAGE;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	uint8_t running_status;
+	uint8_t data[2];
+	uint32_t data_count;
+	uint32_t data_needed;
+
+} MIDI_PARSER;
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+RESULT_MIDI_PARSER midi_parser_setup(MIDI_PARSER * c);
+
+bool midi_parser_read_byte(MIDI_PARSER * c, uint8_t byte,
+		MIDI_MESSAGE * message);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _MIDI_PARSER_H
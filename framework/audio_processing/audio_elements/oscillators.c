@@ -4,9 +4,34 @@
  * This file contains a number of basic oscillators that can be used for audio
  * synthesis or as parameters for various effects.
  *
+ * The single-value functions (oscillator_sine(), etc.) are naive waveforms
+ * evaluated at an arbitrary point in time.  Square, pulse and ramp waves have
+ * jumps which alias badly at audio rates, so for synthesis use the OSCILLATOR
+ * instance and oscillator_read(), which generates a block of band-limited
+ * audio using PolyBLEP: the jumps (and the corners of the triangle wave, via
+ * the integrated PolyBLAMP) are smoothed over the two samples around them by
+ * adding a short polynomial residual.
+ *
+ * oscillator_lfo_block() is a cheap block generator for low frequency
+ * modulation.  Aliasing doesn't matter at LFO rates, so the waveforms are
+ * naive, and the sine is evaluated every OSC_LFO_SEGMENT samples and linearly
+ * interpolated in between (up to ~90 Hz at 48 kHz, above which it's evaluated
+ * every sample).
+ *
  */
 #include <math.h>
+#include <stdlib.h>
 #include "oscillators.h"
+#include "fast_math.h"
+
+// Min/max limits and other constants
+#define OSC_MAX_PHASE_INC           (0.45)
+#define OSC_LFO_SEGMENT             (8)
+#define OSC_LFO_MAX_INTERP_INC      (1.0 / 512.0)
+
+// Static function prototypes
+static inline float osc_blep(float t, float dt);
+static inline float osc_blamp(float t, float dt);
 
 /**
  * @brief Basic sine wave generator
@@ -17,8 +42,7 @@
  */
 #pragma optimize_for_speed
 float oscillator_sine(float t) {
-	t = t - floor(t);
-	return sinf(PI2 * t);
+	return fast_sin_2pi(t);
 }
 
 /**
@@ -30,7 +54,7 @@ float oscillator_sine(float t) {
  */
 #pragma optimize_for_speed
 float oscillator_square(float t) {
-	t = t - floor(t);
+	t = fast_fractf(t);
 	return t > 0.5 ? 1.0 : -1.0;
 }
 
@@ -43,7 +67,7 @@ float oscillator_square(float t) {
  */
 #pragma optimize_for_speed
 float oscillator_triangle(float t) {
-	t = t - floor(t);
+	t = fast_fractf(t);
 
 	float result;
 	if (t < 0.5) {
@@ -64,7 +88,7 @@ float oscillator_triangle(float t) {
  */
 #pragma optimize_for_speed
 float oscillator_ramp(float t) {
-	t = t - floor(t);
+	t = fast_fractf(t);
 
 	return 2.0 * t - 1.0;
 }
@@ -78,6 +102,320 @@ float oscillator_ramp(float t) {
  */
 #pragma optimize_for_speed
 float oscillator_pulse(float t, float width) {
-	t = t - floor(t);
+	t = fast_fractf(t);
 	return width < t ? 1.0 : -1.0;
 }
+
+/**
+ * @brief Initializes instance of a band-limited oscillator
+ *
+ * @param c Pointer to instance structure
+ * @param waveform Waveform to generate
+ * @param freq_hz Frequency in Hz (0 -> 0.45 * sample rate)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Oscillator result (enumeration)
+ */
+RESULT_OSCILLATOR oscillator_setup(OSCILLATOR * c,
+		OSCILLATOR_WAVEFORM waveform, float freq_hz, float audio_sample_rate) {
+
+	if (c == NULL) {
+		return OSCILLATOR_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	if (freq_hz < 0.0 || freq_hz > OSC_MAX_PHASE_INC * audio_sample_rate) {
+		return OSCILLATOR_INVALID_FREQ;
+	}
+
+	c->waveform = waveform;
+	c->sample_rate = audio_sample_rate;
+	c->phase = 0.0;
+	c->phase_inc = freq_hz / audio_sample_rate;
+	c->pulse_width = 0.5;
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return OSCILLATOR_OK;
+}
+
+/**
+ * @brief Modify the oscillator frequency
+ *
+ * If the input parameter is out of bounds, it is clipped to the corresponding
+ * min/max value.  This function will return a value indicating an
+ * invalid input parameter was supplied but the oscillator will continue to
+ * operate.
+ *
+ * @param c Pointer to instance structure
+ * @param freq_hz New frequency in Hz
+ * @return Oscillator result (enumeration)
+ */
+RESULT_OSCILLATOR oscillator_modify_freq(OSCILLATOR * c, float freq_hz) {
+
+	RESULT_OSCILLATOR res = OSCILLATOR_OK;
+
+	float phase_inc = freq_hz / c->sample_rate;
+	if (phase_inc < 0.0) {
+		phase_inc = 0.0;
+		res = OSCILLATOR_INVALID_FREQ;
+	} else if (phase_inc > OSC_MAX_PHASE_INC) {
+		phase_inc = OSC_MAX_PHASE_INC;
+		res = OSCILLATOR_INVALID_FREQ;
+	}
+
+	c->phase_inc = phase_inc;
+
+	return res;
+}
+
+/**
+ * @brief Modify the pulse width (OSC_PULSE only)
+ *
+ * @param c Pointer to instance structure
+ * @param width New pulse width (0.0 -> 1.0)
+ * @return Oscillator result (enumeration)
+ */
+RESULT_OSCILLATOR oscillator_modify_pulse_width(OSCILLATOR * c, float width) {
+
+	RESULT_OSCILLATOR res = OSCILLATOR_OK;
+
+	if (width < 0.0) {
+		width = 0.0;
+		res = OSCILLATOR_INVALID_PULSE_WIDTH;
+	} else if (width > 1.0) {
+		width = 1.0;
+		res = OSCILLATOR_INVALID_PULSE_WIDTH;
+	}
+
+	c->pulse_width = width;
+
+	return res;
+}
+
+/**
+ * @brief Restarts the oscillator at a given phase
+ *
+ * @param c Pointer to instance structure
+ * @param phase New phase (0.0 -> 1.0)
+ */
+void oscillator_reset_phase(OSCILLATOR * c, float phase) {
+	c->phase = fast_fractf(phase);
+}
+
+/**
+ * @brief Generates a block of band-limited audio
+ *
+ * @param c Pointer to instance structure
+ * @param audio_out Pointer to floating point output buffer (mono)
+ * @param audio_block_size The number of floating-point words to generate
+ */
+void oscillator_read(OSCILLATOR * c, float * audio_out,
+		uint32_t audio_block_size) {
+
+	if (c == NULL || !c->initialized) {
+		for (int i = 0; i < audio_block_size; i++) {
+			audio_out[i] = 0.0;
+		}
+		return;
+	}
+
+	oscillator_block(c->waveform, &c->phase, c->phase_inc, c->pulse_width,
+			audio_out, audio_block_size);
+}
+
+/**
+ * @brief Generates a block of band-limited audio from a bare phase
+ *
+ * This is the generator behind oscillator_read() for code that keeps its own
+ * oscillator state, such as a bank of synth voices.
+ *
+ * @param waveform Waveform to generate
+ * @param phase Pointer to the phase (0.0 -> 1.0), advanced by the block
+ * @param phase_inc Phase increment per sample (0.0 -> 0.45)
+ * @param pulse_width Pulse width for OSC_PULSE (0.0 -> 1.0)
+ * @param output Pointer to the output buffer
+ * @param block_size The number of floating-point words to generate
+ */
+#pragma optimize_for_speed
+void oscillator_block(OSCILLATOR_WAVEFORM waveform, float * phase,
+		float phase_inc, float pulse_width, float * output,
+		uint32_t block_size) {
+
+	float t = *phase;
+	float dt = phase_inc;
+
+	switch (waveform) {
+	case OSC_SINE:
+		for (int i = 0; i < block_size; i++) {
+			output[i] = fast_sin_2pi(t);
+			t += dt;
+			if (t >= 1.0)
+				t -= 1.0;
+		}
+		break;
+
+	case OSC_TRIANGLE: {
+		// Corners at t = 0 (slope +4 -> -4) and t = 0.5 (slope -4 -> +4)
+		float corner = 8.0 * dt;
+		for (int i = 0; i < block_size; i++) {
+			float t2 = (t < 0.5) ? t + 0.5 : t - 0.5;
+			float y = (t < 0.5) ? 1.0 - 4.0 * t : 4.0 * t - 3.0;
+			output[i] = y - corner * osc_blamp(t, dt)
+					+ corner * osc_blamp(t2, dt);
+			t += dt;
+			if (t >= 1.0)
+				t -= 1.0;
+		}
+		break;
+	}
+
+	case OSC_SQUARE:
+	case OSC_PULSE: {
+		// Steps of +2 at t = width and -2 at t = 0
+		float width = (waveform == OSC_SQUARE) ? 0.5 : pulse_width;
+		for (int i = 0; i < block_size; i++) {
+			float t2 = (t < width) ? t - width + 1.0 : t - width;
+			float y = (t >= width) ? 1.0 : -1.0;
+			output[i] = y + 2.0 * osc_blep(t2, dt) - 2.0 * osc_blep(t, dt);
+			t += dt;
+			if (t >= 1.0)
+				t -= 1.0;
+		}
+		break;
+	}
+
+	case OSC_RAMP:
+		// Step of -2 at t = 0
+		for (int i = 0; i < block_size; i++) {
+			output[i] = 2.0 * t - 1.0 - 2.0 * osc_blep(t, dt);
+			t += dt;
+			if (t >= 1.0)
+				t -= 1.0;
+		}
+		break;
+	}
+
+	*phase = t;
+}
+
+/**
+ * @brief Generates a block of a low frequency oscillator
+ *
+ * Output is bipolar (-1.0 -> 1.0) and in phase with the single-value
+ * oscillator functions.  The phase is advanced and wrapped to 0.0 -> 1.0.
+ *
+ * @param waveform Waveform to generate (OSC_PULSE is treated as OSC_SQUARE)
+ * @param phase Pointer to the LFO phase
+ * @param phase_inc Phase increment per sample (rate_hz / sample rate)
+ * @param output Pointer to the output buffer
+ * @param block_size The number of floating-point words to generate
+ */
+#pragma optimize_for_speed
+void oscillator_lfo_block(OSCILLATOR_WAVEFORM waveform, float * phase,
+		float phase_inc, float * output, uint32_t block_size) {
+
+	float t = fast_fractf(*phase);
+
+	// Interpolating the sine is only accurate for slow rates
+	if (waveform == OSC_SINE && phase_inc > OSC_LFO_MAX_INTERP_INC) {
+		for (int i = 0; i < block_size; i++) {
+			output[i] = fast_sin_2pi(t);
+			t += phase_inc;
+			if (t >= 1.0)
+				t -= 1.0;
+		}
+		*phase = t;
+		return;
+	}
+
+	switch (waveform) {
+	case OSC_SINE: {
+		float s0 = fast_sin_2pi(t);
+		for (int i = 0; i < block_size; i += OSC_LFO_SEGMENT) {
+			uint32_t n = block_size - i;
+			if (n > OSC_LFO_SEGMENT) {
+				n = OSC_LFO_SEGMENT;
+			}
+			t += phase_inc * n;
+			float s1 = fast_sin_2pi(t);
+			float ds = (s1 - s0) / (float) n;
+			for (int j = 0; j < n; j++) {
+				output[i + j] = s0;
+				s0 += ds;
+			}
+			s0 = s1;
+		}
+		t = fast_fractf(t);
+		break;
+	}
+
+	case OSC_TRIANGLE:
+		for (int i = 0; i < block_size; i++) {
+			output[i] = (t < 0.5) ? 1.0 - 4.0 * t : 4.0 * t - 3.0;
+			t += phase_inc;
+			if (t >= 1.0)
+				t -= 1.0;
+		}
+		break;
+
+	case OSC_SQUARE:
+	case OSC_PULSE:
+		for (int i = 0; i < block_size; i++) {
+			output[i] = (t > 0.5) ? 1.0 : -1.0;
+			t += phase_inc;
+			if (t >= 1.0)
+				t -= 1.0;
+		}
+		break;
+
+	case OSC_RAMP:
+		for (int i = 0; i < block_size; i++) {
+			output[i] = 2.0 * t - 1.0;
+			t += phase_inc;
+			if (t >= 1.0)
+				t -= 1.0;
+		}
+		break;
+	}
+
+	*phase = t;
+}
+
+/**
+ * @brief PolyBLEP residual of a unit step at t = 0
+ *
+ * @param t Phase relative to the step (0.0 -> 1.0)
+ * @param dt Phase increment per sample
+ * @return Correction to add to the naive waveform
+ */
+static inline float osc_blep(float t, float dt) {
+
+	if (t < dt) {
+		float x = 1.0 - t / dt;
+		return -0.5 * x * x;
+	} else if (t > 1.0 - dt) {
+		float x = (t - 1.0) / dt + 1.0;
+		return 0.5 * x * x;
+	}
+	return 0.0;
+}
+
+/**
+ * @brief PolyBLAMP residual of a unit change in slope (per sample) at t = 0
+ *
+ * @param t Phase relative to the corner (0.0 -> 1.0)
+ * @param dt Phase increment per sample
+ * @return Correction to add to the naive waveform
+ */
+static inline float osc_blamp(float t, float dt) {
+
+	if (t < dt) {
+		float x = 1.0 - t / dt;
+		return (1.0 / 6.0) * x * x * x;
+	} else if (t > 1.0 - dt) {
+		float x = (t - 1.0) / dt + 1.0;
+		return (1.0 / 6.0) * x * x * x;
+	}
+	return 0.0;
+}
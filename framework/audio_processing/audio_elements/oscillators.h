@@ -7,13 +7,72 @@
 #ifndef _OSCILLATORS_H
 #define _OSCILLATORS_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #include "audio_elements_common.h"
 
+// Waveforms supported by the block oscillators
+typedef enum {
+	OSC_SINE, OSC_TRIANGLE, OSC_SQUARE, OSC_PULSE, OSC_RAMP
+} OSCILLATOR_WAVEFORM;
+
+// Result enumerations
+typedef enum {
+	OSCILLATOR_OK,
+	OSCILLATOR_INVALID_INSTANCE_POINTER,
+	OSCILLATOR_INVALID_FREQ,
+	OSCILLATOR_INVALID_PULSE_WIDTH
+} RESULT_OSCILLATOR;
+
+// Instance struct for a band-limited oscillator
+typedef struct {
+
+	bool initialized;
+
+	OSCILLATOR_WAVEFORM waveform;
+
+	// Phase (0.0 -> 1.0) and phase increment per sample (freq / fs)
+	float phase;
+	float phase_inc;
+
+	float pulse_width;
+	float sample_rate;
+
+} OSCILLATOR;
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 float oscillator_sine(float t);
 float oscillator_square(float t);
 float oscillator_triangle(float t);
 float oscillator_pulse(float t, float width);
 float oscillator_ramp(float t);
 
-#endif  // _OSCILLATORS_H
+RESULT_OSCILLATOR oscillator_setup(OSCILLATOR * c,
+		OSCILLATOR_WAVEFORM waveform, float freq_hz, float audio_sample_rate);
+
+RESULT_OSCILLATOR oscillator_modify_freq(OSCILLATOR * c, float freq_hz);
+
+RESULT_OSCILLATOR oscillator_modify_pulse_width(OSCILLATOR * c, float width);
+
+void oscillator_reset_phase(OSCILLATOR * c, float phase);
+
+void oscillator_read(OSCILLATOR * c, float * audio_out,
+		uint32_t audio_block_size);
 
+void oscillator_block(OSCILLATOR_WAVEFORM waveform, float * phase,
+		float phase_inc, float pulse_width, float * output,
+		uint32_t block_size);
+
+void oscillator_lfo_block(OSCILLATOR_WAVEFORM waveform, float * phase,
+		float phase_inc, float * output, uint32_t block_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _OSCILLATORS_H
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This audio element runs a nonlinear process (clipper, waveshaper, etc.) at
+ * 2x, 4x or 8x the system sample rate.  Nonlinearities create harmonics above
+ * Nyquist which would otherwise fold back as inharmonic aliasing.
+ *
+ * Each 2x step is a half-band FIR implemented in polyphase form.  Every other
+ * coefficient of a half-band filter is zero and the center tap is 0.5, so an
+ * interpolator only filters one of its two output phases (the other is a
+ * delayed copy of the input) and a decimator only filters the even input
+ * samples.  Compared to zero-stuffing and running a full FIR at the high rate,
+ * this skips all of the multiplies by zero.  Higher factors cascade 2x steps,
+ * and the later steps get away with much shorter filters because their
+ * transition bands are wider.  All stages pass 0 - 19 kHz at 48 kHz and
+ * reject images/aliases by ~80 dB.
+ *
+ * The nonlinearity is supplied as a callback which processes the audio in
+ * place at the oversampled rate.  Audio is handled in chunks of
+ * OVERSAMPLER_CHUNK_SIZE input samples with work buffers in the instance, so
+ * oversampler_read() doesn't put any audio buffers on the stack regardless of
+ * the block size or factor.
+ */
+
+#include <stdlib.h>
+
+#include "oversampler.h"
+
+// Half-band coefficients for each 2x stage, nearest to the center tap first
+static float pm oversampler_halfband_stage_1[12] = { 0.316300677552,
+		-0.100174229985, 0.0542028084478, -0.0330689342354, 0.0207347689496,
+		-0.0128402660745, 0.0076600345782, -0.00430814430915,
+		0.00222791976662, -0.00102100432846, 0.000386831872697,
+		-0.000100462235132 };
+
+static float pm oversampler_halfband_stage_2[6] = { 0.309082378215,
+		-0.0811681897781, 0.0296080685645, -0.00941712838945,
+		0.00211200132963, -0.000217129941877 };
+
+static float pm oversampler_halfband_stage_3[4] = { 0.297893771059,
+		-0.0573786794902, 0.010139712758, -0.000654804326438 };
+
+// Static function prototypes
+static void oversampler_stage_setup(OVERSAMPLER_STAGE * s, uint32_t stage);
+
+static void oversampler_interpolate(OVERSAMPLER_STAGE * s, float * audio_in,
+		float * audio_out, uint32_t audio_block_size);
+
+static void oversampler_decimate(OVERSAMPLER_STAGE * s, float * audio_in,
+		float * audio_out, uint32_t audio_block_size);
+
+/**
+ * @brief Initializes instance of an oversampler
+ *
+ * @param c Pointer to instance structure
+ * @param factor Oversampling factor (2, 4 or 8)
+ * @return Oversampler result (enumeration)
+ */
+RESULT_OVERSAMPLER oversampler_setup(OVERSAMPLER * c, uint32_t factor) {
+
+	if (c == NULL) {
+		return OVERSAMPLER_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	if (factor == 2) {
+		c->num_stages = 1;
+	} else if (factor == 4) {
+		c->num_stages = 2;
+	} else if (factor == 8) {
+		c->num_stages = 3;
+	} else {
+		return OVERSAMPLER_INVALID_FACTOR;
+	}
+
+	c->factor = factor;
+
+	for (int i = 0; i < c->num_stages; i++) {
+		oversampler_stage_setup(&c->upsample[i], i);
+		oversampler_stage_setup(&c->downsample[i], i);
+	}
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return OVERSAMPLER_OK;
+}
+
+/**
+ * @brief Clears the filter history
+ *
+ * @param c Pointer to instance structure
+ */
+void oversampler_reset(OVERSAMPLER * c) {
+
+	if (c == NULL || !c->initialized) {
+		return;
+	}
+
+	for (int i = 0; i < c->num_stages; i++) {
+		oversampler_stage_setup(&c->upsample[i], i);
+		oversampler_stage_setup(&c->downsample[i], i);
+	}
+}
+
+/**
+ * @brief Apply a process to a block of audio data at the oversampled rate
+ *
+ * audio_in and audio_out may point to the same buffer.  If the instance
+ * hasn't been initialized, the process is run at the system rate instead.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point audio output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ * @param process Function to run on each oversampled chunk (in place)
+ * @param context Pointer passed through to process
+ */
+#pragma optimize_for_speed
+void oversampler_read(OVERSAMPLER * c, float * audio_in, float * audio_out,
+		uint32_t audio_block_size, OVERSAMPLER_PROCESS_FUNC process,
+		void * context) {
+
+	if (c == NULL || !c->initialized) {
+		for (int i = 0; i < audio_block_size; i++) {
+			audio_out[i] = audio_in[i];
+		}
+		process(context, audio_out, audio_block_size);
+		return;
+	}
+
+	uint32_t stages = c->num_stages;
+
+	for (uint32_t offset = 0; offset < audio_block_size; offset +=
+			OVERSAMPLER_CHUNK_SIZE) {
+
+		uint32_t count = audio_block_size - offset;
+		if (count > OVERSAMPLER_CHUNK_SIZE) {
+			count = OVERSAMPLER_CHUNK_SIZE;
+		}
+
+		// Upsample, alternating work buffers so the last stage lands in work_a
+		float * src = &audio_in[offset];
+		uint32_t len = count;
+		for (int s = 0; s < stages; s++) {
+			float * dst = ((stages - 1 - s) & 1) ? c->work_b : c->work_a;
+			oversampler_interpolate(&c->upsample[s], src, dst, len);
+			src = dst;
+			len *= 2;
+		}
+
+		process(context, c->work_a, len);
+
+		// Downsample back through the same buffers
+		for (int s = stages - 1; s >= 0; s--) {
+			float * dst;
+			if (s == 0) {
+				dst = &audio_out[offset];
+			} else {
+				dst = ((stages - s) & 1) ? c->work_b : c->work_a;
+			}
+			len /= 2;
+			oversampler_decimate(&c->downsample[s], src, dst, len);
+			src = dst;
+		}
+	}
+}
+
+/**
+ * @brief Sets the coefficients of a stage and clears its history
+ *
+ * @param s Pointer to stage structure
+ * @param stage Stage index (0 is the stage next to the system rate)
+ */
+static void oversampler_stage_setup(OVERSAMPLER_STAGE * s, uint32_t stage) {
+
+	if (stage == 0) {
+		s->coeffs = oversampler_halfband_stage_1;
+		s->half_taps = 12;
+	} else if (stage == 1) {
+		s->coeffs = oversampler_halfband_stage_2;
+		s->half_taps = 6;
+	} else {
+		s->coeffs = oversampler_halfband_stage_3;
+		s->half_taps = 4;
+	}
+
+	s->pos = 0;
+	for (int i = 0; i < 4 * OVERSAMPLER_MAX_HALF_TAPS; i++) {
+		s->even_history[i] = 0.0;
+		s->odd_history[i] = 0.0;
+	}
+}
+
+/**
+ * @brief 2x half-band interpolator
+ *
+ * Produces two output samples per input sample: one from the filtered phase
+ * and one delayed copy of the input (the center tap).
+ *
+ * @param s Pointer to stage structure
+ * @param audio_in Pointer to audio_block_size input samples
+ * @param audio_out Pointer to 2 * audio_block_size output samples
+ * @param audio_block_size The number of input samples to process
+ */
+#pragma optimize_for_speed
+static void oversampler_interpolate(OVERSAMPLER_STAGE * s, float * audio_in,
+		float * audio_out, uint32_t audio_block_size) {
+
+	uint32_t half_taps = s->half_taps;
+	uint32_t len = 2 * half_taps;
+	uint32_t pos = s->pos;
+	float pm * coeffs = s->coeffs;
+	float * history = s->even_history;
+
+	for (int i = 0; i < audio_block_size; i++) {
+
+		history[pos] = audio_in[i];
+		history[pos + len] = audio_in[i];
+		if (++pos >= len) {
+			pos = 0;
+		}
+
+		// Oldest to newest input
+		float * w = &history[pos];
+
+		float acc = 0.0;
+		for (int k = 0; k < half_taps; k++) {
+			acc += coeffs[k] * (w[half_taps + k] + w[half_taps - 1 - k]);
+		}
+
+		// Factor of 2 restores the gain lost to zero-stuffing
+		audio_out[2 * i] = 2.0 * acc;
+		audio_out[2 * i + 1] = w[half_taps];
+	}
+
+	s->pos = pos;
+}
+
+/**
+ * @brief 2x half-band decimator
+ *
+ * Only the even input samples are filtered, the odd samples go through the
+ * center tap.
+ *
+ * @param s Pointer to stage structure
+ * @param audio_in Pointer to 2 * audio_block_size input samples
+ * @param audio_out Pointer to audio_block_size output samples
+ * @param audio_block_size The number of output samples to produce
+ */
+#pragma optimize_for_speed
+static void oversampler_decimate(OVERSAMPLER_STAGE * s, float * audio_in,
+		float * audio_out, uint32_t audio_block_size) {
+
+	uint32_t half_taps = s->half_taps;
+	uint32_t len = 2 * half_taps;
+	uint32_t pos = s->pos;
+	float pm * coeffs = s->coeffs;
+	float * even = s->even_history;
+	float * odd = s->odd_history;
+
+	for (int i = 0; i < audio_block_size; i++) {
+
+		float e = audio_in[2 * i];
+		float o = audio_in[2 * i + 1];
+		even[pos] = e;
+		even[pos + len] = e;
+		odd[pos] = o;
+		odd[pos + len] = o;
+		if (++pos >= len) {
+			pos = 0;
+		}
+
+		float * we = &even[pos];
+		float * wo = &odd[pos];
+
+		float acc = 0.5 * wo[half_taps - 1];
+		for (int k = 0; k < half_taps; k++) {
+			acc += coeffs[k] * (we[half_taps + k] + we[half_taps - 1 - k]);
+		}
+
+		audio_out[i] = acc;
+	}
+
+	s->pos = pos;
+}
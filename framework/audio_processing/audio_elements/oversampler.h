@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _OVERSAMPLER_H
+#define _OVERSAMPLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+#define OVERSAMPLER_MAX_FACTOR          (8)
+#define OVERSAMPLER_MAX_STAGES          (3)
+#define OVERSAMPLER_MAX_HALF_TAPS       (12)
+
+// Number of input samples processed per pass through the nonlinearity
+#define OVERSAMPLER_CHUNK_SIZE          (32)
+
+// Result enumerations
+typedef enum {
+	OVERSAMPLER_OK,
+	OVERSAMPLER_INVALID_INSTANCE_POINTER,
+	OVERSAMPLER_INVALID_FACTOR
+} RESULT_OVERSAMPLER;
+
+// Processes a buffer of audio in place at the oversampled rate
+typedef void (*OVERSAMPLER_PROCESS_FUNC)(void * context, float * audio,
+		uint32_t audio_block_size);
+
+// One 2x half-band interpolator or decimator
+typedef struct {
+
+	float pm * coeffs;
+	uint32_t half_taps;
+	uint32_t pos;
+
+	// Input history, written twice so the filter window is always contiguous
+	float even_history[4 * OVERSAMPLER_MAX_HALF_TAPS];
+	float odd_history[4 * OVERSAMPLER_MAX_HALF_TAPS];
+
+} OVERSAMPLER_STAGE;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	uint32_t factor;
+	uint32_t num_stages;
+
+	OVERSAMPLER_STAGE upsample[OVERSAMPLER_MAX_STAGES];
+	OVERSAMPLER_STAGE downsample[OVERSAMPLER_MAX_STAGES];
+
+	// Work buffers for the intermediate and oversampled rates
+	float work_a[OVERSAMPLER_CHUNK_SIZE * OVERSAMPLER_MAX_FACTOR];
+	float work_b[OVERSAMPLER_CHUNK_SIZE * OVERSAMPLER_MAX_FACTOR / 2];
+
+} OVERSAMPLER;
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+RESULT_OVERSAMPLER oversampler_setup(OVERSAMPLER * c, uint32_t factor);
+
+void oversampler_reset(OVERSAMPLER * c);
+
+void oversampler_read(OVERSAMPLER * c, float * audio_in, float * audio_out,
+		uint32_t audio_block_size, OVERSAMPLER_PROCESS_FUNC process,
+		void * context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _OVERSAMPLER_H
@@ -0,0 +1,410 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * A pitch detector estimates the fundamental frequency of a monophonic
+ * signal (e.g. a guitar string) using the YIN algorithm:
+ *
+ *   A. de Cheveigne, H. Kawahara, "YIN, a fundamental frequency estimator
+ *   for speech and music", JASA 111(4), 2002
+ *
+ * For each candidate period (lag) the difference function
+ *
+ *   d(lag) = sum over the window of (x[j] - x[j + lag])^2
+ *
+ * is small when the signal repeats after lag samples.  It is normalized by
+ * its running mean, and the first dip below the threshold is taken as the
+ * period, refined by parabolic interpolation.  Taking the first dip rather
+ * than the deepest one is what keeps YIN from locking to an octave below,
+ * and the normalization keeps it from locking to an octave above, which are
+ * the usual failures of zero-crossing and peak-picking detectors.
+ *
+ * The input is low-pass filtered and decimated by PITCH_DETECTOR_DECIMATION
+ * into a ring buffer, which cuts the cost of the analysis by the square of
+ * the decimation factor.  Every PITCH_DETECTOR_HOP decimated samples the
+ * latest frame (two of the longest periods) is copied out and analyzed.  The
+ * analysis window is the newest part of the frame, so a new note is detected
+ * once one longest period plus one period of the note has arrived (~15 - 30 ms
+ * for a guitar), plus up to two hops for the frame to be taken and analyzed.
+ *
+ * The analysis can run in one of two ways:
+ *
+ *   Foreground - pitch_detector_read() computes a slice of the difference
+ *   function every block so that one frame is finished per hop.  The cost
+ *   is the same every block.
+ *
+ *   Background - pitch_detector_read() only collects the input, and the
+ *   analysis is done by pitch_detector_process_background(), which should be
+ *   called from the background loop (processaudio_background_loop()).
+ *   Frames that arrive before the previous one has finished are skipped
+ *   (c->analysis_overruns counts them).
+ */
+#include <math.h>
+#include <stdlib.h>
+
+#include "pitch_detector.h"
+
+// Min/max limits and other constants
+#define PITCH_DETECTOR_MIN_FREQ         (40.0)
+#define PITCH_DETECTOR_MAX_FREQ         (1500.0)
+#define PITCH_DETECTOR_THRESHOLD_MIN    (0.01)
+#define PITCH_DETECTOR_THRESHOLD_MAX    (0.5)
+#define PITCH_DETECTOR_LPF_FREQ         (1500.0)
+
+// Number of analyses a lock is held through a missed detection
+#define PITCH_DETECTOR_HOLD_FRAMES      (4)
+
+#define PITCH_DETECTOR_PI               (3.14159265358979)
+
+// Static function prototypes
+static void pitch_detector_difference(PITCH_DETECTOR * c, uint32_t first_lag,
+		uint32_t num_lags);
+
+static void pitch_detector_finish(PITCH_DETECTOR * c);
+
+/**
+ * @brief Initializes instance of a pitch detector
+ *
+ * @param c Pointer to instance structure
+ * @param min_freq_hz Lowest frequency to detect (sets the latency)
+ * @param max_freq_hz Highest frequency to detect (up to 1500 Hz)
+ * @param threshold YIN threshold, lower is stricter (0.01 -> 0.5, usually 0.15)
+ * @param level_threshold RMS level below which there is no pitch (e.g. 0.001)
+ * @param background true to run the analysis in pitch_detector_process_background()
+ * @param audio_sample_rate The system audio sample rate
+ * @return Pitch detector result (enumeration)
+ */
+RESULT_PITCH_DETECTOR pitch_detector_setup(PITCH_DETECTOR * c,
+		float min_freq_hz, float max_freq_hz, float threshold,
+		float level_threshold, bool background, float audio_sample_rate) {
+
+	if (c == NULL) {
+		return PITCH_DETECTOR_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	if (min_freq_hz < PITCH_DETECTOR_MIN_FREQ
+			|| max_freq_hz > PITCH_DETECTOR_MAX_FREQ
+			|| min_freq_hz >= max_freq_hz) {
+		return PITCH_DETECTOR_INVALID_FREQ_RANGE;
+	}
+
+	if (threshold < PITCH_DETECTOR_THRESHOLD_MIN
+			|| threshold > PITCH_DETECTOR_THRESHOLD_MAX) {
+		return PITCH_DETECTOR_INVALID_THRESHOLD;
+	}
+
+	float fs = audio_sample_rate / (float) PITCH_DETECTOR_DECIMATION;
+
+	c->min_lag = (uint32_t) (fs / max_freq_hz);
+	c->max_lag = (uint32_t) ceilf(fs / min_freq_hz);
+	if (c->min_lag < 2) {
+		c->min_lag = 2;
+	}
+
+	// The difference function is computed one lag past max_lag for the interpolation
+	if (c->max_lag + 1 >= PITCH_DETECTOR_MAX_LAG) {
+		return PITCH_DETECTOR_INVALID_FREQ_RANGE;
+	}
+
+	c->window = c->max_lag;
+	c->frame_len = c->window + c->max_lag + 1;
+
+	c->background = background;
+	c->threshold = threshold;
+	c->level_threshold = level_threshold;
+	c->analysis_rate = fs;
+
+	// Butterworth low-pass, ahead of the decimation
+	float w0 = 2.0 * PITCH_DETECTOR_PI * PITCH_DETECTOR_LPF_FREQ
+			/ audio_sample_rate;
+	float alpha = sinf(w0) / (2.0 * 0.7071);
+	float a0 = 1.0 + alpha;
+	c->lpf_b0 = (1.0 - cosf(w0)) * 0.5 / a0;
+	c->lpf_b1 = (1.0 - cosf(w0)) / a0;
+	c->lpf_b2 = c->lpf_b0;
+	c->lpf_a1 = -2.0 * cosf(w0) / a0;
+	c->lpf_a2 = (1.0 - alpha) / a0;
+	c->lpf_x1 = c->lpf_x2 = c->lpf_y1 = c->lpf_y2 = 0.0;
+	c->decimation_phase = 0;
+
+	for (int i = 0; i < 4 * PITCH_DETECTOR_MAX_LAG; i++) {
+		c->ring[i] = 0.0;
+	}
+	c->ring_pos = 0;
+	c->hop_count = 0;
+
+	c->next_lag = 0;
+	c->analysis_pending = false;
+	c->analysis_overruns = 0;
+
+	c->frequency = 0.0;
+	c->confidence = 0.0;
+	c->voiced = false;
+	c->hold = 0;
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return PITCH_DETECTOR_OK;
+}
+
+/**
+ * @brief Processes a block of audio data
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ * @param detected_frequency A pointer to return the detected frequency
+ * @return True indicates frequency lock, false indicates no signal or no lock
+ */
+#pragma optimize_for_speed
+bool pitch_detector_read(PITCH_DETECTOR * c, float * audio_in,
+		uint32_t audio_block_size, float * detected_frequency) {
+
+	if (c == NULL || !c->initialized) {
+		return false;
+	}
+
+	float b0 = c->lpf_b0, b1 = c->lpf_b1, b2 = c->lpf_b2;
+	float a1 = c->lpf_a1, a2 = c->lpf_a2;
+	float x1 = c->lpf_x1, x2 = c->lpf_x2, y1 = c->lpf_y1, y2 = c->lpf_y2;
+
+	uint32_t phase = c->decimation_phase;
+	uint32_t pos = c->ring_pos;
+	uint32_t frame_len = c->frame_len;
+
+	for (int i = 0; i < audio_block_size; i++) {
+
+		float x = audio_in[i];
+		float y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+		x2 = x1;
+		x1 = x;
+		y2 = y1;
+		y1 = y;
+
+		if (++phase < PITCH_DETECTOR_DECIMATION) {
+			continue;
+		}
+		phase = 0;
+
+		c->ring[pos] = y;
+		c->ring[pos + frame_len] = y;
+		if (++pos >= frame_len) {
+			pos = 0;
+		}
+
+		// Start a new analysis every hop, unless the last one is still running
+		if (++c->hop_count >= PITCH_DETECTOR_HOP) {
+			if (c->analysis_pending) {
+				c->analysis_overruns++;
+			} else {
+				float * latest = &c->ring[pos];
+				float energy = 0.0;
+				c->energy[0] = 0.0;
+				for (int j = 0; j < frame_len; j++) {
+					c->frame[j] = latest[j];
+					energy += latest[j] * latest[j];
+					c->energy[j + 1] = energy;
+				}
+				c->next_lag = 0;
+				c->analysis_pending = true;
+			}
+			c->hop_count = 0;
+		}
+	}
+
+	c->lpf_x1 = x1;
+	c->lpf_x2 = x2;
+	c->lpf_y1 = y1;
+	c->lpf_y2 = y2;
+	c->decimation_phase = phase;
+	c->ring_pos = pos;
+
+	// Foreground: enough of the difference function to finish once per hop
+	if (!c->background && c->analysis_pending) {
+
+		uint32_t num_lags = c->max_lag + 2;
+		uint32_t hop_samples = PITCH_DETECTOR_HOP * PITCH_DETECTOR_DECIMATION;
+		uint32_t lags = (num_lags * audio_block_size + hop_samples - 1)
+				/ hop_samples + 1;
+
+		if (c->next_lag + lags > num_lags) {
+			lags = num_lags - c->next_lag;
+		}
+
+		pitch_detector_difference(c, c->next_lag, lags);
+		c->next_lag += lags;
+
+		if (c->next_lag >= num_lags) {
+			pitch_detector_finish(c);
+			c->analysis_pending = false;
+		}
+	}
+
+	*detected_frequency = c->frequency;
+
+	return c->voiced;
+}
+
+/**
+ * @brief Analyzes the waiting frame, if there is one
+ *
+ * Only used when the instance was set up for background analysis.  Call
+ * this from the background loop, often enough to finish each frame within
+ * one hop.
+ *
+ * @param c Pointer to instance structure
+ * @return true if a frame was analyzed
+ */
+#pragma optimize_for_speed
+bool pitch_detector_process_background(PITCH_DETECTOR * c) {
+
+	if (c == NULL || !c->initialized || !c->background
+			|| !c->analysis_pending) {
+		return false;
+	}
+
+	pitch_detector_difference(c, 0, c->max_lag + 2);
+	pitch_detector_finish(c);
+	c->analysis_pending = false;
+
+	return true;
+}
+
+/**
+ * @brief Computes part of the difference function of the current frame
+ *
+ * The window is the newest samples of the frame, compared against older
+ * samples, so a note is detected as soon as one window plus one period of it
+ * has arrived.  The difference function is expanded as
+ * d(lag) = e(0) + e(lag) - 2 r(lag), where e is the energy of the window
+ * shifted back by lag (from the prefix sums made with the frame) and r is the
+ * cross-correlation.  The correlations of four lags are computed together so
+ * each window sample is loaded once for all four.
+ *
+ * @param c Pointer to instance structure
+ * @param first_lag First lag to compute
+ * @param num_lags Number of lags to compute
+ */
+#pragma optimize_for_speed
+static void pitch_detector_difference(PITCH_DETECTOR * c, uint32_t first_lag,
+		uint32_t num_lags) {
+
+	uint32_t window = c->window;
+	uint32_t start = c->frame_len - window;
+	float * x = &c->frame[start];
+	float * e = &c->energy[start];
+	float e0 = e[window] - e[0];
+
+	uint32_t lag = first_lag;
+	uint32_t end = first_lag + num_lags;
+
+	for (; lag + 4 <= end; lag += 4) {
+
+		float * x_lag = x - lag - 3;
+
+		float r0 = 0.0, r1 = 0.0, r2 = 0.0, r3 = 0.0;
+		for (int j = 0; j < window; j++) {
+			float xj = x[j];
+			r0 += xj * x_lag[j + 3];
+			r1 += xj * x_lag[j + 2];
+			r2 += xj * x_lag[j + 1];
+			r3 += xj * x_lag[j];
+		}
+
+		float * el = e - lag;
+		c->diff[lag] = e0 + (el[window] - el[0]) - 2.0 * r0;
+		c->diff[lag + 1] = e0 + (el[window - 1] - el[-1]) - 2.0 * r1;
+		c->diff[lag + 2] = e0 + (el[window - 2] - el[-2]) - 2.0 * r2;
+		c->diff[lag + 3] = e0 + (el[window - 3] - el[-3]) - 2.0 * r3;
+	}
+
+	for (; lag < end; lag++) {
+
+		float * x_lag = x - lag;
+
+		float r = 0.0;
+		for (int j = 0; j < window; j++) {
+			r += x[j] * x_lag[j];
+		}
+
+		float * el = e - lag;
+		c->diff[lag] = e0 + (el[window] - el[0]) - 2.0 * r;
+	}
+}
+
+/**
+ * @brief Picks the period from the difference function and updates the result
+ *
+ * @param c Pointer to instance structure
+ */
+static void pitch_detector_finish(PITCH_DETECTOR * c) {
+
+	uint32_t window = c->window;
+	uint32_t max_lag = c->max_lag;
+	float * d = c->diff;
+
+	// Level check on the window
+	float * e = c->energy;
+	float energy = e[c->frame_len] - e[c->frame_len - window];
+	bool loud = (energy
+			> c->level_threshold * c->level_threshold * (float) window);
+
+	// Cumulative mean normalized difference, in place
+	float running_sum = 0.0;
+	d[0] = 1.0;
+	for (int lag = 1; lag <= max_lag + 1; lag++) {
+		if (d[lag] < 0.0) {
+			d[lag] = 0.0;
+		}
+		running_sum += d[lag];
+		if (running_sum > 0.0) {
+			d[lag] = d[lag] * (float) lag / running_sum;
+		} else {
+			d[lag] = 1.0;
+		}
+	}
+
+	// First dip below the threshold, then down to its minimum
+	int32_t period = -1;
+	for (int lag = c->min_lag; lag <= max_lag; lag++) {
+		if (d[lag] < c->threshold) {
+			while (lag < max_lag && d[lag + 1] < d[lag]) {
+				lag++;
+			}
+			period = lag;
+			break;
+		}
+	}
+
+	if (period < 0 || !loud) {
+		// Hold the last pitch through a few missed detections
+		if (c->hold) {
+			c->hold--;
+		} else {
+			c->voiced = false;
+			c->confidence = 0.0;
+		}
+		return;
+	}
+
+	// Parabolic interpolation of the minimum
+	float ym = d[period - 1];
+	float y0 = d[period];
+	float yp = d[period + 1];
+	float denom = ym - 2.0 * y0 + yp;
+	float offset = 0.0;
+	if (denom > 0.0) {
+		offset = 0.5 * (ym - yp) / denom;
+		if (offset > 0.5) {
+			offset = 0.5;
+		} else if (offset < -0.5) {
+			offset = -0.5;
+		}
+	}
+
+	c->frequency = c->analysis_rate / ((float) period + offset);
+	c->confidence = 1.0 - y0;
+	c->voiced = true;
+	c->hold = PITCH_DETECTOR_HOLD_FRAMES;
+}
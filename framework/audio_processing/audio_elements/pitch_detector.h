@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _PITCH_DETECTOR_H
+#define _PITCH_DETECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Analysis runs at the system sample rate / PITCH_DETECTOR_DECIMATION
+#define PITCH_DETECTOR_DECIMATION           (4)
+
+// Longest period (in decimated samples) the buffers are sized for
+#define PITCH_DETECTOR_MAX_LAG              (304)
+
+// Decimated samples between analyses
+#define PITCH_DETECTOR_HOP                  (64)
+
+// Suggested values for pitch_detector_setup()
+#define PITCH_DETECTOR_DEFAULT_THRESHOLD    (0.15)
+#define PITCH_DETECTOR_DEFAULT_LEVEL        (0.001)
+
+// Result enumerations
+typedef enum {
+	PITCH_DETECTOR_OK,
+	PITCH_DETECTOR_INVALID_INSTANCE_POINTER,
+	PITCH_DETECTOR_INVALID_FREQ_RANGE,
+	PITCH_DETECTOR_INVALID_THRESHOLD
+} RESULT_PITCH_DETECTOR;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	bool background;
+	float threshold;
+	float level_threshold;
+	float analysis_rate;
+
+	// Lag range and window length (decimated samples)
+	uint32_t min_lag;
+	uint32_t max_lag;
+	uint32_t window;
+	uint32_t frame_len;
+
+	// Anti-aliasing low-pass filter (biquad, direct form 1)
+	float lpf_b0, lpf_b1, lpf_b2, lpf_a1, lpf_a2;
+	float lpf_x1, lpf_x2, lpf_y1, lpf_y2;
+	uint32_t decimation_phase;
+
+	// Decimated input, written twice so the latest frame is always contiguous
+	float ring[4 * PITCH_DETECTOR_MAX_LAG];
+	uint32_t ring_pos;
+	uint32_t hop_count;
+
+	// Frame being analyzed, prefix sums of its energy and its difference function
+	float frame[2 * PITCH_DETECTOR_MAX_LAG];
+	float energy[2 * PITCH_DETECTOR_MAX_LAG + 1];
+	float diff[PITCH_DETECTOR_MAX_LAG + 2];
+	uint32_t next_lag;
+	volatile bool analysis_pending;
+	uint32_t analysis_overruns;
+
+	// Latest result
+	volatile float frequency;
+	volatile float confidence;
+	volatile bool voiced;
+	uint32_t hold;
+
+} PITCH_DETECTOR;
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+RESULT_PITCH_DETECTOR pitch_detector_setup(PITCH_DETECTOR * c,
+		float min_freq_hz, float max_freq_hz, float threshold,
+		float level_threshold, bool background, float audio_sample_rate);
+
+bool pitch_detector_read(PITCH_DETECTOR * c, float * audio_in,
+		uint32_t audio_block_size, float * detected_frequency);
+
+bool pitch_detector_process_background(PITCH_DETECTOR * c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _PITCH_DETECTOR_H
@@ -0,0 +1,629 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Poly synth is a polyphonic synthesizer engine for MIDI-driven synthesis.
+ * Where SIMPLE_SYNTH is a single voice, one poly synth instance plays up to
+ * POLY_SYNTH_MAX_VOICES notes at once and mixes them to a mono output.
+ *
+ * Voice state is kept as a struct of arrays (one array per field, indexed by
+ * voice) so the per-block loop walks each field contiguously.  Each active
+ * voice generates a whole block with the band-limited oscillator_block() and
+ * is added into the output with a linear gain ramp.
+ *
+ * The ADSR envelope is computed at control rate: once per block per voice,
+ * rather than once per sample.  The attack is linear, and the decay and
+ * release are exponential with the times given as the time to fall by 60 dB.
+ * The gain ramp across the block interpolates between the control points,
+ * so there is no zipper noise even with short attacks.
+ *
+ * When all voices are busy, a new note steals the quietest voice in its
+ * release stage, or otherwise the oldest note.  A stolen voice restarts its
+ * attack from its current level with a continuous phase, so stealing doesn't
+ * click.
+ *
+ * Notes can be played directly with poly_synth_note_on() / poly_synth_note_off()
+ * from the audio thread, or MIDI messages (see midi_parser.c) can be passed to
+ * poly_synth_midi_message() from the MIDI UART interrupt.  These are queued and
+ * applied at the start of the next poly_synth_read().  Messages on all channels
+ * are played.  Supported messages:
+ *
+ *   Note on / note off
+ *   Pitch bend (+/- 2 semitones)
+ *   CC 64 sustain pedal
+ *   CC 120 all sound off, CC 123 all notes off
+ */
+#include <stdlib.h>
+#include "poly_synth.h"
+#include "fast_math.h"
+
+// Min/max limits and other constants
+#define POLY_SYNTH_MIN_TIME             (0.001)
+#define POLY_SYNTH_MAX_TIME             (20.0)
+#define POLY_SYNTH_MIN_SUSTAIN          (0.0)
+#define POLY_SYNTH_MAX_SUSTAIN          (1.0)
+#define POLY_SYNTH_MIN_GAIN             (0.0)
+#define POLY_SYNTH_MAX_GAIN             (1.0)
+
+// Same limit as the oscillator element
+#define POLY_SYNTH_MAX_PHASE_INC        (0.45)
+
+// Level (-80 dB) below which a decaying envelope is considered finished
+#define POLY_SYNTH_SILENCE              (0.0001)
+
+// log2(10^-3), the decay and release times are for a 60 dB drop
+#define POLY_SYNTH_LOG2_MINUS_60_DB     (-9.965784)
+
+#define POLY_SYNTH_PITCH_BEND_RANGE     (2.0)
+
+// Static function prototypes
+static void poly_synth_set_envelope(POLY_SYNTH * c, float attack_s,
+		float decay_s, float sustain_level, float release_s);
+
+static void poly_synth_apply_message(POLY_SYNTH * c, MIDI_MESSAGE * message);
+
+static void poly_synth_release_voice(POLY_SYNTH * c, uint32_t voice);
+
+static uint32_t poly_synth_allocate_voice(POLY_SYNTH * c, uint32_t note);
+
+/**
+ * @brief Initializes instance of the polyphonic synth
+ *
+ * @param c Pointer to instance structure
+ * @param num_voices Maximum number of notes played at once (1 - 32)
+ * @param waveform Oscillator waveform used by all voices
+ * @param attack_s Attack time in seconds
+ * @param decay_s Decay time (to fall by 60 dB) in seconds
+ * @param sustain_level Sustain level (0.0 -> 1.0)
+ * @param release_s Release time (to fall by 60 dB) in seconds
+ * @param gain Output gain of each voice (0.0 -> 1.0)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Poly synth result (enumeration)
+ */
+RESULT_POLY_SYNTH poly_synth_setup(POLY_SYNTH * c, uint32_t num_voices,
+		OSCILLATOR_WAVEFORM waveform, float attack_s, float decay_s,
+		float sustain_level, float release_s, float gain,
+		float audio_sample_rate) {
+
+	if (c == NULL) {
+		return POLY_SYNTH_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	if (num_voices < 1 || num_voices > POLY_SYNTH_MAX_VOICES) {
+		return POLY_SYNTH_INVALID_NUM_VOICES;
+	}
+
+	if (attack_s < POLY_SYNTH_MIN_TIME || attack_s > POLY_SYNTH_MAX_TIME
+			|| decay_s < POLY_SYNTH_MIN_TIME || decay_s > POLY_SYNTH_MAX_TIME
+			|| release_s < POLY_SYNTH_MIN_TIME
+			|| release_s > POLY_SYNTH_MAX_TIME
+			|| sustain_level < POLY_SYNTH_MIN_SUSTAIN
+			|| sustain_level > POLY_SYNTH_MAX_SUSTAIN) {
+		return POLY_SYNTH_INVALID_ENVELOPE;
+	}
+
+	if (gain < POLY_SYNTH_MIN_GAIN || gain > POLY_SYNTH_MAX_GAIN) {
+		return POLY_SYNTH_INVALID_GAIN;
+	}
+
+	c->num_voices = num_voices;
+	c->waveform = waveform;
+	c->pulse_width = 0.5;
+	c->gain = gain;
+	c->sample_rate = audio_sample_rate;
+
+	poly_synth_set_envelope(c, attack_s, decay_s, sustain_level, release_s);
+
+	c->pitch_bend = 1.0;
+	c->sustain_pedal = false;
+
+	for (int v = 0; v < POLY_SYNTH_MAX_VOICES; v++) {
+		c->note[v] = 0;
+		c->velocity[v] = 0.0;
+		c->phase[v] = 0.0;
+		c->phase_inc[v] = 0.0;
+		c->stage[v] = POLY_SYNTH_IDLE;
+		c->env_level[v] = 0.0;
+		c->voice_gain[v] = 0.0;
+		c->held[v] = false;
+		c->age[v] = 0;
+	}
+	c->note_count = 0;
+
+	c->events_write = 0;
+	c->events_read = 0;
+	c->events_dropped = 0;
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return POLY_SYNTH_OK;
+}
+
+/**
+ * @brief Modifies the ADSR envelope (applies to notes already playing)
+ *
+ * @param c Pointer to instance structure
+ * @param attack_s Attack time in seconds
+ * @param decay_s Decay time (to fall by 60 dB) in seconds
+ * @param sustain_level Sustain level (0.0 -> 1.0)
+ * @param release_s Release time (to fall by 60 dB) in seconds
+ * @return Poly synth result (enumeration)
+ */
+RESULT_POLY_SYNTH poly_synth_modify_envelope(POLY_SYNTH * c, float attack_s,
+		float decay_s, float sustain_level, float release_s) {
+
+	if (c == NULL) {
+		return POLY_SYNTH_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_POLY_SYNTH result = POLY_SYNTH_OK;
+
+	if (attack_s < POLY_SYNTH_MIN_TIME) {
+		attack_s = POLY_SYNTH_MIN_TIME;
+		result = POLY_SYNTH_INVALID_ENVELOPE;
+	} else if (attack_s > POLY_SYNTH_MAX_TIME) {
+		attack_s = POLY_SYNTH_MAX_TIME;
+		result = POLY_SYNTH_INVALID_ENVELOPE;
+	}
+	if (decay_s < POLY_SYNTH_MIN_TIME) {
+		decay_s = POLY_SYNTH_MIN_TIME;
+		result = POLY_SYNTH_INVALID_ENVELOPE;
+	} else if (decay_s > POLY_SYNTH_MAX_TIME) {
+		decay_s = POLY_SYNTH_MAX_TIME;
+		result = POLY_SYNTH_INVALID_ENVELOPE;
+	}
+	if (sustain_level < POLY_SYNTH_MIN_SUSTAIN) {
+		sustain_level = POLY_SYNTH_MIN_SUSTAIN;
+		result = POLY_SYNTH_INVALID_ENVELOPE;
+	} else if (sustain_level > POLY_SYNTH_MAX_SUSTAIN) {
+		sustain_level = POLY_SYNTH_MAX_SUSTAIN;
+		result = POLY_SYNTH_INVALID_ENVELOPE;
+	}
+	if (release_s < POLY_SYNTH_MIN_TIME) {
+		release_s = POLY_SYNTH_MIN_TIME;
+		result = POLY_SYNTH_INVALID_ENVELOPE;
+	} else if (release_s > POLY_SYNTH_MAX_TIME) {
+		release_s = POLY_SYNTH_MAX_TIME;
+		result = POLY_SYNTH_INVALID_ENVELOPE;
+	}
+
+	poly_synth_set_envelope(c, attack_s, decay_s, sustain_level, release_s);
+
+	return result;
+}
+
+/**
+ * @brief Modifies the output gain of each voice
+ *
+ * @param c Pointer to instance structure
+ * @param gain New gain (0.0 -> 1.0)
+ * @return Poly synth result (enumeration)
+ */
+RESULT_POLY_SYNTH poly_synth_modify_gain(POLY_SYNTH * c, float gain) {
+
+	if (c == NULL) {
+		return POLY_SYNTH_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_POLY_SYNTH result = POLY_SYNTH_OK;
+
+	if (gain < POLY_SYNTH_MIN_GAIN) {
+		gain = POLY_SYNTH_MIN_GAIN;
+		result = POLY_SYNTH_INVALID_GAIN;
+	} else if (gain > POLY_SYNTH_MAX_GAIN) {
+		gain = POLY_SYNTH_MAX_GAIN;
+		result = POLY_SYNTH_INVALID_GAIN;
+	}
+
+	c->gain = gain;
+
+	return result;
+}
+
+/**
+ * @brief Modifies the pulse width used by the OSC_PULSE waveform
+ *
+ * @param c Pointer to instance structure
+ * @param width New pulse width (0.0 -> 1.0)
+ * @return Poly synth result (enumeration)
+ */
+RESULT_POLY_SYNTH poly_synth_modify_pulse_width(POLY_SYNTH * c, float width) {
+
+	if (c == NULL) {
+		return POLY_SYNTH_INVALID_INSTANCE_POINTER;
+	}
+
+	RESULT_POLY_SYNTH result = POLY_SYNTH_OK;
+
+	if (width < 0.0) {
+		width = 0.0;
+		result = POLY_SYNTH_INVALID_PULSE_WIDTH;
+	} else if (width > 1.0) {
+		width = 1.0;
+		result = POLY_SYNTH_INVALID_PULSE_WIDTH;
+	}
+
+	c->pulse_width = width;
+
+	return result;
+}
+
+/**
+ * @brief Starts a note, stealing a voice if they are all busy
+ *
+ * Call from the audio thread, use poly_synth_midi_message() from interrupts.
+ *
+ * @param c Pointer to instance structure
+ * @param note MIDI note number (0 - 127)
+ * @param velocity MIDI note velocity (1 - 127)
+ */
+void poly_synth_note_on(POLY_SYNTH * c, uint32_t note, uint32_t velocity) {
+
+	if (c == NULL || !c->initialized || note > 127) {
+		return;
+	}
+
+	if (velocity > 127) {
+		velocity = 127;
+	}
+
+	uint32_t v = poly_synth_allocate_voice(c, note);
+
+	// Voices that were silent start from the beginning of the waveform
+	if (c->stage[v] == POLY_SYNTH_IDLE) {
+		c->phase[v] = 0.0;
+		c->env_level[v] = 0.0;
+		c->voice_gain[v] = 0.0;
+	}
+
+	float freq = fast_exp2f(((float) note - 69.0) * (1.0 / 12.0)) * 440.0;
+
+	c->note[v] = note;
+	c->velocity[v] = (float) velocity * (1.0 / 127.0);
+	c->phase_inc[v] = freq / c->sample_rate;
+	c->stage[v] = POLY_SYNTH_ATTACK;
+	c->held[v] = false;
+	c->age[v] = ++c->note_count;
+}
+
+/**
+ * @brief Releases a note (held until the pedal is lifted if sustain is down)
+ *
+ * @param c Pointer to instance structure
+ * @param note MIDI note number (0 - 127)
+ */
+void poly_synth_note_off(POLY_SYNTH * c, uint32_t note) {
+
+	if (c == NULL || !c->initialized) {
+		return;
+	}
+
+	for (int v = 0; v < c->num_voices; v++) {
+		if (c->note[v] == note && c->stage[v] != POLY_SYNTH_IDLE
+				&& c->stage[v] != POLY_SYNTH_RELEASE) {
+			if (c->sustain_pedal) {
+				c->held[v] = true;
+			} else {
+				poly_synth_release_voice(c, v);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Releases all notes, including those held by the sustain pedal
+ *
+ * @param c Pointer to instance structure
+ */
+void poly_synth_all_notes_off(POLY_SYNTH * c) {
+
+	if (c == NULL || !c->initialized) {
+		return;
+	}
+
+	c->sustain_pedal = false;
+	for (int v = 0; v < c->num_voices; v++) {
+		if (c->stage[v] != POLY_SYNTH_IDLE) {
+			poly_synth_release_voice(c, v);
+		}
+	}
+}
+
+/**
+ * @brief Queues a MIDI message to be applied at the start of the next block
+ *
+ * Safe to call from an interrupt (e.g. the MIDI UART rx callback) while the
+ * audio callback is running poly_synth_read(), as long as only one context
+ * calls this function.
+ *
+ * @param c Pointer to instance structure
+ * @param message Pointer to the complete MIDI message
+ * @return true if the message was queued, false if the queue was full
+ */
+bool poly_synth_midi_message(POLY_SYNTH * c, MIDI_MESSAGE * message) {
+
+	if (c == NULL || !c->initialized) {
+		return false;
+	}
+
+	uint32_t write = c->events_write;
+	uint32_t next = (write + 1) & (POLY_SYNTH_EVENT_QUEUE_SIZE - 1);
+
+	if (next == c->events_read) {
+		c->events_dropped++;
+		return false;
+	}
+
+	c->events[write] = *message;
+	c->events_write = next;
+
+	return true;
+}
+
+/**
+ * @brief Returns the number of voices currently making sound
+ *
+ * @param c Pointer to instance structure
+ * @return Number of active voices
+ */
+uint32_t poly_synth_active_voices(POLY_SYNTH * c) {
+
+	if (c == NULL || !c->initialized) {
+		return 0;
+	}
+
+	uint32_t count = 0;
+	for (int v = 0; v < c->num_voices; v++) {
+		if (c->stage[v] != POLY_SYNTH_IDLE) {
+			count++;
+		}
+	}
+	return count;
+}
+
+/**
+ * @brief Reads the next block of audio from the synth (all voices mixed)
+ *
+ * @param c Pointer to instance structure
+ * @param audio_out Pointer to floating point output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void poly_synth_read(POLY_SYNTH * c, float * audio_out,
+		uint32_t audio_block_size) {
+
+	for (int i = 0; i < audio_block_size; i++) {
+		audio_out[i] = 0.0;
+	}
+
+	if (c == NULL || !c->initialized) {
+		return;
+	}
+
+	// Apply the MIDI messages received since the last block
+	uint32_t read = c->events_read;
+	while (read != c->events_write) {
+		poly_synth_apply_message(c, &c->events[read]);
+		read = (read + 1) & (POLY_SYNTH_EVENT_QUEUE_SIZE - 1);
+		c->events_read = read;
+	}
+
+	// Envelope steps for one block
+	float block = (float) audio_block_size;
+	float attack_step = c->attack_inc * block;
+	float decay_coeff = fast_exp2f(c->decay_log2 * block);
+	float release_coeff = fast_exp2f(c->release_log2 * block);
+	float sustain = c->sustain_level;
+	float gain = c->gain;
+	float block_recip = 1.0 / block;
+
+	float voice_audio[MAX_AUDIO_BLOCK_SIZE];
+
+	for (int v = 0; v < c->num_voices; v++) {
+
+		POLY_SYNTH_STAGE stage = c->stage[v];
+		if (stage == POLY_SYNTH_IDLE) {
+			continue;
+		}
+
+		// Envelope level at the end of this block
+		float level = c->env_level[v];
+		switch (stage) {
+		case POLY_SYNTH_ATTACK:
+			level += attack_step;
+			if (level >= 1.0) {
+				level = 1.0;
+				stage = POLY_SYNTH_DECAY;
+			}
+			break;
+		case POLY_SYNTH_DECAY:
+			level = sustain + (level - sustain) * decay_coeff;
+			if (level - sustain < POLY_SYNTH_SILENCE) {
+				level = sustain;
+				stage = POLY_SYNTH_SUSTAIN;
+			}
+			break;
+		case POLY_SYNTH_SUSTAIN:
+			level = sustain;
+			break;
+		default:
+			level *= release_coeff;
+			break;
+		}
+
+		// Ramp to silence and free the voice once the envelope has finished
+		if (stage != POLY_SYNTH_ATTACK && level < POLY_SYNTH_SILENCE) {
+			level = 0.0;
+			stage = POLY_SYNTH_IDLE;
+		}
+
+		c->env_level[v] = level;
+		c->stage[v] = stage;
+
+		float phase_inc = c->phase_inc[v] * c->pitch_bend;
+		if (phase_inc > POLY_SYNTH_MAX_PHASE_INC) {
+			phase_inc = POLY_SYNTH_MAX_PHASE_INC;
+		}
+
+		oscillator_block(c->waveform, &c->phase[v], phase_inc, c->pulse_width,
+				voice_audio, audio_block_size);
+
+		float g = c->voice_gain[v];
+		float g_target = level * c->velocity[v] * gain;
+		float g_inc = (g_target - g) * block_recip;
+
+		for (int i = 0; i < audio_block_size; i++) {
+			g += g_inc;
+			audio_out[i] += voice_audio[i] * g;
+		}
+
+		c->voice_gain[v] = g_target;
+	}
+}
+
+/**
+ * @brief Converts envelope times to per-sample rates
+ *
+ * @param c Pointer to instance structure
+ * @param attack_s Attack time in seconds
+ * @param decay_s Decay time in seconds
+ * @param sustain_level Sustain level
+ * @param release_s Release time in seconds
+ */
+static void poly_synth_set_envelope(POLY_SYNTH * c, float attack_s,
+		float decay_s, float sustain_level, float release_s) {
+
+	c->attack_inc = 1.0 / (attack_s * c->sample_rate);
+	c->decay_log2 = POLY_SYNTH_LOG2_MINUS_60_DB / (decay_s * c->sample_rate);
+	c->sustain_level = sustain_level;
+	c->release_log2 = POLY_SYNTH_LOG2_MINUS_60_DB
+			/ (release_s * c->sample_rate);
+}
+
+/**
+ * @brief Applies one MIDI message to the voices
+ *
+ * @param c Pointer to instance structure
+ * @param message Pointer to the MIDI message
+ */
+static void poly_synth_apply_message(POLY_SYNTH * c, MIDI_MESSAGE * message) {
+
+	switch (message->status & 0xF0) {
+
+	case MIDI_NOTE_ON:
+		// Note on with a velocity of zero is a note off
+		if (message->data2 == 0) {
+			poly_synth_note_off(c, message->data1);
+		} else {
+			poly_synth_note_on(c, message->data1, message->data2);
+		}
+		break;
+
+	case MIDI_NOTE_OFF:
+		poly_synth_note_off(c, message->data1);
+		break;
+
+	case MIDI_CONTROL_CHANGE:
+		if (message->data1 == MIDI_CC_SUSTAIN_PEDAL) {
+			c->sustain_pedal = (message->data2 >= 64);
+
+			// Pedal lifted, release the notes it was holding
+			if (!c->sustain_pedal) {
+				for (int v = 0; v < c->num_voices; v++) {
+					if (c->held[v]) {
+						poly_synth_release_voice(c, v);
+					}
+				}
+			}
+		} else if (message->data1 == MIDI_CC_ALL_NOTES_OFF) {
+			poly_synth_all_notes_off(c);
+		} else if (message->data1 == MIDI_CC_ALL_SOUND_OFF) {
+			// Fade every voice out over the next block
+			c->sustain_pedal = false;
+			for (int v = 0; v < c->num_voices; v++) {
+				if (c->stage[v] != POLY_SYNTH_IDLE) {
+					poly_synth_release_voice(c, v);
+					c->env_level[v] = 0.0;
+				}
+			}
+		}
+		break;
+
+	case MIDI_PITCH_BEND: {
+		// 14-bit value, 8192 is centered
+		int32_t bend = (((int32_t) message->data2 << 7) | message->data1)
+				- 8192;
+		c->pitch_bend = fast_exp2f(
+				(float) bend
+						* (POLY_SYNTH_PITCH_BEND_RANGE / (12.0 * 8192.0)));
+		break;
+	}
+
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief Moves a voice to the release stage
+ *
+ * @param c Pointer to instance structure
+ * @param voice Voice index
+ */
+static void poly_synth_release_voice(POLY_SYNTH * c, uint32_t voice) {
+
+	c->stage[voice] = POLY_SYNTH_RELEASE;
+	c->held[voice] = false;
+}
+
+/**
+ * @brief Picks the voice for a new note
+ *
+ * In order of preference: the voice already playing this note (retrigger),
+ * an idle voice, the quietest voice in its release stage, the oldest note.
+ *
+ * @param c Pointer to instance structure
+ * @param note MIDI note number
+ * @return Voice index
+ */
+static uint32_t poly_synth_allocate_voice(POLY_SYNTH * c, uint32_t note) {
+
+	int32_t idle = -1;
+	int32_t quietest = -1;
+	int32_t oldest = 0;
+
+	for (int v = 0; v < c->num_voices; v++) {
+
+		POLY_SYNTH_STAGE stage = c->stage[v];
+
+		if (stage == POLY_SYNTH_IDLE) {
+			if (idle < 0) {
+				idle = v;
+			}
+			continue;
+		}
+
+		if (c->note[v] == note) {
+			return v;
+		}
+
+		if (stage == POLY_SYNTH_RELEASE) {
+			if (quietest < 0 || c->env_level[v] < c->env_level[quietest]) {
+				quietest = v;
+			}
+		}
+
+		if (c->age[v] < c->age[oldest]) {
+			oldest = v;
+		}
+	}
+
+	if (idle >= 0) {
+		return idle;
+	}
+	if (quietest >= 0) {
+		return quietest;
+	}
+	return oldest;
+}
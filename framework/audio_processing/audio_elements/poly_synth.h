@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _POLY_SYNTH_H
+#define _POLY_SYNTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+#include "oscillators.h"
+#include "midi_parser.h"
+
+#define POLY_SYNTH_MAX_VOICES           (32)
+
+// Number of MIDI messages that can be queued between audio blocks (power of 2)
+#define POLY_SYNTH_EVENT_QUEUE_SIZE     (64)
+
+// Result enumerations
+typedef enum {
+	POLY_SYNTH_OK,
+	POLY_SYNTH_INVALID_INSTANCE_POINTER,
+	POLY_SYNTH_INVALID_NUM_VOICES,
+	POLY_SYNTH_INVALID_ENVELOPE,
+	POLY_SYNTH_INVALID_GAIN,
+	POLY_SYNTH_INVALID_PULSE_WIDTH
+} RESULT_POLY_SYNTH;
+
+// Envelope stage of a voice
+typedef enum {
+	POLY_SYNTH_IDLE,
+	POLY_SYNTH_ATTACK,
+	POLY_SYNTH_DECAY,
+	POLY_SYNTH_SUSTAIN,
+	POLY_SYNTH_RELEASE
+} POLY_SYNTH_STAGE;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	uint32_t num_voices;
+
+	// Shared voice parameters
+	OSCILLATOR_WAVEFORM waveform;
+	float pulse_width;
+	float gain;
+	float sample_rate;
+
+	// Envelope shape, per sample (scaled to the block size in poly_synth_read)
+	float attack_inc;
+	float decay_log2;
+	float sustain_level;
+	float release_log2;
+
+	// Controllers
+	float pitch_bend;
+	bool sustain_pedal;
+
+	// Voice state, one entry per voice in each array
+	uint8_t note[POLY_SYNTH_MAX_VOICES];
+	float velocity[POLY_SYNTH_MAX_VOICES];
+	float phase[POLY_SYNTH_MAX_VOICES];
+	float phase_inc[POLY_SYNTH_MAX_VOICES];
+	POLY_SYNTH_STAGE stage[POLY_SYNTH_MAX_VOICES];
+	float env_level[POLY_SYNTH_MAX_VOICES];
+	float voice_gain[POLY_SYNTH_MAX_VOICES];
+	bool held[POLY_SYNTH_MAX_VOICES];
+	uint32_t age[POLY_SYNTH_MAX_VOICES];
+	uint32_t note_count;
+
+	// MIDI messages from the UART interrupt, applied at the start of each block
+	MIDI_MESSAGE events[POLY_SYNTH_EVENT_QUEUE_SIZE];
+	volatile uint32_t events_write;
+	volatile uint32_t events_read;
+	uint32_t events_dropped;
+
+} POLY_SYNTH;
+
+// Wrapper allows C code to be called from C++ files
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+RESULT_POLY_SYNTH poly_synth_setup(POLY_SYNTH * c, uint32_t num_voices,
+		OSCILLATOR_WAVEFORM waveform, float attack_s, float decay_s,
+		float sustain_level, float release_s, float gain,
+		float audio_sample_rate);
+
+RESULT_POLY_SYNTH poly_synth_modify_envelope(POLY_SYNTH * c, float attack_s,
+		float decay_s, float sustain_level, float release_s);
+
+RESULT_POLY_SYNTH poly_synth_modify_gain(POLY_SYNTH * c, float gain);
+
+RESULT_POLY_SYNTH poly_synth_modify_pulse_width(POLY_SYNTH * c, float width);
+
+void poly_synth_note_on(POLY_SYNTH * c, uint32_t note, uint32_t velocity);
+
+void poly_synth_note_off(POLY_SYNTH * c, uint32_t note);
+
+void poly_synth_all_notes_off(POLY_SYNTH * c);
+
+bool poly_synth_midi_message(POLY_SYNTH * c, MIDI_MESSAGE * message);
+
+uint32_t poly_synth_active_voices(POLY_SYNTH * c);
+
+void poly_synth_read(POLY_SYNTH * c, float * audio_out,
+		uint32_t audio_block_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _POLY_SYNTH_H
@@ -13,11 +13,12 @@
 #include <stdlib.h>
 #include <math.h>
 #include "simple_synth.h"
-#include "../audio_elements/oscillators.h"
+#include "fast_math.h"
 
 // Prototypes for static functions
-static float note_to_increment(uint32_t note, float sampling_rate);
-static float get_envelope(SIMPLE_SYNTH * c);
+static float note_to_freq(uint32_t note);
+static void apply_envelope(SIMPLE_SYNTH * c, float * audio,
+		uint32_t audio_block_size);
 
 /**
  * @brief Initializes instance of the synthesizer (single voice)
@@ -51,6 +52,26 @@ RESULT_SIMPLE_SYNTH synth_setup(SIMPLE_SYNTH * c, uint32_t attack,
 	// Set operator
 	c->synth_operator = synth_operator;
 
+	OSCILLATOR_WAVEFORM waveform;
+	switch (synth_operator) {
+	case SYNTH_TRIANGLE:
+		waveform = OSC_TRIANGLE;
+		break;
+	case SYNTH_SQUARE:
+		waveform = OSC_SQUARE;
+		break;
+	case SYNTH_PULSE:
+		waveform = OSC_PULSE;
+		break;
+	case SYNTH_RAMP:
+		waveform = OSC_RAMP;
+		break;
+	default:
+		waveform = OSC_SINE;
+		break;
+	}
+	oscillator_setup(&c->osc, waveform, 0.0, audio_sample_rate);
+
 	// Set system audio parameters
 	c->sample_rate = audio_sample_rate;
 
@@ -63,6 +84,9 @@ RESULT_SIMPLE_SYNTH synth_setup(SIMPLE_SYNTH * c, uint32_t attack,
 /**
  * @brief Reads the next frame of audio from the synth engine
  *
+ * The oscillator generates the whole block, and then the envelope is applied
+ * in linear spans (one per ADSR segment that falls in this block).
+ *
  * @param c Pointer to instance structure
  * @param audio_out Pointer to floating point output buffer (mono)
  * @param audio_block_size The number of floating-point words to process
@@ -76,60 +100,11 @@ void synth_read(SIMPLE_SYNTH * c, float * audio_out, uint32_t audio_block_size)
 		for (i = 0; i < audio_block_size; i++) {
 			audio_out[i] = 0.0;
 		}
+		return;
 	}
 
-	float vol = c->volume;
-	float t = c->t;
-	float t_inc = c->t_inc;
-	switch (c->synth_operator) {
-	case SYNTH_SINE:
-		for (i = 0; i < audio_block_size; i++) {
-			audio_out[i] = vol * get_envelope(c) * oscillator_sine(t);
-			t += t_inc;
-			if (t >= 1.0)
-				t -= 1.0;
-			c->position++;
-		}
-		break;
-	case SYNTH_TRIANGLE:
-		for (i = 0; i < audio_block_size; i++) {
-			audio_out[i] = vol * get_envelope(c) * oscillator_triangle(t);
-			t += t_inc;
-			if (t >= 1.0)
-				t -= 1.0;
-			c->position++;
-		}
-		break;
-	case SYNTH_SQUARE:
-		for (i = 0; i < audio_block_size; i++) {
-			audio_out[i] = vol * get_envelope(c) * oscillator_square(t);
-			t += t_inc;
-			if (t >= 1.0)
-				t -= 1.0;
-			c->position++;
-		}
-		break;
-	case SYNTH_PULSE:
-		for (i = 0; i < audio_block_size; i++) {
-			audio_out[i] = vol * get_envelope(c)
-					* oscillator_pulse(t, c->operator_param1);
-			t += t_inc;
-			if (t >= 1.0)
-				t -= 1.0;
-			c->position++;
-		}
-		break;
-	case SYNTH_RAMP:
-		for (i = 0; i < audio_block_size; i++) {
-			audio_out[i] = vol * get_envelope(c) * oscillator_ramp(t);
-			t += t_inc;
-			if (t >= 1.0)
-				t -= 1.0;
-			c->position++;
-		}
-		break;
-	}
-	c->t = t;
+	oscillator_read(&c->osc, audio_out, audio_block_size);
+	apply_envelope(c, audio_out, audio_block_size);
 
 }
 
@@ -147,10 +122,10 @@ void synth_play_note(SIMPLE_SYNTH * c, uint32_t note, float volume) {
 
 	c->playing = true;
 	c->position = 0;
-	c->t = 0.0;
 	c->volume = volume;
 	c->note = note;
-	c->t_inc = note_to_increment(note, c->sample_rate);
+	oscillator_reset_phase(&c->osc, 0.0);
+	oscillator_modify_freq(&c->osc, note_to_freq(note));
 
 }
 
@@ -165,10 +140,10 @@ void synth_play_note_freq(SIMPLE_SYNTH * c, float freq, float volume) {
 
 	c->playing = true;
 	c->position = 0;
-	c->t = 0.0;
 	c->volume = volume;
 
-	c->t_inc = 1.0 / (c->sample_rate / freq);
+	oscillator_reset_phase(&c->osc, 0.0);
+	oscillator_modify_freq(&c->osc, freq);
 }
 
 /**
@@ -183,7 +158,7 @@ void synth_play_note_freq(SIMPLE_SYNTH * c, float freq, float volume) {
  */
 void synth_update_note_freq(SIMPLE_SYNTH * c, float freq) {
 
-	c->t_inc = 1.0 / (c->sample_rate / freq);
+	oscillator_modify_freq(&c->osc, freq);
 }
 
 /**
@@ -218,6 +193,9 @@ void synth_stop_note(SIMPLE_SYNTH * c) {
  */
 void synth_set_operator_param1(SIMPLE_SYNTH * c, float val) {
 	c->operator_param1 = val;
+
+	// Pulse width of SYNTH_PULSE
+	oscillator_modify_pulse_width(&c->osc, val);
 }
 
 /**
@@ -233,14 +211,13 @@ void synth_set_operator_param2(SIMPLE_SYNTH * c, float val) {
 }
 
 /**
- * @brief Converts a frequency to a time increment
+ * @brief Converts a MIDI note to a frequency
  *
  * @param note MIDI note value
- * @param sampling_rate Current system sampling rate
  *
- * @return Time increment value
+ * @return Note frequency in Hz
  */
-static float note_to_increment(uint32_t note, float sampling_rate) {
+static float note_to_freq(uint32_t note) {
 
 	if (note < 21)
 		note = 21;
@@ -248,58 +225,81 @@ static float note_to_increment(uint32_t note, float sampling_rate) {
 		note = 108;
 	float note_f = (float) note;
 
-	float freq = powf(2.0, (note_f - 69.0) * (1.0 / 12.0)) * 440.0;
-
-	float t_inc = freq / sampling_rate;
-
-	return t_inc;
+	return fast_exp2f((note_f - 69.0) * (1.0 / 12.0)) * 440.0;
 
 }
 
-/*
- *
- */
-
 /**
- * @brief  Gets the current volume modifier from our ADSR envelope
+ * @brief Applies the volume and ADSR envelope to a block of audio
+ *
+ * Each segment of the envelope is linear, so it's applied in spans with a
+ * constant increment.  The start of each span is computed from the position
+ * so errors don't accumulate across blocks.
  *
  * @param c Pointer to instance structure
- * @return Current instrument volume level
+ * @param audio Pointer to the oscillator output, scaled in place
+ * @param audio_block_size The number of floating-point words to process
  */
-static float get_envelope(SIMPLE_SYNTH * c) {
-
-	if (!c->playing) {
-		return 0.0;
-	}
-
-	// Attack
-	if (c->position < c->env_attack) {
-		return (float) c->position / (float) c->env_attack;
-	}
-
-	// Decay
-	if (c->position < c->env_attack + c->env_decay) {
-		uint32_t pos = c->position - c->env_attack;
-
-		return 0.8 + 0.2 * (1.0 - ((float) pos / (float) c->env_decay));
-	}
+#pragma optimize_for_speed
+static void apply_envelope(SIMPLE_SYNTH * c, float * audio,
+		uint32_t audio_block_size) {
+
+	uint32_t attack_end = c->env_attack;
+	uint32_t decay_end = attack_end + c->env_decay;
+	uint32_t sustain_end = decay_end + c->env_sustain;
+	uint32_t release_end = sustain_end + c->env_release;
+
+	uint32_t i = 0;
+	while (i < audio_block_size) {
+
+		uint32_t pos = c->position;
+		uint32_t end;
+		float env, env_inc;
+
+		if (pos < attack_end) {
+			// Attack
+			env = (float) pos / (float) c->env_attack;
+			env_inc = 1.0 / (float) c->env_attack;
+			end = attack_end;
+		} else if (pos < decay_end) {
+			// Decay
+			float decay_pos = (float) (pos - attack_end);
+			env = 0.8 + 0.2 * (1.0 - decay_pos / (float) c->env_decay);
+			env_inc = -0.2 / (float) c->env_decay;
+			end = decay_end;
+		} else if (pos < sustain_end) {
+			// Sustain
+			env = 0.8;
+			env_inc = 0.0;
+			end = sustain_end;
+		} else if (pos < release_end) {
+			// Release
+			float release_pos = (float) (pos - sustain_end);
+			env = 0.8 * (1.0 - release_pos / (float) c->env_release);
+			env_inc = -0.8 / (float) c->env_release;
+			end = release_end;
+		} else {
+			// Done, silence the rest of the block
+			c->playing = false;
+			for (; i < audio_block_size; i++) {
+				audio[i] = 0.0;
+			}
+			return;
+		}
 
-	// Sustain
-	if (c->position < c->env_attack + c->env_decay + c->env_sustain) {
-		return 0.8;
-	}
+		uint32_t span = end - pos;
+		if (span > audio_block_size - i) {
+			span = audio_block_size - i;
+		}
 
-	// Release
-	if (c->position
-			< c->env_attack + c->env_decay + c->env_sustain + c->env_release) {
-		uint32_t pos = c->position
-				- (c->env_attack + c->env_decay + c->env_sustain);
-		return 0.8 * (1.0 - ((float) pos / (float) c->env_release));
-	}
+		env *= c->volume;
+		env_inc *= c->volume;
+		for (int j = 0; j < span; j++) {
+			audio[i + j] *= env;
+			env += env_inc;
+		}
 
-	else {
-		c->playing = false;
-		return 0.0;
+		i += span;
+		c->position += span;
 	}
 }
-
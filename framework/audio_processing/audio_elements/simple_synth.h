@@ -10,6 +10,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "../audio_elements/audio_elements_common.h"
+#include "../audio_elements/oscillators.h"
 
 // Various types of synth oscillators to choose from
 typedef enum {
@@ -38,9 +39,8 @@ typedef struct {
 	float volume;
 	uint32_t note;
 
-	// time variable for tone generators
-	float t;
-	float t_inc;
+	// Band-limited tone generator
+	OSCILLATOR osc;
 
 	// Position in ADSR envelope
 	uint32_t position;
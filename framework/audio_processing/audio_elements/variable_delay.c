@@ -52,11 +52,14 @@ RESULT_VARIABLE_DELAY variable_delay_setup(VARIABLE_DELAY * c, float depth,
 	c->feedback = feedback;
 	c->mod_depth = depth;
 	c->mod_rate_hz = rate_hz;
+	c->mod_type = type;
 
 	c->audio_sample_rate = audio_sample_rate;
 	c->inc = rate_hz / c->audio_sample_rate;
+	c->t = 0.0;
 
 	c->delay_index = 0;
+	c->feedback_lastsamp = 0.0;
 
 	// clear delay line
 	for (i = 0; i < VARIABLE_DELAY_MAX_DEPTH + VARIABLE_DELAY_PRE_DELAY; i++)
@@ -197,47 +200,57 @@ void variable_delay_read(VARIABLE_DELAY * c, float * audio_in,
 	uint32_t indx, indx2;
 	float delta;
 
-	float t = c->t;
-	float inc = c->inc;
-
 	last_sample = c->feedback_lastsamp;
 
+	// Modulation signal, -1.0 -> 1.0
+	float lfo[MAX_AUDIO_BLOCK_SIZE];
+	float * mod = lfo;
+	switch (c->mod_type) {
+	case VARIABLE_DELAY_SIN:
+		oscillator_lfo_block(OSC_SINE, &c->t, c->inc, lfo, audio_block_size);
+		break;
+	case VARIABLE_DELAY_TRI:
+		oscillator_lfo_block(OSC_TRIANGLE, &c->t, c->inc, lfo,
+				audio_block_size);
+		break;
+	case VARIABLE_DELAY_SQR:
+		oscillator_lfo_block(OSC_SQUARE, &c->t, c->inc, lfo, audio_block_size);
+		break;
+	case VARIABLE_DELAY_EXT_LFO:
+	default:
+		mod = ext_mod;
+		break;
+	}
+
+	float mod_scale = 0.5 * c->mod_depth * VARIABLE_DELAY_MAX_DEPTH * 0.9;
+	float mod_offset = VARIABLE_DELAY_PRE_DELAY;
+	if (c->mod_type != VARIABLE_DELAY_EXT_LFO) {
+		// Internal LFOs are unipolar (0.5 * lfo + 0.5)
+		mod_offset += mod_scale;
+	}
+
 	for (int i = 0; i < audio_block_size; i++) {
-		if (c->mod_type == VARIABLE_DELAY_EXT_LFO) {
-			mod_pointer = VARIABLE_DELAY_PRE_DELAY
-					+ (0.5 * ext_mod[i] * c->mod_depth
-							* VARIABLE_DELAY_MAX_DEPTH * 0.9);
-		} else {
-			switch (c->mod_type) {
-			case VARIABLE_DELAY_SIN:
-				mod_pointer = VARIABLE_DELAY_PRE_DELAY
-						+ (0.5 * oscillator_sine(t += inc) + 0.5) * c->mod_depth
-								* VARIABLE_DELAY_MAX_DEPTH * 0.9;
-				break;
-			case VARIABLE_DELAY_TRI:
-				mod_pointer = VARIABLE_DELAY_PRE_DELAY
-						+ (0.5 * oscillator_triangle(t += inc) + 0.5)
-								* c->mod_depth * VARIABLE_DELAY_MAX_DEPTH * 0.9;
-				break;
-			case VARIABLE_DELAY_SQR:
-				mod_pointer = VARIABLE_DELAY_PRE_DELAY
-						+ (0.5 * oscillator_square(t += inc) + 0.5)
-								* c->mod_depth * VARIABLE_DELAY_MAX_DEPTH * 0.9;
-				break;
-			default:
-				break;
-			}
-		}
+		mod_pointer = mod_offset + mod_scale * mod[i];
 
 		original = audio_in[i];
 
+		// A bipolar external LFO can put the read pointer on either side
 		mod_pointer = delay_indx - mod_pointer;
-		if (mod_pointer < 0)
+		if (mod_pointer < 0) {
 			mod_pointer += delay_len;
+		} else if (mod_pointer >= delay_len) {
+			mod_pointer -= delay_len;
+		}
 
 		// Interpolate delayed signal
 		indx = (uint32_t) mod_pointer;
-		indx2 = (indx + 1) % VARIABLE_DELAY_MAX_DEPTH;
+		if (indx >= delay_len) {
+			indx -= delay_len;
+		}
+		indx2 = indx + 1;
+		if (indx2 >= delay_len) {
+			indx2 -= delay_len;
+		}
 		delta = mod_pointer - (float) indx;
 		delayed = delay_buf[indx] * (1.0 - delta) + delay_buf[indx2] * delta;
 
@@ -257,9 +270,5 @@ void variable_delay_read(VARIABLE_DELAY * c, float * audio_in,
 	c->feedback_lastsamp = last_sample;
 	c->delay_index = delay_indx;
 
-	// Wrap t and save it
-	t = t - floor(t);
-	c->t = t;
-
 }
 
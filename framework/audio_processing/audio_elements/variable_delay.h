@@ -7,6 +7,7 @@
 #ifndef _VARIABLE_DELAY_H
 #define _VARIABLE_DELAY_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <stdlib.h>
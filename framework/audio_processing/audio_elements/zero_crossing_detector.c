@@ -45,11 +45,11 @@ RESULT_ZERO_CROSSING zero_cross_setup(ZERO_CROSSING_DETECTOR * c,
 	c->peak_amplitude_pos = 0;
 	c->peak_amplitude_neg = 0;
 
-	filter_setup(&c->lpf, BIQUAD_TYPE_LPF, BIQUAD_TRANS_VERY_SLOW,
-			(pm float *) c->lpf_coeffs, 600.0, 1.0, 1.0, audio_sample_rate);
-
-	filter_setup(&c->zero_block, BIQUAD_TYPE_HPF, BIQUAD_TRANS_VERY_SLOW,
-			(pm float *) c->zb_coeffs, 50.0, 1.0, 1.0, audio_sample_rate);
+	biquad_cascade_setup(&c->filters, 2, audio_sample_rate);
+	biquad_cascade_modify_section(&c->filters, 0, BIQUAD_TYPE_HPF, 50.0, 1.0,
+			1.0);
+	biquad_cascade_modify_section(&c->filters, 1, BIQUAD_TYPE_LPF, 600.0, 1.0,
+			1.0);
 
 	// Initialize C struct parameters
 	c->audio_sample_rate = audio_sample_rate;
@@ -90,16 +90,11 @@ bool zero_crossing_read(ZERO_CROSSING_DETECTOR * c, float * audio_in,
 	float zc_buff3[MAX_AUDIO_BLOCK_SIZE];
 
 	float filtered_audio_in[MAX_AUDIO_BLOCK_SIZE];
-	float dc_blocked_audio_in[MAX_AUDIO_BLOCK_SIZE];
 
 	copy_buffer(audio_in, zc_buff1, audio_block_size);
 
-	// Remove DC offset
-	filter_read(&c->zero_block, audio_in, dc_blocked_audio_in,
-			audio_block_size);
-
-	// Run a low-pass filter on the audio
-	filter_read(&c->lpf, dc_blocked_audio_in, filtered_audio_in,
+	// Remove DC offset and run a low-pass filter on the audio
+	biquad_cascade_read(&c->filters, audio_in, filtered_audio_in,
 			audio_block_size);
 
 	// Optionally gain up the input if needed
@@ -12,7 +12,7 @@
 #include <stddef.h>
 
 #include "audio_elements_common.h"
-#include "biquad_filter.h"
+#include "biquad_cascade.h"
 
 // Effect definitions
 #define FREQ_HIST_LEN           (3)
@@ -32,11 +32,8 @@ typedef struct {
 
 	bool initialized;
 
-	BIQUAD_FILTER lpf;
-	float lpf_coeffs[6];
-
-	BIQUAD_FILTER zero_block;
-	float zb_coeffs[6];
+	// DC blocking high-pass filter followed by a low-pass filter
+	BIQUAD_CASCADE filters;
 
 	float dc_last_y;
 	float dc_coeff;
@@ -0,0 +1,502 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * An effect graph describes a chain (or any directed acyclic graph) of audio
+ * elements.  Nodes wrap the _read functions of the elements and edges are
+ * blocks of audio passed between them.  Edges are either bound to a buffer
+ * owned by the caller (the inputs and outputs of the graph, e.g.
+ * audio_effects_left_in) or are intermediate blocks that only exist while the
+ * graph runs.
+ *
+ * effect_graph_compile() does all of the planning up front: it sorts the
+ * nodes into an order where every block is written before it is read, and
+ * then assigns the intermediate blocks to scratch buffers.  A scratch buffer
+ * is reused as soon as the last node reading its block has run, so a long
+ * chain needs only as many buffers as there are blocks alive at the same
+ * time rather than one per connection.  Processing a block is then just a
+ * walk over the precompiled list of nodes.
+ *
+ * A node's outputs never share a buffer with its own inputs, so the wrapped
+ * _read functions don't need to support in-place processing.
+ *
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+
+#include "effect_graph.h"
+#include "audio_elements/audio_utilities.h"
+
+// Edge sources other than a node index
+#define EFFECT_GRAPH_SOURCE_NONE        (-1)
+#define EFFECT_GRAPH_SOURCE_EXTERNAL    (-2)
+
+// Static function prototypes
+static EFFECT_GRAPH_EDGE effect_graph_new_edge(EFFECT_GRAPH * c,
+		float * buffer, int8_t source);
+static bool effect_graph_valid_edge(EFFECT_GRAPH * c, EFFECT_GRAPH_EDGE edge);
+static RESULT_EFFECT_GRAPH effect_graph_sort(EFFECT_GRAPH * c);
+static RESULT_EFFECT_GRAPH effect_graph_allocate(EFFECT_GRAPH * c);
+
+/**
+ * @brief Initializes an empty effect graph
+ *
+ * @param c Pointer to instance structure
+ * @param scratch Pointer to scratch memory (scratch_buffers * audio_block_size floats)
+ * @param scratch_buffers Number of block buffers in the scratch memory
+ * @param audio_block_size The number of floating-point words per block
+ * @return Effect graph result (enumeration)
+ */
+RESULT_EFFECT_GRAPH effect_graph_setup(EFFECT_GRAPH * c, float * scratch,
+		uint32_t scratch_buffers, uint32_t audio_block_size) {
+
+	if (c == NULL) {
+		return EFFECT_GRAPH_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+	c->compiled = false;
+
+	c->num_nodes = 0;
+	c->num_edges = 0;
+	c->build_result = EFFECT_GRAPH_OK;
+
+	if (scratch == NULL && scratch_buffers != 0) {
+		return EFFECT_GRAPH_INVALID_BUFFER_POINTER;
+	}
+
+	if (scratch_buffers > EFFECT_GRAPH_MAX_SCRATCH_BUFFERS) {
+		return EFFECT_GRAPH_OUT_OF_SCRATCH;
+	}
+
+	if (audio_block_size == 0) {
+		return EFFECT_GRAPH_INVALID_BLOCK_SIZE;
+	}
+
+	c->scratch = scratch;
+	c->scratch_buffers = scratch_buffers;
+	c->scratch_buffers_used = 0;
+	c->audio_block_size = audio_block_size;
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return EFFECT_GRAPH_OK;
+}
+
+/**
+ * @brief Adds an edge carrying audio into the graph
+ *
+ * @param c Pointer to instance structure
+ * @param buffer Buffer the graph reads the block from
+ * @return Edge, or EFFECT_GRAPH_NO_EDGE if it couldn't be added
+ */
+EFFECT_GRAPH_EDGE effect_graph_add_input(EFFECT_GRAPH * c, float * buffer) {
+
+	if (buffer == NULL) {
+		if (c != NULL && c->build_result == EFFECT_GRAPH_OK) {
+			c->build_result = EFFECT_GRAPH_INVALID_BUFFER_POINTER;
+		}
+		return EFFECT_GRAPH_NO_EDGE;
+	}
+
+	return effect_graph_new_edge(c, buffer, EFFECT_GRAPH_SOURCE_EXTERNAL);
+}
+
+/**
+ * @brief Adds an edge carrying audio out of the graph
+ *
+ * Exactly one node must write the edge.  Later nodes may also read it.
+ *
+ * @param c Pointer to instance structure
+ * @param buffer Buffer the graph writes the block to
+ * @return Edge, or EFFECT_GRAPH_NO_EDGE if it couldn't be added
+ */
+EFFECT_GRAPH_EDGE effect_graph_add_output(EFFECT_GRAPH * c, float * buffer) {
+
+	if (buffer == NULL) {
+		if (c != NULL && c->build_result == EFFECT_GRAPH_OK) {
+			c->build_result = EFFECT_GRAPH_INVALID_BUFFER_POINTER;
+		}
+		return EFFECT_GRAPH_NO_EDGE;
+	}
+
+	return effect_graph_new_edge(c, buffer, EFFECT_GRAPH_SOURCE_NONE);
+}
+
+/**
+ * @brief Adds an intermediate edge between two or more nodes
+ *
+ * The buffer for the edge is assigned from the scratch memory when the graph
+ * is compiled.
+ *
+ * @param c Pointer to instance structure
+ * @return Edge, or EFFECT_GRAPH_NO_EDGE if it couldn't be added
+ */
+EFFECT_GRAPH_EDGE effect_graph_add_edge(EFFECT_GRAPH * c) {
+
+	return effect_graph_new_edge(c, NULL, EFFECT_GRAPH_SOURCE_NONE);
+}
+
+/**
+ * @brief Adds a node to the graph
+ *
+ * The process function is called once per block with arrays of num_inputs
+ * and num_outputs buffer pointers, in the order the edges are given here.
+ * The same edge may be passed to several inputs.
+ *
+ * @param c Pointer to instance structure
+ * @param process Node process function
+ * @param instance Pointer passed to the process function (e.g. element instance)
+ * @param num_inputs Number of input edges (0 - EFFECT_GRAPH_MAX_PORTS)
+ * @param inputs Array of input edges
+ * @param num_outputs Number of output edges (0 - EFFECT_GRAPH_MAX_PORTS)
+ * @param outputs Array of output edges
+ * @return Effect graph result (enumeration)
+ */
+RESULT_EFFECT_GRAPH effect_graph_add_node(EFFECT_GRAPH * c,
+		EFFECT_GRAPH_PROCESS process, void * instance, uint32_t num_inputs,
+		const EFFECT_GRAPH_EDGE * inputs, uint32_t num_outputs,
+		const EFFECT_GRAPH_EDGE * outputs) {
+
+	RESULT_EFFECT_GRAPH res = EFFECT_GRAPH_OK;
+
+	if (c == NULL || !c->initialized) {
+		return EFFECT_GRAPH_INVALID_INSTANCE_POINTER;
+	}
+
+	// Any change to the graph needs a new compile
+	c->compiled = false;
+
+	if (process == NULL) {
+		res = EFFECT_GRAPH_INVALID_PROCESS_POINTER;
+	} else if (c->num_nodes >= EFFECT_GRAPH_MAX_NODES) {
+		res = EFFECT_GRAPH_TOO_MANY_NODES;
+	} else if (num_inputs > EFFECT_GRAPH_MAX_PORTS
+			|| num_outputs > EFFECT_GRAPH_MAX_PORTS) {
+		res = EFFECT_GRAPH_TOO_MANY_PORTS;
+	} else {
+		for (int i = 0; i < num_inputs; i++) {
+			if (!effect_graph_valid_edge(c, inputs[i])) {
+				res = EFFECT_GRAPH_INVALID_EDGE;
+			}
+		}
+		for (int i = 0; i < num_outputs; i++) {
+			if (!effect_graph_valid_edge(c, outputs[i])) {
+				res = EFFECT_GRAPH_INVALID_EDGE;
+			} else if (c->edge_source[outputs[i]] != EFFECT_GRAPH_SOURCE_NONE) {
+				res = EFFECT_GRAPH_EDGE_WITH_MULTIPLE_SOURCES;
+			}
+			for (int j = 0; j < i; j++) {
+				if (outputs[j] == outputs[i]) {
+					res = EFFECT_GRAPH_EDGE_WITH_MULTIPLE_SOURCES;
+				}
+			}
+		}
+	}
+
+	if (res != EFFECT_GRAPH_OK) {
+		if (c->build_result == EFFECT_GRAPH_OK) {
+			c->build_result = res;
+		}
+		return res;
+	}
+
+	uint32_t n = c->num_nodes++;
+	EFFECT_GRAPH_NODE * node = &c->nodes[n];
+
+	node->process = process;
+	node->instance = instance;
+	node->num_inputs = num_inputs;
+	node->num_outputs = num_outputs;
+	for (int i = 0; i < num_inputs; i++) {
+		node->inputs[i] = inputs[i];
+	}
+	for (int i = 0; i < num_outputs; i++) {
+		node->outputs[i] = outputs[i];
+		c->edge_source[outputs[i]] = n;
+	}
+
+	return EFFECT_GRAPH_OK;
+}
+
+/**
+ * @brief Plans the execution order and buffer assignment of the graph
+ *
+ * Must be called after the last node is added and before the graph is
+ * processed.  Runs in the setup / control path, not per block.
+ *
+ * @param c Pointer to instance structure
+ * @return Effect graph result (enumeration)
+ */
+RESULT_EFFECT_GRAPH effect_graph_compile(EFFECT_GRAPH * c) {
+
+	if (c == NULL || !c->initialized) {
+		return EFFECT_GRAPH_INVALID_INSTANCE_POINTER;
+	}
+
+	c->compiled = false;
+
+	if (c->build_result != EFFECT_GRAPH_OK) {
+		return c->build_result;
+	}
+
+	// Every edge needs something writing it
+	for (int e = 0; e < c->num_edges; e++) {
+		if (c->edge_source[e] == EFFECT_GRAPH_SOURCE_NONE) {
+			return EFFECT_GRAPH_EDGE_WITHOUT_SOURCE;
+		}
+	}
+
+	RESULT_EFFECT_GRAPH res = effect_graph_sort(c);
+	if (res != EFFECT_GRAPH_OK) {
+		return res;
+	}
+
+	res = effect_graph_allocate(c);
+	if (res != EFFECT_GRAPH_OK) {
+		return res;
+	}
+
+	// Resolve the buffers of every port now so processing is a plain walk
+	for (int n = 0; n < c->num_nodes; n++) {
+		EFFECT_GRAPH_NODE * node = &c->nodes[n];
+		for (int i = 0; i < node->num_inputs; i++) {
+			node->input_buffers[i] = c->edge_buffer[node->inputs[i]];
+		}
+		for (int i = 0; i < node->num_outputs; i++) {
+			node->output_buffers[i] = c->edge_buffer[node->outputs[i]];
+		}
+	}
+
+	c->compiled = true;
+	return EFFECT_GRAPH_OK;
+}
+
+/**
+ * @brief Runs every node of the graph on one block of audio
+ *
+ * If the graph hasn't been compiled, its output buffers are cleared.
+ *
+ * @param c Pointer to instance structure
+ */
+#pragma optimize_for_speed
+void effect_graph_process(EFFECT_GRAPH * c) {
+
+	if (c == NULL || !c->initialized) {
+		return;
+	}
+
+	uint32_t audio_block_size = c->audio_block_size;
+
+	if (!c->compiled) {
+		for (int e = 0; e < c->num_edges; e++) {
+			if (c->edge_external[e]
+					&& c->edge_source[e] != EFFECT_GRAPH_SOURCE_EXTERNAL) {
+				clear_buffer(c->edge_buffer[e], audio_block_size);
+			}
+		}
+		return;
+	}
+
+	for (int i = 0; i < c->num_nodes; i++) {
+		EFFECT_GRAPH_NODE * node = &c->nodes[c->order[i]];
+		node->process(node->instance, node->input_buffers,
+				node->output_buffers, audio_block_size);
+	}
+}
+
+/**
+ * @brief Node process function that copies its first input to its first output
+ *
+ * Useful to send a mono effect to both sides of a stereo output.
+ *
+ * @param instance Unused (NULL)
+ * @param audio_in Array with the input buffer
+ * @param audio_out Array with the output buffer
+ * @param audio_block_size The number of floating-point words to process
+ */
+void effect_graph_copy(void * instance, float ** audio_in, float ** audio_out,
+		uint32_t audio_block_size) {
+
+	// Signature of a node process function, there is no instance to use
+	(void) instance;
+
+	copy_buffer(audio_in[0], audio_out[0], audio_block_size);
+}
+
+/**
+ * @brief Adds an edge to the edge table
+ *
+ * @param c Pointer to instance structure
+ * @param buffer Caller's buffer, or NULL for an intermediate edge
+ * @param source Initial source of the edge
+ * @return Edge, or EFFECT_GRAPH_NO_EDGE if the table is full
+ */
+static EFFECT_GRAPH_EDGE effect_graph_new_edge(EFFECT_GRAPH * c,
+		float * buffer, int8_t source) {
+
+	if (c == NULL || !c->initialized) {
+		return EFFECT_GRAPH_NO_EDGE;
+	}
+
+	c->compiled = false;
+
+	if (c->num_edges >= EFFECT_GRAPH_MAX_EDGES) {
+		if (c->build_result == EFFECT_GRAPH_OK) {
+			c->build_result = EFFECT_GRAPH_TOO_MANY_EDGES;
+		}
+		return EFFECT_GRAPH_NO_EDGE;
+	}
+
+	EFFECT_GRAPH_EDGE e = c->num_edges++;
+	c->edge_buffer[e] = buffer;
+	c->edge_source[e] = source;
+	c->edge_external[e] = (buffer != NULL);
+
+	return e;
+}
+
+/**
+ * @brief Checks that an edge belongs to the graph
+ *
+ * @param c Pointer to instance structure
+ * @param edge Edge to check
+ * @return true if the edge is valid
+ */
+static bool effect_graph_valid_edge(EFFECT_GRAPH * c, EFFECT_GRAPH_EDGE edge) {
+
+	return (edge >= 0 && edge < (EFFECT_GRAPH_EDGE) c->num_edges);
+}
+
+/**
+ * @brief Sorts the nodes so each one runs after the nodes writing its inputs
+ *
+ * Among the nodes that are ready to run, the one added first is picked, so a
+ * graph built in processing order keeps that order.
+ *
+ * @param c Pointer to instance structure
+ * @return Effect graph result (enumeration)
+ */
+static RESULT_EFFECT_GRAPH effect_graph_sort(EFFECT_GRAPH * c) {
+
+	bool scheduled[EFFECT_GRAPH_MAX_NODES];
+	for (int n = 0; n < c->num_nodes; n++) {
+		scheduled[n] = false;
+	}
+
+	for (int pos = 0; pos < c->num_nodes; pos++) {
+
+		int ready = -1;
+		for (int n = 0; n < c->num_nodes && ready < 0; n++) {
+			if (scheduled[n]) {
+				continue;
+			}
+			bool inputs_ready = true;
+			EFFECT_GRAPH_NODE * node = &c->nodes[n];
+			for (int i = 0; i < node->num_inputs; i++) {
+				int8_t source = c->edge_source[node->inputs[i]];
+				if (source >= 0 && !scheduled[source]) {
+					inputs_ready = false;
+				}
+			}
+			if (inputs_ready) {
+				ready = n;
+			}
+		}
+
+		// Nodes are left but none can run: they're waiting on each other
+		if (ready < 0) {
+			return EFFECT_GRAPH_CYCLE;
+		}
+
+		scheduled[ready] = true;
+		c->order[pos] = ready;
+	}
+
+	return EFFECT_GRAPH_OK;
+}
+
+/**
+ * @brief Assigns scratch buffers to the intermediate edges
+ *
+ * Walks the nodes in execution order.  Each intermediate output takes the
+ * lowest free scratch buffer; once a node has run, the buffers of the edges
+ * that aren't read again are freed for the nodes that follow.
+ *
+ * @param c Pointer to instance structure
+ * @return Effect graph result (enumeration)
+ */
+static RESULT_EFFECT_GRAPH effect_graph_allocate(EFFECT_GRAPH * c) {
+
+	// Position in the execution order of the last node reading each edge
+	int8_t last_use[EFFECT_GRAPH_MAX_EDGES];
+	int8_t buffer_index[EFFECT_GRAPH_MAX_EDGES];
+
+	for (int e = 0; e < c->num_edges; e++) {
+		last_use[e] = -1;
+		buffer_index[e] = -1;
+	}
+	for (int pos = 0; pos < c->num_nodes; pos++) {
+		EFFECT_GRAPH_NODE * node = &c->nodes[c->order[pos]];
+		for (int i = 0; i < node->num_inputs; i++) {
+			last_use[node->inputs[i]] = pos;
+		}
+		for (int i = 0; i < node->num_outputs; i++) {
+			// A block nobody reads is still written, free it right away
+			if (last_use[node->outputs[i]] < pos) {
+				last_use[node->outputs[i]] = pos;
+			}
+		}
+	}
+
+	uint32_t free_mask = 0;
+	for (int b = 0; b < c->scratch_buffers; b++) {
+		free_mask |= (1u << b);
+	}
+	uint32_t used_mask = 0;
+
+	for (int pos = 0; pos < c->num_nodes; pos++) {
+
+		EFFECT_GRAPH_NODE * node = &c->nodes[c->order[pos]];
+
+		// Take buffers for the outputs before the inputs are released
+		for (int i = 0; i < node->num_outputs; i++) {
+			EFFECT_GRAPH_EDGE e = node->outputs[i];
+			if (c->edge_external[e]) {
+				continue;
+			}
+			if (free_mask == 0) {
+				return EFFECT_GRAPH_OUT_OF_SCRATCH;
+			}
+			int b = 0;
+			while (!(free_mask & (1u << b))) {
+				b++;
+			}
+			free_mask &= ~(1u << b);
+			used_mask |= (1u << b);
+			buffer_index[e] = b;
+			c->edge_buffer[e] = c->scratch + b * c->audio_block_size;
+		}
+
+		// Release the blocks whose last reader (or writer) is this node
+		for (int i = 0; i < node->num_inputs + node->num_outputs; i++) {
+			EFFECT_GRAPH_EDGE e =
+					(i < node->num_inputs) ?
+							node->inputs[i] :
+							node->outputs[i - node->num_inputs];
+			if (buffer_index[e] >= 0 && last_use[e] == pos) {
+				free_mask |= (1u << buffer_index[e]);
+				buffer_index[e] = -1;
+			}
+		}
+	}
+
+	// Highest scratch buffer touched, for sizing the scratch memory
+	c->scratch_buffers_used = 0;
+	while (c->scratch_buffers_used < c->scratch_buffers
+			&& (used_mask >> c->scratch_buffers_used)) {
+		c->scratch_buffers_used++;
+	}
+
+	return EFFECT_GRAPH_OK;
+}
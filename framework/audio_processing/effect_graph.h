@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _EFFECT_GRAPH_H
+#define _EFFECT_GRAPH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements/audio_elements_common.h"
+
+// Size limits of a graph
+#define EFFECT_GRAPH_MAX_NODES              (32)
+#define EFFECT_GRAPH_MAX_EDGES              (64)
+#define EFFECT_GRAPH_MAX_PORTS              (4)
+#define EFFECT_GRAPH_MAX_SCRATCH_BUFFERS    (32)
+
+// Returned by the effect_graph_add_ functions when the edge can't be created
+#define EFFECT_GRAPH_NO_EDGE                (-1)
+
+// Result enumerations
+typedef enum {
+	EFFECT_GRAPH_OK,
+	EFFECT_GRAPH_INVALID_INSTANCE_POINTER,
+	EFFECT_GRAPH_INVALID_BUFFER_POINTER,
+	EFFECT_GRAPH_INVALID_BLOCK_SIZE,
+	EFFECT_GRAPH_INVALID_PROCESS_POINTER,
+	EFFECT_GRAPH_INVALID_EDGE,
+	EFFECT_GRAPH_TOO_MANY_NODES,
+	EFFECT_GRAPH_TOO_MANY_EDGES,
+	EFFECT_GRAPH_TOO_MANY_PORTS,
+	EFFECT_GRAPH_EDGE_WITHOUT_SOURCE,
+	EFFECT_GRAPH_EDGE_WITH_MULTIPLE_SOURCES,
+	EFFECT_GRAPH_CYCLE,
+	EFFECT_GRAPH_OUT_OF_SCRATCH
+} RESULT_EFFECT_GRAPH;
+
+// An edge is one block of audio, referred to by its index in the graph
+typedef int32_t EFFECT_GRAPH_EDGE;
+
+// Node process function (usually a thin wrapper around an element's _read)
+typedef void (*EFFECT_GRAPH_PROCESS)(void * instance, float ** audio_in,
+		float ** audio_out, uint32_t audio_block_size);
+
+// A node and the buffers of its ports (resolved by effect_graph_compile)
+typedef struct {
+	EFFECT_GRAPH_PROCESS process;
+	void * instance;
+
+	uint32_t num_inputs;
+	uint32_t num_outputs;
+	EFFECT_GRAPH_EDGE inputs[EFFECT_GRAPH_MAX_PORTS];
+	EFFECT_GRAPH_EDGE outputs[EFFECT_GRAPH_MAX_PORTS];
+
+	float * input_buffers[EFFECT_GRAPH_MAX_PORTS];
+	float * output_buffers[EFFECT_GRAPH_MAX_PORTS];
+} EFFECT_GRAPH_NODE;
+
+// C struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+	bool compiled;
+
+	// First error while building the graph, reported by effect_graph_compile
+	RESULT_EFFECT_GRAPH build_result;
+
+	uint32_t audio_block_size;
+
+	// Scratch memory shared by the intermediate blocks
+	float * scratch;
+	uint32_t scratch_buffers;
+	uint32_t scratch_buffers_used;
+
+	uint32_t num_nodes;
+	EFFECT_GRAPH_NODE nodes[EFFECT_GRAPH_MAX_NODES];
+
+	// Execution order (node indices)
+	uint8_t order[EFFECT_GRAPH_MAX_NODES];
+
+	uint32_t num_edges;
+	float * edge_buffer[EFFECT_GRAPH_MAX_EDGES];
+	int8_t edge_source[EFFECT_GRAPH_MAX_EDGES];
+	bool edge_external[EFFECT_GRAPH_MAX_EDGES];
+
+} EFFECT_GRAPH;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_EFFECT_GRAPH effect_graph_setup(EFFECT_GRAPH * c, float * scratch,
+		uint32_t scratch_buffers, uint32_t audio_block_size);
+
+EFFECT_GRAPH_EDGE effect_graph_add_input(EFFECT_GRAPH * c, float * buffer);
+EFFECT_GRAPH_EDGE effect_graph_add_output(EFFECT_GRAPH * c, float * buffer);
+EFFECT_GRAPH_EDGE effect_graph_add_edge(EFFECT_GRAPH * c);
+
+RESULT_EFFECT_GRAPH effect_graph_add_node(EFFECT_GRAPH * c,
+		EFFECT_GRAPH_PROCESS process, void * instance, uint32_t num_inputs,
+		const EFFECT_GRAPH_EDGE * inputs, uint32_t num_outputs,
+		const EFFECT_GRAPH_EDGE * outputs);
+
+RESULT_EFFECT_GRAPH effect_graph_compile(EFFECT_GRAPH * c);
+
+void effect_graph_process(EFFECT_GRAPH * c);
+
+void effect_graph_copy(void * instance, float ** audio_in, float ** audio_out,
+		uint32_t audio_block_size);
+
+#if __cplusplus
+}
+#endif
+
+#endif  // _EFFECT_GRAPH_H
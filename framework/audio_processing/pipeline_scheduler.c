@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * The pipeline scheduler splits a chain of effects (the stages of a pipeline)
+ * between SHARC core 1 and SHARC core 2.
+ *
+ * Both cores set up a scheduler with the same list of stages.  A single
+ * number, the split, says which core runs what: core 1 runs the stages before
+ * the split on a block, then the block is moved to core 2 (by MDMA in the
+ * audio framework), which runs the rest of the stages on it.  Stages can be
+ * pinned to a core (e.g. a synth that is driven by MIDI arriving on core 1);
+ * the stages pinned to core 1 must come first and those pinned to core 2 last,
+ * which limits the range of the split.
+ *
+ * The split can be changed while audio is running.  For every block to be
+ * processed exactly once, core 2 has to use the split core 1 used for the
+ * same block, so the split travels with the audio: the caller passes it from
+ * core 1 to core 2 along with each block.  A stage that moves to a core is set
+ * up there first (pipeline_scheduler_prepare(), from the background loop) so
+ * it doesn't play back stale state from the last time it ran on that core.
+ * It starts from a clean state, so a reverb tail for instance is cut short.
+ *
+ * Each stage is timed with a cycle profiler scope (see bm_cycle_profiler.c)
+ * on each core it can run on.  pipeline_scheduler_balance() takes the tables
+ * both cores publish and picks the split that gives the lowest load on the
+ * busier of the two cores.  The cost of a stage is the same on either core,
+ * and whatever else a core does per block (the audio framework, the other
+ * audio processing) is its average block time less the stages it ran.  To
+ * keep the stages from moving back and forth, a new split is only returned
+ * if it's better than the current one by a margin.
+ *
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "pipeline_scheduler.h"
+#include "audio_elements/audio_utilities.h"
+
+// Static function prototypes
+static void pipeline_scheduler_range(PIPELINE_SCHEDULER * c, uint32_t split,
+		uint32_t * first, uint32_t * last);
+static const BM_CYCLE_PROFILE_SCOPE * pipeline_scheduler_find_scope(
+		const BM_CYCLE_PROFILE_TABLE * profile, const char * name);
+
+/**
+ * @brief Initializes a pipeline scheduler on one of the SHARC cores
+ *
+ * The stages this core runs with the initial split are set up here, in the
+ * calling context.  Each stage that can run on this core gets a profiler
+ * scope, so the profiler should be initialized first.
+ *
+ * @param c Pointer to instance structure
+ * @param stages Array of stages, in processing order
+ * @param num_stages Number of stages in the array
+ * @param core SHARC core this instance runs on (1 or 2)
+ * @param split Number of stages initially run on core 1
+ * @param num_channels Number of channels passed between the stages
+ * @param audio_block_size The number of floating-point words per block
+ * @return Pipeline scheduler result (enumeration)
+ */
+RESULT_PIPELINE_SCHEDULER pipeline_scheduler_setup(PIPELINE_SCHEDULER * c,
+		const PIPELINE_STAGE * stages, uint32_t num_stages, uint32_t core,
+		uint32_t split, uint32_t num_channels, uint32_t audio_block_size) {
+
+	if (c == NULL) {
+		return PIPELINE_SCHEDULER_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	if (num_stages < 1 || num_stages > PIPELINE_SCHEDULER_MAX_STAGES) {
+		return PIPELINE_SCHEDULER_INVALID_NUM_STAGES;
+	}
+
+	if (stages == NULL) {
+		return PIPELINE_SCHEDULER_INVALID_STAGES_POINTER;
+	}
+	for (int s = 0; s < num_stages; s++) {
+		if (stages[s].process == NULL) {
+			return PIPELINE_SCHEDULER_INVALID_STAGES_POINTER;
+		}
+	}
+	c->stages = stages;
+	c->num_stages = num_stages;
+
+	if (core != 1 && core != 2) {
+		return PIPELINE_SCHEDULER_INVALID_CORE;
+	}
+	c->core = core;
+
+	if (num_channels < 1 || num_channels > PIPELINE_SCHEDULER_MAX_CHANNELS) {
+		return PIPELINE_SCHEDULER_INVALID_NUM_CHANNELS;
+	}
+	c->num_channels = num_channels;
+
+	c->audio_block_size = audio_block_size;
+
+	// Stages pinned to core 1 come first, stages pinned to core 2 last
+	uint32_t split_min = 0;
+	while (split_min < num_stages
+			&& stages[split_min].core == PIPELINE_STAGE_CORE1) {
+		split_min++;
+	}
+	uint32_t split_max = num_stages;
+	while (split_max > split_min
+			&& stages[split_max - 1].core == PIPELINE_STAGE_CORE2) {
+		split_max--;
+	}
+	for (int s = split_min; s < split_max; s++) {
+		if (stages[s].core != PIPELINE_STAGE_ANY_CORE) {
+			return PIPELINE_SCHEDULER_INVALID_STAGES_POINTER;
+		}
+	}
+	c->split_min = split_min;
+	c->split_max = split_max;
+
+	if (split < split_min || split > split_max) {
+		return PIPELINE_SCHEDULER_INVALID_SPLIT;
+	}
+
+	// Time each stage that can run on this core
+	for (int s = 0; s < num_stages; s++) {
+		bool runs_here = (core == 1) ? (s < split_max) : (s >= split_min);
+		c->profile_scope[s] =
+				runs_here ?
+						cycle_profiler_add_scope(stages[s].name) :
+						CYCLE_PROFILER_NO_SCOPE;
+	}
+
+	// Set up the stages this core starts with
+	uint32_t first, last;
+	pipeline_scheduler_range(c, split, &first, &last);
+	for (int s = first; s < last; s++) {
+		if (stages[s].setup != NULL) {
+			stages[s].setup();
+		}
+	}
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return PIPELINE_SCHEDULER_OK;
+}
+
+/**
+ * @brief Clips a split to the range allowed by the pinned stages
+ *
+ * @param c Pointer to instance structure
+ * @param split Number of stages run on core 1
+ * @return Split within the allowed range
+ */
+uint32_t pipeline_scheduler_clip_split(PIPELINE_SCHEDULER * c,
+		uint32_t split) {
+
+	if (split < c->split_min) {
+		return c->split_min;
+	}
+	if (split > c->split_max) {
+		return c->split_max;
+	}
+	return split;
+}
+
+/**
+ * @brief Sets up the stages that move to this core, call from the background loop
+ *
+ * Must be called before this core runs with the new split.  The stages
+ * leaving this core are left as they are.
+ *
+ * @param c Pointer to instance structure
+ * @param split_from Split the cores are running with
+ * @param split_to Split the cores are about to run with
+ */
+void pipeline_scheduler_prepare(PIPELINE_SCHEDULER * c, uint32_t split_from,
+		uint32_t split_to) {
+
+	if (c == NULL || !c->initialized) {
+		return;
+	}
+
+	uint32_t first_from, last_from, first_to, last_to;
+	pipeline_scheduler_range(c, pipeline_scheduler_clip_split(c, split_from),
+			&first_from, &last_from);
+	pipeline_scheduler_range(c, pipeline_scheduler_clip_split(c, split_to),
+			&first_to, &last_to);
+
+	for (int s = first_to; s < last_to; s++) {
+		if ((s < first_from || s >= last_from) && c->stages[s].setup != NULL) {
+			c->stages[s].setup();
+		}
+	}
+}
+
+/**
+ * @brief Picks the split that balances the load of the two cores
+ *
+ * @param c Pointer to instance structure
+ * @param core1_profile Profile table published by core 1
+ * @param core2_profile Profile table published by core 2
+ * @param split Split the profiles were measured with
+ * @param hysteresis_cycles Cycles per block a new split has to save on the
+ *        busier core before it's returned
+ * @return Split to use (split if it's already the best one)
+ */
+uint32_t pipeline_scheduler_balance(PIPELINE_SCHEDULER * c,
+		const BM_CYCLE_PROFILE_TABLE * core1_profile,
+		const BM_CYCLE_PROFILE_TABLE * core2_profile, uint32_t split,
+		uint32_t hysteresis_cycles) {
+
+	if (c == NULL || !c->initialized || core1_profile == NULL
+			|| core2_profile == NULL || core1_profile->window_blocks == 0
+			|| core2_profile->window_blocks == 0) {
+		return split;
+	}
+
+	split = pipeline_scheduler_clip_split(c, split);
+
+	// Cycles each core spends per block outside of the stages
+	int64_t other_cycles[2] = { core1_profile->block_cycles_avg,
+			core2_profile->block_cycles_avg };
+
+	// Average cost of each stage per block, on whichever core it ran
+	uint32_t cost[PIPELINE_SCHEDULER_MAX_STAGES];
+
+	for (int s = 0; s < c->num_stages; s++) {
+
+		const BM_CYCLE_PROFILE_SCOPE * scope[2];
+		scope[0] = pipeline_scheduler_find_scope(core1_profile,
+				c->stages[s].name);
+		scope[1] = pipeline_scheduler_find_scope(core2_profile,
+				c->stages[s].name);
+		uint32_t window_blocks[2] = { core1_profile->window_blocks,
+				core2_profile->window_blocks };
+
+		uint64_t cycles = 0;
+		uint32_t blocks = 0;
+		for (int k = 0; k < 2; k++) {
+			if (scope[k] != NULL) {
+				cycles += (uint64_t) scope[k]->cycles_avg * scope[k]->blocks;
+				blocks += scope[k]->blocks;
+				other_cycles[k] -= (int64_t) scope[k]->cycles_avg
+						* scope[k]->blocks / window_blocks[k];
+			}
+		}
+		cost[s] = (blocks) ? (uint32_t) (cycles / blocks) : 0;
+	}
+
+	for (int k = 0; k < 2; k++) {
+		if (other_cycles[k] < 0) {
+			other_cycles[k] = 0;
+		}
+	}
+
+	// Load of the busier core for each split, start with all stages on core 2
+	uint64_t load_core1 = other_cycles[0];
+	uint64_t load_core2 = other_cycles[1];
+	for (int s = 0; s < c->num_stages; s++) {
+		load_core2 += cost[s];
+	}
+
+	uint64_t load_current = 0;
+	uint64_t load_best = 0;
+	uint32_t split_best = split;
+
+	for (int k = 0; k <= c->split_max; k++) {
+
+		if (k >= c->split_min) {
+			uint64_t load = (load_core1 > load_core2) ? load_core1 : load_core2;
+			if (k == split) {
+				load_current = load;
+			}
+			if (k == c->split_min || load < load_best) {
+				load_best = load;
+				split_best = k;
+			}
+		}
+
+		// Move stage k to core 1 for the next split
+		if (k < c->num_stages) {
+			load_core1 += cost[k];
+			load_core2 -= cost[k];
+		}
+	}
+
+	if (load_best + hysteresis_cycles < load_current) {
+		return split_best;
+	}
+	return split;
+}
+
+/**
+ * @brief Runs this core's stages on one block of audio
+ *
+ * The first stage reads audio_in, the following ones work on audio_out.  If
+ * this core has no stages for the split, audio_in is copied to audio_out.
+ *
+ * @param c Pointer to instance structure
+ * @param split Number of stages core 1 runs (for this block)
+ * @param audio_in Array of num_channels pointers to audio input buffers
+ * @param audio_out Array of num_channels pointers to audio output buffers
+ */
+#pragma optimize_for_speed
+void pipeline_scheduler_run(PIPELINE_SCHEDULER * c, uint32_t split,
+		float ** audio_in, float ** audio_out) {
+
+	// If this instance hasn't been properly initialized, pass audio through
+	if (c == NULL || !c->initialized) {
+		if (c != NULL) {
+			for (int ch = 0; ch < c->num_channels; ch++) {
+				if (audio_in[ch] != audio_out[ch]) {
+					copy_buffer(audio_in[ch], audio_out[ch],
+							c->audio_block_size);
+				}
+			}
+		}
+		return;
+	}
+
+	uint32_t first, last;
+	pipeline_scheduler_range(c, pipeline_scheduler_clip_split(c, split),
+			&first, &last);
+
+	if (first == last) {
+		for (int ch = 0; ch < c->num_channels; ch++) {
+			if (audio_in[ch] != audio_out[ch]) {
+				copy_buffer(audio_in[ch], audio_out[ch], c->audio_block_size);
+			}
+		}
+		return;
+	}
+
+	float ** stage_in = audio_in;
+	for (int s = first; s < last; s++) {
+		cycle_profiler_scope_begin(c->profile_scope[s]);
+		c->stages[s].process(stage_in, audio_out, c->audio_block_size);
+		cycle_profiler_scope_end(c->profile_scope[s]);
+		stage_in = audio_out;
+	}
+}
+
+/**
+ * @brief Returns the range of stages this core runs for a split
+ *
+ * @param c Pointer to instance structure
+ * @param split Number of stages run on core 1
+ * @param first Set to the first stage this core runs
+ * @param last Set to one past the last stage this core runs
+ */
+static void pipeline_scheduler_range(PIPELINE_SCHEDULER * c, uint32_t split,
+		uint32_t * first, uint32_t * last) {
+
+	if (c->core == 1) {
+		*first = 0;
+		*last = split;
+	} else {
+		*first = split;
+		*last = c->num_stages;
+	}
+}
+
+/**
+ * @brief Finds the scope of a stage in a profile table
+ *
+ * @param profile Profile table
+ * @param name Name of the stage (truncated like the scope names)
+ * @return Pointer to the scope or NULL if the table doesn't have it
+ */
+static const BM_CYCLE_PROFILE_SCOPE * pipeline_scheduler_find_scope(
+		const BM_CYCLE_PROFILE_TABLE * profile, const char * name) {
+
+	for (int i = 0; i < profile->num_scopes && i < CYCLE_PROFILER_MAX_SCOPES;
+			i++) {
+		if (strncmp(profile->scopes[i].name, name,
+				CYCLE_PROFILER_NAME_LEN - 1) == 0) {
+			return &profile->scopes[i];
+		}
+	}
+	return NULL;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _PIPELINE_SCHEDULER_H
+#define _PIPELINE_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements/audio_elements_common.h"
+#include "drivers/bm_cycle_profiler_driver/bm_cycle_profiler.h"
+
+// Maximum number of stages in a pipeline
+#define PIPELINE_SCHEDULER_MAX_STAGES       (8)
+
+// Maximum number of channels passed from stage to stage
+#define PIPELINE_SCHEDULER_MAX_CHANNELS     (16)
+
+// Result enumerations
+typedef enum {
+	PIPELINE_SCHEDULER_OK,
+	PIPELINE_SCHEDULER_INVALID_INSTANCE_POINTER,
+	PIPELINE_SCHEDULER_INVALID_STAGES_POINTER,
+	PIPELINE_SCHEDULER_INVALID_NUM_STAGES,
+	PIPELINE_SCHEDULER_INVALID_CORE,
+	PIPELINE_SCHEDULER_INVALID_NUM_CHANNELS,
+	PIPELINE_SCHEDULER_INVALID_SPLIT
+} RESULT_PIPELINE_SCHEDULER;
+
+// Cores a stage may run on
+typedef enum {
+	PIPELINE_STAGE_ANY_CORE,
+	PIPELINE_STAGE_CORE1,
+	PIPELINE_STAGE_CORE2
+} PIPELINE_STAGE_CORE;
+
+// A stage: setup is run on a core before the stage starts running there
+// (may be NULL), process reads audio_in and writes audio_out, which may be
+// the same buffers.  The name is also the name of its profiler scope.
+typedef struct {
+	const char * name;
+	PIPELINE_STAGE_CORE core;
+	void (*setup)(void);
+	void (*process)(float ** audio_in, float ** audio_out,
+			uint32_t audio_block_size);
+} PIPELINE_STAGE;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	const PIPELINE_STAGE * stages;
+	uint32_t num_stages;
+	uint32_t core;
+	uint32_t num_channels;
+	uint32_t audio_block_size;
+
+	// Range of splits allowed by the stages pinned to a core
+	uint32_t split_min;
+	uint32_t split_max;
+
+	// Profiler scope of each stage on this core
+	int32_t profile_scope[PIPELINE_SCHEDULER_MAX_STAGES];
+
+} PIPELINE_SCHEDULER;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_PIPELINE_SCHEDULER pipeline_scheduler_setup(PIPELINE_SCHEDULER * c,
+		const PIPELINE_STAGE * stages, uint32_t num_stages, uint32_t core,
+		uint32_t split, uint32_t num_channels, uint32_t audio_block_size);
+
+uint32_t pipeline_scheduler_clip_split(PIPELINE_SCHEDULER * c,
+		uint32_t split);
+
+void pipeline_scheduler_prepare(PIPELINE_SCHEDULER * c, uint32_t split_from,
+		uint32_t split_to);
+
+uint32_t pipeline_scheduler_balance(PIPELINE_SCHEDULER * c,
+		const BM_CYCLE_PROFILE_TABLE * core1_profile,
+		const BM_CYCLE_PROFILE_TABLE * core2_profile, uint32_t split,
+		uint32_t hysteresis_cycles);
+
+void pipeline_scheduler_run(PIPELINE_SCHEDULER * c, uint32_t split,
+		float ** audio_in, float ** audio_out);
+
+#if __cplusplus
+}
+#endif
+
+#endif  // _PIPELINE_SCHEDULER_H
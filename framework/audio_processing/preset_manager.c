@@ -0,0 +1,575 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * The preset manager switches between presets (chains of effects described
+ * as effect graphs) without glitches.
+ *
+ * Setting up a preset can take far longer than one audio block: the delay
+ * lines of the echo presets alone are 64000 words of SDRAM to clear.  So
+ * when a new preset is selected from the audio callback, the work is handed
+ * to the background loop, which runs the preset's setup routine (every time
+ * the preset is selected, so no stale delay or reverb state from the last
+ * time it was used plays back), then builds and compiles its graph in the
+ * spare slot.  The audio callback keeps playing the current preset in the
+ * meantime and only ever processes audio.
+ *
+ * Once the new preset is ready, both presets run for crossfade_blocks blocks
+ * while a linear ramp (as in clickless_volume_ctrl.c) fades the old preset
+ * out and the new preset in.  While the crossfade runs, the callback costs
+ * as much as both presets together; outside of a switch it costs one preset
+ * plus a copy of its outputs.
+ *
+ * So that a crossfade never makes the callback overrun its block, each slot
+ * is timed with a cycle profiler scope (see bm_cycle_profiler.c) and the
+ * most cycles each preset has taken in a block are kept.  A crossfade only
+ * starts if the two presets together fit in the cycle budget (see
+ * preset_manager_modify_cycle_budget); a preset that hasn't run yet is
+ * assumed to cost as much as the heaviest one so far.  If they don't fit,
+ * the old preset fades out over half the crossfade and the new one fades in
+ * over the other half, so only one preset runs in any block.  Should a
+ * crossfade take longer than the budget after all, it is cut short and the
+ * new preset takes over in the next block.  Without a budget, or without
+ * the profiler, every switch is a crossfade.
+ *
+ * A switch runs to completion before the next one starts.  The callback can
+ * simply pass the selected preset every block; if it changes during a
+ * switch, the next switch starts once the current one has finished.
+ *
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+
+#include "preset_manager.h"
+#include "audio_elements/audio_utilities.h"
+#include "drivers/bm_cycle_profiler_driver/bm_cycle_profiler.h"
+
+// Output of a preset that is faded out or not faded in yet
+static float preset_manager_silence[MAX_AUDIO_BLOCK_SIZE];
+
+// Static function prototypes
+static RESULT_PRESET_MANAGER preset_manager_prepare(PRESET_MANAGER * c,
+		uint32_t slot, uint32_t preset);
+static void preset_manager_start_switch(PRESET_MANAGER * c);
+static void preset_manager_start_fade(PRESET_MANAGER * c,
+		uint32_t fade_blocks);
+static bool preset_manager_fade(PRESET_MANAGER * c, float ** out_old,
+		float ** out_new, float ** audio_out);
+static uint32_t preset_manager_process_slot(PRESET_MANAGER * c,
+		uint32_t slot);
+static uint32_t preset_manager_control_slot(PRESET_MANAGER * c,
+		uint32_t slot, uint32_t cycles);
+
+/**
+ * @brief Initializes a preset manager and sets up the initial preset
+ *
+ * The initial preset is set up here, in the calling context.  The memory
+ * must hold PRESET_MANAGER_MEMORY_SIZE(num_channels, scratch_buffers,
+ * audio_block_size) floats.
+ *
+ * @param c Pointer to instance structure
+ * @param presets Array of presets
+ * @param num_presets Number of presets in the array
+ * @param initial_preset Preset to start with
+ * @param num_channels Number of output channels (1 - PRESET_MANAGER_MAX_CHANNELS)
+ * @param memory Pointer to memory for the preset outputs and graph scratch
+ * @param scratch_buffers Number of scratch buffers per preset graph
+ * @param crossfade_blocks Crossfade length in blocks (0 switches immediately)
+ * @param audio_block_size The number of floating-point words per block (1 - MAX_AUDIO_BLOCK_SIZE)
+ * @return Preset manager result (enumeration)
+ */
+RESULT_PRESET_MANAGER preset_manager_setup(PRESET_MANAGER * c,
+		const PRESET_MANAGER_PRESET * presets, uint32_t num_presets,
+		uint32_t initial_preset, uint32_t num_channels, float * memory,
+		uint32_t scratch_buffers, uint32_t crossfade_blocks,
+		uint32_t audio_block_size) {
+
+	if (c == NULL) {
+		return PRESET_MANAGER_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+	c->num_channels = 0;
+	c->audio_block_size = 0;
+
+	if (num_channels < 1 || num_channels > PRESET_MANAGER_MAX_CHANNELS) {
+		return PRESET_MANAGER_INVALID_NUM_CHANNELS;
+	}
+	c->num_channels = num_channels;
+
+	if (presets == NULL || num_presets == 0) {
+		return PRESET_MANAGER_INVALID_PRESETS_POINTER;
+	}
+	if (num_presets > PRESET_MANAGER_MAX_PRESETS) {
+		return PRESET_MANAGER_INVALID_NUM_PRESETS;
+	}
+	for (int p = 0; p < num_presets; p++) {
+		if (presets[p].build == NULL) {
+			return PRESET_MANAGER_INVALID_PRESETS_POINTER;
+		}
+	}
+	c->presets = presets;
+	c->num_presets = num_presets;
+
+	if (initial_preset >= num_presets) {
+		return PRESET_MANAGER_INVALID_PRESET;
+	}
+
+	if (memory == NULL) {
+		return PRESET_MANAGER_INVALID_MEMORY_POINTER;
+	}
+
+	if (crossfade_blocks > PRESET_MANAGER_MAX_CROSSFADE_BLOCKS) {
+		return PRESET_MANAGER_INVALID_CROSSFADE;
+	}
+	c->crossfade_blocks = crossfade_blocks;
+
+	// The fades read up to a block of silence
+	if (audio_block_size < 1 || audio_block_size > MAX_AUDIO_BLOCK_SIZE) {
+		return PRESET_MANAGER_INVALID_BLOCK_SIZE;
+	}
+	c->audio_block_size = audio_block_size;
+	c->scratch_buffers = scratch_buffers;
+
+	// Lay out the outputs and scratch memory of both slots
+	float * ptr = memory;
+	for (int slot = 0; slot < 2; slot++) {
+		for (int ch = 0; ch < num_channels; ch++) {
+			c->slot_out[slot][ch] = ptr;
+			ptr += audio_block_size;
+		}
+		c->slot_scratch[slot] = ptr;
+		ptr += scratch_buffers * audio_block_size;
+	}
+
+	c->fade_gain = 0.0;
+	c->fade_delta = 0.0;
+	c->fade_remaining = 0;
+	c->fade_blocks = 0;
+
+	// No budget until one is set, the profiler times the slots if it's running
+	c->cycle_budget = 0;
+	c->profile_scope[0] = cycle_profiler_add_scope("preset_a");
+	c->profile_scope[1] = cycle_profiler_add_scope("preset_b");
+	for (int p = 0; p < PRESET_MANAGER_MAX_PRESETS; p++) {
+		c->preset_cycles[p] = 0;
+	}
+	c->preset_cycles_max = 0;
+	c->switches_faded_through_silence = 0;
+	c->crossfades_cut_short = 0;
+
+	c->active_slot = 0;
+	c->next_preset = initial_preset;
+	c->state = PRESET_MANAGER_RUNNING;
+
+	RESULT_PRESET_MANAGER res = preset_manager_prepare(c, 0, initial_preset);
+	if (res != PRESET_MANAGER_OK) {
+		return res;
+	}
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return PRESET_MANAGER_OK;
+}
+
+/**
+ * @brief Modify the crossfade length
+ *
+ * If the input parameter is out of bounds, clip it to the corresponding min/max
+ * and apply that value.  This function will return a flag indicating an
+ * invalid input parameter was supplied but it won't disable the manager.
+ * The new length applies from the next switch.
+ *
+ * @param c Pointer to instance structure
+ * @param crossfade_blocks_new Crossfade length in blocks (0 switches immediately)
+ * @return Preset manager result (enumeration)
+ */
+RESULT_PRESET_MANAGER preset_manager_modify_crossfade(PRESET_MANAGER * c,
+		uint32_t crossfade_blocks_new) {
+
+	RESULT_PRESET_MANAGER res;
+
+	if (c == NULL) {
+		return PRESET_MANAGER_INVALID_INSTANCE_POINTER;
+	}
+
+	uint32_t crossfade_blocks;
+	if (crossfade_blocks_new > PRESET_MANAGER_MAX_CROSSFADE_BLOCKS) {
+		crossfade_blocks = PRESET_MANAGER_MAX_CROSSFADE_BLOCKS;
+		res = PRESET_MANAGER_INVALID_CROSSFADE;
+	} else {
+		crossfade_blocks = crossfade_blocks_new;
+		res = PRESET_MANAGER_OK;
+	}
+
+	c->crossfade_blocks = crossfade_blocks;
+
+	return res;
+}
+
+/**
+ * @brief Modify the cycle budget of the presets
+ *
+ * The budget is the number of cycles the presets (their graphs and control
+ * routines) may take in one block, i.e. the cycles per block less whatever
+ * else runs in the callback.  A switch only crossfades if both presets fit
+ * in it.  The new budget applies from the next switch.
+ *
+ * @param c Pointer to instance structure
+ * @param cycle_budget_new Cycles per block (0 for no limit)
+ * @return Preset manager result (enumeration)
+ */
+RESULT_PRESET_MANAGER preset_manager_modify_cycle_budget(PRESET_MANAGER * c,
+		uint32_t cycle_budget_new) {
+
+	if (c == NULL) {
+		return PRESET_MANAGER_INVALID_INSTANCE_POINTER;
+	}
+
+	c->cycle_budget = cycle_budget_new;
+
+	return PRESET_MANAGER_OK;
+}
+
+/**
+ * @brief Requests a switch to a preset
+ *
+ * Called from the audio callback.  If the preset differs from the one
+ * playing, the background loop is asked to prepare it.  While a switch is in
+ * progress, other requests are refused (PRESET_MANAGER_BUSY) and should be
+ * repeated later.
+ *
+ * @param c Pointer to instance structure
+ * @param preset Preset to switch to
+ * @return Preset manager result (enumeration)
+ */
+RESULT_PRESET_MANAGER preset_manager_select(PRESET_MANAGER * c,
+		uint32_t preset) {
+
+	if (c == NULL || !c->initialized) {
+		return PRESET_MANAGER_INVALID_INSTANCE_POINTER;
+	}
+
+	if (preset >= c->num_presets) {
+		return PRESET_MANAGER_INVALID_PRESET;
+	}
+
+	if (c->state != PRESET_MANAGER_RUNNING) {
+		return (preset == c->next_preset) ?
+				PRESET_MANAGER_OK : PRESET_MANAGER_BUSY;
+	}
+
+	if (preset != c->slot_preset[c->active_slot]) {
+		c->next_preset = preset;
+		c->state = PRESET_MANAGER_PREPARING;
+	}
+
+	return PRESET_MANAGER_OK;
+}
+
+/**
+ * @brief Returns the preset playing (the outgoing one during a crossfade)
+ *
+ * @param c Pointer to instance structure
+ * @return Preset number
+ */
+uint32_t preset_manager_active_preset(PRESET_MANAGER * c) {
+
+	return c->slot_preset[c->active_slot];
+}
+
+/**
+ * @brief Prepares a requested preset, call from the background loop
+ *
+ * @param c Pointer to instance structure
+ * @return true if a preset was prepared
+ */
+bool preset_manager_process_background(PRESET_MANAGER * c) {
+
+	if (c == NULL || !c->initialized
+			|| c->state != PRESET_MANAGER_PREPARING) {
+		return false;
+	}
+
+	// A graph that fails to compile outputs silence, so fade to it anyway
+	preset_manager_prepare(c, 1 - c->active_slot, c->next_preset);
+
+	c->state = PRESET_MANAGER_READY;
+	return true;
+}
+
+/**
+ * @brief Runs the playing preset(s) on one block of audio
+ *
+ * @param c Pointer to instance structure
+ * @param audio_out Array of num_channels pointers to audio output buffers
+ */
+#pragma optimize_for_speed
+void preset_manager_read(PRESET_MANAGER * c, float ** audio_out) {
+
+	// If this instance hasn't been properly initialized, output silence
+	if (c == NULL || !c->initialized) {
+		if (c != NULL) {
+			for (int ch = 0; ch < c->num_channels; ch++) {
+				clear_buffer(audio_out[ch], c->audio_block_size);
+			}
+		}
+		return;
+	}
+
+	// The background loop has finished preparing, start the switch
+	if (c->state == PRESET_MANAGER_READY) {
+		preset_manager_start_switch(c);
+	}
+
+	uint32_t active = c->active_slot;
+	uint32_t incoming = 1 - active;
+
+	switch (c->state) {
+
+	case PRESET_MANAGER_CROSSFADING: {
+		uint32_t cycles_old = preset_manager_process_slot(c, active);
+		uint32_t cycles_new = preset_manager_process_slot(c, incoming);
+
+		bool done = preset_manager_fade(c, c->slot_out[active],
+				c->slot_out[incoming], audio_out);
+
+		uint32_t cycles = preset_manager_control_slot(c, active, cycles_old)
+				+ preset_manager_control_slot(c, incoming, cycles_new);
+
+		// Both presets took longer than the budget, cut to the incoming one
+		if (!done && c->cycle_budget && cycles > c->cycle_budget) {
+			c->crossfades_cut_short++;
+			done = true;
+		}
+
+		// The old preset is silent now, the incoming one takes over
+		if (done) {
+			c->active_slot = incoming;
+			c->state = PRESET_MANAGER_RUNNING;
+		}
+		break;
+	}
+
+	case PRESET_MANAGER_FADING_OUT: {
+		uint32_t cycles = preset_manager_process_slot(c, active);
+
+		bool done = preset_manager_fade(c, c->slot_out[active], NULL,
+				audio_out);
+
+		preset_manager_control_slot(c, active, cycles);
+
+		// Once the old preset is silent, fade the incoming one in on its own
+		if (done) {
+			c->active_slot = incoming;
+			preset_manager_start_fade(c, c->fade_blocks);
+			c->state = PRESET_MANAGER_FADING_IN;
+		}
+		break;
+	}
+
+	case PRESET_MANAGER_FADING_IN: {
+		uint32_t cycles = preset_manager_process_slot(c, active);
+
+		bool done = preset_manager_fade(c, NULL, c->slot_out[active],
+				audio_out);
+
+		preset_manager_control_slot(c, active, cycles);
+
+		if (done) {
+			c->state = PRESET_MANAGER_RUNNING;
+		}
+		break;
+	}
+
+	default: {
+		uint32_t cycles = preset_manager_process_slot(c, active);
+
+		for (int ch = 0; ch < c->num_channels; ch++) {
+			copy_buffer(c->slot_out[active][ch], audio_out[ch],
+					c->audio_block_size);
+		}
+
+		preset_manager_control_slot(c, active, cycles);
+		break;
+	}
+	}
+}
+
+/**
+ * @brief Starts switching to the prepared preset
+ *
+ * Crossfades if both presets fit in the cycle budget, otherwise fades the
+ * old preset out and then the new one in.
+ *
+ * @param c Pointer to instance structure
+ */
+static void preset_manager_start_switch(PRESET_MANAGER * c) {
+
+	uint32_t active = c->active_slot;
+	uint32_t incoming = 1 - active;
+
+	// No crossfade, the new preset plays from the next block
+	if (c->crossfade_blocks == 0) {
+		c->active_slot = incoming;
+		c->state = PRESET_MANAGER_RUNNING;
+		return;
+	}
+
+	// A preset that hasn't run yet may be as heavy as the heaviest so far
+	uint32_t cycles_old = c->preset_cycles[c->slot_preset[active]];
+	uint32_t cycles_new = c->preset_cycles[c->slot_preset[incoming]];
+	if (cycles_new == 0) {
+		cycles_new = c->preset_cycles_max;
+	}
+
+	if (c->cycle_budget == 0 || cycles_old + cycles_new <= c->cycle_budget) {
+		preset_manager_start_fade(c, c->crossfade_blocks);
+		c->state = PRESET_MANAGER_CROSSFADING;
+	} else {
+		c->switches_faded_through_silence++;
+		c->fade_blocks = (c->crossfade_blocks + 1) / 2;
+		preset_manager_start_fade(c, c->fade_blocks);
+		c->state = PRESET_MANAGER_FADING_OUT;
+	}
+}
+
+/**
+ * @brief Starts a linear ramp of the incoming gain from 0.0 to 1.0
+ *
+ * @param c Pointer to instance structure
+ * @param fade_blocks Length of the ramp in blocks (> 0)
+ */
+static void preset_manager_start_fade(PRESET_MANAGER * c,
+		uint32_t fade_blocks) {
+
+	c->fade_remaining = fade_blocks * c->audio_block_size;
+	c->fade_gain = 0.0;
+	c->fade_delta = 1.0 / (float) c->fade_remaining;
+}
+
+/**
+ * @brief Fades one block from one set of outputs to another
+ *
+ * @param c Pointer to instance structure
+ * @param out_old Outputs faded out (NULL for silence)
+ * @param out_new Outputs faded in (NULL for silence)
+ * @param audio_out Array of num_channels pointers to audio output buffers
+ * @return true once the ramp has finished
+ */
+#pragma optimize_for_speed
+static bool preset_manager_fade(PRESET_MANAGER * c, float ** out_old,
+		float ** out_new, float ** audio_out) {
+
+	// Every channel follows the same ramp
+	float fade_gain = c->fade_gain;
+	uint32_t fade_remaining = c->fade_remaining;
+
+	for (int ch = 0; ch < c->num_channels; ch++) {
+
+		float * in_old = (out_old != NULL) ? out_old[ch] : preset_manager_silence;
+		float * in_new = (out_new != NULL) ? out_new[ch] : preset_manager_silence;
+		float * out = audio_out[ch];
+
+		float gain = c->fade_gain;
+		float delta = c->fade_delta;
+		uint32_t remaining = c->fade_remaining;
+
+		for (int i = 0; i < c->audio_block_size; i++) {
+			out[i] = in_old[i] + gain * (in_new[i] - in_old[i]);
+			if (remaining) {
+				remaining--;
+				gain = (remaining) ? gain + delta : 1.0;
+			} else {
+				gain = 1.0;
+			}
+		}
+
+		fade_gain = gain;
+		fade_remaining = remaining;
+	}
+
+	c->fade_gain = fade_gain;
+	c->fade_remaining = fade_remaining;
+
+	return (fade_remaining == 0);
+}
+
+/**
+ * @brief Runs the graph of the preset in one slot
+ *
+ * @param c Pointer to instance structure
+ * @param slot Slot to run (0 or 1)
+ * @return Cycles taken (0 if the profiler isn't running)
+ */
+static uint32_t preset_manager_process_slot(PRESET_MANAGER * c,
+		uint32_t slot) {
+
+	cycle_profiler_scope_begin(c->profile_scope[slot]);
+	effect_graph_process(&c->graph[slot]);
+	return cycle_profiler_scope_end(c->profile_scope[slot]);
+}
+
+/**
+ * @brief Runs the control routine of the preset in one slot
+ *
+ * The control routines run after the graphs (and the fade), as parameters
+ * updated for one preset may be shared with the other.
+ *
+ * @param c Pointer to instance structure
+ * @param slot Slot to run (0 or 1)
+ * @param cycles Cycles the slot's graph took this block
+ * @return Cycles taken by the graph and the control routine
+ */
+static uint32_t preset_manager_control_slot(PRESET_MANAGER * c,
+		uint32_t slot, uint32_t cycles) {
+
+	uint32_t preset = c->slot_preset[slot];
+
+	if (c->presets[preset].control != NULL) {
+		cycle_profiler_scope_begin(c->profile_scope[slot]);
+		c->presets[preset].control();
+		cycles += cycle_profiler_scope_end(c->profile_scope[slot]);
+	}
+
+	// Keep the most cycles each preset has taken in a block
+	if (cycles > c->preset_cycles[preset]) {
+		c->preset_cycles[preset] = cycles;
+		if (cycles > c->preset_cycles_max) {
+			c->preset_cycles_max = cycles;
+		}
+	}
+
+	return cycles;
+}
+
+/**
+ * @brief Sets up a preset and builds its graph in one of the two slots
+ *
+ * @param c Pointer to instance structure
+ * @param slot Slot to build the graph in (0 or 1)
+ * @param preset Preset to prepare
+ * @return Preset manager result (enumeration)
+ */
+static RESULT_PRESET_MANAGER preset_manager_prepare(PRESET_MANAGER * c,
+		uint32_t slot, uint32_t preset) {
+
+	const PRESET_MANAGER_PRESET * p = &c->presets[preset];
+
+	if (p->setup != NULL) {
+		p->setup();
+	}
+
+	c->slot_preset[slot] = preset;
+
+	EFFECT_GRAPH * graph = &c->graph[slot];
+	effect_graph_setup(graph, c->slot_scratch[slot], c->scratch_buffers,
+			c->audio_block_size);
+	p->build(graph, c->slot_out[slot]);
+
+	if (effect_graph_compile(graph) != EFFECT_GRAPH_OK) {
+		return PRESET_MANAGER_INVALID_GRAPH;
+	}
+
+	return PRESET_MANAGER_OK;
+}
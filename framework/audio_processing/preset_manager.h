@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _PRESET_MANAGER_H
+#define _PRESET_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements/audio_elements_common.h"
+#include "effect_graph.h"
+
+// Maximum number of output channels of a preset
+#define PRESET_MANAGER_MAX_CHANNELS         (16)
+
+// Maximum number of presets
+#define PRESET_MANAGER_MAX_PRESETS          (32)
+
+// Longest crossfade between two presets
+#define PRESET_MANAGER_MAX_CROSSFADE_BLOCKS (1024)
+
+// Floats of memory needed by preset_manager_setup (two preset slots, each with
+// its outputs and graph scratch memory)
+#define PRESET_MANAGER_MEMORY_SIZE(num_channels, scratch_buffers, block_size) \
+	(2 * ((num_channels) + (scratch_buffers)) * (block_size))
+
+// Result enumerations
+typedef enum {
+	PRESET_MANAGER_OK,
+	PRESET_MANAGER_INVALID_INSTANCE_POINTER,
+	PRESET_MANAGER_INVALID_PRESETS_POINTER,
+	PRESET_MANAGER_INVALID_PRESET,
+	PRESET_MANAGER_INVALID_NUM_PRESETS,
+	PRESET_MANAGER_INVALID_NUM_CHANNELS,
+	PRESET_MANAGER_INVALID_MEMORY_POINTER,
+	PRESET_MANAGER_INVALID_CROSSFADE,
+	PRESET_MANAGER_INVALID_BLOCK_SIZE,
+	PRESET_MANAGER_INVALID_GRAPH,
+	PRESET_MANAGER_BUSY
+} RESULT_PRESET_MANAGER;
+
+// Switching state
+typedef enum {
+	PRESET_MANAGER_RUNNING,		// one preset is playing
+	PRESET_MANAGER_PREPARING,	// background loop is setting up the next preset
+	PRESET_MANAGER_READY,		// next preset is ready, switch starts next block
+	PRESET_MANAGER_CROSSFADING,	// both presets are playing
+	PRESET_MANAGER_FADING_OUT,	// old preset is fading out (both don't fit in a block)
+	PRESET_MANAGER_FADING_IN	// new preset is fading in after the old one faded out
+} PRESET_MANAGER_STATE;
+
+// A preset: setup is run (in the background) every time the preset is
+// selected, build adds its effects to a graph writing audio_out and control
+// updates its parameters after each block (setup and control may be NULL)
+typedef struct {
+	void (*setup)(void);
+	void (*build)(EFFECT_GRAPH * graph, float ** audio_out);
+	void (*control)(void);
+} PRESET_MANAGER_PRESET;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	const PRESET_MANAGER_PRESET * presets;
+	uint32_t num_presets;
+	uint32_t num_channels;
+	uint32_t audio_block_size;
+	uint32_t crossfade_blocks;
+
+	// Two slots: the preset playing and the one being prepared / faded in
+	EFFECT_GRAPH graph[2];
+	float * slot_out[2][PRESET_MANAGER_MAX_CHANNELS];
+	float * slot_scratch[2];
+	uint32_t scratch_buffers;
+	uint32_t slot_preset[2];
+	uint32_t active_slot;
+
+	// Shared between the audio callback and the background loop
+	volatile PRESET_MANAGER_STATE state;
+	volatile uint32_t next_preset;
+
+	// Linear crossfade ramp (gain of the incoming preset)
+	float fade_gain;
+	float fade_delta;
+	uint32_t fade_remaining;
+	uint32_t fade_blocks;
+
+	// Cycles the presets may take per block (0 for no limit) and the most
+	// each preset has taken (0 until it has run), timed with a profiler
+	// scope per slot
+	uint32_t cycle_budget;
+	int32_t profile_scope[2];
+	uint32_t preset_cycles[PRESET_MANAGER_MAX_PRESETS];
+	uint32_t preset_cycles_max;
+
+	// Switches that didn't fit in the budget
+	uint32_t switches_faded_through_silence;
+	uint32_t crossfades_cut_short;
+
+} PRESET_MANAGER;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_PRESET_MANAGER preset_manager_setup(PRESET_MANAGER * c,
+		const PRESET_MANAGER_PRESET * presets, uint32_t num_presets,
+		uint32_t initial_preset, uint32_t num_channels, float * memory,
+		uint32_t scratch_buffers, uint32_t crossfade_blocks,
+		uint32_t audio_block_size);
+
+RESULT_PRESET_MANAGER preset_manager_modify_crossfade(PRESET_MANAGER * c,
+		uint32_t crossfade_blocks_new);
+
+RESULT_PRESET_MANAGER preset_manager_modify_cycle_budget(PRESET_MANAGER * c,
+		uint32_t cycle_budget_new);
+
+RESULT_PRESET_MANAGER preset_manager_select(PRESET_MANAGER * c,
+		uint32_t preset);
+
+uint32_t preset_manager_active_preset(PRESET_MANAGER * c);
+
+bool preset_manager_process_background(PRESET_MANAGER * c);
+
+void preset_manager_read(PRESET_MANAGER * c, float ** audio_out);
+
+#if __cplusplus
+}
+#endif
+
+#endif  // _PRESET_MANAGER_H
@@ -73,6 +73,9 @@
 // Set to true to use both cores, set to false to just use SHARC Core 1
 #define USE_BOTH_CORES_TO_PROCESS_AUDIO                    TRUE
 
+// Set to true to move effects between the cores to balance their load
+#define REBALANCE_EFFECTS_BETWEEN_CORES                    TRUE
+
 /*******************************************************************************
  * 3. Select an audio processing framework to use (only select one)
  ******************************************************************************/
@@ -207,10 +210,6 @@
 #if (FAUST_INSTALLED)
     #define   MIDI_UART_MANAGED_BY_ARM_CORE      FALSE
     #define   MIDI_UART_MANAGED_BY_SHARC1_CORE   FALSE
-
-    #if (USE_FAUST_ALGORITHM_CORE1 && USE_FAUST_ALGORITHM_CORE2)
-        #define SH1_SH2_BYTE_FIFO_SIZE           (32)
-    #endif
 #endif
 
 // Settings for events
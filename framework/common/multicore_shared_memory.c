@@ -30,6 +30,6 @@ volatile MULTICORE_DATA *multicore_data = (MULTICORE_DATA *) 0x20080000;
  * segment it is going into.
  */
 bool check_shared_memory_structure_sizes() {
-    if (sizeof(multicore_data) > 0x1000) return false;
+    if (sizeof(*multicore_data) > 0x1000) return false;
     return true;
 }
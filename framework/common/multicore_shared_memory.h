@@ -10,6 +10,21 @@
 
 #include "audio_system_config.h"
 #include "drivers/bm_event_logging_driver/bm_event_logging.h"
+#include "drivers/bm_cycle_profiler_driver/bm_cycle_profiler.h"
+#include "drivers/bm_message_queue_driver/bm_message_queue.h"
+#include "drivers/bm_parameter_snapshot_driver/bm_parameter_snapshot.h"
+
+// Parameters published in audioproj_fin_hadc (see bm_parameter_snapshot.c)
+typedef enum {
+    AUDIOPROJ_FIN_POT_HADC0,
+    AUDIOPROJ_FIN_POT_HADC1,
+    AUDIOPROJ_FIN_POT_HADC2,
+    AUDIOPROJ_FIN_AUX_HADC3,
+    AUDIOPROJ_FIN_AUX_HADC4,
+    AUDIOPROJ_FIN_AUX_HADC5,
+    AUDIOPROJ_FIN_AUX_HADC6,
+    AUDIOPROJ_FIN_HADC_PARAMETERS
+} AUDIOPROJ_FIN_HADC_PARAMETER;
 
 /*
  * This structure lives in L2 memory where the MCAPI memory normally live
@@ -51,9 +66,13 @@ typedef struct
     uint32_t sharc_core1_dropped_audio_frames;
     uint32_t sharc_core2_dropped_audio_frames;
 
-    // ARM captures PB events and lets rest of system know
-    uint32_t sharc_sam_pb_1_pressed;
-    uint32_t sharc_sam_pb_2_pressed;
+    // Per-scope cycle counts of the audio callbacks (see bm_cycle_profiler.c)
+    BM_CYCLE_PROFILE_TABLE sharc_core1_cycle_profile;
+    BM_CYCLE_PROFILE_TABLE sharc_core2_cycle_profile;
+
+    // Timing of the blocks before the last dropped block on each core
+    BM_CYCLE_TRACE sharc_core1_cycle_trace;
+    BM_CYCLE_TRACE sharc_core2_cycle_trace;
 
     /*
      * If the Audio Project Fin is installed on the SHARC Audio Module board, expose
@@ -61,30 +80,15 @@ typedef struct
      **/
     #ifdef SAM_AUDIOPROJ_FIN_BOARD_PRESENT
 
-        uint32_t audioproj_fin_sw_1_core1_pressed;
-        uint32_t audioproj_fin_sw_2_core1_pressed;
-        uint32_t audioproj_fin_sw_3_core1_pressed;
-        uint32_t audioproj_fin_sw_4_core1_pressed;
-        uint32_t audioproj_fin_sw_1_core2_pressed;
-        uint32_t audioproj_fin_sw_2_core2_pressed;
-        uint32_t audioproj_fin_sw_3_core2_pressed;
-        uint32_t audioproj_fin_sw_4_core2_pressed;
-
         uint32_t audioproj_fin_sw_1_state;
         uint32_t audioproj_fin_sw_2_state;
         uint32_t audioproj_fin_sw_3_state;
         uint32_t audioproj_fin_sw_4_state;
 
-        // These are the POTS on the Audio Project Fin
-        float audioproj_fin_pot_hadc0;
-        float audioproj_fin_pot_hadc1;
-        float audioproj_fin_pot_hadc2;
-
-        // And these are the additional HADC input channels available on the Audio Project Fin headers
-        float audioproj_fin_aux_hadc3;
-        float audioproj_fin_aux_hadc4;
-        float audioproj_fin_aux_hadc5;
-        float audioproj_fin_aux_hadc6;
+        // These are the POTS on the Audio Project Fin and the additional HADC
+        // input channels available on its headers.  The ARM publishes them
+        // together so the SHARC cores can latch a consistent snapshot per block.
+        BM_PARAMETER_BLOCK audioproj_fin_hadc;
 
         float audio_in_amplitude;
 
@@ -98,6 +102,16 @@ typedef struct
     uint32_t	reverb_preset;
     uint32_t	total_effects_presets;
 
+    // Split of the effects pipeline between the SHARC cores (number of stages
+    // run on SHARC Core 1, see pipeline_scheduler.c), the split handed to SHARC
+    // Core 2 with the block it is processing, the split being moved to and the
+    // split SHARC Core 2 has set up its stages for
+    uint32_t	pipeline_split;
+    uint32_t	pipeline_split_to_core2;
+    uint32_t	pipeline_split_requested;
+    uint32_t	pipeline_split_prepared;
+    uint32_t	pipeline_rebalances;
+
 
     /**
      * We are using memory DMA (MDMA) to move audio data between cores in the background,
@@ -127,16 +141,13 @@ typedef struct
     // Add any parameters that you'd like all three cores to access here
 
     /*
-     * If we're using Faust on both cores, use a simple FIFO to move MIDI notes
-     * from SHARC Core 1 to SHARC Core 2
+     * Queues for passing events between the cores (see bm_message_queue.c).
+     * The ARM sends PB / SW events to both SHARC cores and SHARC Core 1 passes
+     * MIDI on to SHARC Core 2 when both run Faust.
      */
-    #if (USE_FAUST_ALGORITHM_CORE1) && (USE_FAUST_ALGORITHM_CORE2)
-
-        uint8_t sh1_sh2_byte_fifo[SH1_SH2_BYTE_FIFO_SIZE];
-        uint32_t sh1_sh2_fifo_read_ptr;
-        uint32_t sh1_sh2_fifo_write_ptr;
-
-    #endif
+    BM_MESSAGE_QUEUE arm_to_sharc_core1_messages;
+    BM_MESSAGE_QUEUE arm_to_sharc_core2_messages;
+    BM_MESSAGE_QUEUE sharc_core1_to_sharc_core2_messages;
 } MULTICORE_DATA;
 
 extern volatile MULTICORE_DATA *multicore_data;
@@ -19,6 +19,9 @@
 // Driver for GPIO functionality
 #include "drivers/bm_gpio_driver/bm_gpio.h"
 
+// Conversions between the DMA buffers and the floating point channel buffers
+#include "bm_audio_flow_convert.h"
+
 // Constants used to initialize the audio DMA engine
 #define AUDIO_DMA_MSIZE               (2)
 #define AUDIO_DMA_PSIZE               (2)
@@ -0,0 +1,587 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * These routines convert the fixed point audio in the SPORT DMA buffers to and
+ * from the floating point channel buffers the audio callbacks work on.
+ *
+ * audioflow_fixed_to_float() and audioflow_float_to_fixed() convert a whole
+ * DMA buffer in one flat pass, so the DMA handler converted every channel of
+ * every port each block, whether anything used it or not.  The routines here
+ * are given an AUDIOFLOW_CONVERSION describing the buffer and, in the same
+ * pass, can:
+ *
+ *  - skip the channels that aren't used (channel_mask) - a port with no
+ *    channels in use doesn't need to be converted at all
+ *  - apply a gain to each channel (gains)
+ *  - read / write 16-bit samples packed two to a word, 24-bit samples either
+ *    one to a word or packed four to three words, as well as the 32-bit
+ *    samples the frameworks use
+ *  - de-interleave / interleave the channels of buffers holding one frame
+ *    after another.  The SPORT DMAs set up by audioflow_init_sport_dma() use
+ *    2D DMA to sort the samples into a block per channel as they go, so the
+ *    frameworks use AUDIOFLOW_LAYOUT_CHANNEL_BLOCKS
+ *
+ * The loops over a block of samples of one channel are written so the
+ * compiler can run them in SIMD mode when the samples are contiguous.  Any
+ * block_size (and any number of samples left over from the packed formats)
+ * is allowed, so the loops carry no loop_count hints.  Up to
+ * AUDIOFLOW_MAX_CHANNELS channels can be converted, as the channel mask has
+ * a bit per channel.  The
+ * _reference versions do the same conversions in portable C, one sample at a
+ * time, and are used to check the optimized versions on a host
+ * (SHARC_HOST_BUILD).
+ *
+ * @file       bm_audio_flow_convert.c
+ * @brief      fused conversion, (de-)interleaving and gain for audio DMA buffers
+ */
+
+#include <math.h>
+
+#include "bm_audio_flow_convert.h"
+
+//*******************************************************************************************
+// These functions are designed to run on the SHARC cores so don't include if compiled on ARM
+//*******************************************************************************************
+#ifndef CORE0
+
+// Largest value converted to fixed point (keeps clear of the positive limit)
+#define AUDIOFLOW_CLIP_LEVEL        (0.9999)
+
+/**
+ * @brief      Finds where the samples of a channel are in a DMA buffer
+ *
+ * @param[in]  conversion   description of the DMA buffer
+ * @param      channel      channel number
+ * @param      first        set to the index of the channel's first sample
+ * @param      step         set to the distance between the channel's samples
+ */
+static void audioflow_channel_position(const AUDIOFLOW_CONVERSION *conversion,
+                                       uint32_t channel,
+                                       uint32_t *first,
+                                       uint32_t *step) {
+
+    if (conversion->layout == AUDIOFLOW_LAYOUT_INTERLEAVED) {
+        *first = channel;
+        *step = conversion->channels;
+    } else {
+        *first = channel * conversion->block_size;
+        *step = 1;
+    }
+}
+
+/**
+ * @brief      Sign extends the low half of a word of packed 16-bit samples
+ */
+static inline int32_t audioflow_low_half(int32_t word) {
+    return (int32_t)((uint32_t)word << 16) >> 16;
+}
+
+/**
+ * @brief      Reads a packed 24-bit sample, returned in the top bits of a word (1.31)
+ *
+ * Sample n starts at bit 24 * n of the buffer, so it either fits in one word
+ * or is split over two.  Leaving it in the top 24 bits saves sign extending it.
+ */
+static inline int32_t audioflow_packed24_read(const int *buffer, uint32_t index) {
+
+    uint32_t bit = index * 24;
+    const int *word = buffer + (bit >> 5);
+    uint32_t shift = bit & 31;
+
+    uint32_t value = (uint32_t)word[0] >> shift;
+    if (shift > 8) {
+        value |= (uint32_t)word[1] << (32 - shift);
+    }
+    return (int32_t)(value << 8);
+}
+
+/**
+ * @brief      Writes a packed 24-bit sample (1.23), leaving the bits around it untouched
+ */
+static inline void audioflow_packed24_write(int *buffer, uint32_t index, uint32_t sample) {
+
+    uint32_t bit = index * 24;
+    int *word = buffer + (bit >> 5);
+    uint32_t shift = bit & 31;
+
+    sample &= 0xFFFFFF;
+    word[0] = (int)(((uint32_t)word[0] & ~(0xFFFFFFu << shift)) | (sample << shift));
+    if (shift > 8) {
+        word[1] = (int)(((uint32_t)word[1] & ~(0xFFFFFFu >> (32 - shift))) | (sample >> (32 - shift)));
+    }
+}
+
+/**
+ * @brief      Converts one channel of 32-bit or 24-bit samples to floating point
+ *
+ * @param[in]  input    pointer to the channel's first sample
+ * @param      step     distance between the channel's samples
+ * @param      output   pointer to the channel's floating point block
+ * @param      gain     gain to apply
+ * @param      scale    -31 for 32-bit samples, -23 for 24-bit samples
+ * @param      count    number of samples to convert
+ */
+#pragma optimize_for_speed
+static void audioflow_words_to_float(const int *input,
+                                     uint32_t step,
+                                     float *output,
+                                     float gain,
+                                     int scale,
+                                     uint32_t count) {
+
+    uint32_t i;
+
+    if (step == 1) {
+        #pragma SIMD_for
+        for (i = 0; i < count; i++)
+        {
+            output[i] = __builtin_conv_float_by(input[i], scale) * gain;
+        }
+    } else {
+        for (i = 0; i < count; i++)
+        {
+            output[i] = __builtin_conv_float_by(input[i * step], scale) * gain;
+        }
+    }
+}
+
+/**
+ * @brief      Converts one channel of floating point audio to 32-bit or 24-bit samples
+ *
+ * @param[in]  input    pointer to the channel's floating point block
+ * @param      output   pointer to the channel's first sample
+ * @param      step     distance between the channel's samples
+ * @param      gain     gain to apply
+ * @param      scale    31 for 32-bit samples, 23 for 24-bit samples
+ * @param      count    number of samples to convert
+ */
+#pragma optimize_for_speed
+static void audioflow_float_to_words(const float *input,
+                                     int *output,
+                                     uint32_t step,
+                                     float gain,
+                                     int scale,
+                                     uint32_t count) {
+
+    uint32_t i;
+
+    if (step == 1) {
+        #pragma SIMD_for
+        for (i = 0; i < count; i++)
+        {
+            output[i] = __builtin_conv_fix_by(__builtin_fclipf(input[i] * gain, AUDIOFLOW_CLIP_LEVEL), scale);
+        }
+    } else {
+        for (i = 0; i < count; i++)
+        {
+            output[i * step] = __builtin_conv_fix_by(__builtin_fclipf(input[i] * gain, AUDIOFLOW_CLIP_LEVEL), scale);
+        }
+    }
+}
+
+/**
+ * @brief      Converts one channel of packed 16-bit samples to floating point
+ *
+ * @param[in]  input    pointer to the DMA buffer
+ * @param      first    index of the channel's first sample
+ * @param      step     distance between the channel's samples
+ * @param      output   pointer to the channel's floating point block
+ * @param      gain     gain to apply
+ * @param      count    number of samples to convert
+ */
+#pragma optimize_for_speed
+static void audioflow_packed_to_float(const int *input,
+                                      uint32_t first,
+                                      uint32_t step,
+                                      float *output,
+                                      float gain,
+                                      uint32_t count) {
+
+    uint32_t i;
+
+    // Contiguous samples starting on a word boundary, two samples per word
+    if (step == 1 && (first & 1) == 0) {
+        const int *words = input + (first >> 1);
+        for (i = 0; i < count / 2; i++)
+        {
+            int32_t word = words[i];
+            output[2 * i]     = __builtin_conv_float_by(audioflow_low_half(word), -15) * gain;
+            output[2 * i + 1] = __builtin_conv_float_by(word >> 16, -15) * gain;
+        }
+        if (count & 1) {
+            output[count - 1] = __builtin_conv_float_by(audioflow_low_half(words[count / 2]), -15) * gain;
+        }
+        return;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        uint32_t index = first + i * step;
+        int32_t word = input[index >> 1];
+        int32_t sample = (index & 1) ? (word >> 16) : audioflow_low_half(word);
+        output[i] = __builtin_conv_float_by(sample, -15) * gain;
+    }
+}
+
+/**
+ * @brief      Converts one channel of floating point audio to packed 16-bit samples
+ *
+ * @param[in]  input    pointer to the channel's floating point block
+ * @param      output   pointer to the DMA buffer
+ * @param      first    index of the channel's first sample
+ * @param      step     distance between the channel's samples
+ * @param      gain     gain to apply
+ * @param      count    number of samples to convert
+ */
+#pragma optimize_for_speed
+static void audioflow_float_to_packed(const float *input,
+                                      int *output,
+                                      uint32_t first,
+                                      uint32_t step,
+                                      float gain,
+                                      uint32_t count) {
+
+    uint32_t i;
+
+    // Contiguous samples starting on a word boundary, two samples per word
+    if (step == 1 && (first & 1) == 0) {
+        int *words = output + (first >> 1);
+        for (i = 0; i < count / 2; i++)
+        {
+            uint32_t low  = __builtin_conv_fix_by(__builtin_fclipf(input[2 * i] * gain, AUDIOFLOW_CLIP_LEVEL), 15);
+            uint32_t high = __builtin_conv_fix_by(__builtin_fclipf(input[2 * i + 1] * gain, AUDIOFLOW_CLIP_LEVEL), 15);
+            words[i] = (int)((low & 0xFFFF) | (high << 16));
+        }
+        if ((count & 1) == 0) {
+            return;
+        }
+        first += count - 1;
+        input += count - 1;
+        count = 1;
+    }
+
+    // Otherwise the other half of each word may belong to another channel
+    for (i = 0; i < count; i++)
+    {
+        uint32_t index = first + i * step;
+        uint32_t shift = (index & 1) ? 16 : 0;
+        uint32_t sample = __builtin_conv_fix_by(__builtin_fclipf(input[i] * gain, AUDIOFLOW_CLIP_LEVEL), 15);
+        uint32_t word = (uint32_t)output[index >> 1] & ~(0xFFFFu << shift);
+        output[index >> 1] = (int)(word | ((sample & 0xFFFF) << shift));
+    }
+}
+
+/**
+ * @brief      Converts one channel of packed 24-bit samples to floating point
+ *
+ * @param[in]  input    pointer to the DMA buffer
+ * @param      first    index of the channel's first sample
+ * @param      step     distance between the channel's samples
+ * @param      output   pointer to the channel's floating point block
+ * @param      gain     gain to apply
+ * @param      count    number of samples to convert
+ */
+#pragma optimize_for_speed
+static void audioflow_packed24_to_float(const int *input,
+                                        uint32_t first,
+                                        uint32_t step,
+                                        float *output,
+                                        float gain,
+                                        uint32_t count) {
+
+    uint32_t i = 0;
+
+    // Contiguous samples starting on a word boundary, four samples per three words
+    if (step == 1 && (first & 3) == 0) {
+        const int *words = input + (first >> 2) * 3;
+        for (i = 0; i < count / 4; i++)
+        {
+            uint32_t w0 = words[3 * i];
+            uint32_t w1 = words[3 * i + 1];
+            uint32_t w2 = words[3 * i + 2];
+            output[4 * i]     = __builtin_conv_float_by((int32_t)(w0 << 8), -31) * gain;
+            output[4 * i + 1] = __builtin_conv_float_by((int32_t)(((w0 >> 16) & 0xFF00) | (w1 << 16)), -31) * gain;
+            output[4 * i + 2] = __builtin_conv_float_by((int32_t)(((w1 >> 8) & 0xFFFF00) | (w2 << 24)), -31) * gain;
+            output[4 * i + 3] = __builtin_conv_float_by((int32_t)(w2 & 0xFFFFFF00), -31) * gain;
+        }
+        i *= 4;
+    }
+
+    for (; i < count; i++)
+    {
+        output[i] = __builtin_conv_float_by(audioflow_packed24_read(input, first + i * step), -31) * gain;
+    }
+}
+
+/**
+ * @brief      Converts one channel of floating point audio to packed 24-bit samples
+ *
+ * @param[in]  input    pointer to the channel's floating point block
+ * @param      output   pointer to the DMA buffer
+ * @param      first    index of the channel's first sample
+ * @param      step     distance between the channel's samples
+ * @param      gain     gain to apply
+ * @param      count    number of samples to convert
+ */
+#pragma optimize_for_speed
+static void audioflow_float_to_packed24(const float *input,
+                                        int *output,
+                                        uint32_t first,
+                                        uint32_t step,
+                                        float gain,
+                                        uint32_t count) {
+
+    uint32_t i = 0;
+
+    // Contiguous samples starting on a word boundary, four samples per three words
+    if (step == 1 && (first & 3) == 0) {
+        int *words = output + (first >> 2) * 3;
+        for (i = 0; i < count / 4; i++)
+        {
+            uint32_t s0 = __builtin_conv_fix_by(__builtin_fclipf(input[4 * i] * gain, AUDIOFLOW_CLIP_LEVEL), 23);
+            uint32_t s1 = __builtin_conv_fix_by(__builtin_fclipf(input[4 * i + 1] * gain, AUDIOFLOW_CLIP_LEVEL), 23);
+            uint32_t s2 = __builtin_conv_fix_by(__builtin_fclipf(input[4 * i + 2] * gain, AUDIOFLOW_CLIP_LEVEL), 23);
+            uint32_t s3 = __builtin_conv_fix_by(__builtin_fclipf(input[4 * i + 3] * gain, AUDIOFLOW_CLIP_LEVEL), 23);
+            words[3 * i]     = (int)((s0 & 0xFFFFFF) | (s1 << 24));
+            words[3 * i + 1] = (int)(((s1 >> 8) & 0xFFFF) | (s2 << 16));
+            words[3 * i + 2] = (int)(((s2 >> 16) & 0xFF) | (s3 << 8));
+        }
+        i *= 4;
+    }
+
+    // Otherwise the words at either end may hold another channel's samples
+    for (; i < count; i++)
+    {
+        uint32_t sample = __builtin_conv_fix_by(__builtin_fclipf(input[i] * gain, AUDIOFLOW_CLIP_LEVEL), 23);
+        audioflow_packed24_write(output, first + i * step, sample);
+    }
+}
+
+/**
+ * @brief      Converts a DMA buffer of fixed point audio to floating point
+ *
+ * Each channel in the channel mask is converted to its block in the output
+ * (channel n at output + n * block_size), applying the channel's gain.  The
+ * blocks of the other channels are left untouched.
+ *
+ * @param[in]  conversion   description of the DMA buffer
+ * @param[in]  input        pointer to the DMA buffer
+ * @param      output       pointer to the floating point channel blocks
+ * @return     None
+ */
+void audioflow_fixed_to_float_channels(const AUDIOFLOW_CONVERSION *conversion,
+                                       const int *input,
+                                       float *output) {
+
+    uint32_t channel, first, step;
+
+    if (conversion->channels > AUDIOFLOW_MAX_CHANNELS) {
+        return;
+    }
+
+    for (channel = 0; channel < conversion->channels; channel++) {
+
+        if (!(conversion->channel_mask & (1u << channel))) {
+            continue;
+        }
+
+        float gain = (conversion->gains != NULL) ? conversion->gains[channel] : 1.0;
+        float *channel_output = output + channel * conversion->block_size;
+        audioflow_channel_position(conversion, channel, &first, &step);
+
+        switch (conversion->format) {
+            case AUDIOFLOW_FORMAT_24BIT:
+                audioflow_words_to_float(input + first, step, channel_output, gain, -23, conversion->block_size);
+                break;
+            case AUDIOFLOW_FORMAT_24BIT_PACKED:
+                audioflow_packed24_to_float(input, first, step, channel_output, gain, conversion->block_size);
+                break;
+            case AUDIOFLOW_FORMAT_16BIT_PACKED:
+                audioflow_packed_to_float(input, first, step, channel_output, gain, conversion->block_size);
+                break;
+            default:
+                audioflow_words_to_float(input + first, step, channel_output, gain, -31, conversion->block_size);
+                break;
+        }
+    }
+}
+
+/**
+ * @brief      Converts floating point audio to a DMA buffer of fixed point audio
+ *
+ * Each channel in the channel mask is converted from its block in the input
+ * (channel n at input + n * block_size), applying the channel's gain and
+ * clipping.  The samples of the other channels are left untouched, so a
+ * channel that is never converted stays silent (the DMA buffers start out
+ * cleared).
+ *
+ * @param[in]  conversion   description of the DMA buffer
+ * @param[in]  input        pointer to the floating point channel blocks
+ * @param      output       pointer to the DMA buffer
+ * @return     None
+ */
+void audioflow_float_to_fixed_channels(const AUDIOFLOW_CONVERSION *conversion,
+                                       const float *input,
+                                       int *output) {
+
+    uint32_t channel, first, step;
+
+    if (conversion->channels > AUDIOFLOW_MAX_CHANNELS) {
+        return;
+    }
+
+    for (channel = 0; channel < conversion->channels; channel++) {
+
+        if (!(conversion->channel_mask & (1u << channel))) {
+            continue;
+        }
+
+        float gain = (conversion->gains != NULL) ? conversion->gains[channel] : 1.0;
+        const float *channel_input = input + channel * conversion->block_size;
+        audioflow_channel_position(conversion, channel, &first, &step);
+
+        switch (conversion->format) {
+            case AUDIOFLOW_FORMAT_24BIT:
+                audioflow_float_to_words(channel_input, output + first, step, gain, 23, conversion->block_size);
+                break;
+            case AUDIOFLOW_FORMAT_24BIT_PACKED:
+                audioflow_float_to_packed24(channel_input, output, first, step, gain, conversion->block_size);
+                break;
+            case AUDIOFLOW_FORMAT_16BIT_PACKED:
+                audioflow_float_to_packed(channel_input, output, first, step, gain, conversion->block_size);
+                break;
+            default:
+                audioflow_float_to_words(channel_input, output + first, step, gain, 31, conversion->block_size);
+                break;
+        }
+    }
+}
+
+/**
+ * @brief      Returns the full scale value of a fixed point format
+ */
+static double audioflow_reference_full_scale(AUDIOFLOW_FORMAT format) {
+
+    switch (format) {
+        case AUDIOFLOW_FORMAT_24BIT:
+        case AUDIOFLOW_FORMAT_24BIT_PACKED:
+            return 8388608.0;           // 2^23
+        case AUDIOFLOW_FORMAT_16BIT_PACKED:
+            return 32768.0;             // 2^15
+        default:
+            return 2147483648.0;        // 2^31
+    }
+}
+
+/**
+ * @brief      Portable version of audioflow_fixed_to_float_channels
+ *
+ * @param[in]  conversion   description of the DMA buffer
+ * @param[in]  input        pointer to the DMA buffer
+ * @param      output       pointer to the floating point channel blocks
+ * @return     None
+ */
+void audioflow_fixed_to_float_channels_reference(const AUDIOFLOW_CONVERSION *conversion,
+                                                 const int *input,
+                                                 float *output) {
+
+    double full_scale = audioflow_reference_full_scale(conversion->format);
+    uint32_t channel, i, first, step;
+
+    if (conversion->channels > AUDIOFLOW_MAX_CHANNELS) {
+        return;
+    }
+
+    for (channel = 0; channel < conversion->channels; channel++) {
+
+        if (!(conversion->channel_mask & (1u << channel))) {
+            continue;
+        }
+
+        float gain = (conversion->gains != NULL) ? conversion->gains[channel] : 1.0;
+        audioflow_channel_position(conversion, channel, &first, &step);
+
+        for (i = 0; i < conversion->block_size; i++) {
+
+            uint32_t index = first + i * step;
+            int32_t sample;
+            if (conversion->format == AUDIOFLOW_FORMAT_16BIT_PACKED) {
+                int32_t word = input[index >> 1];
+                sample = (index & 1) ? (word >> 16) : audioflow_low_half(word);
+            } else if (conversion->format == AUDIOFLOW_FORMAT_24BIT_PACKED) {
+                // Three bytes, lowest first, from the buffer as a stream of bytes
+                uint32_t value = 0, byte, k;
+                for (k = 0; k < 3; k++) {
+                    byte = index * 3 + k;
+                    value |= (((uint32_t)input[byte >> 2] >> (8 * (byte & 3))) & 0xFF) << (8 * k);
+                }
+                sample = (value & 0x800000) ? (int32_t)value - 0x1000000 : (int32_t)value;
+            } else {
+                sample = input[index];
+            }
+
+            output[channel * conversion->block_size + i] = (float)(sample / full_scale) * gain;
+        }
+    }
+}
+
+/**
+ * @brief      Portable version of audioflow_float_to_fixed_channels
+ *
+ * @param[in]  conversion   description of the DMA buffer
+ * @param[in]  input        pointer to the floating point channel blocks
+ * @param      output       pointer to the DMA buffer
+ * @return     None
+ */
+void audioflow_float_to_fixed_channels_reference(const AUDIOFLOW_CONVERSION *conversion,
+                                                 const float *input,
+                                                 int *output) {
+
+    double full_scale = audioflow_reference_full_scale(conversion->format);
+    float clip_level = AUDIOFLOW_CLIP_LEVEL;
+    uint32_t channel, i, first, step;
+
+    if (conversion->channels > AUDIOFLOW_MAX_CHANNELS) {
+        return;
+    }
+
+    for (channel = 0; channel < conversion->channels; channel++) {
+
+        if (!(conversion->channel_mask & (1u << channel))) {
+            continue;
+        }
+
+        float gain = (conversion->gains != NULL) ? conversion->gains[channel] : 1.0;
+        audioflow_channel_position(conversion, channel, &first, &step);
+
+        for (i = 0; i < conversion->block_size; i++) {
+
+            float value = input[channel * conversion->block_size + i] * gain;
+            if (value > clip_level) {
+                value = clip_level;
+            } else if (value < -clip_level) {
+                value = -clip_level;
+            }
+            int32_t sample = (int32_t)lrint(value * full_scale);
+
+            uint32_t index = first + i * step;
+            if (conversion->format == AUDIOFLOW_FORMAT_16BIT_PACKED) {
+                uint32_t shift = (index & 1) ? 16 : 0;
+                uint32_t word = (uint32_t)output[index >> 1] & ~(0xFFFFu << shift);
+                output[index >> 1] = (int)(word | (((uint32_t)sample & 0xFFFF) << shift));
+            } else if (conversion->format == AUDIOFLOW_FORMAT_24BIT_PACKED) {
+                uint32_t byte, k;
+                for (k = 0; k < 3; k++) {
+                    byte = index * 3 + k;
+                    uint32_t shift = 8 * (byte & 3);
+                    uint32_t word = (uint32_t)output[byte >> 2] & ~(0xFFu << shift);
+                    output[byte >> 2] = (int)(word | ((((uint32_t)sample >> (8 * k)) & 0xFF) << shift));
+                }
+            } else {
+                output[index] = sample;
+            }
+        }
+    }
+}
+
+#endif    // CORE0
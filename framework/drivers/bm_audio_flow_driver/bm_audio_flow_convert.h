@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver header file for audio flow conversions
+ */
+
+#ifndef _BM_AUDIO_FLOW_CONVERT_H_
+#define _BM_AUDIO_FLOW_CONVERT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Most channels in a buffer (one bit each in channel_mask)
+#define AUDIOFLOW_MAX_CHANNELS          (32)
+
+// Formats of the fixed point audio in a DMA buffer
+typedef enum {
+    AUDIOFLOW_FORMAT_32BIT,             // 1.31, one sample per word
+    AUDIOFLOW_FORMAT_24BIT,             // 1.23 sign extended, one sample per word (unpacked)
+    AUDIOFLOW_FORMAT_24BIT_PACKED,      // 1.23, four samples in three words (first in the low bytes)
+    AUDIOFLOW_FORMAT_16BIT_PACKED       // 1.15, two samples per word (first in the low half)
+} AUDIOFLOW_FORMAT;
+
+// Order of the samples in a DMA buffer
+typedef enum {
+    AUDIOFLOW_LAYOUT_CHANNEL_BLOCKS,    // a block per channel (2D DMA, see audioflow_init_sport_dma)
+    AUDIOFLOW_LAYOUT_INTERLEAVED        // one frame (a sample of each channel) after another
+} AUDIOFLOW_LAYOUT;
+
+/*
+ * Describes a DMA buffer and how it is converted to / from floating point.
+ * The floating point side always holds a block of block_size samples per
+ * channel, one after another.  Packed samples follow each other in the
+ * buffer with no gaps, so a channel's samples may share words with another
+ * channel's.
+ */
+typedef struct
+{
+    AUDIOFLOW_FORMAT format;
+    AUDIOFLOW_LAYOUT layout;
+
+    uint32_t channels;                  // 1 - AUDIOFLOW_MAX_CHANNELS (nothing is converted otherwise)
+    uint32_t block_size;                // any number of samples per channel
+
+    // Channels to convert, bit n for channel n (others are left untouched)
+    uint32_t channel_mask;
+
+    // Gain applied to each channel, or NULL for none
+    const float *gains;
+} AUDIOFLOW_CONVERSION;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Converts a DMA buffer of fixed point audio to per-channel floating point blocks
+void audioflow_fixed_to_float_channels(const AUDIOFLOW_CONVERSION *conversion,
+                                       const int *input,
+                                       float *output);
+
+// Converts per-channel floating point blocks to a DMA buffer of fixed point audio
+void audioflow_float_to_fixed_channels(const AUDIOFLOW_CONVERSION *conversion,
+                                       const float *input,
+                                       int *output);
+
+// Portable versions of the above, used as a reference when testing on a host
+void audioflow_fixed_to_float_channels_reference(const AUDIOFLOW_CONVERSION *conversion,
+                                                 const int *input,
+                                                 float *output);
+
+void audioflow_float_to_fixed_channels_reference(const AUDIOFLOW_CONVERSION *conversion,
+                                                 const float *input,
+                                                 int *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif    // _BM_AUDIO_FLOW_CONVERT_H_
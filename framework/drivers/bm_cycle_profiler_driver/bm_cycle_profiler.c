@@ -0,0 +1,581 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver for profiling the audio callback.
+ *
+ * The CPU load reported in the shared memory structure tells us how long a
+ * block took in total, but not which part of the processing made it take
+ * that long.  This driver times named scopes (e.g. an effect or an element
+ * call) inside the audio callback with the emuclk cycle counter.
+ *
+ * On the SHARC cores, cycle_profiler_block_start() and cycle_profiler_block_end()
+ * are called at the start and end of the audio callback by the audio framework and
+ * the code being profiled is wrapped in cycle_profiler_scope_begin() /
+ * cycle_profiler_scope_end().  For each scope, the cycles spent per block are
+ * accumulated over a window of blocks (min, average, max and a histogram for the
+ * 99th percentile), along with the cycles each scope took in the window's
+ * longest block.  At the end of each window, the statistics are published to a
+ * table in shared L2 memory and the accumulators are cleared.  Publishing takes a
+ * few thousand cycles once per window, at the end of a block.
+ *
+ * The profiler also keeps a ring with the timing of the most recent blocks:
+ * when each block arrived (cycle_profiler_block_arrival() in the DMA interrupt),
+ * how long the DMA interrupt waited for MDMA transfers, when the callback
+ * started and finished processing it and which preset was in use.  When a block
+ * is dropped because the callback hasn't finished the previous one, the framework
+ * calls cycle_profiler_block_dropped() and the ring is frozen into a trace in
+ * shared L2 memory.  The trace is held until the ARM has logged it.
+ *
+ * On the ARM, cycle_profiler_log_table() and cycle_profiler_log_trace() read a
+ * table / trace and log it as events, which the event logging driver sends out
+ * over the UART.  The SHARC cores can read each other's tables with
+ * cycle_profiler_copy_table() (e.g. to balance the load between them).
+ *
+ * @file       bm_cycle_profiler.c
+ * @brief      per-scope cycle profiling of the audio callback
+ */
+#include <string.h>
+
+#include "bm_cycle_profiler.h"
+
+// Number of times a table is read while a SHARC core is updating it
+#define CYCLE_PROFILER_READ_ATTEMPTS    (100)
+
+/**
+ * @brief Takes a consistent copy of the table published by a SHARC core
+ *
+ * @param shared_table pointer to the table in shared memory
+ * @param table pointer to the copy
+ * @return true if successful, false if nothing has been published yet or
+ *         the table couldn't be read
+ */
+bool cycle_profiler_copy_table(volatile BM_CYCLE_PROFILE_TABLE *shared_table,
+                               BM_CYCLE_PROFILE_TABLE *table) {
+
+    int attempt;
+
+    // The sequence number is odd while the table is being updated
+    for (attempt = 0; attempt < CYCLE_PROFILER_READ_ATTEMPTS; attempt++) {
+        uint32_t sequence = shared_table->sequence;
+        if (sequence & 1) {
+            continue;
+        }
+        *table = *shared_table;
+        if (shared_table->sequence == sequence) {
+            break;
+        }
+    }
+
+    return (attempt < CYCLE_PROFILER_READ_ATTEMPTS && table->windows_published != 0);
+}
+
+/**
+ * The code below is only compiled on the ARM processor not on the SHARC cores
+ */
+#if defined (CORE0)
+
+#include <stdio.h>
+
+#include "drivers/bm_event_logging_driver/bm_event_logging.h"
+
+/**
+ * @brief Logs the profile table published by a SHARC core
+ *
+ * One INFO event is logged for the table and one for each scope.
+ *
+ * @param shared_table pointer to the table in shared memory
+ * @param core_name name of the core used in the messages (e.g. "SHARC core 1")
+ * @return true if the table was logged, false if nothing has been published
+ *         yet or the table couldn't be read
+ */
+bool cycle_profiler_log_table(volatile BM_CYCLE_PROFILE_TABLE *shared_table,
+                              char *core_name) {
+
+    BM_CYCLE_PROFILE_TABLE table;
+    char message[EVENT_LOG_MESSAGE_LEN];
+
+    if (!cycle_profiler_copy_table(shared_table, &table)) {
+        return false;
+    }
+
+    sprintf(message, "%s profile: %u of %u blocks over budget, avg block %u, longest block %u of %u cycles",
+            core_name,
+            (unsigned int)table.blocks_over_budget,
+            (unsigned int)table.window_blocks,
+            (unsigned int)table.block_cycles_avg,
+            (unsigned int)table.longest_block_cycles,
+            (unsigned int)table.cycles_per_block);
+    log_event(EVENT_INFO, message);
+
+    for (uint32_t i = 0; i < table.num_scopes && i < CYCLE_PROFILER_MAX_SCOPES; i++) {
+        BM_CYCLE_PROFILE_SCOPE *s = &table.scopes[i];
+        s->name[CYCLE_PROFILER_NAME_LEN - 1] = 0;
+        sprintf(message, "  %s: avg %u, p99 %u, max %u, min %u cycles (%u in longest block)",
+                s->name,
+                (unsigned int)s->cycles_avg,
+                (unsigned int)s->cycles_p99,
+                (unsigned int)s->cycles_max,
+                (unsigned int)s->cycles_min,
+                (unsigned int)s->cycles_longest_block);
+        log_event(EVENT_INFO, message);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Logs the trace captured by a SHARC core when it dropped a block
+ *
+ * Does nothing unless a new trace has been captured since the last call.  One
+ * WARN event is logged for the drop and one INFO event for each block.
+ *
+ * @param shared_trace pointer to the trace in shared memory
+ * @param core_name name of the core used in the messages (e.g. "SHARC core 1")
+ * @return true if a trace was logged
+ */
+bool cycle_profiler_log_trace(volatile BM_CYCLE_TRACE *shared_trace,
+                              char *core_name) {
+
+    char message[EVENT_LOG_MESSAGE_LEN];
+    char callback[48];
+
+    // The SHARC core doesn't touch the trace until captures_logged catches up
+    uint32_t captures = shared_trace->captures;
+    if (captures == shared_trace->captures_logged) {
+        return false;
+    }
+
+    uint32_t num_entries = shared_trace->num_entries;
+    if (num_entries > CYCLE_PROFILER_TRACE_BLOCKS) {
+        num_entries = CYCLE_PROFILER_TRACE_BLOCKS;
+    }
+
+    sprintf(message, "%s dropped block %u (%u dropped so far), last %u blocks:",
+            core_name,
+            (unsigned int)shared_trace->dropped_block,
+            (unsigned int)shared_trace->blocks_dropped,
+            (unsigned int)num_entries);
+    log_event(EVENT_WARN, message);
+
+    for (uint32_t i = 0; i < num_entries; i++) {
+
+        volatile BM_CYCLE_TRACE_ENTRY *e = &shared_trace->entries[i];
+
+        if (e->callback_start == CYCLE_PROFILER_TRACE_NOT_RUN) {
+            sprintf(callback, "not run");
+        }
+        else if (e->callback_end == CYCLE_PROFILER_TRACE_NOT_RUN) {
+            sprintf(callback, "%u - still running",
+                    (unsigned int)e->callback_start);
+        }
+        else {
+            sprintf(callback, "%u - %u",
+                    (unsigned int)e->callback_start,
+                    (unsigned int)e->callback_end);
+        }
+
+        // Cycles since the previous block arrived
+        uint32_t period = (i > 0) ? e->arrival - shared_trace->entries[i - 1].arrival : 0;
+
+        sprintf(message, "  block %u: period %u, mdma wait %u, callback %s, preset %u",
+                (unsigned int)e->block,
+                (unsigned int)period,
+                (unsigned int)e->mdma_wait,
+                callback,
+                (unsigned int)e->preset);
+        log_event(EVENT_INFO, message);
+    }
+
+    // Let the SHARC core capture the next drop
+    shared_trace->captures_logged = captures;
+
+    return true;
+}
+
+#endif    // END ARM-only code
+
+/**
+ * The code below is only compiled on the SHARC processors, not on the ARM
+ */
+#ifndef CORE0
+
+// State structure with the accumulators of each scope on this core
+BM_CYCLE_PROFILER_STATE cycle_profiler_state;
+
+// Function prototypes
+static uint32_t cycle_profiler_histogram_bin(uint32_t cycles);
+static uint32_t cycle_profiler_histogram_bin_upper_edge(uint32_t bin);
+static void cycle_profiler_clear_window(void);
+static void cycle_profiler_publish_window(void);
+
+/**
+ * @brief Initializes the profiler on a SHARC core
+ *
+ * Scopes are added afterwards with cycle_profiler_add_scope().
+ *
+ * @param shared_table pointer to this core's table in shared L2 memory
+ * @param shared_trace pointer to this core's trace in shared L2 memory (or NULL)
+ * @param cycles_per_block number of cycles available to process a block
+ * @param window_blocks number of blocks the statistics are gathered over
+ * @return true if successful, false if not
+ */
+bool cycle_profiler_initialize_sharc_core(BM_CYCLE_PROFILE_TABLE *shared_table,
+                                          BM_CYCLE_TRACE *shared_trace,
+                                          uint32_t cycles_per_block,
+                                          uint32_t window_blocks) {
+
+    BM_CYCLE_PROFILER_STATE *c = &cycle_profiler_state;
+
+    c->initialized = false;
+    c->num_scopes = 0;
+
+    if (shared_table == NULL ||
+        window_blocks == 0 ||
+        window_blocks > CYCLE_PROFILER_MAX_WINDOW_BLOCKS) {
+        return false;
+    }
+
+    c->shared_table = shared_table;
+    c->cycles_per_block = cycles_per_block;
+    c->window_blocks = window_blocks;
+
+    // Nothing published yet
+    c->shared_table->sequence = 0;
+    c->shared_table->windows_published = 0;
+    c->shared_table->window_blocks = window_blocks;
+    c->shared_table->cycles_per_block = cycles_per_block;
+    c->shared_table->num_scopes = 0;
+
+    c->shared_trace = shared_trace;
+    if (shared_trace != NULL) {
+        shared_trace->blocks_dropped = 0;
+        shared_trace->captures = 0;
+        shared_trace->captures_logged = 0;
+        shared_trace->num_entries = 0;
+    }
+    c->trace_index = 0;
+    c->trace_callback_index = 0;
+    c->trace_blocks = 0;
+    memset(c->trace, 0, sizeof(c->trace));
+
+    cycle_profiler_clear_window();
+
+    c->initialized = true;
+    return true;
+}
+
+/**
+ * @brief Creates a named scope
+ *
+ * The id returned is passed to cycle_profiler_scope_begin() and
+ * cycle_profiler_scope_end().  If the profiler isn't initialized or all scopes
+ * are in use, CYCLE_PROFILER_NO_SCOPE is returned, which the begin and end
+ * functions ignore.  So code can always be instrumented, whether or not the
+ * framework has set the profiler up.
+ *
+ * @param name name of the scope (truncated to CYCLE_PROFILER_NAME_LEN - 1 characters)
+ * @return id of the scope or CYCLE_PROFILER_NO_SCOPE
+ */
+int32_t cycle_profiler_add_scope(const char *name) {
+
+    BM_CYCLE_PROFILER_STATE *c = &cycle_profiler_state;
+
+    if (!c->initialized || c->num_scopes >= CYCLE_PROFILER_MAX_SCOPES) {
+        return CYCLE_PROFILER_NO_SCOPE;
+    }
+
+    uint32_t scope = c->num_scopes;
+
+    // Copy the name into the shared table once, it doesn't change afterwards
+    volatile char *shared_name = c->shared_table->scopes[scope].name;
+    uint32_t i;
+    for (i = 0; i < CYCLE_PROFILER_NAME_LEN - 1 && name != NULL && name[i] != 0; i++) {
+        shared_name[i] = name[i];
+    }
+    for (; i < CYCLE_PROFILER_NAME_LEN; i++) {
+        shared_name[i] = 0;
+    }
+
+    BM_CYCLE_PROFILER_SCOPE_STATE *s = &c->scopes[scope];
+    s->block_cycles = 0;
+    s->ran_this_block = false;
+    s->blocks = 0;
+    s->cycles_min = UINT32_MAX;
+    s->cycles_max = 0;
+    s->cycles_total = 0;
+    s->cycles_longest_block = 0;
+    memset(s->histogram, 0, sizeof(s->histogram));
+
+    c->num_scopes = scope + 1;
+
+    return (int32_t)scope;
+}
+
+/**
+ * @brief Records the arrival of an audio block
+ *
+ * Called by the audio framework at the start of the DMA interrupt (where the
+ * cycle counter for the CPU load is captured).
+ *
+ * @param preset effects preset in use, recorded in the trace
+ */
+void cycle_profiler_block_arrival(uint32_t preset) {
+
+    BM_CYCLE_PROFILER_STATE *c = &cycle_profiler_state;
+
+    uint64_t arrival = __builtin_emuclk();
+    c->block_arrival = arrival;
+
+    // Start a new entry in the ring
+    c->trace_index = (c->trace_index + 1) % CYCLE_PROFILER_TRACE_BLOCKS;
+
+    BM_CYCLE_TRACE_ENTRY *e = &c->trace[c->trace_index];
+    e->block = c->trace_blocks++;
+    e->arrival = (uint32_t)arrival;
+    e->callback_start = CYCLE_PROFILER_TRACE_NOT_RUN;
+    e->callback_end = CYCLE_PROFILER_TRACE_NOT_RUN;
+    e->mdma_wait = 0;
+    e->preset = preset;
+}
+
+/**
+ * @brief Captures the trace when the block that just arrived is dropped
+ *
+ * Called by the audio framework from the DMA interrupt when the callback
+ * hasn't finished the previous block.  The last CYCLE_PROFILER_TRACE_BLOCKS
+ * blocks are copied to the shared trace unless the ARM hasn't logged the
+ * previous capture yet.
+ */
+void cycle_profiler_block_dropped(void) {
+
+    BM_CYCLE_PROFILER_STATE *c = &cycle_profiler_state;
+    volatile BM_CYCLE_TRACE *trace = c->shared_trace;
+
+    if (!c->initialized || trace == NULL) {
+        return;
+    }
+
+    trace->blocks_dropped++;
+
+    // Keep the capture the ARM hasn't logged yet
+    if (trace->captures != trace->captures_logged) {
+        return;
+    }
+
+    uint32_t num_entries = c->trace_blocks;
+    if (num_entries > CYCLE_PROFILER_TRACE_BLOCKS) {
+        num_entries = CYCLE_PROFILER_TRACE_BLOCKS;
+    }
+
+    // Oldest entry first, ending with the dropped block
+    uint32_t index = c->trace_index + CYCLE_PROFILER_TRACE_BLOCKS + 1 - num_entries;
+    for (uint32_t i = 0; i < num_entries; i++) {
+        trace->entries[i] = c->trace[index % CYCLE_PROFILER_TRACE_BLOCKS];
+        index++;
+    }
+
+    trace->dropped_block = c->trace[c->trace_index].block;
+    trace->num_entries = num_entries;
+
+    // Published last, the ARM reads the trace once it sees a new capture
+    trace->captures++;
+}
+
+/**
+ * @brief Marks the start of the audio callback
+ *
+ * Called by the audio framework at the start of the callback, which processes
+ * the block that arrived last.
+ */
+void cycle_profiler_block_start(void) {
+
+    BM_CYCLE_PROFILER_STATE *c = &cycle_profiler_state;
+
+    c->block_start = c->block_arrival;
+    c->trace_callback_index = c->trace_index;
+    c->trace[c->trace_index].callback_start =
+        (uint32_t)(__builtin_emuclk() - c->block_start);
+}
+
+/**
+ * @brief Marks the end of an audio block
+ *
+ * Called by the audio framework once the block has been processed.  Adds the
+ * cycles each scope spent in this block to the window and publishes the
+ * window once it's complete.
+ */
+#pragma optimize_for_speed
+void cycle_profiler_block_end(void) {
+
+    BM_CYCLE_PROFILER_STATE *c = &cycle_profiler_state;
+
+    if (!c->initialized) {
+        return;
+    }
+
+    uint32_t block_cycles = (uint32_t)(__builtin_emuclk() - c->block_start);
+    c->trace[c->trace_callback_index].callback_end = block_cycles;
+
+    c->window_cycles_total += block_cycles;
+    if (block_cycles > c->cycles_per_block) {
+        c->blocks_over_budget++;
+    }
+
+    // Remember how the longest block so far was spent
+    bool longest_block = (block_cycles > c->longest_block_cycles);
+    if (longest_block) {
+        c->longest_block_cycles = block_cycles;
+    }
+
+    for (uint32_t i = 0; i < c->num_scopes; i++) {
+
+        BM_CYCLE_PROFILER_SCOPE_STATE *s = &c->scopes[i];
+        uint32_t cycles = s->block_cycles;
+
+        if (longest_block) {
+            s->cycles_longest_block = cycles;
+        }
+
+        if (s->ran_this_block) {
+            s->blocks++;
+            s->cycles_total += cycles;
+            if (cycles < s->cycles_min) {
+                s->cycles_min = cycles;
+            }
+            if (cycles > s->cycles_max) {
+                s->cycles_max = cycles;
+            }
+            s->histogram[cycle_profiler_histogram_bin(cycles)]++;
+        }
+
+        s->block_cycles = 0;
+        s->ran_this_block = false;
+    }
+
+    c->window_block_count++;
+    if (c->window_block_count >= c->window_blocks) {
+        cycle_profiler_publish_window();
+        cycle_profiler_clear_window();
+    }
+}
+
+/**
+ * @brief Returns the histogram bin for a cycle count
+ *
+ * Values below 8 have a bin each, above that each octave is split into 8 bins.
+ *
+ * @param cycles number of cycles
+ * @return bin index
+ */
+static uint32_t cycle_profiler_histogram_bin(uint32_t cycles) {
+
+    if (cycles < 8) {
+        return cycles;
+    }
+
+    uint32_t octave = 3;
+    while (cycles >> (octave + 1)) {
+        octave++;
+    }
+
+    uint32_t bin = (octave - 2) * 8 + ((cycles >> (octave - 3)) & 7);
+    if (bin >= CYCLE_PROFILER_HISTOGRAM_BINS) {
+        bin = CYCLE_PROFILER_HISTOGRAM_BINS - 1;
+    }
+    return bin;
+}
+
+/**
+ * @brief Returns the largest cycle count that falls into a histogram bin
+ *
+ * @param bin bin index
+ * @return number of cycles
+ */
+static uint32_t cycle_profiler_histogram_bin_upper_edge(uint32_t bin) {
+
+    if (bin < 8) {
+        return bin;
+    }
+
+    uint32_t shift = bin / 8 - 1;
+    return ((8 + (bin & 7) + 1) << shift) - 1;
+}
+
+/**
+ * @brief Clears the accumulators of the window
+ */
+static void cycle_profiler_clear_window(void) {
+
+    BM_CYCLE_PROFILER_STATE *c = &cycle_profiler_state;
+
+    c->window_block_count = 0;
+    c->window_cycles_total = 0;
+    c->blocks_over_budget = 0;
+    c->longest_block_cycles = 0;
+
+    for (uint32_t i = 0; i < c->num_scopes; i++) {
+        BM_CYCLE_PROFILER_SCOPE_STATE *s = &c->scopes[i];
+        s->blocks = 0;
+        s->cycles_min = UINT32_MAX;
+        s->cycles_max = 0;
+        s->cycles_total = 0;
+        s->cycles_longest_block = 0;
+        memset(s->histogram, 0, sizeof(s->histogram));
+    }
+}
+
+/**
+ * @brief Publishes the statistics of the window to the shared table
+ */
+static void cycle_profiler_publish_window(void) {
+
+    BM_CYCLE_PROFILER_STATE *c = &cycle_profiler_state;
+    volatile BM_CYCLE_PROFILE_TABLE *table = c->shared_table;
+
+    // Odd sequence number tells the ARM the table is being updated
+    table->sequence++;
+
+    table->blocks_over_budget = c->blocks_over_budget;
+    table->block_cycles_avg = (uint32_t)(c->window_cycles_total / c->window_block_count);
+    table->longest_block_cycles = c->longest_block_cycles;
+    table->num_scopes = c->num_scopes;
+
+    for (uint32_t i = 0; i < c->num_scopes; i++) {
+
+        BM_CYCLE_PROFILER_SCOPE_STATE *s = &c->scopes[i];
+        volatile BM_CYCLE_PROFILE_SCOPE *out = &table->scopes[i];
+
+        out->blocks = s->blocks;
+        out->cycles_longest_block = s->cycles_longest_block;
+
+        if (s->blocks == 0) {
+            out->cycles_min = 0;
+            out->cycles_avg = 0;
+            out->cycles_max = 0;
+            out->cycles_p99 = 0;
+            continue;
+        }
+
+        out->cycles_min = s->cycles_min;
+        out->cycles_avg = (uint32_t)(s->cycles_total / s->blocks);
+        out->cycles_max = s->cycles_max;
+
+        // 99th percentile: first bin where 99% of the blocks have been counted
+        uint32_t target = s->blocks - s->blocks / 100;
+        uint32_t count = 0;
+        uint32_t bin;
+        for (bin = 0; bin < CYCLE_PROFILER_HISTOGRAM_BINS - 1; bin++) {
+            count += s->histogram[bin];
+            if (count >= target) {
+                break;
+            }
+        }
+        uint32_t p99 = cycle_profiler_histogram_bin_upper_edge(bin);
+        out->cycles_p99 = (p99 < s->cycles_max) ? p99 : s->cycles_max;
+    }
+
+    table->windows_published++;
+    table->sequence++;
+}
+
+#endif    // END SHARC-only code
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver header file for the cycle profiler
+ *
+ */
+#ifndef _BM_CYCLE_PROFILER_H_
+#define _BM_CYCLE_PROFILER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Global profiler parameters
+#define CYCLE_PROFILER_MAX_SCOPES           (12)
+#define CYCLE_PROFILER_NAME_LEN             (12)
+#define CYCLE_PROFILER_HISTOGRAM_BINS       (160)   // 8 bins per octave, up to 4M cycles
+#define CYCLE_PROFILER_MAX_WINDOW_BLOCKS    (65535)
+#define CYCLE_PROFILER_TRACE_BLOCKS         (16)
+
+// Trace entry value for a callback that didn't start / finish
+#define CYCLE_PROFILER_TRACE_NOT_RUN        (0xFFFFFFFF)
+
+// Returned by cycle_profiler_add_scope() if the scope can't be created
+#define CYCLE_PROFILER_NO_SCOPE             (-1)
+
+/*
+ * Statistics of one scope over the last window, as published in shared memory.
+ * All values are in processor cycles (emuclk) per block.
+ */
+typedef struct
+{
+    char name[CYCLE_PROFILER_NAME_LEN];
+    uint32_t blocks;                // blocks in which the scope ran
+    uint32_t cycles_min;
+    uint32_t cycles_avg;
+    uint32_t cycles_max;
+    uint32_t cycles_p99;            // upper edge of the histogram bin (~9% resolution)
+    uint32_t cycles_longest_block;  // cycles spent in the window's longest block
+} BM_CYCLE_PROFILE_SCOPE;
+
+/*
+ * Table published by a SHARC core in shared L2 memory.  sequence is odd while
+ * the SHARC core is updating the table, so the ARM can detect torn reads.
+ */
+typedef struct
+{
+    uint32_t sequence;
+    uint32_t windows_published;
+    uint32_t window_blocks;
+    uint32_t cycles_per_block;      // budget: cycles available for each block
+    uint32_t blocks_over_budget;
+    uint32_t block_cycles_avg;      // from the arrival of a block to the end of its callback
+    uint32_t longest_block_cycles;
+    uint32_t num_scopes;
+    BM_CYCLE_PROFILE_SCOPE scopes[CYCLE_PROFILER_MAX_SCOPES];
+} BM_CYCLE_PROFILE_TABLE;
+
+/*
+ * Timing of one audio block.  Callback start / end are in cycles after the
+ * block arrived (CYCLE_PROFILER_TRACE_NOT_RUN if they didn't happen).
+ */
+typedef struct
+{
+    uint32_t block;                 // block number since the profiler was initialized
+    uint32_t arrival;               // emuclk (lower 32 bits) when the block arrived
+    uint32_t callback_start;
+    uint32_t callback_end;
+    uint32_t mdma_wait;             // cycles spent waiting for MDMA transfers
+    uint32_t preset;                // effects preset in use
+} BM_CYCLE_TRACE_ENTRY;
+
+/*
+ * Trace of the blocks leading up to a dropped block, captured by a SHARC core
+ * in shared L2 memory.  A new capture is only made once the ARM has logged the
+ * previous one (captures_logged == captures), so the first drop of a burst is
+ * kept.
+ */
+typedef struct
+{
+    uint32_t blocks_dropped;
+    uint32_t captures;
+    uint32_t captures_logged;       // written by the ARM
+    uint32_t dropped_block;
+    uint32_t num_entries;
+    BM_CYCLE_TRACE_ENTRY entries[CYCLE_PROFILER_TRACE_BLOCKS];  // oldest first
+} BM_CYCLE_TRACE;
+
+#ifndef CORE0
+// SHARC specific functionality
+
+// Per-scope accumulators kept in local (SHARC) memory
+typedef struct
+{
+    uint64_t scope_start;
+    uint32_t block_cycles;
+    bool ran_this_block;
+
+    uint32_t blocks;
+    uint32_t cycles_min;
+    uint32_t cycles_max;
+    uint64_t cycles_total;
+    uint32_t cycles_longest_block;
+    uint16_t histogram[CYCLE_PROFILER_HISTOGRAM_BINS];
+} BM_CYCLE_PROFILER_SCOPE_STATE;
+
+typedef struct
+{
+    bool initialized;
+
+    // Table in shared memory that the statistics are published to
+    volatile BM_CYCLE_PROFILE_TABLE *shared_table;
+
+    // Trace in shared memory that dropped blocks are captured to (or NULL)
+    volatile BM_CYCLE_TRACE *shared_trace;
+
+    uint32_t cycles_per_block;
+    uint32_t window_blocks;
+
+    uint32_t num_scopes;
+    BM_CYCLE_PROFILER_SCOPE_STATE scopes[CYCLE_PROFILER_MAX_SCOPES];
+
+    // Current block and window
+    uint64_t block_arrival;
+    uint64_t block_start;
+    uint64_t mdma_wait_start;
+    uint32_t window_block_count;
+    uint64_t window_cycles_total;
+    uint32_t blocks_over_budget;
+    uint32_t longest_block_cycles;
+
+    // Ring of the most recent blocks
+    BM_CYCLE_TRACE_ENTRY trace[CYCLE_PROFILER_TRACE_BLOCKS];
+    uint32_t trace_index;
+    uint32_t trace_callback_index;
+    uint32_t trace_blocks;
+} BM_CYCLE_PROFILER_STATE;
+
+extern BM_CYCLE_PROFILER_STATE cycle_profiler_state;
+
+#endif    // CORE0
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// SHARC only - initializes the profiler and the table / trace it publishes to
+bool cycle_profiler_initialize_sharc_core(BM_CYCLE_PROFILE_TABLE *shared_table,
+                                          BM_CYCLE_TRACE *shared_trace,
+                                          uint32_t cycles_per_block,
+                                          uint32_t window_blocks);
+
+// SHARC only - creates a named scope, returns its id
+int32_t cycle_profiler_add_scope(const char *name);
+
+// SHARC only - call when a block arrives (DMA interrupt) and when it is dropped
+void cycle_profiler_block_arrival(uint32_t preset);
+void cycle_profiler_block_dropped(void);
+
+// SHARC only - call at the start and end of the audio callback
+void cycle_profiler_block_start(void);
+void cycle_profiler_block_end(void);
+
+// Takes a consistent copy of the table published by a SHARC core
+bool cycle_profiler_copy_table(volatile BM_CYCLE_PROFILE_TABLE *shared_table,
+                               BM_CYCLE_PROFILE_TABLE *table);
+
+// ARM only - logs the table / captured trace published by a SHARC core
+bool cycle_profiler_log_table(volatile BM_CYCLE_PROFILE_TABLE *shared_table,
+                              char *core_name);
+bool cycle_profiler_log_trace(volatile BM_CYCLE_TRACE *shared_trace,
+                              char *core_name);
+
+#ifndef CORE0
+
+/**
+ * @brief      Starts timing a scope
+ *
+ * Inlined to keep the overhead to a read of the cycle counter.  A scope may
+ * be entered several times per block; the cycles are summed.
+ *
+ * @param[in]  scope   id returned by cycle_profiler_add_scope()
+ */
+static inline void cycle_profiler_scope_begin(int32_t scope) {
+    if ((uint32_t)scope < cycle_profiler_state.num_scopes) {
+        cycle_profiler_state.scopes[scope].scope_start = __builtin_emuclk();
+    }
+}
+
+/**
+ * @brief      Stops timing a scope
+ *
+ * @param[in]  scope   id returned by cycle_profiler_add_scope()
+ * @return     cycles spent in the scope since cycle_profiler_scope_begin()
+ *             (0 if the scope doesn't exist)
+ */
+static inline uint32_t cycle_profiler_scope_end(int32_t scope) {
+    if ((uint32_t)scope < cycle_profiler_state.num_scopes) {
+        BM_CYCLE_PROFILER_SCOPE_STATE *s = &cycle_profiler_state.scopes[scope];
+        uint32_t cycles = (uint32_t)(__builtin_emuclk() - s->scope_start);
+        s->block_cycles += cycles;
+        s->ran_this_block = true;
+        return cycles;
+    }
+    return 0;
+}
+
+/**
+ * @brief      Starts timing a wait for an MDMA transfer in the DMA interrupt
+ */
+static inline void cycle_profiler_mdma_wait_begin(void) {
+    cycle_profiler_state.mdma_wait_start = __builtin_emuclk();
+}
+
+/**
+ * @brief      Stops timing a wait for an MDMA transfer, adding it to the trace
+ */
+static inline void cycle_profiler_mdma_wait_end(void) {
+    BM_CYCLE_PROFILER_STATE *c = &cycle_profiler_state;
+    c->trace[c->trace_index].mdma_wait += (uint32_t)(__builtin_emuclk() - c->mdma_wait_start);
+}
+
+#endif    // CORE0
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif    // _BM_CYCLE_PROFILER_H_
@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver for passing messages between the cores.
+ *
+ * Events such as a switch being pressed used to be passed to the SHARC cores
+ * as flags in the shared memory structure, set by one core and polled and
+ * cleared by another.  A second event arriving before the first was seen was
+ * lost, and a flag set between the read and the clear was lost as well.
+ *
+ * This driver implements a lock-free single-producer / single-consumer queue
+ * of typed messages (parameter and preset changes, MIDI, meter data and
+ * switches) that lives in shared L2 memory.  One core sends and one core
+ * receives on each queue, so a queue is needed for each direction between a
+ * pair of cores.  The sender only writes the message slots and the write index,
+ * the receiver only writes the read index, so no locks are needed as long as
+ * the message is written before the write index is advanced and read before
+ * the read index is advanced.  The indices are free running and wrap around
+ * at 2^32, which MESSAGE_QUEUE_LENGTH (a power of 2) divides.
+ *
+ * The ARM can reorder its accesses to memory, so a data memory barrier is
+ * issued between writing / reading a slot and updating the index.  On the
+ * SHARC cores accesses to L2 memory are made in program order and declaring
+ * the queue volatile is enough.  The functions can also be built on a host
+ * (SHARC_HOST_BUILD), where the barrier makes them safe to use between
+ * threads.
+ *
+ * @file       bm_message_queue.c
+ * @brief      lock-free message queues between the cores
+ */
+#include <stddef.h>
+
+#include "bm_message_queue.h"
+
+// Orders the accesses to a slot and to the index that hands it over
+#if defined(CORE0) || defined(SHARC_HOST_BUILD)
+#define MESSAGE_QUEUE_BARRIER()     __sync_synchronize()
+#else
+#define MESSAGE_QUEUE_BARRIER()
+#endif
+
+/**
+ * @brief Empties a queue
+ *
+ * Call before either core uses the queue (e.g. from the ARM before the SHARC
+ * cores are started).
+ *
+ * @param queue pointer to the queue in shared memory
+ */
+void message_queue_initialize(volatile BM_MESSAGE_QUEUE *queue) {
+
+    queue->write_index = 0;
+    queue->messages_dropped = 0;
+    queue->read_index = 0;
+    MESSAGE_QUEUE_BARRIER();
+}
+
+/**
+ * @brief Sends a message
+ *
+ * Must only be called by the core that sends on this queue.
+ *
+ * @param queue pointer to the queue in shared memory
+ * @param message pointer to the message to send
+ * @return true if successful, false if the queue is full (the message is
+ *         counted in messages_dropped)
+ */
+bool message_queue_send(volatile BM_MESSAGE_QUEUE *queue,
+                        const BM_MESSAGE *message) {
+
+    uint32_t write_index = queue->write_index;
+
+    if (write_index - queue->read_index >= MESSAGE_QUEUE_LENGTH) {
+        queue->messages_dropped++;
+        return false;
+    }
+
+    volatile BM_MESSAGE *slot = &queue->messages[write_index & (MESSAGE_QUEUE_LENGTH - 1)];
+    slot->type = message->type;
+    slot->id = message->id;
+    slot->data.word[0] = message->data.word[0];
+    slot->data.word[1] = message->data.word[1];
+
+    // Hand the slot over to the receiver once the message is in it
+    MESSAGE_QUEUE_BARRIER();
+    queue->write_index = write_index + 1;
+
+    return true;
+}
+
+/**
+ * @brief Sends a parameter change
+ *
+ * @param queue pointer to the queue in shared memory
+ * @param parameter id of the parameter
+ * @param value new value
+ * @return true if successful, false if the queue is full
+ */
+bool message_queue_send_parameter(volatile BM_MESSAGE_QUEUE *queue,
+                                  uint32_t parameter,
+                                  float value) {
+
+    BM_MESSAGE message;
+
+    message.type = MESSAGE_TYPE_PARAMETER;
+    message.id = parameter;
+    message.data.value[0] = value;
+    message.data.value[1] = 0.0;
+
+    return message_queue_send(queue, &message);
+}
+
+/**
+ * @brief Sends a preset change
+ *
+ * @param queue pointer to the queue in shared memory
+ * @param slot which preset is changing (e.g. effects or reverb)
+ * @param preset new preset
+ * @return true if successful, false if the queue is full
+ */
+bool message_queue_send_preset(volatile BM_MESSAGE_QUEUE *queue,
+                               uint32_t slot,
+                               uint32_t preset) {
+
+    BM_MESSAGE message;
+
+    message.type = MESSAGE_TYPE_PRESET;
+    message.id = slot;
+    message.data.word[0] = preset;
+    message.data.word[1] = 0;
+
+    return message_queue_send(queue, &message);
+}
+
+/**
+ * @brief Sends MIDI bytes
+ *
+ * @param queue pointer to the queue in shared memory
+ * @param bytes MIDI bytes to send
+ * @param num_bytes number of bytes, 1 to MESSAGE_QUEUE_MAX_MIDI_BYTES
+ * @return true if successful, false if the queue is full or num_bytes is
+ *         out of range
+ */
+bool message_queue_send_midi(volatile BM_MESSAGE_QUEUE *queue,
+                             const uint8_t *bytes,
+                             uint32_t num_bytes) {
+
+    BM_MESSAGE message;
+    uint32_t i;
+
+    if (num_bytes < 1 || num_bytes > MESSAGE_QUEUE_MAX_MIDI_BYTES) {
+        return false;
+    }
+
+    message.type = MESSAGE_TYPE_MIDI;
+    message.id = num_bytes;
+    message.data.word[0] = 0;
+    message.data.word[1] = 0;
+    for (i = 0; i < num_bytes; i++) {
+        message.data.word[0] |= (uint32_t)bytes[i] << (8 * i);
+    }
+
+    return message_queue_send(queue, &message);
+}
+
+/**
+ * @brief Sends meter data
+ *
+ * @param queue pointer to the queue in shared memory
+ * @param meter id of the meter
+ * @param level current level
+ * @param peak peak level
+ * @return true if successful, false if the queue is full
+ */
+bool message_queue_send_meter(volatile BM_MESSAGE_QUEUE *queue,
+                              uint32_t meter,
+                              float level,
+                              float peak) {
+
+    BM_MESSAGE message;
+
+    message.type = MESSAGE_TYPE_METER;
+    message.id = meter;
+    message.data.value[0] = level;
+    message.data.value[1] = peak;
+
+    return message_queue_send(queue, &message);
+}
+
+/**
+ * @brief Sends a switch event
+ *
+ * @param queue pointer to the queue in shared memory
+ * @param sw switch that was pressed
+ * @param state state of the switch (for switches controlling an on-off state)
+ * @return true if successful, false if the queue is full
+ */
+bool message_queue_send_switch(volatile BM_MESSAGE_QUEUE *queue,
+                               MESSAGE_SWITCH sw,
+                               uint32_t state) {
+
+    BM_MESSAGE message;
+
+    message.type = MESSAGE_TYPE_SWITCH;
+    message.id = sw;
+    message.data.word[0] = state;
+    message.data.word[1] = 0;
+
+    return message_queue_send(queue, &message);
+}
+
+/**
+ * @brief Receives the oldest message in a queue
+ *
+ * Must only be called by the core that receives on this queue.
+ *
+ * @param queue pointer to the queue in shared memory
+ * @param message pointer to where the message is copied
+ * @return true if a message was received, false if the queue is empty
+ */
+bool message_queue_receive(volatile BM_MESSAGE_QUEUE *queue,
+                           BM_MESSAGE *message) {
+
+    uint32_t read_index = queue->read_index;
+
+    if (queue->write_index == read_index) {
+        return false;
+    }
+
+    // Read the slot only after seeing the write index that handed it over
+    MESSAGE_QUEUE_BARRIER();
+
+    volatile BM_MESSAGE *slot = &queue->messages[read_index & (MESSAGE_QUEUE_LENGTH - 1)];
+    message->type = slot->type;
+    message->id = slot->id;
+    message->data.word[0] = slot->data.word[0];
+    message->data.word[1] = slot->data.word[1];
+
+    // Hand the slot back to the sender once the message has been read
+    MESSAGE_QUEUE_BARRIER();
+    queue->read_index = read_index + 1;
+
+    return true;
+}
+
+/**
+ * @brief Discards the messages waiting in a queue
+ *
+ * Must only be called by the core that receives on this queue.  Used by a
+ * receiver that has no use for the messages sent on a queue, so the sender
+ * doesn't find it full and count its messages as dropped.
+ *
+ * @param queue pointer to the queue in shared memory
+ * @return number of messages discarded
+ */
+uint32_t message_queue_discard(volatile BM_MESSAGE_QUEUE *queue) {
+
+    uint32_t write_index = queue->write_index;
+    uint32_t discarded = write_index - queue->read_index;
+
+    if (discarded) {
+        // Hand the slots back to the sender
+        MESSAGE_QUEUE_BARRIER();
+        queue->read_index = write_index;
+    }
+
+    return discarded;
+}
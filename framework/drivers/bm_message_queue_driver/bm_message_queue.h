@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver header file for the inter-core message queues
+ *
+ */
+#ifndef _BM_MESSAGE_QUEUE_H_
+#define _BM_MESSAGE_QUEUE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Global message queue parameters
+#define MESSAGE_QUEUE_LENGTH                (16)    // must be a power of 2
+#define MESSAGE_QUEUE_CACHE_LINE_BYTES      (64)
+#define MESSAGE_QUEUE_CACHE_LINE_WORDS      (MESSAGE_QUEUE_CACHE_LINE_BYTES / 4)
+#define MESSAGE_QUEUE_MAX_MIDI_BYTES        (4)
+
+// Types of message
+typedef enum {
+    MESSAGE_TYPE_PARAMETER,     // id: parameter, value[0]: new value
+    MESSAGE_TYPE_PRESET,        // id: preset slot, word[0]: new preset
+    MESSAGE_TYPE_MIDI,          // id: number of bytes, word[0]: bytes (first in the LSBs)
+    MESSAGE_TYPE_METER,         // id: meter, value[0] / value[1]: level / peak
+    MESSAGE_TYPE_SWITCH         // id: MESSAGE_SWITCH, word[0]: switch state
+} MESSAGE_TYPE;
+
+// Switches reported with MESSAGE_TYPE_SWITCH
+typedef enum {
+    MESSAGE_SWITCH_SAM_PB_1,
+    MESSAGE_SWITCH_SAM_PB_2,
+    MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_1,
+    MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_2,
+    MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_3,
+    MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_4
+} MESSAGE_SWITCH;
+
+/*
+ * A message.  Only 32-bit fields are used so the layout is the same on the
+ * ARM and the SHARC cores.
+ */
+typedef struct
+{
+    uint32_t type;                  // MESSAGE_TYPE
+    uint32_t id;
+    union {
+        float value[2];
+        uint32_t word[2];
+    } data;
+} BM_MESSAGE;
+
+/*
+ * Single-producer / single-consumer queue in shared L2 memory.  The write index
+ * is only written by the sending core and the read index only by the receiving
+ * core.  The queue starts on a cache line boundary and each index sits in its
+ * own cache line, so the two cores never write to the same line and the
+ * indices don't share a line with the shared memory around the queue.
+ */
+typedef struct
+{
+    uint32_t write_index;           // free running, written by the sender
+    uint32_t messages_dropped;      // written by the sender when the queue is full
+    uint32_t sender_pad[MESSAGE_QUEUE_CACHE_LINE_WORDS - 2];
+
+    uint32_t read_index;            // free running, written by the receiver
+    uint32_t receiver_pad[MESSAGE_QUEUE_CACHE_LINE_WORDS - 1];
+
+    BM_MESSAGE messages[MESSAGE_QUEUE_LENGTH];
+} __attribute__((aligned(MESSAGE_QUEUE_CACHE_LINE_BYTES))) BM_MESSAGE_QUEUE;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Empties a queue, call before either core uses it
+void message_queue_initialize(volatile BM_MESSAGE_QUEUE *queue);
+
+// Sender only - returns false (and counts the message as dropped) if the queue is full
+bool message_queue_send(volatile BM_MESSAGE_QUEUE *queue,
+                        const BM_MESSAGE *message);
+
+bool message_queue_send_parameter(volatile BM_MESSAGE_QUEUE *queue,
+                                  uint32_t parameter,
+                                  float value);
+bool message_queue_send_preset(volatile BM_MESSAGE_QUEUE *queue,
+                               uint32_t slot,
+                               uint32_t preset);
+bool message_queue_send_midi(volatile BM_MESSAGE_QUEUE *queue,
+                             const uint8_t *bytes,
+                             uint32_t num_bytes);
+bool message_queue_send_meter(volatile BM_MESSAGE_QUEUE *queue,
+                              uint32_t meter,
+                              float level,
+                              float peak);
+bool message_queue_send_switch(volatile BM_MESSAGE_QUEUE *queue,
+                               MESSAGE_SWITCH sw,
+                               uint32_t state);
+
+// Receiver only - returns false if the queue is empty
+bool message_queue_receive(volatile BM_MESSAGE_QUEUE *queue,
+                           BM_MESSAGE *message);
+
+// Receiver only - discards any messages waiting, returns how many
+uint32_t message_queue_discard(volatile BM_MESSAGE_QUEUE *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif    // _BM_MESSAGE_QUEUE_H_
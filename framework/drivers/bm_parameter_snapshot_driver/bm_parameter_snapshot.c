@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver for passing parameters between the cores.
+ *
+ * Parameters such as the pots on the Audio Project Fin used to be written by
+ * the ARM into individual fields of the shared memory structure at any time
+ * and read by the SHARC cores wherever they were needed.  A block could be
+ * processed with some parameters from one reading and some from the next,
+ * and the effects recomputed their coefficients every block whether or not
+ * anything had moved.
+ *
+ * With this driver, the writer (the ARM) keeps the parameters in a block of
+ * two buffers in shared L2 memory.  It fills the buffer that isn't the latest
+ * one and then publishes it by incrementing the published count, so a reader
+ * always has one complete set of values to copy.  Each buffer also has a
+ * sequence number which is odd while it is being written, in case a reader is
+ * slow enough to still be copying a buffer when the writer comes back to it.
+ *
+ * A reader (e.g. the audio callback on a SHARC core) latches one snapshot per
+ * block into local memory with parameter_snapshot_latch() and uses only that
+ * snapshot for the block.  The snapshot records in which version each
+ * parameter last changed, so code that applies the parameters can skip the
+ * ones that haven't changed since it last applied them (see
+ * parameter_snapshot_changed()).
+ *
+ * @file       bm_parameter_snapshot.c
+ * @brief      double-buffered parameter snapshots between the cores
+ */
+#include <string.h>
+
+#include "bm_parameter_snapshot.h"
+
+// Number of times a reader tries to copy the latest buffer
+#define PARAMETER_SNAPSHOT_READ_ATTEMPTS    (10)
+
+// Orders the accesses to a buffer and to the counts that hand it over
+#if defined(CORE0) || defined(SHARC_HOST_BUILD)
+#define PARAMETER_SNAPSHOT_BARRIER()        __sync_synchronize()
+#else
+#define PARAMETER_SNAPSHOT_BARRIER()
+#endif
+
+/**
+ * @brief Clears a parameter block
+ *
+ * Call before any core reads the block (e.g. from the ARM before the SHARC
+ * cores are started).
+ *
+ * @param block pointer to the parameter block in shared memory
+ * @param num_parameters number of parameters, up to PARAMETER_SNAPSHOT_MAX_PARAMETERS
+ */
+void parameter_snapshot_initialize(volatile BM_PARAMETER_BLOCK *block,
+                                   uint32_t num_parameters) {
+
+    int b, i;
+
+    if (num_parameters > PARAMETER_SNAPSHOT_MAX_PARAMETERS) {
+        num_parameters = PARAMETER_SNAPSHOT_MAX_PARAMETERS;
+    }
+
+    block->published = 0;
+    block->num_parameters = num_parameters;
+    for (b = 0; b < 2; b++) {
+        block->buffers[b].sequence = 0;
+        for (i = 0; i < PARAMETER_SNAPSHOT_MAX_PARAMETERS; i++) {
+            block->buffers[b].values[i] = 0.0;
+        }
+    }
+    PARAMETER_SNAPSHOT_BARRIER();
+}
+
+/**
+ * @brief Publishes a new set of values
+ *
+ * Must only be called by the core that writes the block.  Nothing is
+ * published if all of the values are the same as the latest ones.
+ *
+ * @param block pointer to the parameter block in shared memory
+ * @param values num_parameters new values
+ * @return true if the values were published, false if none changed
+ */
+bool parameter_snapshot_publish(volatile BM_PARAMETER_BLOCK *block,
+                                const float *values) {
+
+    uint32_t published = block->published;
+    uint32_t num_parameters = block->num_parameters;
+    uint32_t i;
+
+    // Skip the update if nothing has changed since the last one
+    volatile BM_PARAMETER_BUFFER *latest = &block->buffers[published & 1];
+    for (i = 0; i < num_parameters; i++) {
+        if (latest->values[i] != values[i]) {
+            break;
+        }
+    }
+    if (published != 0 && i == num_parameters) {
+        return false;
+    }
+
+    // Fill the other buffer, marked as being written while we do
+    volatile BM_PARAMETER_BUFFER *next = &block->buffers[(published + 1) & 1];
+    next->sequence++;
+    PARAMETER_SNAPSHOT_BARRIER();
+    for (i = 0; i < num_parameters; i++) {
+        next->values[i] = values[i];
+    }
+    PARAMETER_SNAPSHOT_BARRIER();
+    next->sequence++;
+
+    // And make it the latest
+    PARAMETER_SNAPSHOT_BARRIER();
+    block->published = published + 1;
+
+    return true;
+}
+
+/**
+ * @brief Clears a local snapshot
+ *
+ * @param snapshot pointer to the local snapshot
+ */
+void parameter_snapshot_setup(BM_PARAMETER_SNAPSHOT *snapshot) {
+
+    memset(snapshot, 0, sizeof(BM_PARAMETER_SNAPSHOT));
+}
+
+/**
+ * @brief Latches the latest values into a local snapshot
+ *
+ * Call once per block and read the parameters from the snapshot for the rest
+ * of the block.  If a consistent copy can't be taken (the writer keeps
+ * updating the buffer being read), the snapshot is left as it was and the
+ * new values are picked up on the next call.
+ *
+ * @param block pointer to the parameter block in shared memory
+ * @param snapshot pointer to the local snapshot
+ * @return true if any of the values changed
+ */
+bool parameter_snapshot_latch(volatile BM_PARAMETER_BLOCK *block,
+                              BM_PARAMETER_SNAPSHOT *snapshot) {
+
+    float values[PARAMETER_SNAPSHOT_MAX_PARAMETERS];
+    uint32_t num_parameters = block->num_parameters;
+    uint32_t published;
+    int attempt;
+    uint32_t i;
+
+    if (num_parameters > PARAMETER_SNAPSHOT_MAX_PARAMETERS) {
+        return false;
+    }
+
+    for (attempt = 0; attempt < PARAMETER_SNAPSHOT_READ_ATTEMPTS; attempt++) {
+
+        published = block->published;
+        if (published == snapshot->published) {
+            return false;
+        }
+        PARAMETER_SNAPSHOT_BARRIER();
+
+        volatile BM_PARAMETER_BUFFER *buffer = &block->buffers[published & 1];
+        uint32_t sequence = buffer->sequence;
+        if (sequence & 1) {
+            continue;
+        }
+        PARAMETER_SNAPSHOT_BARRIER();
+        for (i = 0; i < num_parameters; i++) {
+            values[i] = buffer->values[i];
+        }
+        PARAMETER_SNAPSHOT_BARRIER();
+        if (buffer->sequence == sequence) {
+            break;
+        }
+    }
+
+    if (attempt == PARAMETER_SNAPSHOT_READ_ATTEMPTS) {
+        return false;
+    }
+    snapshot->published = published;
+
+    // Note the version in which each value changed (all of them the first time)
+    bool first = (snapshot->version == 0);
+    bool changed = false;
+    for (i = 0; i < num_parameters; i++) {
+        if (values[i] != snapshot->values[i] || first) {
+            if (!changed) {
+                snapshot->version++;
+                changed = true;
+            }
+            snapshot->values[i] = values[i];
+            snapshot->changed[i] = snapshot->version;
+        }
+    }
+
+    return changed;
+}
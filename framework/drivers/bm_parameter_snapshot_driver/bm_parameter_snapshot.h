@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver header file for parameter snapshots
+ *
+ */
+#ifndef _BM_PARAMETER_SNAPSHOT_H_
+#define _BM_PARAMETER_SNAPSHOT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Global parameter snapshot parameters
+#define PARAMETER_SNAPSHOT_MAX_PARAMETERS   (8)
+
+/*
+ * One of the two buffers of a parameter block.  sequence is odd while the
+ * writer is updating the buffer.
+ */
+typedef struct
+{
+    uint32_t sequence;
+    float values[PARAMETER_SNAPSHOT_MAX_PARAMETERS];
+} BM_PARAMETER_BUFFER;
+
+/*
+ * Parameter block in shared L2 memory, written by one core and read by any
+ * number of cores.  The latest values are in buffers[published & 1], the
+ * writer updates the other buffer and then publishes it.
+ */
+typedef struct
+{
+    uint32_t published;             // number of snapshots published
+    uint32_t num_parameters;
+    BM_PARAMETER_BUFFER buffers[2];
+} BM_PARAMETER_BLOCK;
+
+/*
+ * Snapshot latched by a reader in local memory.  version is incremented each
+ * time a latch changes any of the values and changed[] holds the version in
+ * which each parameter last changed.
+ */
+typedef struct
+{
+    uint32_t published;             // publication latched last
+    uint32_t version;
+    float values[PARAMETER_SNAPSHOT_MAX_PARAMETERS];
+    uint32_t changed[PARAMETER_SNAPSHOT_MAX_PARAMETERS];
+} BM_PARAMETER_SNAPSHOT;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Writer only - clears the block, call before any core reads it
+void parameter_snapshot_initialize(volatile BM_PARAMETER_BLOCK *block,
+                                   uint32_t num_parameters);
+
+// Writer only - publishes new values, returns false if none changed
+bool parameter_snapshot_publish(volatile BM_PARAMETER_BLOCK *block,
+                                const float *values);
+
+// Reader - clears a local snapshot
+void parameter_snapshot_setup(BM_PARAMETER_SNAPSHOT *snapshot);
+
+// Reader - latches the latest values, returns true if any changed
+bool parameter_snapshot_latch(volatile BM_PARAMETER_BLOCK *block,
+                              BM_PARAMETER_SNAPSHOT *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @brief Checks if a parameter changed after a given version of a snapshot
+ *
+ * A consumer keeps the version it last applied (snapshot->version), and sets
+ * it to 0 to have every parameter applied again.
+ *
+ * @param snapshot pointer to the local snapshot
+ * @param parameter index of the parameter
+ * @param applied version last applied by the consumer
+ * @return true if the parameter has changed since
+ */
+static inline bool parameter_snapshot_changed(const BM_PARAMETER_SNAPSHOT *snapshot,
+                                              uint32_t parameter,
+                                              uint32_t applied) {
+
+    return snapshot->changed[parameter] > applied;
+}
+
+#endif    // _BM_PARAMETER_SNAPSHOT_H_
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Host test of the audio flow conversions (bm_audio_flow_convert.c).
+ *
+ * The optimized audioflow_fixed_to_float_channels() and
+ * audioflow_float_to_fixed_channels() are run side by side with their
+ * portable _reference versions on the same pseudo-random buffers, for every
+ * format and layout, odd and even channel counts and block sizes, with and
+ * without gains and with all or only some of the channels selected.  Block
+ * sizes from 1 up cover the samples left over by the packed formats.  The
+ * destination buffers start out filled with the same random contents, so
+ * the channels that are skipped (and the other samples sharing a word with a
+ * packed sample) are checked to be left untouched as well.  The outputs must
+ * match bit for bit.
+ *
+ * Returns 0 if all checks pass (run by ctest).
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "drivers/bm_audio_flow_driver/bm_audio_flow_convert.h"
+
+#define TEST_MAX_CHANNELS       (8)
+#define TEST_MAX_BLOCK_SIZE     (64)
+#define TEST_MAX_SAMPLES        (TEST_MAX_CHANNELS * TEST_MAX_BLOCK_SIZE)
+
+#define TEST_PARTIAL_MASK       (0x5B)
+
+static const AUDIOFLOW_FORMAT test_formats[] = {
+    AUDIOFLOW_FORMAT_32BIT,
+    AUDIOFLOW_FORMAT_24BIT,
+    AUDIOFLOW_FORMAT_24BIT_PACKED,
+    AUDIOFLOW_FORMAT_16BIT_PACKED
+};
+static const char *test_format_names[] = { "32bit", "24bit", "24bit_packed", "16bit_packed" };
+
+static const AUDIOFLOW_LAYOUT test_layouts[] = {
+    AUDIOFLOW_LAYOUT_CHANNEL_BLOCKS,
+    AUDIOFLOW_LAYOUT_INTERLEAVED
+};
+static const char *test_layout_names[] = { "channel_blocks", "interleaved" };
+
+static const uint32_t test_channels[] = { 1, 2, 3, 5, 7, 8 };
+static const uint32_t test_block_sizes[] = { 1, 2, 3, 4, 5, 7, 16, 33, 64 };
+
+static const float test_gains[TEST_MAX_CHANNELS] = {
+    1.0, 0.5, 2.0, 0.7071, 1.5, 0.0, 0.25, 3.0
+};
+
+static int dma_input[TEST_MAX_SAMPLES];
+static float float_input[TEST_MAX_SAMPLES];
+
+static int fixed_output[TEST_MAX_SAMPLES];
+static int fixed_output_reference[TEST_MAX_SAMPLES];
+static float float_output[TEST_MAX_SAMPLES];
+static float float_output_reference[TEST_MAX_SAMPLES];
+
+static uint32_t test_random_state = 12345;
+
+static uint32_t test_random(void) {
+
+    test_random_state = test_random_state * 1664525u + 1013904223u;
+    return test_random_state;
+}
+
+// Fills the buffers with random samples (floats in +/-1.25, so some clip)
+static void test_fill(AUDIOFLOW_FORMAT format) {
+
+    uint32_t i;
+
+    for (i = 0; i < TEST_MAX_SAMPLES; i++) {
+        uint32_t r = test_random();
+        // Unpacked 24-bit samples are sign extended
+        dma_input[i] = (format == AUDIOFLOW_FORMAT_24BIT) ? ((int32_t)(r << 8) >> 8) : (int)r;
+        float_input[i] = ((float)(test_random() >> 8) / 8388608.0 - 1.0) * 1.25;
+        fixed_output[i] = fixed_output_reference[i] = (int)test_random();
+        float_output[i] = float_output_reference[i] = (float)(test_random() >> 8);
+    }
+    // Full scale and zero, in both directions
+    float_input[0] = 1.0;
+    float_input[1] = -1.0;
+    float_input[2] = 0.0;
+}
+
+static int test_case(AUDIOFLOW_FORMAT format, AUDIOFLOW_LAYOUT layout,
+                     uint32_t channels, uint32_t block_size,
+                     uint32_t channel_mask, const float *gains) {
+
+    AUDIOFLOW_CONVERSION conversion;
+    int errors = 0;
+
+    conversion.format = format;
+    conversion.layout = layout;
+    conversion.channels = channels;
+    conversion.block_size = block_size;
+    conversion.channel_mask = channel_mask;
+    conversion.gains = gains;
+
+    test_fill(format);
+
+    audioflow_fixed_to_float_channels(&conversion, dma_input, float_output);
+    audioflow_fixed_to_float_channels_reference(&conversion, dma_input, float_output_reference);
+    if (memcmp(float_output, float_output_reference, sizeof(float_output))) {
+        errors++;
+    }
+
+    audioflow_float_to_fixed_channels(&conversion, float_input, fixed_output);
+    audioflow_float_to_fixed_channels_reference(&conversion, float_input, fixed_output_reference);
+    if (memcmp(fixed_output, fixed_output_reference, sizeof(fixed_output))) {
+        errors++;
+    }
+
+    return errors;
+}
+
+int main(void) {
+
+    uint32_t f, l, c, b, m, g;
+    uint32_t cases = 0;
+    int errors = 0;
+
+    for (f = 0; f < sizeof(test_formats) / sizeof(test_formats[0]); f++) {
+        for (l = 0; l < sizeof(test_layouts) / sizeof(test_layouts[0]); l++) {
+            for (c = 0; c < sizeof(test_channels) / sizeof(test_channels[0]); c++) {
+                for (b = 0; b < sizeof(test_block_sizes) / sizeof(test_block_sizes[0]); b++) {
+                    for (m = 0; m < 2; m++) {
+                        for (g = 0; g < 2; g++) {
+
+                            uint32_t channels = test_channels[c];
+                            uint32_t all = (1u << channels) - 1;
+                            uint32_t mask = m ? (TEST_PARTIAL_MASK & all) : all;
+                            int e = test_case(test_formats[f], test_layouts[l],
+                                              channels, test_block_sizes[b],
+                                              mask, g ? test_gains : NULL);
+                            if (e) {
+                                printf("%s %s: %u channels, block %u, mask 0x%X, %s: outputs differ\n",
+                                       test_format_names[f], test_layout_names[l],
+                                       channels, test_block_sizes[b], mask,
+                                       g ? "gains" : "no gains");
+                            }
+                            errors += e;
+                            cases++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    printf("%u cases, %d mismatches\n", cases, errors);
+    printf("%s\n", errors ? "FAILED" : "PASSED");
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,654 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Offline block-processing benchmark for the audio elements and effects.
+ *
+ * Each entry in the benchmark table wraps a *_setup / *_read pair.  For every
+ * legal AUDIO_BLOCK_SIZE (4 - 128) the instance is set up from scratch, warmed
+ * up, and then driven with a synthetic signal (a decaying harmonic "pluck"
+ * retriggered twice a second plus a little noise) for a fixed amount of audio.
+ * The fastest of several runs is reported as a CSV table on stdout:
+ *
+ *   name,block_size,ns_per_sample,cycles_per_block,sharc_mhz_at_48k
+ *
+ * cycles_per_block is measured with the host cycle counter (see
+ * sharc_host_emuclk).  sharc_mhz_at_48k is the core clock that would be
+ * needed to run the element in real time at AUDIO_SAMPLE_RATE, scaled by
+ * --sharc-scale (SHARC cycles per host cycle, 1.0 by default).  Calibrate
+ * the scale factor once against sharc_core1_cpu_load_mhz on hardware to turn
+ * these into budget numbers for effect chains.
+ *
+ * Usage: audio_processing_benchmark [--seconds S] [--repeats N]
+ *                                   [--sharc-scale X] [--filter SUBSTRING]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "common/audio_system_config.h"
+
+#include "audio_processing/audio_elements/allpass_filter.h"
+#include "audio_processing/audio_elements/amplitude_modulation.h"
+#include "audio_processing/audio_elements/biquad_cascade.h"
+#include "audio_processing/audio_elements/biquad_filter.h"
+#include "audio_processing/audio_elements/clickless_volume_ctrl.h"
+#include "audio_processing/audio_elements/clipper.h"
+#include "audio_processing/audio_elements/compressor.h"
+#include "audio_processing/audio_elements/compressor_linked.h"
+#include "audio_processing/audio_elements/convolver.h"
+#include "audio_processing/audio_elements/integer_delay_lpf.h"
+#include "audio_processing/audio_elements/integer_delay_multitap.h"
+#include "audio_processing/audio_elements/simple_synth.h"
+#include "audio_processing/audio_elements/poly_synth.h"
+#include "audio_processing/audio_elements/variable_delay.h"
+#include "audio_processing/audio_elements/fractional_delay.h"
+#include "audio_processing/audio_elements/zero_crossing_detector.h"
+#include "audio_processing/audio_elements/pitch_detector.h"
+
+#include "audio_processing/audio_effects/effect_autowah.h"
+#include "audio_processing/audio_effects/effect_fdn_reverb.h"
+#include "audio_processing/audio_effects/effect_guitar_synth.h"
+#include "audio_processing/audio_effects/effect_multiband_compressor.h"
+#include "audio_processing/audio_effects/effect_ring_modulator.h"
+#include "audio_processing/audio_effects/effect_stereo_flanger.h"
+#include "audio_processing/audio_effects/effect_stereo_reverb.h"
+#include "audio_processing/audio_effects/effect_tremelo.h"
+#include "audio_processing/audio_effects/effect_tube_distortion.h"
+
+#include "drivers/bm_audio_flow_driver/bm_audio_flow_convert.h"
+
+// Length of the synthetic test signal (one second at the system sample rate)
+#define BENCH_SIGNAL_LEN        (AUDIO_SAMPLE_RATE)
+#define BENCH_WARMUP_BLOCKS     (64)
+#define BENCH_DELAY_LEN         (32000)
+
+// A benchmark entry: a setup routine and a block processing routine
+typedef struct {
+    const char *name;
+    void (*setup)(void);
+    void (*process)(float *audio_in, float *audio_out_left,
+                    float *audio_out_right, uint32_t audio_block_size);
+} BENCHMARK_ENTRY;
+
+static const uint32_t block_sizes[] = { 4, 8, 16, 32, 64, 128 };
+
+static float test_signal[BENCH_SIGNAL_LEN];
+
+// Caller-provided memory for the elements that need it
+static float delay_line[2 * BENCH_DELAY_LEN];
+static float allpass_line[1024];
+static float pm biquad_coeffs[4];
+static uint32_t tap_offsets[2 * 3] = { 10000, 20000, 28000, 8000, 22000, 29000 };
+static float tap_gains[2 * 3] = { 0.3, 0.4, 0.2, 0.4, 0.3, 0.2 };
+
+/******************************************************************************
+ * Audio elements
+ *****************************************************************************/
+
+static ALLPASS_FILTER bench_allpass;
+static void allpass_bench_setup(void) {
+    allpass_setup(&bench_allpass, allpass_line, 556, 0.5);
+}
+static void allpass_bench_process(float *in, float *out_l, float *out_r,
+                                  uint32_t n) {
+    allpass_read(&bench_allpass, in, out_l, n);
+}
+
+static AMPLITUDE_MODULATION bench_amp_mod;
+static void amplitude_modulation_bench_setup(void) {
+    amplitude_modulation_setup(&bench_amp_mod, 0.5, 4.0, AMP_MOD_SIN,
+                               AUDIO_SAMPLE_RATE);
+}
+static void amplitude_modulation_bench_process(float *in, float *out_l,
+                                               float *out_r, uint32_t n) {
+    amplitude_modulation_read(&bench_amp_mod, in, out_l, NULL, n);
+}
+
+static BIQUAD_FILTER bench_biquad;
+static void biquad_bench_setup(void) {
+    filter_setup(&bench_biquad, BIQUAD_TYPE_PEAKING, BIQUAD_TRANS_MED,
+                 biquad_coeffs, 1000.0, 1.0, 6.0, AUDIO_SAMPLE_RATE);
+}
+static void biquad_bench_process(float *in, float *out_l, float *out_r,
+                                 uint32_t n) {
+    filter_read(&bench_biquad, in, out_l, n);
+}
+
+static BIQUAD_CASCADE bench_biquad_cascade;
+static void biquad_cascade_bench_setup(void) {
+    // 10-band parametric EQ, octave spaced from 31 Hz
+    biquad_cascade_setup(&bench_biquad_cascade, 10, AUDIO_SAMPLE_RATE);
+    for (uint32_t i = 0; i < 10; i++) {
+        biquad_cascade_modify_section(&bench_biquad_cascade, i,
+                                      BIQUAD_TYPE_PEAKING, 31.25 * (1 << i),
+                                      1.4, (i & 1) ? 3.0 : -3.0);
+    }
+}
+static void biquad_cascade_bench_process(float *in, float *out_l,
+                                         float *out_r, uint32_t n) {
+    biquad_cascade_read(&bench_biquad_cascade, in, out_l, n);
+}
+
+static VOLUME_CTRL bench_volume;
+static void volume_control_bench_setup(void) {
+    volume_control_setup(&bench_volume, 0.5);
+}
+static void volume_control_bench_process(float *in, float *out_l,
+                                         float *out_r, uint32_t n) {
+    volume_control_read(&bench_volume, in, out_l, n);
+}
+
+static CLIPPER bench_clipper;
+static void clipper_bench_setup(void) {
+    clipper_setup(&bench_clipper, 0.5, POLY_SMOOTHSTEP, false);
+}
+static void clipper_upsampled_bench_setup(void) {
+    clipper_setup(&bench_clipper, 0.5, POLY_SMOOTHSTEP, true);
+}
+static void clipper_bench_process(float *in, float *out_l, float *out_r,
+                                  uint32_t n) {
+    clipper_read(&bench_clipper, in, out_l, n);
+}
+
+static COMPRESSOR bench_compressor;
+static void compressor_bench_setup(void) {
+    compressor_setup(&bench_compressor, -20.0, 4.0, 5.0, 50.0, 1.0,
+                     AUDIO_SAMPLE_RATE);
+}
+static void compressor_bench_process(float *in, float *out_l, float *out_r,
+                                     uint32_t n) {
+    compressor_read(&bench_compressor, in, out_l, n);
+}
+
+static LINKED_COMPRESSOR bench_linked_compressor;
+static float linked_compressor_lookahead[2 * 32];
+static void linked_compressor_bench_setup(void) {
+    linked_compressor_setup(&bench_linked_compressor, 2, -20.0, 4.0, 0.0,
+                            50.0, 1.0, LINKED_COMPRESSOR_DETECT_PEAK, 16,
+                            linked_compressor_lookahead, 32,
+                            AUDIO_SAMPLE_RATE);
+}
+static void linked_compressor_bench_process(float *in, float *out_l,
+                                            float *out_r, uint32_t n) {
+    float *channels_in[2] = { in, in };
+    float *channels_out[2] = { out_l, out_r };
+    linked_compressor_read(&bench_linked_compressor, channels_in,
+                           channels_out, n);
+}
+
+static CONVOLVER bench_convolver;
+static float convolver_ir[2 * AUDIO_SAMPLE_RATE];
+static float convolver_fast_memory[16384];
+static float convolver_bulk_memory[2048 * 190];
+static uint32_t convolver_ir_length;
+static uint32_t convolver_tail_size;
+static void convolver_bench_init(uint32_t ir_length, uint32_t tail_size) {
+    // Exponentially decaying noise, the IR is transformed on the first block
+    // since the transform depends on the block size
+    srand(2);
+    for (uint32_t i = 0; i < ir_length; i++) {
+        convolver_ir[i] = ((float)rand() / RAND_MAX - 0.5)
+                * expf(-6.9 * (float)i / ir_length);
+    }
+    convolver_ir_length = ir_length;
+    convolver_tail_size = tail_size;
+    bench_convolver.initialized = false;
+}
+static void convolver_cabinet_bench_setup(void) {
+    convolver_bench_init(3000, 0);
+}
+static void convolver_2s_bench_setup(void) {
+    convolver_bench_init(2 * AUDIO_SAMPLE_RATE, 1024);
+}
+static void convolver_bench_process(float *in, float *out_l, float *out_r,
+                                    uint32_t n) {
+    if (!bench_convolver.initialized) {
+        convolver_setup(&bench_convolver, convolver_ir, convolver_ir_length, n,
+                        convolver_tail_size, convolver_fast_memory,
+                        sizeof(convolver_fast_memory) / sizeof(float),
+                        convolver_bulk_memory,
+                        sizeof(convolver_bulk_memory) / sizeof(float));
+    }
+    convolver_read(&bench_convolver, in, out_l, n);
+
+    // Background work is included, as it would be on a single core
+    while (convolver_process_tail(&bench_convolver)) {
+    }
+}
+
+static DELAY_LPF bench_delay;
+static void delay_bench_setup(void) {
+    delay_setup(&bench_delay, delay_line, BENCH_DELAY_LEN,
+                BENCH_DELAY_LEN - 1000, 0.5, 0.8, 0.2);
+}
+static void delay_bench_process(float *in, float *out_l, float *out_r,
+                                uint32_t n) {
+    delay_read(&bench_delay, in, out_l, n);
+}
+
+static void delay_stereo_bench_setup(void) {
+    delay_setup_multichannel(&bench_delay, 2, delay_line, BENCH_DELAY_LEN,
+                             BENCH_DELAY_LEN - 1000, NULL, 0.5, 0.8, 0.2);
+}
+static void delay_stereo_bench_process(float *in, float *out_l, float *out_r,
+                                       uint32_t n) {
+    float *channels_in[2] = { in, in };
+    float *channels_out[2] = { out_l, out_r };
+    delay_read_multichannel(&bench_delay, channels_in, channels_out, n);
+}
+
+static MULTITAP_DELAY bench_multitap;
+static void multitap_delay_bench_setup(void) {
+    multitap_delay_setup(&bench_multitap, delay_line, BENCH_DELAY_LEN, 3,
+                         tap_offsets, tap_gains, 0.8);
+}
+static void multitap_delay_bench_process(float *in, float *out_l,
+                                         float *out_r, uint32_t n) {
+    multitap_delay_read(&bench_multitap, in, out_l, n);
+}
+
+static void multitap_delay_stereo_bench_setup(void) {
+    multitap_delay_setup_multichannel(&bench_multitap, 2, delay_line,
+                                      BENCH_DELAY_LEN, 3, tap_offsets,
+                                      tap_gains, 0.8);
+}
+static void multitap_delay_stereo_bench_process(float *in, float *out_l,
+                                                float *out_r, uint32_t n) {
+    float *channels_in[2] = { in, in };
+    float *channels_out[2] = { out_l, out_r };
+    multitap_delay_read_multichannel(&bench_multitap, channels_in,
+                                     channels_out, n);
+}
+
+static SIMPLE_SYNTH bench_synth;
+static void synth_bench_setup(void) {
+    synth_setup(&bench_synth, 100, 100, 480000, 1000, SYNTH_TRIANGLE,
+                AUDIO_SAMPLE_RATE);
+    synth_play_note_freq(&bench_synth, 220.0, 0.5);
+}
+static void synth_bench_process(float *in, float *out_l, float *out_r,
+                                uint32_t n) {
+    synth_read(&bench_synth, out_l, n);
+}
+
+// Chorus-length delay (20 ms +/- 5 ms) swept by a block LFO
+#define BENCH_FRACTIONAL_DELAY_LEN  (2048)
+static FRACTIONAL_DELAY bench_fractional_delay;
+static float bench_fractional_delay_line[BENCH_FRACTIONAL_DELAY_LEN];
+static float bench_fractional_delay_lfo_t;
+static void fractional_delay_bench_setup(FRACTIONAL_DELAY_INTERPOLATION interp) {
+    fractional_delay_setup(&bench_fractional_delay, bench_fractional_delay_line,
+                           BENCH_FRACTIONAL_DELAY_LEN, 960.0, 240.0, 0.3,
+                           interp);
+    bench_fractional_delay_lfo_t = 0.0;
+}
+static void fractional_delay_linear_bench_setup(void) {
+    fractional_delay_bench_setup(FRACTIONAL_DELAY_LINEAR);
+}
+static void fractional_delay_lagrange_bench_setup(void) {
+    fractional_delay_bench_setup(FRACTIONAL_DELAY_LAGRANGE3);
+}
+static void fractional_delay_allpass_bench_setup(void) {
+    fractional_delay_bench_setup(FRACTIONAL_DELAY_ALLPASS);
+}
+static void fractional_delay_bench_process(float *in, float *out_l,
+                                           float *out_r, uint32_t n) {
+    float lfo[MAX_AUDIO_BLOCK_SIZE];
+    oscillator_lfo_block(OSC_SINE, &bench_fractional_delay_lfo_t,
+                         0.5 / AUDIO_SAMPLE_RATE, lfo, n);
+    fractional_delay_read(&bench_fractional_delay, in, out_l, lfo, n);
+}
+
+static VARIABLE_DELAY bench_variable_delay;
+static void variable_delay_bench_setup(void) {
+    variable_delay_setup(&bench_variable_delay, 0.5, 0.5, 0.5,
+                         AUDIO_SAMPLE_RATE, VARIABLE_DELAY_SIN);
+}
+static void variable_delay_bench_process(float *in, float *out_l,
+                                         float *out_r, uint32_t n) {
+    variable_delay_read(&bench_variable_delay, in, out_l, NULL, n);
+}
+
+static ZERO_CROSSING_DETECTOR bench_zero_crossing;
+static void zero_crossing_bench_setup(void) {
+    zero_cross_setup(&bench_zero_crossing, 0.01, AUDIO_SAMPLE_RATE);
+}
+static void zero_crossing_bench_process(float *in, float *out_l,
+                                        float *out_r, uint32_t n) {
+    zero_crossing_read(&bench_zero_crossing, in, n, out_l);
+}
+
+static PITCH_DETECTOR bench_pitch_detector;
+static void pitch_detector_bench_setup(void) {
+    pitch_detector_setup(&bench_pitch_detector, 70.0, 1200.0,
+                         PITCH_DETECTOR_DEFAULT_THRESHOLD,
+                         PITCH_DETECTOR_DEFAULT_LEVEL, false,
+                         AUDIO_SAMPLE_RATE);
+}
+static void pitch_detector_bench_process(float *in, float *out_l,
+                                         float *out_r, uint32_t n) {
+    pitch_detector_read(&bench_pitch_detector, in, n, out_l);
+}
+
+/******************************************************************************
+ * Audio effects
+ *****************************************************************************/
+
+static AUTOWAH bench_autowah;
+static void autowah_bench_setup(void) {
+    autowah_setup(&bench_autowah, 0.5, 0.5, AUDIO_SAMPLE_RATE);
+}
+static void autowah_bench_process(float *in, float *out_l, float *out_r,
+                                  uint32_t n) {
+    autowah_read(&bench_autowah, in, out_l, n);
+}
+
+// 32 sustained notes, so every voice is rendered each block
+static POLY_SYNTH bench_poly_synth;
+static void poly_synth_bench_setup(void) {
+    poly_synth_setup(&bench_poly_synth, POLY_SYNTH_MAX_VOICES, OSC_RAMP,
+                     0.005, 0.3, 0.6, 10.0, 0.05, AUDIO_SAMPLE_RATE);
+    for (uint32_t v = 0; v < POLY_SYNTH_MAX_VOICES; v++) {
+        poly_synth_note_on(&bench_poly_synth, 36 + 2 * v, 100);
+    }
+}
+static void poly_synth_bench_process(float *in, float *out_l, float *out_r,
+                                     uint32_t n) {
+    poly_synth_read(&bench_poly_synth, out_l, n);
+}
+
+static GUITAR_SYNTH bench_guitar_synth;
+static void guitar_synth_bench_setup(void) {
+    guitar_synth_setup(&bench_guitar_synth, 0.5, 0.5, AUDIO_SAMPLE_RATE);
+}
+static void guitar_synth_bench_process(float *in, float *out_l,
+                                       float *out_r, uint32_t n) {
+    guitar_synth_read(&bench_guitar_synth, in, out_l, n);
+}
+
+static MULTIBAND_COMPRESSOR bench_multiband_comp;
+static void multiband_comp_bench_setup(void) {
+    multiband_comp_setup(&bench_multiband_comp, 200.0, -40.0,
+                         AUDIO_SAMPLE_RATE);
+}
+static void multiband_comp_bench_process(float *in, float *out_l,
+                                         float *out_r, uint32_t n) {
+    multiband_comp_read(&bench_multiband_comp, in, out_l, n);
+}
+
+static RING_MODULATOR bench_ring_mod;
+static void ring_modulator_bench_setup(void) {
+    ring_modulator_setup(&bench_ring_mod, 200.0, 0.5, AUDIO_SAMPLE_RATE);
+}
+static void ring_modulator_bench_process(float *in, float *out_l,
+                                         float *out_r, uint32_t n) {
+    ring_modulator_read(&bench_ring_mod, in, out_l, n);
+}
+
+static STEREO_FLANGER bench_flanger;
+static void flanger_bench_setup(void) {
+    flanger_setup(&bench_flanger, 0.5, 0.5, 0.5, AUDIO_SAMPLE_RATE);
+}
+static void flanger_bench_process(float *in, float *out_l, float *out_r,
+                                  uint32_t n) {
+    flanger_read(&bench_flanger, in, out_l, out_r, n);
+}
+
+static STEREO_REVERB bench_reverb;
+static void reverb_bench_setup(void) {
+    reverb_setup(&bench_reverb, 0.3, 1.0, 0.92, 0.2);
+}
+static void reverb_bench_process(float *in, float *out_l, float *out_r,
+                                 uint32_t n) {
+    reverb_read(&bench_reverb, in, out_l, out_r, n);
+}
+
+static FDN_REVERB bench_fdn_reverb;
+static float fdn_reverb_memory[FDN_REVERB_MEMORY_SIZE_16_LINES];
+static void fdn_reverb_8_bench_setup(void) {
+    fdn_reverb_setup(&bench_fdn_reverb, 8, FDN_REVERB_MIX_HADAMARD,
+                     fdn_reverb_memory, FDN_REVERB_MEMORY_SIZE_8_LINES, 1.5,
+                     0.2, 0.3, 1.0, AUDIO_SAMPLE_RATE);
+}
+static void fdn_reverb_16_bench_setup(void) {
+    fdn_reverb_setup(&bench_fdn_reverb, 16, FDN_REVERB_MIX_HADAMARD,
+                     fdn_reverb_memory, FDN_REVERB_MEMORY_SIZE_16_LINES, 1.5,
+                     0.2, 0.3, 1.0, AUDIO_SAMPLE_RATE);
+}
+static void fdn_reverb_16_householder_bench_setup(void) {
+    fdn_reverb_setup(&bench_fdn_reverb, 16, FDN_REVERB_MIX_HOUSEHOLDER,
+                     fdn_reverb_memory, FDN_REVERB_MEMORY_SIZE_16_LINES, 1.5,
+                     0.2, 0.3, 1.0, AUDIO_SAMPLE_RATE);
+}
+static void fdn_reverb_bench_process(float *in, float *out_l, float *out_r,
+                                     uint32_t n) {
+    fdn_reverb_read(&bench_fdn_reverb, in, out_l, out_r, n);
+}
+
+static TREMELO bench_tremelo;
+static void tremelo_bench_setup(void) {
+    tremelo_setup(&bench_tremelo, 0.5, 4.0, AUDIO_SAMPLE_RATE);
+}
+static void tremelo_bench_process(float *in, float *out_l, float *out_r,
+                                  uint32_t n) {
+    tremelo_read(&bench_tremelo, in, out_l, n);
+}
+
+static TUBE_DISTORTION bench_tube_distortion;
+static void tube_distortion_bench_setup(void) {
+    tube_distortion_setup(&bench_tube_distortion, 32.0, 0.5, 0.5,
+                          AUDIO_SAMPLE_RATE);
+}
+static void tube_distortion_bench_process(float *in, float *out_l,
+                                          float *out_r, uint32_t n) {
+    tube_distortion_read(&bench_tube_distortion, in, out_l, n);
+}
+
+// Round trip through a DMA buffer, as the DMA handler converts each block
+static AUDIOFLOW_FORMAT bench_audioflow_format;
+static int bench_audioflow_dma_buffer[128];
+static void audioflow_32bit_bench_setup(void) {
+    bench_audioflow_format = AUDIOFLOW_FORMAT_32BIT;
+}
+static void audioflow_24bit_packed_bench_setup(void) {
+    bench_audioflow_format = AUDIOFLOW_FORMAT_24BIT_PACKED;
+}
+static void audioflow_16bit_packed_bench_setup(void) {
+    bench_audioflow_format = AUDIOFLOW_FORMAT_16BIT_PACKED;
+}
+static void audioflow_bench_process(float *in, float *out_l, float *out_r,
+                                    uint32_t n) {
+    AUDIOFLOW_CONVERSION conversion = { bench_audioflow_format,
+                                        AUDIOFLOW_LAYOUT_CHANNEL_BLOCKS,
+                                        1, n, 0x1, NULL };
+    audioflow_float_to_fixed_channels(&conversion, in,
+                                      bench_audioflow_dma_buffer);
+    audioflow_fixed_to_float_channels(&conversion, bench_audioflow_dma_buffer,
+                                      out_l);
+}
+
+static const BENCHMARK_ENTRY benchmarks[] = {
+    { "allpass_read",               allpass_bench_setup,                allpass_bench_process },
+    { "amplitude_modulation_read",  amplitude_modulation_bench_setup,   amplitude_modulation_bench_process },
+    { "filter_read",                biquad_bench_setup,                 biquad_bench_process },
+    { "biquad_cascade_read_10",     biquad_cascade_bench_setup,         biquad_cascade_bench_process },
+    { "volume_control_read",        volume_control_bench_setup,         volume_control_bench_process },
+    { "clipper_read",               clipper_bench_setup,                clipper_bench_process },
+    { "clipper_read_upsampled",     clipper_upsampled_bench_setup,      clipper_bench_process },
+    { "compressor_read",            compressor_bench_setup,             compressor_bench_process },
+    { "linked_compressor_read_2ch", linked_compressor_bench_setup,      linked_compressor_bench_process },
+    { "convolver_read_3000",        convolver_cabinet_bench_setup,      convolver_bench_process },
+    { "convolver_read_2s_tail",     convolver_2s_bench_setup,           convolver_bench_process },
+    { "delay_read",                 delay_bench_setup,                  delay_bench_process },
+    { "delay_read_stereo",          delay_stereo_bench_setup,           delay_stereo_bench_process },
+    { "multitap_delay_read",        multitap_delay_bench_setup,         multitap_delay_bench_process },
+    { "multitap_delay_read_stereo", multitap_delay_stereo_bench_setup,  multitap_delay_stereo_bench_process },
+    { "synth_read",                 synth_bench_setup,                  synth_bench_process },
+    { "poly_synth_read_32",         poly_synth_bench_setup,             poly_synth_bench_process },
+    { "variable_delay_read",        variable_delay_bench_setup,         variable_delay_bench_process },
+    { "fractional_delay_read_linear", fractional_delay_linear_bench_setup, fractional_delay_bench_process },
+    { "fractional_delay_read_lagrange3", fractional_delay_lagrange_bench_setup, fractional_delay_bench_process },
+    { "fractional_delay_read_allpass", fractional_delay_allpass_bench_setup, fractional_delay_bench_process },
+    { "zero_crossing_read",         zero_crossing_bench_setup,          zero_crossing_bench_process },
+    { "pitch_detector_read",        pitch_detector_bench_setup,         pitch_detector_bench_process },
+    { "autowah_read",               autowah_bench_setup,                autowah_bench_process },
+    { "guitar_synth_read",          guitar_synth_bench_setup,           guitar_synth_bench_process },
+    { "multiband_comp_read",        multiband_comp_bench_setup,         multiband_comp_bench_process },
+    { "ring_modulator_read",        ring_modulator_bench_setup,         ring_modulator_bench_process },
+    { "flanger_read",               flanger_bench_setup,                flanger_bench_process },
+    { "reverb_read",                reverb_bench_setup,                 reverb_bench_process },
+    { "fdn_reverb_read_8",          fdn_reverb_8_bench_setup,           fdn_reverb_bench_process },
+    { "fdn_reverb_read_16",         fdn_reverb_16_bench_setup,          fdn_reverb_bench_process },
+    { "fdn_reverb_read_16_hh",      fdn_reverb_16_householder_bench_setup, fdn_reverb_bench_process },
+    { "tremelo_read",               tremelo_bench_setup,                tremelo_bench_process },
+    { "tube_distortion_read",       tube_distortion_bench_setup,        tube_distortion_bench_process },
+    { "audioflow_convert_32bit",    audioflow_32bit_bench_setup,        audioflow_bench_process },
+    { "audioflow_convert_24bit_packed", audioflow_24bit_packed_bench_setup, audioflow_bench_process },
+    { "audioflow_convert_16bit_packed", audioflow_16bit_packed_bench_setup, audioflow_bench_process },
+};
+
+/**
+ * @brief Generates the synthetic test signal
+ *
+ * A plucked-string like tone (110 Hz with a few harmonics) with an exponential
+ * decay, retriggered every half second, plus low-level noise so elements that
+ * track pitch / level see realistic input.
+ */
+static void generate_test_signal(void) {
+
+    srand(1);
+
+    for (int i = 0; i < BENCH_SIGNAL_LEN; i++) {
+        float t = (float)(i % (AUDIO_SAMPLE_RATE / 2)) / AUDIO_SAMPLE_RATE;
+        float phase = PI2 * 110.0 * (float)i / AUDIO_SAMPLE_RATE;
+        float tone = 0.6 * sinf(phase) + 0.25 * sinf(2.0 * phase)
+                + 0.1 * sinf(3.0 * phase);
+        float noise = ((float)rand() / RAND_MAX - 0.5) * 0.002;
+        test_signal[i] = tone * expf(-4.0 * t) + noise;
+    }
+}
+
+/**
+ * @brief Wall clock in nanoseconds
+ */
+static uint64_t bench_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Runs one entry at one block size
+ *
+ * @param b benchmark entry
+ * @param block_size audio block size
+ * @param total_blocks number of blocks per timed run
+ * @param repeats number of timed runs (fastest is kept)
+ * @param ns_per_block result: wall clock time per block
+ * @param cycles_per_block result: host cycles per block
+ */
+static void run_benchmark(const BENCHMARK_ENTRY *b, uint32_t block_size,
+                          uint32_t total_blocks, uint32_t repeats,
+                          double *ns_per_block, double *cycles_per_block) {
+
+    static float out_l[MAX_AUDIO_BLOCK_SIZE];
+    static float out_r[MAX_AUDIO_BLOCK_SIZE];
+    uint32_t blocks_per_signal = BENCH_SIGNAL_LEN / block_size;
+
+    *ns_per_block = 1e30;
+    *cycles_per_block = 1e30;
+
+    for (uint32_t r = 0; r < repeats; r++) {
+
+        memset(delay_line, 0, sizeof(delay_line));
+        memset(allpass_line, 0, sizeof(allpass_line));
+        b->setup();
+
+        for (uint32_t i = 0; i < BENCH_WARMUP_BLOCKS; i++) {
+            b->process(&test_signal[(i % blocks_per_signal) * block_size],
+                       out_l, out_r, block_size);
+        }
+
+        uint64_t ns_start = bench_time_ns();
+        uint64_t cycles_start = __builtin_emuclk();
+
+        for (uint32_t i = 0; i < total_blocks; i++) {
+            b->process(&test_signal[(i % blocks_per_signal) * block_size],
+                       out_l, out_r, block_size);
+        }
+
+        uint64_t cycles = __builtin_emuclk() - cycles_start;
+        uint64_t ns = bench_time_ns() - ns_start;
+
+        if ((double)ns / total_blocks < *ns_per_block) {
+            *ns_per_block = (double)ns / total_blocks;
+        }
+        if ((double)cycles / total_blocks < *cycles_per_block) {
+            *cycles_per_block = (double)cycles / total_blocks;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+
+    double seconds = 2.0;
+    uint32_t repeats = 3;
+    double sharc_scale = 1.0;
+    const char *filter = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--repeats") && i + 1 < argc) {
+            repeats = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--sharc-scale") && i + 1 < argc) {
+            sharc_scale = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--filter") && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--seconds S] [--repeats N] "
+                    "[--sharc-scale X] [--filter SUBSTRING]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (repeats < 1) repeats = 1;
+
+    generate_test_signal();
+
+    printf("name,block_size,ns_per_sample,cycles_per_block,sharc_mhz_at_48k\n");
+
+    for (size_t e = 0; e < sizeof(benchmarks) / sizeof(benchmarks[0]); e++) {
+
+        const BENCHMARK_ENTRY *b = &benchmarks[e];
+        if (filter != NULL && strstr(b->name, filter) == NULL) {
+            continue;
+        }
+
+        for (size_t s = 0; s < sizeof(block_sizes) / sizeof(block_sizes[0]);
+                s++) {
+
+            uint32_t block_size = block_sizes[s];
+            uint32_t total_blocks = (uint32_t)(seconds * AUDIO_SAMPLE_RATE
+                    / block_size);
+            if (total_blocks < 1) total_blocks = 1;
+
+            double ns_per_block, cycles_per_block;
+            run_benchmark(b, block_size, total_blocks, repeats, &ns_per_block,
+                          &cycles_per_block);
+
+            double sharc_mhz = cycles_per_block * sharc_scale
+                    * ((double)AUDIO_SAMPLE_RATE / block_size) / 1e6;
+
+            printf("%s,%u,%.3f,%.1f,%.3f\n", b->name, block_size,
+                   ns_per_block / block_size, cycles_per_block, sharc_mhz);
+            fflush(stdout);
+        }
+    }
+
+    return 0;
+}
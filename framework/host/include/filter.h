@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Host stand-in for the CCES <filter.h> run-time library header.  Only the
+ * routines used by the audio processing library are provided.  See
+ * sharc_host_compat.c for documentation.
+ */
+
+#ifndef _SHARC_HOST_FILTER_H
+#define _SHARC_HOST_FILTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+float *iir(const float input[],
+           float output[],
+           const float coeffs[],
+           float state[],
+           int samples,
+           int sections);
+
+float *fir(const float input[],
+           float output[],
+           const float coeffs[],
+           float state[],
+           int samples,
+           int taps);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // _SHARC_HOST_FILTER_H
@@ -0,0 +1,12 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Host stand-in for the CCES <filters.h> run-time library header.
+ */
+
+#ifndef _SHARC_HOST_FILTERS_H
+#define _SHARC_HOST_FILTERS_H
+
+#include <filter.h>
+
+#endif // _SHARC_HOST_FILTERS_H
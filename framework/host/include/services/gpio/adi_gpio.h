@@ -0,0 +1,11 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Empty host stand-in for the CCES <services/gpio/adi_gpio.h> header.  The driver headers that
+ * pull it in only need it for declarations the host build never uses.
+ */
+
+#ifndef _SHARC_HOST_SERVICES_GPIO_ADI_GPIO_H
+#define _SHARC_HOST_SERVICES_GPIO_ADI_GPIO_H
+
+#endif // _SHARC_HOST_SERVICES_GPIO_ADI_GPIO_H
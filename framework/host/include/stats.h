@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Host stand-in for the CCES <stats.h> run-time library header.  See
+ * sharc_host_compat.c for documentation.
+ */
+
+#ifndef _SHARC_HOST_STATS_H
+#define _SHARC_HOST_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+float meanf(const float samples[], int sample_length);
+
+float varf(const float samples[], int sample_length);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // _SHARC_HOST_STATS_H
@@ -0,0 +1,11 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Empty host stand-in for the CCES <sys/platform.h> header.  The driver headers that
+ * pull it in only need it for declarations the host build never uses.
+ */
+
+#ifndef _SHARC_HOST_SYS_PLATFORM_H
+#define _SHARC_HOST_SYS_PLATFORM_H
+
+#endif // _SHARC_HOST_SYS_PLATFORM_H
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Host test of the inter-core message queues (bm_message_queue.c).
+ *
+ * The queue is only safe between cores if the message is written before the
+ * write index is advanced and read before the read index is advanced.  Here a
+ * producer thread and a consumer thread stand in for the two cores and pass a
+ * numbered stream of messages through one queue; the consumer checks that
+ * every message arrives once, in order and intact.  The full-queue path
+ * (messages_dropped) and message_queue_discard() are checked single threaded
+ * first.  Both threads yield while they wait so the test also runs quickly on
+ * a single CPU.
+ *
+ * Returns 0 if all checks pass (run by ctest).
+ *
+ * Usage: message_queue_host_test [--messages N]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "drivers/bm_message_queue_driver/bm_message_queue.h"
+
+#define TEST_DEFAULT_MESSAGES   (200000)
+
+static BM_MESSAGE_QUEUE test_queue;
+
+static uint32_t test_messages = TEST_DEFAULT_MESSAGES;
+static uint32_t producer_retries;
+static uint32_t consumer_errors;
+
+// Each message carries its sequence number in every field it has
+static void test_fill_message(BM_MESSAGE *message, uint32_t sequence) {
+
+    message->type = MESSAGE_TYPE_PARAMETER + (sequence % 5);
+    message->id = sequence;
+    message->data.word[0] = sequence;
+    message->data.word[1] = ~sequence;
+}
+
+static int test_check_message(const BM_MESSAGE *message, uint32_t sequence) {
+
+    return message->type == MESSAGE_TYPE_PARAMETER + (sequence % 5)
+           && message->id == sequence
+           && message->data.word[0] == sequence
+           && message->data.word[1] == ~sequence;
+}
+
+// Fills the queue, checks that a further message is dropped and counted
+static int test_full_queue(void) {
+
+    BM_MESSAGE message;
+    uint32_t i;
+    int errors = 0;
+
+    message_queue_initialize(&test_queue);
+
+    for (i = 0; i < MESSAGE_QUEUE_LENGTH; i++) {
+        test_fill_message(&message, i);
+        if (!message_queue_send(&test_queue, &message)) {
+            printf("full queue: message %u not sent\n", i);
+            errors++;
+        }
+    }
+
+    test_fill_message(&message, MESSAGE_QUEUE_LENGTH);
+    if (message_queue_send(&test_queue, &message)) {
+        printf("full queue: message sent to a full queue\n");
+        errors++;
+    }
+    if (test_queue.messages_dropped != 1) {
+        printf("full queue: %u messages counted as dropped, expected 1\n",
+               test_queue.messages_dropped);
+        errors++;
+    }
+
+    // Freeing one slot lets the next message through
+    if (!message_queue_receive(&test_queue, &message)
+        || !test_check_message(&message, 0)) {
+        printf("full queue: first message not received intact\n");
+        errors++;
+    }
+    test_fill_message(&message, MESSAGE_QUEUE_LENGTH);
+    if (!message_queue_send(&test_queue, &message)) {
+        printf("full queue: message not sent after a slot was freed\n");
+        errors++;
+    }
+
+    // Everything else comes out in order, then the queue is empty
+    for (i = 1; i <= MESSAGE_QUEUE_LENGTH; i++) {
+        if (!message_queue_receive(&test_queue, &message)
+            || !test_check_message(&message, i)) {
+            printf("full queue: message %u not received intact\n", i);
+            errors++;
+        }
+    }
+    if (message_queue_receive(&test_queue, &message)) {
+        printf("full queue: message received from an empty queue\n");
+        errors++;
+    }
+
+    // Discarding frees every slot without counting drops
+    for (i = 0; i < MESSAGE_QUEUE_LENGTH; i++) {
+        test_fill_message(&message, i);
+        message_queue_send(&test_queue, &message);
+    }
+    if (message_queue_discard(&test_queue) != MESSAGE_QUEUE_LENGTH
+        || message_queue_discard(&test_queue) != 0
+        || message_queue_receive(&test_queue, &message)
+        || test_queue.messages_dropped != 1) {
+        printf("full queue: discard didn't empty the queue\n");
+        errors++;
+    }
+    test_fill_message(&message, 0);
+    if (!message_queue_send(&test_queue, &message)) {
+        printf("full queue: message not sent after a discard\n");
+        errors++;
+    }
+
+    return errors;
+}
+
+static void *test_producer(void *arg) {
+
+    BM_MESSAGE message;
+    uint32_t sequence;
+
+    (void) arg;
+
+    for (sequence = 0; sequence < test_messages; sequence++) {
+        test_fill_message(&message, sequence);
+        while (!message_queue_send(&test_queue, &message)) {
+            producer_retries++;
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+static void *test_consumer(void *arg) {
+
+    BM_MESSAGE message;
+    uint32_t sequence = 0;
+
+    (void) arg;
+
+    while (sequence < test_messages) {
+        if (!message_queue_receive(&test_queue, &message)) {
+            sched_yield();
+            continue;
+        }
+        if (!test_check_message(&message, sequence)) {
+            if (consumer_errors < 10) {
+                printf("threads: expected message %u, got %u (id %u)\n",
+                       sequence, message.data.word[0], message.id);
+            }
+            consumer_errors++;
+            sequence = message.data.word[0];
+        }
+        sequence++;
+    }
+
+    return NULL;
+}
+
+// Passes test_messages messages from a producer thread to a consumer thread
+static int test_threads(void) {
+
+    pthread_t producer, consumer;
+    int errors = 0;
+
+    message_queue_initialize(&test_queue);
+    producer_retries = 0;
+    consumer_errors = 0;
+
+    if (pthread_create(&consumer, NULL, test_consumer, NULL) != 0
+        || pthread_create(&producer, NULL, test_producer, NULL) != 0) {
+        printf("threads: can't create threads\n");
+        return 1;
+    }
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+
+    errors += consumer_errors;
+
+    // Every full queue the producer ran into was counted as a drop
+    if (test_queue.messages_dropped != producer_retries) {
+        printf("threads: %u messages counted as dropped, producer saw %u\n",
+               test_queue.messages_dropped, producer_retries);
+        errors++;
+    }
+    if (test_queue.write_index != test_messages
+        || test_queue.read_index != test_messages) {
+        printf("threads: indices %u / %u, expected %u\n",
+               test_queue.write_index, test_queue.read_index, test_messages);
+        errors++;
+    }
+
+    printf("threads: %u messages, %u full queue retries, %u errors\n",
+           test_messages, producer_retries, consumer_errors);
+
+    return errors;
+}
+
+int main(int argc, char **argv) {
+
+    int errors = 0;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--messages") && i + 1 < argc) {
+            test_messages = (uint32_t) strtoul(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "Usage: %s [--messages N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    errors += test_full_queue();
+    errors += test_threads();
+
+    printf("%s\n", errors ? "FAILED" : "PASSED");
+
+    return errors ? 1 : 0;
+}
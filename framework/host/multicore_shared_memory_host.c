@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Host replacement for common/multicore_shared_memory.c.  On target the
+ * shared structure is manually placed at a fixed L2 address; on the host it
+ * is simply a zero-initialized global so code that reads pots, presets and
+ * status fields through multicore_data can run off-target.
+ */
+
+#include "common/multicore_shared_memory.h"
+
+static MULTICORE_DATA multicore_data_host;
+
+volatile MULTICORE_DATA *multicore_data = &multicore_data_host;
+
+bool check_shared_memory_structure_sizes() {
+    return true;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Portable reference implementations of the CCES run-time library routines
+ * used by the audio processing library (iir, fir, meanf, varf).  These follow
+ * the calling conventions and coefficient / state layouts of the SHARC
+ * library so the audio elements behave the same on the host as on target.
+ * They are written for clarity rather than speed.
+ */
+
+#include <filter.h>
+#include <stats.h>
+
+/**
+ * @brief Cascaded biquad IIR filter (direct form II)
+ *
+ * Each section uses four coefficients in the order a2, a1, b2, b1.  The 'a'
+ * coefficients are already negated and every section is normalized so that
+ * b0 = 1; the caller applies any overall gain.  The state array holds two
+ * delay elements per section (2 * sections + 1 floats are reserved on target).
+ *
+ * @param input input samples
+ * @param output output samples (may be the same buffer as input)
+ * @param coeffs 4 * sections coefficients
+ * @param state filter state, zeroed by the caller before first use
+ * @param samples number of samples to process
+ * @param sections number of biquad sections
+ * @return pointer to the output buffer
+ */
+float *iir(const float input[],
+           float output[],
+           const float coeffs[],
+           float state[],
+           int samples,
+           int sections) {
+
+    for (int n = 0; n < samples; n++) {
+        float x = input[n];
+        for (int s = 0; s < sections; s++) {
+            const float *k = &coeffs[4 * s];
+            float *w = &state[2 * s];
+            float w0 = x + k[1] * w[0] + k[0] * w[1];
+            x = w0 + k[3] * w[0] + k[2] * w[1];
+            w[1] = w[0];
+            w[0] = w0;
+        }
+        output[n] = x;
+    }
+
+    return output;
+}
+
+/**
+ * @brief FIR filter
+ *
+ * The state array is taps + 1 floats long: state[0] holds the write index
+ * into the circular delay line stored in state[1..taps].
+ *
+ * @param input input samples
+ * @param output output samples (may be the same buffer as input)
+ * @param coeffs filter coefficients h[0]..h[taps-1]
+ * @param state filter state, zeroed by the caller before first use
+ * @param samples number of samples to process
+ * @param taps number of filter taps
+ * @return pointer to the output buffer
+ */
+float *fir(const float input[],
+           float output[],
+           const float coeffs[],
+           float state[],
+           int samples,
+           int taps) {
+
+    float *delay = &state[1];
+    int indx = (int)state[0];
+
+    for (int n = 0; n < samples; n++) {
+        delay[indx] = input[n];
+
+        float acc = 0.0;
+        int j = indx;
+        for (int k = 0; k < taps; k++) {
+            acc += coeffs[k] * delay[j];
+            if (--j < 0) j = taps - 1;
+        }
+        output[n] = acc;
+
+        if (++indx >= taps) indx = 0;
+    }
+
+    state[0] = (float)indx;
+
+    return output;
+}
+
+/**
+ * @brief Arithmetic mean of a vector
+ */
+float meanf(const float samples[], int sample_length) {
+
+    float sum = 0.0;
+    for (int i = 0; i < sample_length; i++) {
+        sum += samples[i];
+    }
+
+    return sum / sample_length;
+}
+
+/**
+ * @brief Sample variance of a vector
+ */
+float varf(const float samples[], int sample_length) {
+
+    if (sample_length < 2) {
+        return 0.0;
+    }
+
+    float mean = meanf(samples, sample_length);
+    float sum = 0.0;
+    for (int i = 0; i < sample_length; i++) {
+        float d = samples[i] - mean;
+        sum += d * d;
+    }
+
+    return sum / (sample_length - 1);
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Host (x86 / Linux) compatibility layer for the audio processing library.
+ *
+ * The audio elements and effects in framework/audio_processing are written
+ * for the SHARC compiler and use a handful of CCES language extensions and
+ * run-time library routines.  This header is force-included (-include) into
+ * every translation unit of the host build (see the top-level CMakeLists.txt)
+ * so that the same sources compile unmodified with GCC / Clang.  It is never
+ * part of a CCES project.
+ *
+ * Reference implementations of iir(), fir(), varf() and meanf() live in
+ * sharc_host_compat.c and are declared by the stand-in <filter.h> and
+ * <stats.h> headers in host/include.
+ */
+
+#ifndef _SHARC_HOST_COMPAT_H
+#define _SHARC_HOST_COMPAT_H
+
+#include <math.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+// Memory space qualifier (pm / dm) and section placement have no host equivalent
+#define pm
+#define section(x)
+
+// Lets code that must differ between the SHARC and host builds test for the latter
+#define SHARC_HOST_BUILD    (1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Free running cycle counter (stands in for __builtin_emuclk)
+ *
+ * Uses the time stamp counter on x86 and a nanosecond clock elsewhere.
+ *
+ * @return current cycle count
+ */
+static inline uint64_t sharc_host_emuclk(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Clips x to the range [-|y|, |y|] (stands in for __builtin_fclipf)
+ */
+static inline float sharc_host_fclipf(float x, float y) {
+    float lim = fabsf(y);
+    if (x > lim) return lim;
+    if (x < -lim) return -lim;
+    return x;
+}
+
+/**
+ * @brief Float to saturated fixed point, scaled by 2^scale (__builtin_conv_fix_by)
+ */
+static inline int32_t sharc_host_conv_fix_by(float x, int scale) {
+    double v = ldexp((double)x, scale);
+    if (v >= 2147483647.0) return INT32_MAX;
+    if (v <= -2147483648.0) return INT32_MIN;
+    return (int32_t)lrint(v);
+}
+
+/**
+ * @brief Fixed point to float, scaled by 2^scale (__builtin_conv_float_by)
+ */
+static inline float sharc_host_conv_float_by(int32_t x, int scale) {
+    return ldexpf((float)x, scale);
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#define __builtin_emuclk()                  sharc_host_emuclk()
+#define __builtin_fclipf(x, y)              sharc_host_fclipf((x), (y))
+#define __builtin_conv_fix_by(x, scale)     sharc_host_conv_fix_by((x), (scale))
+#define __builtin_conv_float_by(x, scale)   sharc_host_conv_float_by((x), (scale))
+
+#endif // _SHARC_HOST_COMPAT_H
@@ -36,6 +36,9 @@
 // Simple event logging / error handling functionality
 #include "drivers/bm_event_logging_driver/bm_event_logging.h"
 
+// Per-scope cycle profiles published by the SHARC cores
+#include "drivers/bm_cycle_profiler_driver/bm_cycle_profiler.h"
+
 // Simple system functionality (clocks, delays, etc.)
 #include "drivers/bm_sysctrl_driver/bm_system_control.h"
 
@@ -93,6 +96,18 @@ void ms_tick_event_callback() {
 
     // Check to see if there are any event messages from the SHARC cores
     event_logging_poll_sharc_cores_for_new_message();
+
+    // If a SHARC core dropped a block, log the timing of the blocks before it
+    cycle_profiler_log_trace(&multicore_data->sharc_core1_cycle_trace, "SHARC core 1");
+    cycle_profiler_log_trace(&multicore_data->sharc_core2_cycle_trace, "SHARC core 2");
+
+    // Every 10 seconds, log where the SHARC cores spend their cycles
+    static uint32_t profile_counter = 0;
+    if (++profile_counter >= 10000) {
+        profile_counter = 0;
+        cycle_profiler_log_table(&multicore_data->sharc_core1_cycle_profile, "SHARC core 1");
+        cycle_profiler_log_table(&multicore_data->sharc_core2_cycle_profile, "SHARC core 2");
+    }
 }
 
 /**
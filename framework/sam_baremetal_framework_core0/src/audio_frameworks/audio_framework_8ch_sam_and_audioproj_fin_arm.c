@@ -50,6 +50,9 @@
 // Simple event logging / error handling functionality
 #include "drivers/bm_event_logging_driver/bm_event_logging.h"
 
+// Per-scope cycle profiles published by the SHARC cores
+#include "drivers/bm_cycle_profiler_driver/bm_cycle_profiler.h"
+
 #include "../callback_midi_message.h"
 #include "../callback_pushbuttons.h"
 
@@ -182,19 +185,33 @@ void gpio_initialize(void) {
 void ms_tick_event_callback(void) {
 
     #if (SAM_AUDIOPROJ_FIN_BOARD_PRESENT)
-		// Copy the latest read vales from the HADC into our shared memory struct
+		// Publish the latest read vales from the HADC in our shared memory struct
 		// so SHARC cores can access too
-		multicore_data->audioproj_fin_pot_hadc0 = hadc_read_float(SAM_AUDIOPROJ_FIN_POT_HADC0);
-		multicore_data->audioproj_fin_pot_hadc1 = hadc_read_float(SAM_AUDIOPROJ_FIN_POT_HADC1);
-		multicore_data->audioproj_fin_pot_hadc2 = hadc_read_float(SAM_AUDIOPROJ_FIN_POT_HADC2);
-		multicore_data->audioproj_fin_aux_hadc3 = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC3);
-		multicore_data->audioproj_fin_aux_hadc4 = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC4);
-		multicore_data->audioproj_fin_aux_hadc5 = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC5);
-		multicore_data->audioproj_fin_aux_hadc6 = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC6);
+		float hadc_values[AUDIOPROJ_FIN_HADC_PARAMETERS];
+		hadc_values[AUDIOPROJ_FIN_POT_HADC0] = hadc_read_float(SAM_AUDIOPROJ_FIN_POT_HADC0);
+		hadc_values[AUDIOPROJ_FIN_POT_HADC1] = hadc_read_float(SAM_AUDIOPROJ_FIN_POT_HADC1);
+		hadc_values[AUDIOPROJ_FIN_POT_HADC2] = hadc_read_float(SAM_AUDIOPROJ_FIN_POT_HADC2);
+		hadc_values[AUDIOPROJ_FIN_AUX_HADC3] = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC3);
+		hadc_values[AUDIOPROJ_FIN_AUX_HADC4] = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC4);
+		hadc_values[AUDIOPROJ_FIN_AUX_HADC5] = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC5);
+		hadc_values[AUDIOPROJ_FIN_AUX_HADC6] = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC6);
+		parameter_snapshot_publish(&multicore_data->audioproj_fin_hadc, hadc_values);
     #endif
 
 	// Check to see if there are any event messages from the SHARC cores
     event_logging_poll_sharc_cores_for_new_message();
+
+    // If a SHARC core dropped a block, log the timing of the blocks before it
+    cycle_profiler_log_trace(&multicore_data->sharc_core1_cycle_trace, "SHARC core 1");
+    cycle_profiler_log_trace(&multicore_data->sharc_core2_cycle_trace, "SHARC core 2");
+
+    // Every 10 seconds, log where the SHARC cores spend their cycles
+    static uint32_t profile_counter = 0;
+    if (++profile_counter >= 10000) {
+        profile_counter = 0;
+        cycle_profiler_log_table(&multicore_data->sharc_core1_cycle_profile, "SHARC core 1");
+        cycle_profiler_log_table(&multicore_data->sharc_core2_cycle_profile, "SHARC core 2");
+    }
 }
 
 /**
@@ -19,6 +19,18 @@
 
 #include "callback_pushbuttons.h"
 
+/**
+ * @brief Sends a PB / SW event to both SHARC cores
+ *
+ * @param sw switch that was pressed
+ * @param state state of the switch
+ */
+static void pushbutton_send_to_sharcs(MESSAGE_SWITCH sw, uint32_t state) {
+
+    message_queue_send_switch(&multicore_data->arm_to_sharc_core1_messages, sw, state);
+    message_queue_send_switch(&multicore_data->arm_to_sharc_core2_messages, sw, state);
+}
+
 /**
  * @brief Call back for push button (PB1) on SHARC Audio Module board
  *
@@ -28,8 +40,8 @@ void pushbutton_callback_sam_pb1(void  *data_object) {
 
     // Add custom code here
 
-    // Update our multicore structure to let the SHARCs know that a PB has been pressed
-    multicore_data->sharc_sam_pb_1_pressed = true;
+    // Let the SHARCs know that a PB has been pressed
+    pushbutton_send_to_sharcs(MESSAGE_SWITCH_SAM_PB_1, true);
 }
 
 /**
@@ -41,8 +53,8 @@ void pushbutton_callback_sam_pb2(void  *data_object) {
 
     // Add custom code here
 
-    // Update our multicore structure to let the SHARCs know that a PB has been pressed
-    multicore_data->sharc_sam_pb_2_pressed = true;
+    // Let the SHARCs know that a PB has been pressed
+    pushbutton_send_to_sharcs(MESSAGE_SWITCH_SAM_PB_2, true);
 }
 
 #if    (SAM_AUDIOPROJ_FIN_BOARD_PRESENT)
@@ -59,9 +71,9 @@ void pushbutton_callback_external_1(void  *data_object) {
 	// Remove this code if SW will be used to trigger an event rather than toggle a state
     multicore_data->audioproj_fin_sw_1_state = !multicore_data->audioproj_fin_sw_1_state;
 
-    // Update our multicore structure to let the SHARCs know that a SW has been pressed
-    multicore_data->audioproj_fin_sw_1_core1_pressed = true;
-    multicore_data->audioproj_fin_sw_1_core2_pressed = true;
+    // Let the SHARCs know that a SW has been pressed
+    pushbutton_send_to_sharcs(MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_1,
+                              multicore_data->audioproj_fin_sw_1_state);
 
     // Decrement our reverb effect
     multicore_data->reverb_preset--;
@@ -83,9 +95,9 @@ void pushbutton_callback_external_2(void  *data_object) {
 	// Remove this code if SW will be used to trigger an event rather than toggle a state
     multicore_data->audioproj_fin_sw_2_state = !multicore_data->audioproj_fin_sw_2_state;
 
-    // Update our multicore structure to let the SHARCs know that a PB has been pressed
-    multicore_data->audioproj_fin_sw_2_core1_pressed = true;
-    multicore_data->audioproj_fin_sw_2_core2_pressed = true;
+    // Let the SHARCs know that a PB has been pressed
+    pushbutton_send_to_sharcs(MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_2,
+                              multicore_data->audioproj_fin_sw_2_state);
 
     // Increment our reverb effect
     multicore_data->reverb_preset++;
@@ -107,9 +119,9 @@ void pushbutton_callback_external_3(void  *data_object) {
 	// Remove this code if SW will be used to trigger an event rather than toggle a state
     multicore_data->audioproj_fin_sw_3_state = !multicore_data->audioproj_fin_sw_3_state;
 
-    // Update our multicore structure to let the SHARCs know that a PB has been pressed
-    multicore_data->audioproj_fin_sw_3_core1_pressed = true;
-    multicore_data->audioproj_fin_sw_3_core2_pressed = true;
+    // Let the SHARCs know that a PB has been pressed
+    pushbutton_send_to_sharcs(MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_3,
+                              multicore_data->audioproj_fin_sw_3_state);
 
     // Decrement our current effect
     multicore_data->effects_preset--;
@@ -132,9 +144,9 @@ void pushbutton_callback_external_4(void  *data_object) {
 	// Remove this code if SW will be used to trigger an event rather than toggle a state
     multicore_data->audioproj_fin_sw_4_state = !multicore_data->audioproj_fin_sw_4_state;
 
-    // Update our multicore structure to let the SHARCs know that a PB has been pressed
-    multicore_data->audioproj_fin_sw_4_core1_pressed = true;
-    multicore_data->audioproj_fin_sw_4_core2_pressed = true;
+    // Let the SHARCs know that a PB has been pressed
+    pushbutton_send_to_sharcs(MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_4,
+                              multicore_data->audioproj_fin_sw_4_state);
 
     // Increment our current effect
     multicore_data->effects_preset++;
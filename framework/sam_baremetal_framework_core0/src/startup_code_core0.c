@@ -116,14 +116,31 @@ int main(int argc, const char *argv[]) {
         log_event(EVENT_FATAL, "Structure defined in multicore_shared_memory.h file is too big");
     }
 
+    // Empty the message queues between the cores before the SHARC cores use them
+    message_queue_initialize(&multicore_data->arm_to_sharc_core1_messages);
+    message_queue_initialize(&multicore_data->arm_to_sharc_core2_messages);
+    message_queue_initialize(&multicore_data->sharc_core1_to_sharc_core2_messages);
+
+    // Clear the HADC values before the SHARC cores latch them
+    #if (SAM_AUDIOPROJ_FIN_BOARD_PRESENT)
+    parameter_snapshot_initialize(&multicore_data->audioproj_fin_hadc, AUDIOPROJ_FIN_HADC_PARAMETERS);
+    #endif
+
     // Initialize our selected the audio framework
     audioframework_initialize();
 
     // Initialize the effects presets
-    multicore_data->total_effects_presets = 10;
+    multicore_data->total_effects_presets = 11;
     multicore_data->effects_preset = 0;
     multicore_data->reverb_preset = 0;
 
+    // SHARC Core 1 sets up the split of the effects pipeline
+    multicore_data->pipeline_split = 0;
+    multicore_data->pipeline_split_to_core2 = 0;
+    multicore_data->pipeline_split_requested = 0;
+    multicore_data->pipeline_split_prepared = 0;
+    multicore_data->pipeline_rebalances = 0;
+
     #if defined(MIDI_UART_MANAGED_BY_ARM_CORE) && (MIDI_UART_MANAGED_BY_ARM_CORE)
     if (midi_setup_arm()) {
         log_event(EVENT_INFO, "SHARC Core 1 is configured to process MIDI");
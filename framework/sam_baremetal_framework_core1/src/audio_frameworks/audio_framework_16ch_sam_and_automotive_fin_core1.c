@@ -50,17 +50,26 @@
 // Structure containing shared variables between the three cores
 #include "common/multicore_shared_memory.h"
 
+// Per-scope cycle profiling of the audio callback
+#include "drivers/bm_cycle_profiler_driver/bm_cycle_profiler.h"
+
 // Hooks into user processing functions
 #include "../callback_audio_processing.h"
 
 // Local function prototypes for our interrupt handlers
 void audioframework_dma_handler(uint32_t iid, void *arg);
+void audioframework_mdma_complete_handler(uint32_t iid, void *arg);
 void audioframework_audiocallback_handler(uint32_t iid);
 
 // Definitions for this specific framework
 #define    AUDIO_CHANNELS              (16)
 #define    AUDIO_CHANNELS_MASK         (0xFFFF)
 
+// Channels converted in the DMA handler (bit n = channel n).  Clear the bits
+// of the channels that aren't used to save cycles in the DMA handler, a
+// channel that isn't converted stays silent.
+#define    AUTOMOTIVE_CHANNELS_CONVERTED   AUDIO_CHANNELS_MASK
+
 // Fixed-point (raw ADC/DAC data) DMA buffers for ping-pong / double-buffered DMA
 int section("seg_dmda_nw") sport4_dma_rx_0_buffer[AUDIO_CHANNELS * AUDIO_BLOCK_SIZE] = {
     0
@@ -82,6 +91,16 @@ float automotive_audiochannels_out[AUDIO_CHANNELS * AUDIO_BLOCK_SIZE] = {0};
 #pragma align 32
 float automotive_audiochannels_in[AUDIO_CHANNELS * AUDIO_BLOCK_SIZE] = {0};     // Audio from ADCs
 
+// Conversion between the fixed-point DMA buffers and the floating-point buffers
+static const AUDIOFLOW_CONVERSION automotive_conversion = {
+    .format       = AUDIOFLOW_FORMAT_32BIT,
+    .layout       = AUDIOFLOW_LAYOUT_CHANNEL_BLOCKS,
+    .channels     = AUDIO_CHANNELS,
+    .block_size   = AUDIO_BLOCK_SIZE,
+    .channel_mask = AUTOMOTIVE_CHANNELS_CONVERTED,
+    .gains        = NULL
+};
+
 #if (USE_BOTH_CORES_TO_PROCESS_AUDIO)
 #pragma align 32
 float audiochannels_from_sharc_core2[AUDIO_CHANNELS * AUDIO_BLOCK_SIZE] = {0};    // Audio from SHARC Core 2
@@ -274,6 +293,9 @@ uint32_t audio_blocks_new_events_count = 0;
 // Cycle counter used for benchmarking our code
 uint64_t cycle_cntr;
 
+// Profiler scope around the user audio processing
+static int32_t profile_scope_callback = CYCLE_PROFILER_NO_SCOPE;
+
 // DMA & SPORT Configuration for SPORT 0 (ADAU1761 connection)
 SPORT_DMA_CONFIG SPR4_Automotive_16CH_Config = {
 
@@ -323,6 +345,47 @@ SPORT_DMA_CONFIG SPR4_Automotive_16CH_Config = {
     .dma_interrupt_routine = audioframework_dma_handler
 };
 
+/**
+ * @brief      Raises the software interrupt that calls the audio callback
+ *
+ * If the audio callback hasn't finished the last block, the block is dropped
+ * instead.
+ */
+static void audioframework_raise_audio_callback(void) {
+    int i;
+
+    // Detect and handle the "frame dropped" event
+    if (!last_audio_frame_completed) {
+
+        // Make a call to the callback
+        processaudio_mips_overflow();
+
+        // Zero output buffers so we get silence instead of repeated audio
+        for (i = 0; i < AUDIO_CHANNELS * AUDIO_BLOCK_SIZE; i++) {
+            #if (USE_BOTH_CORES_TO_PROCESS_AUDIO)
+            audiochannels_to_sharc_core2[i] = 0;
+            #endif
+            automotive_audiochannels_out[i] = 0;
+        }
+
+        // Update dropped audio frame counter
+        multicore_data->sharc_core1_dropped_audio_frames++;
+
+        // Capture the timing of the blocks that led up to this
+        cycle_profiler_block_dropped();
+
+        // Don't trigger the software interrupt for audio processing on this block
+        return;
+    }
+    else {
+        // Set to false as we begin processing this new audio frame
+        last_audio_frame_completed = false;
+
+        // Raise lower priority interrupt to kick off AudioFramework_AudioCallback_Handler
+        *pREG_SEC0_RAISE = INTR_TRU0_INT4;
+    }
+}
+
 /**
  * @brief      SHARC Core 1 handler for DMA interrupts
  *
@@ -335,9 +398,11 @@ SPORT_DMA_CONFIG SPR4_Automotive_16CH_Config = {
  *
  * When using a dual-core framework, this routine also sets up the memory DMA
  * to move blocks of data from core 1 to core 2, and then from core 2 back to core 1.
- * This operation is pipelined.
+ * This operation is pipelined.  Rather than waiting here for the block to reach
+ * core 2, the rest of the work is done in audioframework_mdma_complete_handler
+ * when that transfer completes.
  *
- * Finally, this routine raises a software interrupt which in turn calls the user's
+ * Finally, a software interrupt is raised which in turn calls the user's
  * audio processing callback function.  The reason for doing this is to keep the audio
  * processing at a lower priority that these interrupts.  If the audio processing is
  * done within this interrupt service routine, we may miss new blocks of audio if processing
@@ -346,7 +411,6 @@ SPORT_DMA_CONFIG SPR4_Automotive_16CH_Config = {
  *
  */
 void audioframework_dma_handler(uint32_t iid, void *arg){
-    int i;
 
     // Clear DMA interrupt
     *pREG_DMA11_STAT |= BITM_DMA_STAT_IRQDONE;
@@ -355,6 +419,7 @@ void audioframework_dma_handler(uint32_t iid, void *arg){
 
     // Capture a processor cycle count for benchmarking purposes.
     cycle_cntr = audioflow_get_cpu_cycle_counter();
+    cycle_profiler_block_arrival(multicore_data->effects_preset);
 
     // Set flag that we are now getting audio interrupts and processing audio
     multicore_data->sharc_core1_processing_audio = true;
@@ -384,10 +449,15 @@ void audioframework_dma_handler(uint32_t iid, void *arg){
      */
 
     // Be sure the MDMA we kicked off at the end of the last block has now completed
+    cycle_profiler_mdma_wait_begin();
     while (!*pREG_DMA19_STAT & 0x1) {
 
         // We should never get here
     }
+    cycle_profiler_mdma_wait_end();
+
+    // Pass on the split of the effects pipeline core 1 processed this block with
+    multicore_data->pipeline_split_to_core2 = multicore_data->pipeline_split;
 
     // Translate addresses from local to global
     void *sharc_core2_dest_addr = (void *)((uint32_t)multicore_data->sharc_core2_audio_in  + 0x28800000);
@@ -413,6 +483,7 @@ void audioframework_dma_handler(uint32_t iid, void *arg){
         = BITM_DMA_CFG_EN |                                    // Enable DMA
           BITM_DMA_CFG_WNR |                                 // Write mode
           (0x2 << BITP_DMA_CFG_MSIZE) |
+          (0x1 << BITP_DMA_CFG_INT) |                        // Generate an interrupt when complete
           0;
 
     // And then route the audio we received from core 2 to the right output buffers
@@ -433,21 +504,41 @@ void audioframework_dma_handler(uint32_t iid, void *arg){
      * point in the process and clip audio if needed.  Use the current DMA pointers to determine
      * which pair of buffers is not presently being transmitted / received.
      */
-    if (    (uint32_t)sport_dma_cfg->dma_descriptor_rx_0_list.Next_Desc !=
-            (*sport_dma_cfg->pREG_DMA_RX_DSCPTR_NXT)
-            )
-    {
+    bool ping = (uint32_t)sport_dma_cfg->dma_descriptor_rx_0_list.Next_Desc !=
+                (*sport_dma_cfg->pREG_DMA_RX_DSCPTR_NXT);
+
+    audioflow_float_to_fixed_channels(&automotive_conversion, automotive_audiochannels_out,
+                                      ping ? sport4_dma_tx_0_buffer : sport4_dma_tx_1_buffer);
+    audioflow_fixed_to_float_channels(&automotive_conversion,
+                                      ping ? sport4_dma_rx_0_buffer : sport4_dma_rx_1_buffer,
+                                      automotive_audiochannels_in);
+
+    #if !(USE_BOTH_CORES_TO_PROCESS_AUDIO)
+    // With both cores, this is done once the block has been moved to core 2
+    // (see audioframework_mdma_complete_handler)
+    audioframework_raise_audio_callback();
+    #endif
+}
 
-        audioflow_float_to_fixed(automotive_audiochannels_out, sport4_dma_tx_0_buffer, AUDIO_CHANNELS * AUDIO_BLOCK_SIZE);
-        audioflow_fixed_to_float(sport4_dma_rx_0_buffer, automotive_audiochannels_in,  AUDIO_CHANNELS * AUDIO_BLOCK_SIZE);
-    }
-    else
-    {
-        audioflow_float_to_fixed(automotive_audiochannels_out, sport4_dma_tx_1_buffer, AUDIO_CHANNELS * AUDIO_BLOCK_SIZE);
-        audioflow_fixed_to_float(sport4_dma_rx_1_buffer, automotive_audiochannels_in,  AUDIO_CHANNELS * AUDIO_BLOCK_SIZE);
-    }
+#if (USE_BOTH_CORES_TO_PROCESS_AUDIO)
+/**
+ * @brief      Memory DMA complete handler
+ *
+ * Called when the output audio of SHARC 1 from the last block has been moved
+ * to SHARC 2 (step 1 of audioframework_dma_handler).  Taking an interrupt
+ * rather than polling the transfer in the DMA handler leaves the core free
+ * while the transfer completes.
+ *
+ * Only now is the output audio of SHARC 2 moved back, which in turn
+ * interrupts SHARC 2 to process the block that has just arrived.  And only
+ * now can SHARC 1 start processing the next block without overwriting the
+ * buffer being moved out.
+ */
+void audioframework_mdma_complete_handler(uint32_t iid, void *arg) {
+
+    // Clear DMA interrupt
+    *pREG_DMA9_STAT |= BITM_DMA_STAT_IRQDONE;
 
-    #if (USE_BOTH_CORES_TO_PROCESS_AUDIO)
     /*
      ********************************************************************************
      * STEP 3:
@@ -487,43 +578,13 @@ void audioframework_dma_handler(uint32_t iid, void *arg){
     /*
      ********************************************************************************
      * STEP 4:
-     * Before we kick off audio processing on SHARC 1, make sure we have copied
-     * the full output buffer from SHARC 1 to SHARC 2 (from step 1).  We don't want
-     * to begin processing data in SHARC 1 until all of the processed data has been
-     * moved out.
+     * Kick off audio processing on SHARC 1.  All of the processed data from the
+     * last block has been moved out to SHARC 2 (step 1).
      ********************************************************************************
      */
-    while (!*pREG_DMA9_STAT & 0x1) { }
-    #endif
-
-    // Detect and handle the "frame dropped" event
-    if (!last_audio_frame_completed) {
-
-        // Make a call to the callback
-        processaudio_mips_overflow();
-
-        // Zero output buffers so we get silence instead of repeated audio
-        for (i = 0; i < AUDIO_CHANNELS * AUDIO_BLOCK_SIZE; i++) {
-            #if (USE_BOTH_CORES_TO_PROCESS_AUDIO)
-            audiochannels_to_sharc_core2[i] = 0;
-            #endif
-            automotive_audiochannels_out[i] = 0;
-        }
-
-        // Update dropped audio frame counter
-        multicore_data->sharc_core1_dropped_audio_frames++;
-
-        // Don't trigger the software interrupt for audio processing on this block
-        return;
-    }
-    else {
-        // Set to false as we begin processing this new audio frame
-        last_audio_frame_completed = false;
-
-        // Raise lower priority interrupt to kick off AudioFramework_AudioCallback_Handler
-        *pREG_SEC0_RAISE = INTR_TRU0_INT4;
-    }
+    audioframework_raise_audio_callback();
 }
+#endif
 
 /**
  * @brief      SHARC Core 1 Audio callback handler
@@ -553,8 +614,16 @@ void audioframework_audiocallback_handler(uint32_t iid) {
     // Clear the pending software interrupt
     *pREG_SEC0_END = INTR_TRU0_INT4;
 
+    // Start of the callback for the profiler / trace
+    cycle_profiler_block_start();
+
     // Call user audio processing
+    cycle_profiler_scope_begin(profile_scope_callback);
     processaudio_callback();
+    cycle_profiler_scope_end(profile_scope_callback);
+
+    // Add the cycles of this block to the profile
+    cycle_profiler_block_end();
 
     // Calculate our CPU load for this SHARC core based on our cycle counter
     multicore_data->sharc_core1_cpu_load_mhz = audioflow_get_cpu_load(cycle_cntr,
@@ -595,6 +664,14 @@ void audioframework_initialize() {
     // Clear dropped frame counter
     multicore_data->sharc_core1_dropped_audio_frames = 0;
 
+    // Profile the audio callback, publishing the statistics once per second and
+    // capturing the timing of the last blocks when one is dropped
+    cycle_profiler_initialize_sharc_core((BM_CYCLE_PROFILE_TABLE *)&multicore_data->sharc_core1_cycle_profile,
+                                         (BM_CYCLE_TRACE *)&multicore_data->sharc_core1_cycle_trace,
+                                         (CORE_CLOCK_FREQ_HZ / AUDIO_SAMPLE_RATE) * AUDIO_BLOCK_SIZE,
+                                         AUDIO_SAMPLE_RATE / AUDIO_BLOCK_SIZE);
+    profile_scope_callback = cycle_profiler_add_scope("callback");
+
     // Initialize peripherals and DMA to configure audio data I/O flow
     audioflow_init_sport_dma(&SPR4_Automotive_16CH_Config);
 
@@ -602,6 +679,9 @@ void audioframework_initialize() {
     adi_int_InstallHandler(INTR_TRU0_INT4, (ADI_INT_HANDLER_PTR)audioframework_audiocallback_handler, NULL, true);
 
     #if (USE_BOTH_CORES_TO_PROCESS_AUDIO)
+    // Set up interrupt handler for the memory DMA moving audio to core 2
+    adi_int_InstallHandler(INTR_MDMA0_DST, (ADI_INT_HANDLER_PTR)audioframework_mdma_complete_handler, NULL, true);
+
     // Set pointers in our shared memory structure
     multicore_data->sharc_core1_audio_out = audiochannels_to_sharc_core2;
     multicore_data->sharc_core1_audio_in  = audiochannels_from_sharc_core2;
@@ -43,6 +43,9 @@
 // Structure containing shared variables between the three cores
 #include "common/multicore_shared_memory.h"
 
+// Per-scope cycle profiling of the audio callback
+#include "drivers/bm_cycle_profiler_driver/bm_cycle_profiler.h"
+
 // Hooks into user processing functions
 #include "../callback_audio_processing.h"
 
@@ -52,6 +55,7 @@
 
 // Local function prototypes for our interrupt handlers
 void audioframework_dma_handler(uint32_t iid, void *arg);
+void audioframework_mdma_complete_handler(uint32_t iid, void *arg);
 void audioframework_audiocallback_handler(uint32_t iid);
 
 // Definitions for this specific framework
@@ -60,6 +64,14 @@ void audioframework_audiocallback_handler(uint32_t iid);
 #define     SPDIF_DMA_CHANNELS         (2)
 #define     SPDIF_DMA_CHANNEL_MASK     (0x3)
 
+// Channels of each port converted in the DMA handler (bit n = channel n).
+// Clear the bits of the channels that aren't used to save cycles in the DMA
+// handler, a channel that isn't converted stays silent.  Set a mask to 0 to
+// skip a port altogether (e.g. SPDIF_CHANNELS_CONVERTED if SPDIF isn't used).
+#define     ADAU1761_CHANNELS_CONVERTED    AUDIO_CHANNELS_MASK
+#define     A2B_CHANNELS_CONVERTED         AUDIO_CHANNELS_MASK
+#define     SPDIF_CHANNELS_CONVERTED       SPDIF_DMA_CHANNEL_MASK
+
 // ADAU1761 Fixed-point (raw ADC/DAC data) DMA buffers for ping-pong / double-buffered DMA
 int section("seg_dmda_nw") sport0_dma_rx_0_buffer[AUDIO_CHANNELS * AUDIO_BLOCK_SIZE] = {
     0
@@ -119,6 +131,34 @@ float spdif_audiochannels_out[SPDIF_DMA_CHANNELS * AUDIO_BLOCK_SIZE] = {0};    /
 #pragma align 32
 float spdif_audiochannels_in[SPDIF_DMA_CHANNELS * AUDIO_BLOCK_SIZE] = {0};      // Audio from SPDIF RX
 
+// Conversions between the fixed-point DMA buffers and the floating-point buffers
+static const AUDIOFLOW_CONVERSION adau1761_conversion = {
+    .format       = AUDIOFLOW_FORMAT_32BIT,
+    .layout       = AUDIOFLOW_LAYOUT_CHANNEL_BLOCKS,
+    .channels     = AUDIO_CHANNELS,
+    .block_size   = AUDIO_BLOCK_SIZE,
+    .channel_mask = ADAU1761_CHANNELS_CONVERTED,
+    .gains        = NULL
+};
+
+static const AUDIOFLOW_CONVERSION a2b_conversion = {
+    .format       = AUDIOFLOW_FORMAT_32BIT,
+    .layout       = AUDIOFLOW_LAYOUT_CHANNEL_BLOCKS,
+    .channels     = AUDIO_CHANNELS,
+    .block_size   = AUDIO_BLOCK_SIZE,
+    .channel_mask = A2B_CHANNELS_CONVERTED,
+    .gains        = NULL
+};
+
+static const AUDIOFLOW_CONVERSION spdif_conversion = {
+    .format       = AUDIOFLOW_FORMAT_32BIT,
+    .layout       = AUDIOFLOW_LAYOUT_CHANNEL_BLOCKS,
+    .channels     = SPDIF_DMA_CHANNELS,
+    .block_size   = AUDIO_BLOCK_SIZE,
+    .channel_mask = SPDIF_CHANNELS_CONVERTED,
+    .gains        = NULL
+};
+
 #if (USE_BOTH_CORES_TO_PROCESS_AUDIO)
 #pragma align 32
 float audiochannels_from_sharc_core2[AUDIO_CHANNELS * AUDIO_BLOCK_SIZE] = {0};      // Audio from SHARC Core 2
@@ -252,6 +292,12 @@ uint32_t audio_blocks_new_events_count = 0;
 // Cycle counter used for benchmarking our code
 uint64_t cycle_cntr;
 
+// Profiler scopes around the user audio processing
+static int32_t profile_scope_callback = CYCLE_PROFILER_NO_SCOPE;
+#if defined(USE_FAUST_ALGORITHM_CORE1) && USE_FAUST_ALGORITHM_CORE1
+static int32_t profile_scope_faust = CYCLE_PROFILER_NO_SCOPE;
+#endif
+
 // DMA & SPORT Configuration for SPORT 0 (ADAU1761 connection)
 SPORT_DMA_CONFIG SPR0_ADAU1761_8CH_Config = {
 
@@ -400,6 +446,47 @@ SPORT_DMA_CONFIG SPR2_spdif_2CH_Config = {
     .generates_interrupts = false
 };
 
+/**
+ * @brief      Raises the software interrupt that calls the audio callback
+ *
+ * If the audio callback hasn't finished the last block, the block is dropped
+ * instead.
+ */
+static void audioframework_raise_audio_callback(void) {
+    int i;
+
+    // Detect and handle the "frame dropped" event
+    if (!last_audio_frame_completed) {
+
+        // Make a call to the callback
+        processaudio_mips_overflow();
+
+        // Zero output buffers so we get silence instead of repeated audio
+        for (i = 0; i < AUDIO_CHANNELS * AUDIO_BLOCK_SIZE; i++) {
+			#if (USE_BOTH_CORES_TO_PROCESS_AUDIO)
+            	audiochannels_to_sharc_core2[i] = 0;
+		    #endif
+            adau1761_audiochannels_out[i] = 0;
+        }
+
+        // Update dropped audio frame counter
+        multicore_data->sharc_core1_dropped_audio_frames++;
+
+        // Capture the timing of the blocks that led up to this
+        cycle_profiler_block_dropped();
+
+        // Don't trigger the software interrupt for audio processing on this block
+        return;
+    }
+    else {
+        // Set to false as we begin processing this new audio frame
+        last_audio_frame_completed = false;
+
+        // Raise lower priority interrupt to kick off AudioFramework_AudioCallback_Handler
+        *pREG_SEC0_RAISE = INTR_TRU0_INT4;
+    }
+}
+
 /**
  * @brief      SHARC Core 1 handler for DMA interrupts
  *
@@ -412,9 +499,11 @@ SPORT_DMA_CONFIG SPR2_spdif_2CH_Config = {
  *
  * When using a dual-core framework, this routine also sets up the memory DMA
  * to move blocks of data from core 1 to core 2, and then from core 2 back to core 1.
- * This operation is pipelined.
+ * This operation is pipelined.  Rather than waiting here for the block to reach
+ * core 2, the rest of the work is done in audioframework_mdma_complete_handler
+ * when that transfer completes.
  *
- * Finally, this routine raises a software interrupt which in turn calls the user's
+ * Finally, a software interrupt is raised which in turn calls the user's
  * audio processing callback function.  The reason for doing this is to keep the audio
  * processing at a lower priority that these interrupts.  If the audio processing is
  * done within this interrupt service routine, we may miss new blocks of audio if processing
@@ -424,13 +513,13 @@ SPORT_DMA_CONFIG SPR2_spdif_2CH_Config = {
  */
 
 void audioframework_dma_handler(uint32_t iid, void *arg){
-    int i;
 
     // Clear DMA interrupt
     *pREG_DMA1_STAT |= BITM_DMA_STAT_IRQDONE;
 
     // Capture a processor cycle count for benchmarking purposes.
     cycle_cntr = audioflow_get_cpu_cycle_counter();
+    cycle_profiler_block_arrival(multicore_data->effects_preset);
 
     // Get the configuration of the SPORT / DMA combo driving interrupts
     SPORT_DMA_CONFIG *sport_dma_cfg = (SPORT_DMA_CONFIG *)arg;
@@ -460,10 +549,15 @@ void audioframework_dma_handler(uint32_t iid, void *arg){
      */
 
     // Be sure the MDMA we kicked off at the end of the last block has now completed
+    cycle_profiler_mdma_wait_begin();
     while (!*pREG_DMA19_STAT & 0x1) {
 
         // We should never get here
     }
+    cycle_profiler_mdma_wait_end();
+
+    // Pass on the split of the effects pipeline core 1 processed this block with
+    multicore_data->pipeline_split_to_core2 = multicore_data->pipeline_split;
 
     // Translate addresses from local to global
     void *sharc_core2_dest_addr = (void *)((uint32_t)multicore_data->sharc_core2_audio_in  + 0x28800000);
@@ -487,6 +581,7 @@ void audioframework_dma_handler(uint32_t iid, void *arg){
     *pREG_DMA9_CFG = BITM_DMA_CFG_EN |                        // Enable DMA
                      BITM_DMA_CFG_WNR |                      // Write mode
                      (0x2 << BITP_DMA_CFG_MSIZE) |
+                     (0x1 << BITP_DMA_CFG_INT) |             // Generate an interrupt when complete
                      0;
 
     // And then route the audio we received from core 2 to the right output buffers
@@ -507,38 +602,58 @@ void audioframework_dma_handler(uint32_t iid, void *arg){
      * point in the process and clip audio if needed.  Use the current DMA pointers to determine
      * which pair of buffers is not presently being transmitted / received.
      */
-    if (    (uint32_t)sport_dma_cfg->dma_descriptor_rx_0_list.Next_Desc !=
-            (*sport_dma_cfg->pREG_DMA_RX_DSCPTR_NXT)
-            )  {
+    bool ping = (uint32_t)sport_dma_cfg->dma_descriptor_rx_0_list.Next_Desc !=
+                (*sport_dma_cfg->pREG_DMA_RX_DSCPTR_NXT);
+
+    audioflow_float_to_fixed_channels(&adau1761_conversion, adau1761_audiochannels_out,
+                                      ping ? sport0_dma_tx_0_buffer : sport0_dma_tx_1_buffer);
+    audioflow_fixed_to_float_channels(&adau1761_conversion,
+                                      ping ? sport0_dma_rx_0_buffer : sport0_dma_rx_1_buffer,
+                                      adau1761_audiochannels_in);
+
+    #if (ENABLE_A2B)
+    audioflow_float_to_fixed_channels(&a2b_conversion, a2b_audiochannels_out,
+                                      ping ? sport1_dma_tx_0_buffer : sport1_dma_tx_1_buffer);
+    audioflow_fixed_to_float_channels(&a2b_conversion,
+                                      ping ? sport1_dma_rx_0_buffer : sport1_dma_rx_1_buffer,
+                                      a2b_audiochannels_in);
+    #endif
 
-        audioflow_float_to_fixed(adau1761_audiochannels_out, sport0_dma_tx_0_buffer, AUDIO_CHANNELS * AUDIO_BLOCK_SIZE);
-        audioflow_fixed_to_float(sport0_dma_rx_0_buffer, adau1761_audiochannels_in,  AUDIO_CHANNELS * AUDIO_BLOCK_SIZE);
+    // Audio data to/from SPDIF
+    #if (SPDIF_CHANNELS_CONVERTED)
+    audioflow_float_to_fixed_channels(&spdif_conversion, spdif_audiochannels_out,
+                                      ping ? sport2_dma_tx_0_buffer : sport2_dma_tx_1_buffer);
+    audioflow_fixed_to_float_channels(&spdif_conversion,
+                                      ping ? sport2_dma_rx_0_buffer : sport2_dma_rx_1_buffer,
+                                      spdif_audiochannels_in);
+    #endif
 
-        #if (ENABLE_A2B)
-        audioflow_float_to_fixed(a2b_audiochannels_out, sport1_dma_tx_0_buffer, AUDIO_CHANNELS * AUDIO_BLOCK_SIZE);
-        audioflow_fixed_to_float(sport1_dma_rx_0_buffer, a2b_audiochannels_in,  AUDIO_CHANNELS * AUDIO_BLOCK_SIZE);
-        #endif
+    #if !(USE_BOTH_CORES_TO_PROCESS_AUDIO)
+    // With both cores, this is done once the block has been moved to core 2
+    // (see audioframework_mdma_complete_handler)
+    audioframework_raise_audio_callback();
+    #endif
+}
 
-        // Audio data to/from SPDIF
-        audioflow_float_to_fixed(spdif_audiochannels_out, sport2_dma_tx_0_buffer, SPDIF_DMA_CHANNELS * AUDIO_BLOCK_SIZE);
-        audioflow_fixed_to_float(sport2_dma_rx_0_buffer, spdif_audiochannels_in, SPDIF_DMA_CHANNELS * AUDIO_BLOCK_SIZE);
-    }
-    else
-    {
-        audioflow_float_to_fixed(adau1761_audiochannels_out, sport0_dma_tx_1_buffer, AUDIO_CHANNELS * AUDIO_BLOCK_SIZE);
-        audioflow_fixed_to_float(sport0_dma_rx_1_buffer, adau1761_audiochannels_in,  AUDIO_CHANNELS * AUDIO_BLOCK_SIZE);
-
-        #if (ENABLE_A2B)
-        audioflow_float_to_fixed(a2b_audiochannels_out, sport1_dma_tx_1_buffer, AUDIO_CHANNELS * AUDIO_BLOCK_SIZE);
-        audioflow_fixed_to_float(sport1_dma_rx_1_buffer, a2b_audiochannels_in,  AUDIO_CHANNELS * AUDIO_BLOCK_SIZE);
-        #endif
-
-        // Audio data to/from SPDIF
-        audioflow_float_to_fixed(spdif_audiochannels_out, sport2_dma_tx_1_buffer, SPDIF_DMA_CHANNELS * AUDIO_BLOCK_SIZE);
-        audioflow_fixed_to_float(sport2_dma_rx_1_buffer, spdif_audiochannels_in, SPDIF_DMA_CHANNELS * AUDIO_BLOCK_SIZE);
-    }
+#if (USE_BOTH_CORES_TO_PROCESS_AUDIO)
+/**
+ * @brief      Memory DMA complete handler
+ *
+ * Called when the output audio of SHARC 1 from the last block has been moved
+ * to SHARC 2 (step 1 of audioframework_dma_handler).  Taking an interrupt
+ * rather than polling the transfer in the DMA handler leaves the core free
+ * while the transfer completes.
+ *
+ * Only now is the output audio of SHARC 2 moved back, which in turn
+ * interrupts SHARC 2 to process the block that has just arrived.  And only
+ * now can SHARC 1 start processing the next block without overwriting the
+ * buffer being moved out.
+ */
+void audioframework_mdma_complete_handler(uint32_t iid, void *arg) {
+
+    // Clear DMA interrupt
+    *pREG_DMA9_STAT |= BITM_DMA_STAT_IRQDONE;
 
-    #if (USE_BOTH_CORES_TO_PROCESS_AUDIO)
     /*
      ********************************************************************************
      * STEP 3:
@@ -578,43 +693,13 @@ void audioframework_dma_handler(uint32_t iid, void *arg){
     /*
      ********************************************************************************
      * STEP 4:
-     * Before we kick off audio processing on SHARC 1, make sure we have copied
-     * the full output buffer from SHARC 1 to SHARC 2 (from step 1).  We don't want
-     * to begin processing data in SHARC 1 until all of the processed data has been
-     * moved out.
+     * Kick off audio processing on SHARC 1.  All of the processed data from the
+     * last block has been moved out to SHARC 2 (step 1).
      ********************************************************************************
      */
-    while (!*pREG_DMA9_STAT & 0x1) { }
-    #endif    // USE_BOTH_CORES_TO_PROCESS_AUDIO
-
-    // Detect and handle the "frame dropped" event
-    if (!last_audio_frame_completed) {
-
-        // Make a call to the callback
-        processaudio_mips_overflow();
-
-        // Zero output buffers so we get silence instead of repeated audio
-        for (i = 0; i < AUDIO_CHANNELS * AUDIO_BLOCK_SIZE; i++) {
-			#if (USE_BOTH_CORES_TO_PROCESS_AUDIO)
-            	audiochannels_to_sharc_core2[i] = 0;
-		    #endif
-            adau1761_audiochannels_out[i] = 0;
-        }
-
-        // Update dropped audio frame counter
-        multicore_data->sharc_core1_dropped_audio_frames++;
-
-        // Don't trigger the software interrupt for audio processing on this block
-        return;
-    }
-    else {
-        // Set to false as we begin processing this new audio frame
-        last_audio_frame_completed = false;
-
-        // Raise lower priority interrupt to kick off AudioFramework_AudioCallback_Handler
-        *pREG_SEC0_RAISE = INTR_TRU0_INT4;
-    }
+    audioframework_raise_audio_callback();
 }
+#endif    // USE_BOTH_CORES_TO_PROCESS_AUDIO
 
 /**
  * @brief      SHARC Core 1 Audio callback handler
@@ -643,13 +728,23 @@ void audioframework_audiocallback_handler(uint32_t iid) {
     //*pREG_SEC0_END = INTR_SOFT7;
     *pREG_SEC0_END = INTR_TRU0_INT4;
 
+    // Start of the callback for the profiler / trace
+    cycle_profiler_block_start();
+
     // If we're using Faust, run the Faust audio processing before our callback
     #if (defined(USE_FAUST_ALGORITHM_CORE1) && USE_FAUST_ALGORITHM_CORE1)
+    cycle_profiler_scope_begin(profile_scope_faust);
     Faust_audio_processing();
+    cycle_profiler_scope_end(profile_scope_faust);
     #endif
 
     // Call user audio processing
+    cycle_profiler_scope_begin(profile_scope_callback);
     processaudio_callback();
+    cycle_profiler_scope_end(profile_scope_callback);
+
+    // Add the cycles of this block to the profile
+    cycle_profiler_block_end();
 
     // Calculate our CPU load for this SHARC core based on our cycle counter
     multicore_data->sharc_core1_cpu_load_mhz = audioflow_get_cpu_load(cycle_cntr,
@@ -703,6 +798,17 @@ void audioframework_initialize() {
     // Clear dropped frame counter
     multicore_data->sharc_core1_dropped_audio_frames = 0;
 
+    // Profile the audio callback, publishing the statistics once per second and
+    // capturing the timing of the last blocks when one is dropped
+    cycle_profiler_initialize_sharc_core((BM_CYCLE_PROFILE_TABLE *)&multicore_data->sharc_core1_cycle_profile,
+                                         (BM_CYCLE_TRACE *)&multicore_data->sharc_core1_cycle_trace,
+                                         (CORE_CLOCK_FREQ_HZ / AUDIO_SAMPLE_RATE) * AUDIO_BLOCK_SIZE,
+                                         AUDIO_SAMPLE_RATE / AUDIO_BLOCK_SIZE);
+    profile_scope_callback = cycle_profiler_add_scope("callback");
+    #if defined(USE_FAUST_ALGORITHM_CORE1) && USE_FAUST_ALGORITHM_CORE1
+    profile_scope_faust = cycle_profiler_add_scope("faust");
+    #endif
+
     // If we're using Faust on either core, initialize the Faust engine
     #if (USE_FAUST_ALGORITHM_CORE1)
     	faust_initialize();
@@ -717,6 +823,9 @@ void audioframework_initialize() {
     adi_int_InstallHandler(INTR_TRU0_INT4, (ADI_INT_HANDLER_PTR)audioframework_audiocallback_handler, NULL, true);
 
     #if (USE_BOTH_CORES_TO_PROCESS_AUDIO)
+		// Set up interrupt handler for the memory DMA moving audio to core 2
+		adi_int_InstallHandler(INTR_MDMA0_DST, (ADI_INT_HANDLER_PTR)audioframework_mdma_complete_handler, NULL, true);
+
 		// Set pointers in our shared memory structure
 		multicore_data->sharc_core1_audio_out = audiochannels_to_sharc_core2;
 		multicore_data->sharc_core1_audio_in  = audiochannels_from_sharc_core2;
@@ -87,12 +87,6 @@ void faust_initialize(void){
 
     #endif
 
-    // Initialize FIFO pointers for moving MIDI events from SHARC core 1 to SHARC core 2
-    #if (USE_FAUST_ALGORITHM_CORE2)
-		multicore_data->sh1_sh2_fifo_read_ptr = 0;
-		multicore_data->sh1_sh2_fifo_write_ptr = 0;
-    #endif
-
     // Initialize the MIDI / UART interface
     if (uart_initialize(&midi_uart,
                         UART_BAUD_RATE_MIDI,
@@ -129,10 +123,14 @@ void Faust_audio_processing(void){
 
     // pots are always on CC-2,3,4
 
+    // latch one consistent set of pot values for this block
+    static BM_PARAMETER_SNAPSHOT pots;
+    parameter_snapshot_latch(&multicore_data->audioproj_fin_hadc, &pots);
+
     float epsilon = 1.0 / 50.0;
 
     // lock the value of the pot.
-    float currentPotValue0 = multicore_data->audioproj_fin_pot_hadc0;
+    float currentPotValue0 = pots.values[AUDIOPROJ_FIN_POT_HADC0];
     // if it changed then send MIDI to the samFaustDSP object
     if ((currentPotValue0 >= (lastPotValue0 + epsilon)) || (currentPotValue0 <= (lastPotValue0 - epsilon))) {
         lastPotValue0 = currentPotValue0;
@@ -141,7 +139,7 @@ void Faust_audio_processing(void){
     }
 
     // lock the value of the pot.
-    float currentPotValue1 = multicore_data->audioproj_fin_pot_hadc1;
+    float currentPotValue1 = pots.values[AUDIOPROJ_FIN_POT_HADC1];
     // if it changed then send MIDI to the samFaustDSP object
     if ((currentPotValue1 >= (lastPotValue1 + epsilon)) || (currentPotValue1 <= (lastPotValue1 - epsilon))) {
         lastPotValue1 = currentPotValue1;
@@ -150,7 +148,7 @@ void Faust_audio_processing(void){
     }
 
     // lock the value of the pot.
-    float currentPotValue2 = multicore_data->audioproj_fin_pot_hadc2;
+    float currentPotValue2 = pots.values[AUDIOPROJ_FIN_POT_HADC2];
     // if it changed then send MIDI to the samFaustDSP object
     if ((currentPotValue2 >= (lastPotValue2 + epsilon)) || (currentPotValue2 <= (lastPotValue2 - epsilon))) {
         lastPotValue2 = currentPotValue2;
@@ -159,28 +157,33 @@ void Faust_audio_processing(void){
     }
 
     // push buttons are always CC-102(66H), 103(67H), 104(68H), 105(69H)
-    if (multicore_data->audioproj_fin_sw_1_core1_pressed) {
-        multicore_data->audioproj_fin_sw_1_core1_pressed = false;
-        enablePB1 = !enablePB1;
-        faust_handle_pushbutton(enablePB1, 0x66);
-    }
+    BM_MESSAGE message;
+    while (message_queue_receive(&multicore_data->arm_to_sharc_core1_messages, &message)) {
 
-    if (multicore_data->audioproj_fin_sw_2_core1_pressed) {
-        multicore_data->audioproj_fin_sw_2_core1_pressed = false;
-        enablePB2 = !enablePB2;
-        faust_handle_pushbutton(enablePB2, 0x67);
-    }
-
-    if (multicore_data->audioproj_fin_sw_3_core1_pressed) {
-        multicore_data->audioproj_fin_sw_3_core1_pressed = false;
-        enablePB3 = !enablePB3;
-        faust_handle_pushbutton(enablePB3, 0x68);
-    }
+        if (message.type != MESSAGE_TYPE_SWITCH) {
+            continue;
+        }
 
-    if (multicore_data->audioproj_fin_sw_4_core1_pressed) {
-        multicore_data->audioproj_fin_sw_4_core1_pressed = false;
-        enablePB4 = !enablePB4;
-        faust_handle_pushbutton(enablePB4, 0x69);
+        switch (message.id) {
+            case MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_1:
+                enablePB1 = !enablePB1;
+                faust_handle_pushbutton(enablePB1, 0x66);
+                break;
+            case MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_2:
+                enablePB2 = !enablePB2;
+                faust_handle_pushbutton(enablePB2, 0x67);
+                break;
+            case MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_3:
+                enablePB3 = !enablePB3;
+                faust_handle_pushbutton(enablePB3, 0x68);
+                break;
+            case MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_4:
+                enablePB4 = !enablePB4;
+                faust_handle_pushbutton(enablePB4, 0x69);
+                break;
+            default:
+                break;
+        }
     }
 
     // run the FAUST call back
@@ -213,19 +216,8 @@ static void faust_midi_rx_callback(void) {
          * If we're using Core 2 for Faust, pipe these MIDI events over to the second SHARC
          * core.  We do this regardless of whether or not we're using Faust on SHARC core 1.
          */
-        if (((multicore_data->sh1_sh2_fifo_write_ptr + 1) % SH1_SH2_BYTE_FIFO_SIZE) !=
-            multicore_data->sh1_sh2_fifo_read_ptr) {
-
-            // If there is room in the FIFO, copy this byte
-            multicore_data->sh1_sh2_byte_fifo[multicore_data->sh1_sh2_fifo_write_ptr++] = val;
-
-            // Wrap our write pointer if necessary
-            if (multicore_data->sh1_sh2_fifo_write_ptr >= SH1_SH2_BYTE_FIFO_SIZE) {
-                multicore_data->sh1_sh2_fifo_write_ptr = 0;
-            }
-        }
-        else {
-            // Add code here to handle a FIFO full error
+        if (!message_queue_send_midi(&multicore_data->sharc_core1_to_sharc_core2_messages, &val, 1)) {
+            // Add code here to handle a queue full error
         }
 
         #endif
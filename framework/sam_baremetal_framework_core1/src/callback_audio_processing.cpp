@@ -192,6 +192,11 @@
  */
 void processaudio_setup(void) {
 
+	// Let the effects work directly on the framework's channel 0 buffers so
+	// the audio doesn't have to be copied in and out of the effects
+	audio_effects_set_buffers(audiochannel_0_left_in, audiochannel_0_right_in,
+			audiochannel_0_left_out, audiochannel_0_right_out);
+
 	// Initialize the audio effects in the audio_processing/ folder
 	audio_effects_setup_core1();
 
@@ -227,19 +232,16 @@ void processaudio_callback(void) {
 
 	if (true) {
 
-		// Copy incoming audio buffers to the effects input buffers
-		copy_buffer(audiochannel_0_left_in, audio_effects_left_in,
-				AUDIO_BLOCK_SIZE);
-		copy_buffer(audiochannel_0_right_in, audio_effects_right_in,
-				AUDIO_BLOCK_SIZE);
-
-		// Process audio effects
+		// Process audio effects (they read audiochannel_0_left_in / right_in
+		// and write audiochannel_0_left_out / right_out, see processaudio_setup)
 		audio_effects_process_audio_core1();
 
-		// Copy processed audio back to input buffers
-		copy_buffer(audio_effects_left_out, audiochannel_0_left_in,
+	} else {
+
+		// Default: Pass audio just from 1/8" (or 1/4" on Audio Project Fin) inputs to outputs
+		copy_buffer(audiochannel_0_left_in, audiochannel_0_left_out,
 				AUDIO_BLOCK_SIZE);
-		copy_buffer(audio_effects_right_out, audiochannel_0_right_in,
+		copy_buffer(audiochannel_0_right_in, audiochannel_0_right_out,
 				AUDIO_BLOCK_SIZE);
 
 	}
@@ -248,14 +250,9 @@ void processaudio_callback(void) {
 	for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
 
 		// *******************************************************************************
-		// Replace the pass-through code below with your custom audio processing code here
+		// Add your custom audio processing code here
 		// *******************************************************************************
 
-		// Default: Pass audio just from 1/8" (or 1/4" on Audio Project Fin) inputs to outputs
-
-		audiochannel_0_left_out[i] = audiochannel_0_left_in[i];
-		audiochannel_0_right_out[i] = audiochannel_0_right_in[i];
-
 		/* Below are some additional examples of how to receive audio from the various input buffers
 
 		 // Example: Pass audio just from 1/8" (or 1/4" on Audio Project Fin) inputs to outputs
@@ -305,6 +302,10 @@ void processaudio_callback(void) {
 		// If we're using Faust, copy audio into the flow
 #if (USE_FAUST_ALGORITHM_CORE1)
 
+		// Route audio (after the effects) to Faust for next block
+		audioChannel_faust_0_left_in[i] = audiochannel_0_left_out[i] + audiochannel_spdif_0_left_in[i];
+		audioChannel_faust_0_right_in[i] = audiochannel_0_right_out[i] + audiochannel_spdif_0_right_in[i];
+
 		// Copy 8 channel audio from Faust to output buffers
 		audiochannel_0_left_out[i] = audioChannel_faust_0_left_out[i];
 		audiochannel_0_right_out[i] = audioChannel_faust_0_right_out[i];
@@ -315,10 +316,6 @@ void processaudio_callback(void) {
 		audiochannel_3_left_out[i] = audioChannel_faust_3_left_out[i];
 		audiochannel_3_right_out[i] = audioChannel_faust_3_right_out[i];
 
-		// Route audio to Faust for next block
-		audioChannel_faust_0_left_in[i] = audiochannel_0_left_in[i] + audiochannel_spdif_0_left_in[i];
-		audioChannel_faust_0_right_in[i] = audiochannel_0_right_in[i] + audiochannel_spdif_0_right_in[i];
-
 #endif
 	}
 
@@ -401,6 +398,15 @@ void processaudio_output_routing(void) {
  */
 void processaudio_background_loop(void) {
 
+	// Set up newly selected effect presets (see audio_effects_selector.cpp)
+	audio_effects_background_core1();
+
+#if !(USE_FAUST_ALGORITHM_CORE1)
+	// Only Faust handles the switch events the ARM sends, discard them so the
+	// queue doesn't fill up and count every later event as dropped
+	message_queue_discard(&multicore_data->arm_to_sharc_core1_messages);
+#endif
+
 	// *******************************************************************************
 	// Add any custom background processing here
 	// *******************************************************************************
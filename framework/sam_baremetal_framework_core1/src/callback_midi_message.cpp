@@ -23,9 +23,15 @@
 
 #include "callback_midi_message.h"
 
+// Poly synth in the audio effects receives the parsed MIDI messages
+#include "audio_processing/audio_effects_selector.h"
+
 // Create an instance of our MIDI UART driver
 BM_UART midi_uart_sharc1;
 
+// Assembles the received bytes into MIDI messages
+MIDI_PARSER midi_parser_sharc1;
+
 /**
  * @brief Sets up MIDI on the SHARC Core 1
  *
@@ -33,6 +39,8 @@ BM_UART midi_uart_sharc1;
  */
 bool midi_setup_sharc1(void) {
 
+    midi_parser_setup(&midi_parser_sharc1);
+
     if (uart_initialize(&midi_uart_sharc1, UART_BAUD_RATE_MIDI, UART_SERIAL_8N1, UART_AUDIOPROJ_DEVICE_MIDI)
         != UART_SUCCESS) {
         return false;
@@ -50,18 +58,21 @@ bool midi_setup_sharc1(void) {
 void midi_rx_callback_sharc1(void) {
 
     uint8_t val;
+    MIDI_MESSAGE message;
 
     // Keep reading bytes from MIDI FIFO until we have processed all of them
     while (uart_available(&midi_uart_sharc1)) {
 
-        // Replace the uart_read_byte() / uart_write_byte() functions below with any custom code
-        // This code just passes the received MIDI byte back to MIDI out
-
         // Read the new byte
         uart_read_byte(&midi_uart_sharc1, &val);
 
-        // Write that byte back to MIDI TX
+        // Write that byte back to MIDI TX (MIDI thru)
         uart_write_byte(&midi_uart_sharc1, val);
+
+        // Send complete messages to the poly synth on this core
+        if (midi_parser_read_byte(&midi_parser_sharc1, val, &message)) {
+            audio_effects_midi_message_core1(&message);
+        }
     }
 }
 
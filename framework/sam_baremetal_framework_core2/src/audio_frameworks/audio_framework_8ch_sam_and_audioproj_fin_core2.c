@@ -28,6 +28,9 @@
 // Simple multi-core data sharing scheme
 #include "common/multicore_shared_memory.h"
 
+// Per-scope cycle profiling of the audio callback
+#include "drivers/bm_cycle_profiler_driver/bm_cycle_profiler.h"
+
 // Simple gpio functionality
 #include "drivers/bm_gpio_driver/bm_gpio.h"
 
@@ -82,6 +85,12 @@ uint32_t audio_blocks_new_events_count = 0;
 // Cycle counter used for benchmarking our code
 uint64_t cycle_cntr;
 
+// Profiler scopes around the user audio processing
+static int32_t profile_scope_callback = CYCLE_PROFILER_NO_SCOPE;
+#if defined(USE_FAUST_ALGORITHM_CORE2) && USE_FAUST_ALGORITHM_CORE2
+static int32_t profile_scope_faust = CYCLE_PROFILER_NO_SCOPE;
+#endif
+
 //#pragma optimize_for_speed
 void audioframework_dma_handler(void) {
 
@@ -92,6 +101,7 @@ void audioframework_dma_handler(void) {
 
     // Capture a processor cycle count for benchmarking purposes.
     cycle_cntr = audioflow_get_cpu_cycle_counter();
+    cycle_profiler_block_arrival(multicore_data->reverb_preset);
 
     // Toggle LED12 on the SHARC Audio Module board to show that the audio is running and we're getting interrupts
     static uint16_t tglCntr = 0;
@@ -120,6 +130,9 @@ void audioframework_dma_handler(void) {
         // Update dropped audio frame counter
         multicore_data->sharc_core2_dropped_audio_frames++;
 
+        // Capture the timing of the blocks that led up to this
+        cycle_profiler_block_dropped();
+
         // Don't trigger the software interrupt for audio processing on this block
         return;
     }
@@ -159,13 +172,23 @@ void audioframework_audiocallback_handler(uint32_t iid) {
     // Clear the pending software interrupt
     *pREG_SEC0_END = INTR_SOFT6;
 
+    // Start of the callback for the profiler / trace
+    cycle_profiler_block_start();
+
     // If we're using Faust, run the Faust audio processing before our callback
     #if defined(USE_FAUST_ALGORITHM_CORE2) && USE_FAUST_ALGORITHM_CORE2
+    cycle_profiler_scope_begin(profile_scope_faust);
     Faust_audio_processing();
+    cycle_profiler_scope_end(profile_scope_faust);
     #endif
 
     // Call our audio callback function
+    cycle_profiler_scope_begin(profile_scope_callback);
     processaudio_callback();
+    cycle_profiler_scope_end(profile_scope_callback);
+
+    // Add the cycles of this block to the profile
+    cycle_profiler_block_end();
 
     // Calculate our CPU load for this SHARC core based on our cycle counter
     multicore_data->sharc_core2_cpu_load_mhz = audioflow_get_cpu_load(cycle_cntr,
@@ -197,6 +220,17 @@ void audioframework_initialize() {
     // Clear dropped audio frame counter
     multicore_data->sharc_core2_dropped_audio_frames = 0;
 
+    // Profile the audio callback, publishing the statistics once per second and
+    // capturing the timing of the last blocks when one is dropped
+    cycle_profiler_initialize_sharc_core((BM_CYCLE_PROFILE_TABLE *)&multicore_data->sharc_core2_cycle_profile,
+                                         (BM_CYCLE_TRACE *)&multicore_data->sharc_core2_cycle_trace,
+                                         (CORE_CLOCK_FREQ_HZ / AUDIO_SAMPLE_RATE) * AUDIO_BLOCK_SIZE,
+                                         AUDIO_SAMPLE_RATE / AUDIO_BLOCK_SIZE);
+    profile_scope_callback = cycle_profiler_add_scope("callback");
+    #if defined(USE_FAUST_ALGORITHM_CORE2) && USE_FAUST_ALGORITHM_CORE2
+    profile_scope_faust = cycle_profiler_add_scope("faust");
+    #endif
+
     // Set pointers in shared memory structure so SHARC Core 1 knows where to MDMA data to / from
     multicore_data->sharc_core2_audio_in  = AudioChannels_From_SHARC_Core1;
     multicore_data->sharc_core2_audio_out = AudioChannels_To_SHARC_Core1;
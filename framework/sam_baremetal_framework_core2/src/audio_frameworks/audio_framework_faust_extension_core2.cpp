@@ -111,23 +111,23 @@ void Faust_audio_processing(){
 
 	/**
 	 * If core 1 is also being used for Faust, core 1 will pass along MIDI bytes
-	 * via the fifo in our shared memory structure.  If core 1 is not being used for
+	 * via a message queue in our shared memory structure.  If core 1 is not being used for
 	 * Faust, core 2 will connect to the UART directly.  In this case, new MIDI
 	 * bytes will come in via the faust_midi_rx_callback() routine.
 	 */
 	#if USE_FAUST_ALGORITHM_CORE1
 
-		// check the FIFO for any new bytes.  When read pointer = write pointer, FIFO is empty.
-		if (multicore_data->sh1_sh2_fifo_write_ptr != multicore_data->sh1_sh2_fifo_read_ptr) {
+		// Pass on the MIDI bytes that have arrived from core 1
+		BM_MESSAGE midi_message;
+		while (message_queue_receive(&multicore_data->sharc_core1_to_sharc_core2_messages, &midi_message)) {
 
-			uint8_t midi_byte = multicore_data->sh1_sh2_byte_fifo[multicore_data->sh1_sh2_fifo_read_ptr++];
-
-			// Wrap the read pointer if necessary
-			if (multicore_data->sh1_sh2_fifo_read_ptr >= SH1_SH2_BYTE_FIFO_SIZE) {
-				multicore_data->sh1_sh2_fifo_read_ptr = 0;
+			if (midi_message.type != MESSAGE_TYPE_MIDI) {
+				continue;
 			}
 
-			faust_core2_process_midi(midi_byte);
+			for (uint32_t i = 0; i < midi_message.id; i++) {
+				faust_core2_process_midi((midi_message.data.word[0] >> (8 * i)) & 0xFF);
+			}
 		}
 
 	#endif
@@ -145,10 +145,14 @@ void Faust_audio_processing(){
 
     // pots are always on CC-2,3,4
 
+    // latch one consistent set of pot values for this block
+    static BM_PARAMETER_SNAPSHOT pots;
+    parameter_snapshot_latch(&multicore_data->audioproj_fin_hadc, &pots);
+
     float epsilon = 1.0 / 50.0;
 
     // lock the value of the pot.
-    float currentPotValue0 = multicore_data->audioproj_fin_pot_hadc0;
+    float currentPotValue0 = pots.values[AUDIOPROJ_FIN_POT_HADC0];
     // if it changed then send MIDI to the samFaustDSP object
     if ((currentPotValue0 >= (lastPotValue0 + epsilon)) || (currentPotValue0 <= (lastPotValue0 - epsilon))) {
         lastPotValue0 = currentPotValue0;
@@ -157,7 +161,7 @@ void Faust_audio_processing(){
     }
 
     // lock the value of the pot.
-    float currentPotValue1 = multicore_data->audioproj_fin_pot_hadc1;
+    float currentPotValue1 = pots.values[AUDIOPROJ_FIN_POT_HADC1];
     // if it changed then send MIDI to the samFaustDSP object
     if ((currentPotValue1 >= (lastPotValue1 + epsilon)) || (currentPotValue1 <= (lastPotValue1 - epsilon))) {
         lastPotValue1 = currentPotValue1;
@@ -166,7 +170,7 @@ void Faust_audio_processing(){
     }
 
     // lock the value of the pot.
-    float currentPotValue2 = multicore_data->audioproj_fin_pot_hadc2;
+    float currentPotValue2 = pots.values[AUDIOPROJ_FIN_POT_HADC2];
     // if it changed then send MIDI to the samFaustDSP object
     if ((currentPotValue2 >= (lastPotValue2 + epsilon)) || (currentPotValue2 <= (lastPotValue2 - epsilon))) {
         lastPotValue2 = currentPotValue2;
@@ -175,28 +179,33 @@ void Faust_audio_processing(){
     }
 
     // push buttons are always CC-102(66H), 103(67H), 104(68H), 105(69H)
-    if (multicore_data->audioproj_fin_sw_1_core2_pressed) {
-        multicore_data->audioproj_fin_sw_1_core2_pressed = false;
-        enablePB1 = !enablePB1;
-        faust_handle_pushbutton(enablePB1, 0x66);
-    }
-
-    if (multicore_data->audioproj_fin_sw_2_core2_pressed) {
-        multicore_data->audioproj_fin_sw_2_core2_pressed = false;
-        enablePB2 = !enablePB2;
-        faust_handle_pushbutton(enablePB2, 0x67);
-    }
-
-    if (multicore_data->audioproj_fin_sw_3_core2_pressed) {
-        multicore_data->audioproj_fin_sw_3_core2_pressed = false;
-        enablePB3 = !enablePB3;
-        faust_handle_pushbutton(enablePB3, 0x68);
-    }
-
-    if (multicore_data->audioproj_fin_sw_4_core2_pressed) {
-        multicore_data->audioproj_fin_sw_4_core2_pressed = false;
-        enablePB4 = !enablePB4;
-        faust_handle_pushbutton(enablePB4, 0x69);
+    BM_MESSAGE message;
+    while (message_queue_receive(&multicore_data->arm_to_sharc_core2_messages, &message)) {
+
+        if (message.type != MESSAGE_TYPE_SWITCH) {
+            continue;
+        }
+
+        switch (message.id) {
+            case MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_1:
+                enablePB1 = !enablePB1;
+                faust_handle_pushbutton(enablePB1, 0x66);
+                break;
+            case MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_2:
+                enablePB2 = !enablePB2;
+                faust_handle_pushbutton(enablePB2, 0x67);
+                break;
+            case MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_3:
+                enablePB3 = !enablePB3;
+                faust_handle_pushbutton(enablePB3, 0x68);
+                break;
+            case MESSAGE_SWITCH_AUDIOPROJ_FIN_SW_4:
+                enablePB4 = !enablePB4;
+                faust_handle_pushbutton(enablePB4, 0x69);
+                break;
+            default:
+                break;
+        }
     }
 
     // run the FAUST call back
@@ -118,6 +118,11 @@
  */
 void processaudio_setup(void) {
 
+	// Let the effects work directly on the framework's channel 0 buffers so
+	// the audio doesn't have to be copied in and out of the effects
+	audio_effects_set_buffers(audiochannel_0_left_in, audiochannel_0_right_in,
+			audiochannel_0_left_out, audiochannel_0_right_out);
+
 	// Initialize the audio effects in the audio_processing/ folder
 	audio_effects_setup_core2();
 
@@ -154,16 +159,15 @@ void processaudio_callback(void) {
 
 	if (true) {
 
-		// Copy incoming audio buffers to the effects input buffers
-		copy_buffer(audiochannel_0_left_in,  audio_effects_left_in, AUDIO_BLOCK_SIZE);
-		copy_buffer(audiochannel_0_right_in, audio_effects_right_in, AUDIO_BLOCK_SIZE);
-
-		// Process audio effects
+		// Process audio effects (they read audiochannel_0_left_in / right_in
+		// and write audiochannel_0_left_out / right_out, see processaudio_setup)
 		audio_effects_process_audio_core2();
 
-		// Copy processed audio back to input buffers
-		copy_buffer(audio_effects_left_out, audiochannel_0_left_in, AUDIO_BLOCK_SIZE);
-		copy_buffer(audio_effects_right_out, audiochannel_0_right_in, AUDIO_BLOCK_SIZE);
+	} else {
+
+		// Pass audio through
+		copy_buffer(audiochannel_0_left_in,  audiochannel_0_left_out, AUDIO_BLOCK_SIZE);
+		copy_buffer(audiochannel_0_right_in, audiochannel_0_right_out, AUDIO_BLOCK_SIZE);
 
 	}
 
@@ -173,8 +177,6 @@ void processaudio_callback(void) {
         // Replace the pass-through code below with your custom audio processing code here
         // *******************************************************************************
 
-        audiochannel_0_left_out[i]  = audiochannel_0_left_in[i];
-        audiochannel_0_right_out[i] = audiochannel_0_right_in[i];
         audiochannel_1_left_out[i]  = audiochannel_1_left_in[i];
         audiochannel_1_right_out[i] = audiochannel_1_right_in[i];
         audiochannel_2_left_out[i]  = audiochannel_2_left_in[i];
@@ -199,6 +201,16 @@ void processaudio_callback(void) {
         // If we're using Faust, route audio into the flow
         #if defined(USE_FAUST_ALGORITHM_CORE2) && USE_FAUST_ALGORITHM_CORE2
 
+            // Route 8 channel audio (after the effects) to Faust for next block
+            audioChannel_faust_0_left_in[i]  = audiochannel_0_left_out[i];
+            audioChannel_faust_0_right_in[i] = audiochannel_0_right_out[i];
+            audioChannel_faust_1_left_in[i]  = audiochannel_1_left_in[i];
+            audioChannel_faust_1_right_in[i] = audiochannel_1_right_in[i];
+            audioChannel_faust_2_left_in[i]  = audiochannel_2_left_in[i];
+            audioChannel_faust_2_right_in[i] = audiochannel_2_right_in[i];
+            audioChannel_faust_3_left_in[i]  = audiochannel_3_left_in[i];
+            audioChannel_faust_3_right_in[i] = audiochannel_3_right_in[i];
+
             // Mix in 8 channel audio from Faust
             audiochannel_0_left_out[i]  = audioChannel_faust_0_left_out[i];
             audiochannel_0_right_out[i] = audioChannel_faust_0_right_out[i];
@@ -209,16 +221,6 @@ void processaudio_callback(void) {
             audiochannel_3_left_out[i]  = audioChannel_faust_3_left_out[i];
             audiochannel_3_right_out[i] = audioChannel_faust_3_right_out[i];
 
-            // Route 8 channel audio to Faust for next block
-            audioChannel_faust_0_left_in[i]  = audiochannel_0_left_in[i];
-            audioChannel_faust_0_right_in[i] = audiochannel_0_right_in[i];
-            audioChannel_faust_1_left_in[i]  = audiochannel_1_left_in[i];
-            audioChannel_faust_1_right_in[i] = audiochannel_1_right_in[i];
-            audioChannel_faust_2_left_in[i]  = audiochannel_2_left_in[i];
-            audioChannel_faust_2_right_in[i] = audiochannel_2_right_in[i];
-            audioChannel_faust_3_left_in[i]  = audiochannel_3_left_in[i];
-            audioChannel_faust_3_right_in[i] = audiochannel_3_right_in[i];
-
         #endif
     }
 }
@@ -229,6 +231,15 @@ void processaudio_callback(void) {
  */
 void processaudio_background_loop(void) {
 
+    // Set up effects moving from core 1 (see audio_effects_selector.cpp)
+    audio_effects_background_core2();
+
+#if !(defined(USE_FAUST_ALGORITHM_CORE2) && USE_FAUST_ALGORITHM_CORE2)
+    // Only Faust handles the switch events the ARM sends, discard them so the
+    // queue doesn't fill up and count every later event as dropped
+    message_queue_discard(&multicore_data->arm_to_sharc_core2_messages);
+#endif
+
     // *******************************************************************************
     // Add any custom background processing here
     // *******************************************************************************